@@ -55,7 +55,11 @@ void CalcAttackState (register ENGINE *E)
       INT mobSum = 0;
       for (SQUARE sq = a1; sq <= h8; sq++)                 // Compute attack table, pawn
          if (onBoard(sq) && E->B.Board[sq])                // structure and mobility.
+#ifdef __engine_asm
             mobSum += UpdPieceAttack(sq);
+#else
+            mobSum += UpdPieceAttack(E, sq);
+#endif
       E->S.rootNode->mobEval = mobSum;
    Asm_End();
 } /* CalcAttackState */
@@ -73,6 +77,8 @@ void CalcAttackState (register ENGINE *E)
 // is handled by the "UpdPieceAttack(sq)" routine which simply inverts the relevant attack bits for
 // the affected squares.
 
+#ifdef __engine_asm
+
 #define wdispatch(L)  addi rTmp4,rTmp4,ENGINE.A.AttackW ; b L
 #define bdispatch(L)  addi rTmp4,rTmp4,ENGINE.A.AttackB ; b L
 
@@ -375,6 +381,107 @@ asm INT UpdBlockAttack (register SQUARE sq)
    #undef dm
 } /* UpdBlockAttack */
 
+#else
+
+/*------------------------------------- Portable Versions ----------------------------------------*/
+// C versions of the two routines above. They don't rely on the global registers, so the engine
+// "E" is passed explicitly (and the current node for the block attack update).
+
+INT UpdPieceAttack (ENGINE *E, SQUARE sq)
+{
+   PIECE  *Board = E->B.Board;
+   PIECE  piece  = Board[sq];
+   ATTACK *A     = (pieceColour(piece) == white ? E->A.AttackW : E->A.AttackB);
+   INT    dm     = (pieceColour(piece) == white ? 1 : -1);
+   INT    dmob   = 0;
+
+   switch (pieceType(piece))
+   {
+      case pawn :
+         if (piece == wPawn)
+         {  A[sq + 0x0F] ^= pMaskL;
+            A[sq + 0x11] ^= pMaskR;
+            E->B.PawnStructW[rank(sq)] ^= bit(file(sq));
+         }
+         else
+         {  A[sq - 0x11] ^= pMaskL;
+            A[sq - 0x0F] ^= pMaskR;
+            E->B.PawnStructB[rank(sq)] ^= bit(file(sq));
+         }
+         break;
+
+      case knight :
+         UpdKnightAttack(A, sq);
+         break;
+
+      case bishop :
+         dm *= bishopMob;
+         dmob += UpdRayAttack(Board, A, sq, -0x0F, 0x0100, dm);
+         dmob += UpdRayAttack(Board, A, sq, -0x11, 0x0200, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x11, 0x0400, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x0F, 0x0800, dm);
+         break;
+
+      case rook :
+         dm *= rookMob;
+         dmob += UpdRayAttack(Board, A, sq, -0x10, 0x1000, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x10, 0x2000, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x01, 0x4000, dm);
+         dmob += UpdRayAttack(Board, A, sq, -0x01, 0x8000, dm);
+         break;
+
+      case queen :
+         dm *= queenMob;
+         dmob += UpdRayAttack(Board, A, sq, -0x0F, 0x0001, dm);
+         dmob += UpdRayAttack(Board, A, sq, -0x11, 0x0002, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x11, 0x0004, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x0F, 0x0008, dm);
+         dmob += UpdRayAttack(Board, A, sq, -0x10, 0x0010, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x10, 0x0020, dm);
+         dmob += UpdRayAttack(Board, A, sq, +0x01, 0x0040, dm);
+         dmob += UpdRayAttack(Board, A, sq, -0x01, 0x0080, dm);
+         break;
+
+      case king :
+         UpdKingAttack(A, sq);
+         break;
+   }
+
+   return dmob;
+} /* UpdPieceAttack */
+
+
+static INT UpdBlockAttack1 (ENGINE *E, ATTACK *A, SQUARE sq)
+{
+   ATTACK_COMMON *AC = &E->Global->A;
+   PIECE  *Board = E->B.Board;
+   ATTACK At     = A[sq] & qrbMask;
+   INT    bits   = qrbBits(At);
+   INT    dmob   = 0;
+
+   while (bits)
+   {
+      INT    j   = AC->LowBit[bits];
+      SQUARE dir = E->Global->B.QueenDir[j];
+      ATTACK dA  = (0x0101 << j) & At;
+      INT    dm  = (dA & bMask ? bishopMob : (dA & rMask ? rookMob : queenMob));
+
+      dmob += UpdRayAttack(Board, A, sq, dir, dA, dm);
+      bits ^= bit(j);
+   }
+
+   return dmob;
+} /* UpdBlockAttack1 */
+
+
+INT UpdBlockAttack (ENGINE *E, NODE *N, SQUARE sq)
+{
+   INT dmob = UpdBlockAttack1(E, N->Attack, sq) - UpdBlockAttack1(E, N->Attack_, sq);
+   return (N->player == white ? dmob : -dmob);
+} /* UpdBlockAttack */
+
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -470,8 +577,12 @@ static void ComputeAttackDir (GLOBAL *Global)
       A->AttackDir[Global->B.KnightDir[i]] = nDirMask;
    }
 
-   A->AttackDir[0x11]  |= wPawnDirMask; A->AttackDir[0xF]  |= wPawnDirMask;
-   A->AttackDir[-0x11] |= bPawnDirMask; A->AttackDir[-0xF] |= bPawnDirMask;
+   // Pawn capture directions. NB: Not set via constant negative indices (e.g. AttackDir[-0x11]),
+   // since an optimizing compiler may then assume that they don't alias the entries set above.
+   for (INT i = 0; i < 4; i++)
+   {  SQUARE dir = Global->B.BishopDir[i];
+      A->AttackDir[dir] |= (dir > 0 ? wPawnDirMask : bPawnDirMask);
+   }
 
    A->AttackDirMask[wQueen]  = qDirMask;
    A->AttackDirMask[wRook]   = rDirMask;
@@ -36,5 +36,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 void InitAttackModule (GLOBAL *Global);
 
 void CalcAttackState (register ENGINE *E);
+#ifdef __engine_asm
 asm INT UpdPieceAttack (register SQUARE sq);  // Returns the mobility change
 asm INT UpdBlockAttack (register SQUARE sq);  // Returns the mobility change
+#else
+INT UpdPieceAttack (ENGINE *E, SQUARE sq);
+INT UpdBlockAttack (ENGINE *E, NODE *N, SQUARE sq);
+#endif
@@ -26,6 +26,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "General.h"
 #include "Board.h"
+#include "AsmDef.h"
 
 
 /**************************************************************************************************/
@@ -224,3 +225,57 @@ typedef struct
 
    BLOCKTAB BlockTab[256];             // Table facilitating updating of block attack.
 } ATTACK_COMMON;
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                         PORTABLE HELPERS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#ifndef __engine_asm
+
+// C counterparts of the assembler macros above. UpdRayAttack toggles "abit" along the ray from
+// "sq" in direction "dir" up to and including the first non-empty square, and returns the
+// resulting mobility change (dm per square toggled).
+
+inline INT UpdRayAttack (PIECE Board[], ATTACK A[], SQUARE sq, SQUARE dir, ATTACK abit, INT dm)
+{
+   INT dmob = 0;
+
+   do
+   {  sq += dir;
+      A[sq] ^= abit;
+      dmob += dm;
+   } while (Board[sq] == empty);
+
+   return dmob;
+} /* UpdRayAttack */
+
+
+inline void UpdKnightAttack (ATTACK A[], SQUARE sq)
+{
+   A[sq - 14] ^= 0x00010000;
+   A[sq - 18] ^= 0x00020000;
+   A[sq - 31] ^= 0x00040000;
+   A[sq - 33] ^= 0x00080000;
+   A[sq + 18] ^= 0x00100000;
+   A[sq + 14] ^= 0x00200000;
+   A[sq + 33] ^= 0x00400000;
+   A[sq + 31] ^= 0x00800000;
+} /* UpdKnightAttack */
+
+
+inline void UpdKingAttack (ATTACK A[], SQUARE sq)
+{
+   A[sq - 1]  ^= kMask;
+   A[sq + 1]  ^= kMask;
+   A[sq - 16] ^= kMask;
+   A[sq + 16] ^= kMask;
+   A[sq - 15] ^= kMask;
+   A[sq + 15] ^= kMask;
+   A[sq - 17] ^= kMask;
+   A[sq + 17] ^= kMask;
+} /* UpdKingAttack */
+
+#endif
@@ -32,7 +32,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "Engine.h"
-#include "TaskScheduler.h"
+#ifndef __engine_threads
+   #include "TaskScheduler.h"
+#endif
 
 #include "Engine.f"
 #include "Board.f"
@@ -42,7 +44,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Evaluate.f"
 #include "PieceVal.f"
 #include "Search.f"
+#include "SMP.f"
 #include "HashCode.f"
+#include "EndgameDB.f"
+#include "Tablebase.f"
+#include "TransTables.f"
 #include "Time.f"
 
 
@@ -58,7 +64,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // the entire engine state (excluding transposition tables, opening libraries and endgame databases).
 //
 // The engine can run as a separate task, and supports multiple engine instances, i.e. the
-// engine can search multiple positions simultaneously via multitasking.
+// engine can search multiple positions simultaneously via multitasking. In builds with
+// "__engine_threads" each engine instead runs in its own (preemptive) OS thread.
 
 
 /**************************************************************************************************/
@@ -70,9 +77,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*------------------------------------- Initialize Engine System ---------------------------------*/
 // At startup the common "Global" engine data structure is initialized. However, allocation of
 // this structure is left to the calling host application, in order to keep all memory allocation
-// and global data structure definitions outside the engine.
+// and global data structure definitions outside the engine. If "Tables" is supplied, the read only
+// tables are copied from there (and "kpkData" is ignored).
 
-void Engine_InitSystem (GLOBAL *Global, PTR kpkData)
+void Engine_InitSystem (GLOBAL *Global, PTR kpkData, const ENGINE_TABLES *Tables)
 {
    Global->msgBitTab = 0;
 
@@ -80,18 +88,53 @@ void Engine_InitSystem (GLOBAL *Global, PTR kpkData)
    for (INT i = 0; i < maxEngines; i++)
       Global->Engine[i] = nil;
 
-   // The remaining engine modules MUST be initialized in the following order:
-   InitBoardModule(Global);
-   InitAttackModule(Global);
-   InitMoveGenModule(Global);
-   InitPerformMoveModule(Global);
-   InitPieceValModule(Global);
-   InitEvaluateModule(Global, kpkData);
-   InitSearchModule(Global);
-   InitHashCodeModule(Global);
+   if (Tables && Tables->size == sizeof(ENGINE_TABLES))
+   {
+      Global->B = Tables->B;
+      Global->A = Tables->A;
+      Global->M = Tables->M;
+      Global->P = Tables->P;
+      Global->H = Tables->H;
+      Global->V = Tables->V;
+      Global->E = Tables->E;
+   }
+   else
+   {
+      // The remaining engine modules MUST be initialized in the following order:
+      InitBoardModule(Global);
+      InitAttackModule(Global);
+      InitMoveGenModule(Global);
+      InitPerformMoveModule(Global);
+      InitPieceValModule(Global);
+      InitEvaluateModule(Global, kpkData);
+      InitSearchModule(Global);
+      InitHashCodeModule(Global);
+   }
+
+   InitEndgameDBModule(Global);
+#ifndef __engine_asm
+   InitTablebaseModule(Global);
+#endif
 } /* Engine_InitSystem */
 
 
+// Takes a snapshot of the read only tables (after Engine_InitSystem).
+
+void Engine_GetTables (GLOBAL *Global, ENGINE_TABLES *Tables)
+{
+   ClearBlock((PTR)Tables, sizeof(ENGINE_TABLES));   // (Incl. any padding).
+
+   Tables->size = sizeof(ENGINE_TABLES);
+   Tables->B = Global->B;
+   Tables->A = Global->A;
+   Tables->M = Global->M;
+   Tables->P = Global->P;
+   Tables->H = Global->H;
+   Tables->V = Global->V;
+   Tables->E = Global->E;
+} /* Engine_GetTables */
+
+
 /**************************************************************************************************/
 /*                                                                                                */
 /*                                      CREATE/DISPOSE ENGINE                                     */
@@ -125,10 +168,24 @@ BOOL Engine_Create (GLOBAL *Global, ENGINE *E, ULONG refID)
    E->R.taskID = 0;
    E->R.taskRunning = false;
    E->R.state = state_Stopped;
+#ifdef __engine_threads
+   E->R.hostRequest = -1;
+   E->R.threadActive = false;
+   E->msgSync = 0;
+   E->hostWaiting = false;
+   pthread_mutex_init(&E->msgLock, nil);
+   pthread_cond_init(&E->msgCond, nil);
+#endif
+
+   E->SMP.helperCount = 0;
+   E->SMP.activeHelpers = 0;
+   E->SMP.helperMoveCount = 0;
+   E->SMP.Master = nil;
 
    InitSearchParam(&E->P);
    InitBoardState(&E->B);
    InitSearchState(E);
+   InitEvaluateState(E);
 
    return true;
 } /* Engine_Create */
@@ -144,6 +201,7 @@ static void InitSearchParam (PARAM *P)     // Initializes the search parameters
    P->extensions      = true;
    P->selection       = true;
    P->deepSelection   = false;
+   P->selMargin       = 4;
    P->nondeterm       = false;
    P->useEndgameDB    = true;
    P->proVersion      = true;
@@ -154,12 +212,17 @@ static void InitSearchParam (PARAM *P)     // Initializes the search parameters
    P->movesLeft       = allMoves;          // Moves left to next time control.
    P->timeLeft        = 300;               // Time left in seconds to next time control (if time mode).
    P->timeInc         = 0;
+   P->timeLeftMS      = 0;                 // Time in milliseconds (UCI) not used.
+   P->timeIncMS       = 0;
+   P->moveTimeMS      = 0;
+   P->nodeLimit       = 0;
    P->moveTime        = 5;
    P->depth           = 1;                 // Depth/level if fixed depth, mate finder or novice.
    P->playingStyle    = style_Normal;
    P->reduceStrength  = false;
    P->engineELO       = 2400;
    P->nextBest        = false;
+   P->multiPV         = 1;
 
    // Opening Library:
    P->Library         = nil;               // Opening library to be used.
@@ -168,6 +231,12 @@ static void InitSearchParam (PARAM *P)     // Initializes the search parameters
    // Transposition Tables:
    P->TransTables     = nil;               // Transposition table memory block.
    P->transSize       = 0;
+
+   // SMP:
+   P->threads         = 1;                 // Single threaded (no helper engines).
+
+   // Search Trace:
+   P->Trace           = nil;               // No tracing.
 } /* InitSearchParam */
 
 /*----------------------------------------- Destroy Engine ---------------------------------------*/
@@ -182,11 +251,89 @@ void Engine_Destroy (ENGINE *E)
       Engine_Abort(E);
 
    // Remove from engine table:
-   G->msgBitTab &= ~bit(E->localID);  // Can't use ^= because we are not sure if bit is set
+   G->msgBitTab &= ~engineBit(E->localID);  // Can't use ^= because we are not sure if bit is set
    G->Engine[E->localID] = nil;
    G->engineCount--;
+
+   Engine_RemoveHelpers(E);
+
+#ifdef __engine_threads
+   pthread_cond_destroy(&E->msgCond);
+   pthread_mutex_destroy(&E->msgLock);
+#endif
 } /* Engine_Destroy */
 
+/*-------------------------------------- Add/Remove SMP Helpers ----------------------------------*/
+// Attaches the helper engine "H" to the master engine "E" (see "SMP.c"). As for Engine_Create,
+// the helper struct must have been allocated by the caller. Helpers are not entered in the
+// engine table, and are only used if E->P.threads > 1. Returns false if no more helpers can be
+// attached, or if helper threads aren't supported by this build.
+
+BOOL Engine_AddHelper (ENGINE *E, ENGINE *H)
+{
+#ifdef __engine_smp
+   if (! E || ! H || E->SMP.Master || E->SMP.helperCount >= maxSearchThreads - 1 || E->R.taskRunning)
+      return false;
+
+   H->refID    = E->refID;
+   H->localID  = E->localID;
+   H->Global   = E->Global;
+   H->msgQueue = 0;
+   H->UCI      = false;
+
+   H->R.taskID = 0;
+   H->R.taskRunning = false;
+   H->R.state = state_Stopped;
+
+   H->SMP.helperCount = 0;
+   H->SMP.activeHelpers = 0;
+   H->SMP.helperMoveCount = 0;
+   H->SMP.Master   = E;
+   H->SMP.helperNo = E->SMP.helperCount;
+
+   InitSearchParam(&H->P);
+   InitBoardState(&H->B);
+   InitSearchState(H);
+   InitEvaluateState(H);
+
+   E->SMP.Helper[E->SMP.helperCount++] = H;
+   return true;
+#else
+   return false;
+#endif
+} /* Engine_AddHelper */
+
+// Detaches all helpers (which may then be deallocated by the caller).
+
+void Engine_RemoveHelpers (ENGINE *E)
+{
+   SMP_Abort(E);
+   E->SMP.helperCount = 0;
+} /* Engine_RemoveHelpers */
+
+/*--------------------------------- Transposition Table Snapshots --------------------------------*/
+// The host may save the transposition tables (along with Engine_TransGeneration()) and reload
+// them later, e.g. to resume a long analysis. After pointing E->P.TransTables/transSize to the
+// reloaded tables, the host calls Engine_ResumeTransTab(), so the next search uses the scores of
+// the snapshot instead of starting a new generation (which only keeps the moves). Returns false
+// if the tables can't be resumed (e.g. too small, or not supported by this build).
+
+BOOL Engine_ResumeTransTab (ENGINE *E, LONG generation)
+{
+#ifndef __engine_asm
+   if (E->R.taskRunning || generation < 1) return false;
+
+   CalcTransState(E);
+   if (! E->Tr.transTabOn) return false;
+
+   E->Tr.generation = generation;
+   E->Tr.resume     = true;
+   return true;
+#else
+   return false;
+#endif
+} /* Engine_ResumeTransTab */
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -197,7 +344,33 @@ void Engine_Destroy (ENGINE *E)
 /*----------------------------------------- Start Engine -----------------------------------------*/
 // This routine starts the engine, i.e. the engine starts analyzing the specified position
 // given the specified search constraints/parameters (the PARAM record in the ENGINE data).
-// This call starts a separate task in which the engine runs.
+// This call starts a separate task in which the engine runs (or a separate thread if
+// "__engine_threads").
+
+#if defined(__engine_threads)
+
+static void *Engine_ThreadFunc (void *data)
+{
+   ENGINE *E = (ENGINE*)data;
+
+   MainSearch(E);
+
+   pthread_mutex_lock(&E->msgLock);                 // Wake up the host (MainSearch has cleared
+   pthread_cond_broadcast(&E->msgCond);             // "taskRunning").
+   pthread_mutex_unlock(&E->msgLock);
+   return nil;
+} /* Engine_ThreadFunc */
+
+
+static void JoinEngineThread (ENGINE *E)
+{
+   if (E->R.threadActive && ! pthread_equal(E->thread, pthread_self()))
+   {  pthread_join(E->thread, nil);
+      E->R.threadActive = false;
+   }
+} /* JoinEngineThread */
+
+#elif defined(__engine_asm)
 
 asm LONG Engine_TaskFuncASM (void *data);
 
@@ -206,16 +379,45 @@ asm LONG Engine_TaskFuncASM (void *data)
    taskFuncWrapper(MainSearch)
 } /* Engine_TaskFuncASM */
 
+#else
+
+static LONG Engine_TaskFuncASM (void *data)
+{
+   MainSearch((ENGINE*)data);
+   return 0;
+} /* Engine_TaskFuncASM */
+
+#endif
+
 
 void Engine_Start (ENGINE *E)
 {
+#ifndef __engine_threads
    E->Global->currentEngine = E;  //### Only for debugging (single engine instance).
+#endif
    E->R.taskRunning = true;
    
    if (E->UCI)
       MainSearch_BeginUCI(E);
    else
+   {
+#ifdef __engine_threads
+      JoinEngineThread(E);                          // Previous search (if not joined by the host).
+      E->R.taskRunning = true;
+      E->R.hostRequest = -1;
+      E->msgQueue = 0;
+      E->msgSync  = 0;
+
+      pthread_attr_t attr;
+      pthread_attr_init(&attr);
+      pthread_attr_setstacksize(&attr, smpStackSize);
+      E->R.threadActive = (pthread_create(&E->thread, &attr, Engine_ThreadFunc, (void*)E) == 0);
+      if (! E->R.threadActive) E->R.taskRunning = false;
+      pthread_attr_destroy(&attr);
+#else
       E->R.taskID = Task_Create(Engine_TaskFuncASM, (PTR)E);
+#endif
+   }
 } /* Engine_Start */
 
 /*--------------------------------------- Stop/Abort Engine --------------------------------------*/
@@ -226,7 +428,11 @@ void Engine_Stop (ENGINE *E)
       if (E->UCI)
          MainSearch_EndUCI(E);
       else
-         E->R.state = state_Stopping;
+      {  E->R.state = state_Stopping;
+#ifdef __engine_threads
+         E->R.hostRequest = state_Stopping;       // In case the engine thread is still preparing.
+#endif
+      }
 
    E->R.aborted = false;
 } /* Engine_Stop */
@@ -236,16 +442,33 @@ void Engine_Abort (ENGINE *E)
 {
    E->R.state = state_Stopped;
    E->R.aborted = true;
+
+#ifdef __engine_threads
+   if (! E->UCI && E->R.threadActive && ! pthread_equal(E->thread, pthread_self()))
+   {  pthread_mutex_lock(&E->msgLock);              // Wake the engine if waiting for a reply, and
+      E->R.hostRequest = state_Stopped;             // wait for it to finish (which also stops its
+      E->msgSync = 0;                               // helpers).
+      pthread_cond_broadcast(&E->msgCond);
+      pthread_mutex_unlock(&E->msgLock);
+      JoinEngineThread(E);
+      E->R.taskRunning = false;
+   }
+#endif
+
    E->msgQueue = 0;
-   E->Global->msgBitTab &= ~bit(E->localID);  // Can't use ^= because we are not sure if bit is set
+   E->Global->msgBitTab &= ~engineBit(E->localID);  // Can't use ^= because we are not sure if bit is set
+
+   SMP_Abort(E);
 
    if (E->UCI)
    {  E->R.taskRunning = false;
    }
+#ifndef __engine_threads
    else if (E->R.taskRunning && E->R.taskID != Task_GetCurrent())
    {  Task_Kill(E->R.taskID);
       E->R.taskRunning = false;
    }
+#endif
 } /* Engine_Abort */
 
 
@@ -294,18 +517,52 @@ BOOL Engine_OtherRunning (GLOBAL *Global, ENGINE *Except)
 
 void Engine_Periodic (ENGINE *E)
 {
-   if (E->UCI || Timer() < E->S.periodicTime) return;
+   LONG64 now     = MicroTimer();
+   LONG64 elapsed = now - E->S.startMicroTime;
 
-   if (E->Tr.transSize > 0)
-      E->S.hashFull = (10*E->Tr.transUsed)/MaxL(1,E->Tr.transSize/100);
+   if (elapsed > 0)                              // Adapt node polling interval to measured NPS.
+   {  LONG64 n = (E->S.moveCount*pollMicroSecs)/elapsed;
+      E->S.pollNodes = (n < minPollNodes ? minPollNodes : (n > maxPollNodes ? maxPollNodes : (LONG)n));
+   }
+
+#ifdef __engine_smp
+   if (E->SMP.Master)                            // SMP helpers only publish their move count
+   {                                             // and check if they should stop (see "SMP.c").
+      __atomic_store_n(&E->SMP.moveCount, E->S.moveCount, __ATOMIC_RELAXED);
+      if (__atomic_load_n(&E->SMP.stop, __ATOMIC_ACQUIRE)) E->R.state = state_Stopping;
+      return;
+   }
+#endif
+
+#ifdef __engine_threads
+   INT request = E->R.hostRequest;               // Stop/abort from the host thread.
+   if (request >= 0 && E->R.state != state_Stopped && E->R.state != request)
+      E->R.state = request;
+#endif
+
+   if (E->UCI) return;
 
-   if (TimeOut(E) && E->R.state == state_Running)
+   if (E->R.state == state_Running &&                // Time and node limits are checked at every
+       (TimeOut(E) ||                                // poll, the rest only every 5 (or 20) ticks.
+        (E->P.nodeLimit > 0 && E->S.moveCount >= E->P.nodeLimit)))
       Engine_Stop(E);
 
+   if (now < E->S.periodicTime) return;
+
+   SMP_Periodic(E);
+
+   if (E->Tr.transSize > 0)
+      E->S.hashFull = TransTabUsage(E);
+
+#ifdef __engine_threads
+   SendMsg_Async(E, msg_Periodic);
+   E->S.periodicTime = now + ticksToMicroSecs(5);
+#else
    E->msgQueue |= msg_Periodic;
-   E->Global->msgBitTab |= bit(E->localID);
+   E->Global->msgBitTab |= engineBit(E->localID);
    Task_Switch();
-   E->S.periodicTime = Timer() + (Task_GetCount() > 2 ? 5 : 20);
+   E->S.periodicTime = MicroTimer() + ticksToMicroSecs(Task_GetCount() > 2 ? 5 : 20);
+#endif
 } /* Engine_Periodic */
 
 
@@ -319,26 +576,117 @@ void Engine_Periodic (ENGINE *E)
 // via the specified callback routine (which is mainly used for displaying the information
 // to the user).
 
+#ifdef __engine_threads
+
+// The message bits are posted lock-free. The mutex is only taken to wake up the host if it's
+// blocked in Engine_WaitMsg() (which sets "hostWaiting" before checking the queue, so a message
+// can't slip in unnoticed).
+
+static void PostMsg (ENGINE *E, ULONG message)
+{
+   __atomic_fetch_or(&E->msgQueue, message, __ATOMIC_SEQ_CST);
+   __atomic_fetch_or(&E->Global->msgBitTab, engineBit(E->localID), __ATOMIC_SEQ_CST);
+
+   if (__atomic_load_n(&E->hostWaiting, __ATOMIC_SEQ_CST))
+   {  pthread_mutex_lock(&E->msgLock);
+      pthread_cond_broadcast(&E->msgCond);
+      pthread_mutex_unlock(&E->msgLock);
+   }
+} /* PostMsg */
+
+
 void SendMsg_Async (ENGINE *E, ULONG message)
 {
+   if (E->SMP.Master) return;                    // SMP helpers are invisible to the host.
+
+   if (E->UCI)
+   {  E->msgQueue |= message;
+      E->Global->msgBitTab |= engineBit(E->localID);
+   }
+   else
+      PostMsg(E, message);
+} /* SendMsg_Async */
+
+
+void SendMsg_Sync (ENGINE *E, ULONG message)
+{
+   if (E->SMP.Master || E->UCI) return;
+
+   pthread_mutex_lock(&E->msgLock);
+   if (E->R.hostRequest != state_Stopped)        // Don't wait if the host is aborting.
+   {  E->msgSync = message;
+      __atomic_fetch_or(&E->msgQueue, message, __ATOMIC_SEQ_CST);
+      __atomic_fetch_or(&E->Global->msgBitTab, engineBit(E->localID), __ATOMIC_SEQ_CST);
+      pthread_cond_broadcast(&E->msgCond);
+      while (E->msgSync && E->R.hostRequest != state_Stopped)
+         pthread_cond_wait(&E->msgCond, &E->msgLock);
+   }
+   pthread_mutex_unlock(&E->msgLock);
+} /* SendMsg_Sync */
+
+/*----------------------------------------- Host Side --------------------------------------------*/
+// Called by the host thread. Waits until the engine has posted messages and returns them (clearing
+// the queue). Returns 0 when the engine has terminated (the engine thread has then been joined).
+
+ULONG Engine_WaitMsg (ENGINE *E)
+{
+   pthread_mutex_lock(&E->msgLock);
+   __atomic_store_n(&E->hostWaiting, true, __ATOMIC_SEQ_CST);
+   while (! __atomic_load_n(&E->msgQueue, __ATOMIC_SEQ_CST) &&
+          __atomic_load_n(&E->R.taskRunning, __ATOMIC_SEQ_CST))
+      pthread_cond_wait(&E->msgCond, &E->msgLock);
+   __atomic_store_n(&E->hostWaiting, false, __ATOMIC_SEQ_CST);
+   pthread_mutex_unlock(&E->msgLock);
+
+   __atomic_fetch_and(&E->Global->msgBitTab, ~engineBit(E->localID), __ATOMIC_SEQ_CST);
+   ULONG queue = __atomic_exchange_n(&E->msgQueue, 0, __ATOMIC_SEQ_CST);
+
+   if (! queue && ! E->R.taskRunning)
+      JoinEngineThread(E);
+   return queue;
+} /* Engine_WaitMsg */
+
+// Must be called once the host has processed the messages returned by Engine_WaitMsg(), in order
+// to wake up the engine if one of them was a sync message.
+
+void Engine_ReplyMsg (ENGINE *E, ULONG queue)
+{
+   pthread_mutex_lock(&E->msgLock);
+   if (E->msgSync & queue)
+   {  E->msgSync = 0;
+      pthread_cond_broadcast(&E->msgCond);
+   }
+   pthread_mutex_unlock(&E->msgLock);
+} /* Engine_ReplyMsg */
+
+#else
+
+void SendMsg_Async (ENGINE *E, ULONG message)
+{
+   if (E->SMP.Master) return;                    // SMP helpers are invisible to the host.
+
    E->msgQueue |= message;
-   E->Global->msgBitTab |= bit(E->localID);
+   E->Global->msgBitTab |= engineBit(E->localID);
 
-   if (! E->UCI && Timer() >= E->S.periodicTime)
+   if (! E->UCI && MicroTimer() >= E->S.periodicTime)
    {  Task_Switch();
-      E->S.periodicTime = Timer() + (Task_GetCount() > 2 ? 5 : 20);
+      E->S.periodicTime = MicroTimer() + ticksToMicroSecs(Task_GetCount() > 2 ? 5 : 20);
    }
 } /* SendMsg_Async */
 
 
 void SendMsg_Sync (ENGINE *E, ULONG message)
 {
+   if (E->SMP.Master) return;
+
    E->msgQueue |= message;
-   E->Global->msgBitTab |= bit(E->localID);
+   E->Global->msgBitTab |= engineBit(E->localID);
 
    do Task_Switch(); while (E->msgQueue & message);  // Wait until host app has processed message
 } /* SendMsg_Sync */
 
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -358,6 +706,8 @@ void SendMsg_Sync (ENGINE *E, ULONG message)
 //    Asm_End();
 // }
 
+#ifdef __engine_asm
+
 #define engineEnvSize  (4*19)                    // 19 registers are saved (r13...r31)
 
 asm void Asm_Begin (ENGINE *E)           // Sets up the registers e.t.c.
@@ -388,3 +738,5 @@ asm void Asm_End (void)    // Restores the registers (and flushes "copyback" reg
    lmw     rEngine,-engineEnvSize(SP)
    blr
 } /* Asm_End */
+
+#endif
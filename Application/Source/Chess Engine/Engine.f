@@ -35,7 +35,18 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 /*----------------------------------- Engine System Initialization -------------------------------*/
 
-void Engine_InitSystem (GLOBAL *Global, PTR kpkData = nil);
+void Engine_InitSystem (GLOBAL *Global, PTR kpkData = nil, const ENGINE_TABLES *Tables = nil);
+void Engine_GetTables  (GLOBAL *Global, ENGINE_TABLES *Tables);
+
+/*---------------------------------------- Endgame Databases -------------------------------------*/
+
+CHAR *Engine_EndgameDBName (INT db);
+BOOL  Engine_SetEndgameDB  (GLOBAL *Global, INT db, PTR data, ULONG size);
+
+#ifndef __engine_asm
+BOOL  Engine_OpenTablebase (TABLEBASE *T, PTR data, ULONG size);
+void  Engine_SetTablebases (GLOBAL *Global, TABLEBASE Table[], INT count);
+#endif
 
 /*---------------------------------- Create/Destroy Engine Instance ------------------------------*/
 
@@ -53,6 +64,36 @@ BOOL Engine_AnyRunning (GLOBAL *Global);
 BOOL Engine_OtherRunning (GLOBAL *Global, ENGINE *Except);
 void Engine_Periodic   (ENGINE *E);
 
+// Calls Engine_Periodic (which reads the clock) only every "pollNodes" moves. Used by the search
+// loops, whereas wait loops (which poll the clock anyway) call Engine_Periodic directly.
+
+#define Engine_Poll(E) \
+   { if (--(E)->S.periodicCounter <= 0) { Engine_Periodic(E); (E)->S.periodicCounter = (E)->S.pollNodes; } }
+
+/*------------------------------------ Host Side Message Handling --------------------------------*/
+
+#ifdef __engine_threads
+ULONG Engine_WaitMsg    (ENGINE *E);
+void  Engine_ReplyMsg   (ENGINE *E, ULONG queue);
+#endif
+
+/*--------------------------------------- SMP Helper Engines -------------------------------------*/
+
+BOOL Engine_AddHelper     (ENGINE *E, ENGINE *H);
+void Engine_RemoveHelpers (ENGINE *E);
+
+/*--------------------------------- Transposition Table Snapshots --------------------------------*/
+
+BOOL Engine_ResumeTransTab (ENGINE *E, LONG generation);
+
+/*---------------------------------------- Move Generator Test -----------------------------------*/
+
+LONG64 Engine_Perft    (ENGINE *E, INT depth, LONG64 Divide[] = nil);
+
+/*---------------------------------- Piece Value Micro Benchmark ---------------------------------*/
+
+LONG64 Engine_BenchPieceVal (ENGINE *E, LONG count, ULONG *checksum);
+
 /*------------------------------- Access Engine Instance Stats/Results ---------------------------*/
 
 #define Engine_BestScore(E)    E->S.bestScore
@@ -63,7 +104,10 @@ void Engine_Periodic   (ENGINE *E);
 #define Engine_MultiPV(E)      E->S.multiPV
 #define Engine_MainLine(E)     E->S.MainLine
 #define Engine_MainDepth(E)    E->S.mainDepth
-#define Engine_MoveCount(E)    E->S.moveCount
+#define Engine_PVCount(E)      E->S.pvCount           // Multi PV lines found (last iteration)
+#define Engine_PVLine(E,k)     E->S.PVLine[k]         // k = 0..Engine_PVCount(E)-1
+#define Engine_PVScore(E,k)    E->S.PVScore[k]
+#define Engine_MoveCount(E)    (E->S.moveCount + E->SMP.helperMoveCount)
 #define Engine_CurrMoveNo(E)   (E->S.currMove + 1)    // [1..numRootMoves]
 #define Engine_CurrMove(E)     E->S.rootNode->m
 
@@ -72,6 +116,15 @@ void Engine_Periodic   (ENGINE *E);
 #define Engine_MainTime(E)     E->S.mainTime
 #define Engine_MateTime(E)     E->S.mateTime
 #define Engine_HashFull(E)     E->S.hashFull
+#define Engine_TransGeneration(E) E->Tr.generation   // Portable engine only (0 = tables unused)
+#define Engine_PawnHashProbes(E) E->S.pawnHashProbes  // Portable engine only (master thread)
+#define Engine_PawnHashHits(E)   E->S.pawnHashHits
+#define Engine_EdbProbes(E)    E->S.edbProbes         // Endgame database probes (master thread)
+#define Engine_EdbMicroSecs(E) E->S.edbMicroSecs      // Total probe time
+#define Engine_TbHits(E)       E->S.tbHits            // Tablebase hits in search (portable engine only)
+#ifdef __engine_stats
+#define Engine_SearchStats(E)  (&E->S.Stats)         // Search statistics (see "Search.h")
+#endif
 
 #define Engine_TaskRunning(E)  E->R.taskRunning
 #define Engine_RunState(E)     E->R.state
@@ -94,5 +147,10 @@ void Engine_Periodic   (ENGINE *E);
 void SendMsg_Async (ENGINE *E, ULONG message);
 void SendMsg_Sync  (ENGINE *E, ULONG message);
 
+#ifdef __engine_asm
 asm void Asm_Begin    (ENGINE *E);
 asm void Asm_End      (void);
+#else
+#define Asm_Begin(E)                 // The portable engine doesn't use the global registers.
+#define Asm_End()
+#endif
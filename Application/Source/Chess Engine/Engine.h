@@ -27,6 +27,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #undef check   // Needed because this macro is used in Carbon headers!!
 
 #include "General.h"
+#include "AsmDef.h"
 #include "Board.h"
 #include "Move.h"
 #include "HashCode.h"
@@ -34,12 +35,19 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Attack.h"
 #include "Mobility.h"
 #include "Search.h"
+#include "SMP.h"
+#include "Trace.h"
 #include "MoveGen.h"
 #include "PerformMove.h"
 #include "Evaluate.h"
 #include "PieceVal.h"
+#include "EndgameDB.h"
+#include "Tablebase.h"
 #include "Time.h"
-#include "AsmDef.h"
+
+#ifdef __engine_threads
+   #include <pthread.h>
+#endif
 
 
 /**************************************************************************************************/
@@ -48,7 +56,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
+#ifdef __sigma_headless
+#define maxEngines   64        // Maximum number of active engines (e.g. 2 per concurrent match game)
+#else
 #define maxEngines   10        // Maximum number of active engines
+#endif
+
+#define engineBit(i)   ((ULONG64)1 << (i))   // Bit of Engine[i] in GLOBAL.msgBitTab
 
 /*--------------------------------------- Engine Run State ---------------------------------------*/
 
@@ -78,6 +92,11 @@ enum ENGINE_STATE
 // some execution time (so it can respond to the message). For sync messages, the engine continually
 // loops and calls Task_Switch until the sync message bit has been cleared, hence indicating that
 // it has been processed.
+//
+// In builds with "__engine_threads" each engine instead runs in its own OS thread (see "Engine.c").
+// The engine then sets the message bits atomically (lock-free) and continues, while the host
+// blocks in Engine_WaitMsg() until messages arrive and takes them all at once. After posting a
+// sync message the engine sleeps on a condition variable until the host calls Engine_ReplyMsg().
 
 enum ENGINE_MESSAGE            // Outbound Engine message types (i.e message FROM engine):
 {
@@ -178,12 +197,15 @@ typedef struct
    BOOL     backgrounding;           // Is this a background analysis (in opponents time)?
    BOOL     nextBest;                // True if "Next Best" search. If so, the "Ignore[]" list
                                      // is NOT reset.
+   INT      multiPV;                 // Number of best lines to search/report (1 = normal search).
    //--- Search/eval parameters ---
    BOOL     pvSearch;                // Principal variation search?
    BOOL     alphaBetaWin;            // Narrow root alpha/beta win?
    BOOL     extensions;              // Apply depth extensions for forced/dangerous moves?
    BOOL     selection;               // Apply selection of "poor" moves?
    BOOL     deepSelection;           // Start selection earlier.
+   INT      selMargin;               // Selection margin per ply beyond the selection horizon
+                                     // (default 4). Portable engine only.
    BOOL     nondeterm;               // Non-deterministic (i.e. add small random value)?
    BOOL     useEndgameDB;            // Are endgame databases enabled?
    BOOL     proVersion;              // Pro-version?
@@ -194,6 +216,10 @@ typedef struct
    INT      movesLeft;               // Moves left to next time control.
    LONG     timeLeft;                // Time left in seconds to next time control (if time mode).
    INT      timeInc;                 // Time increment (in secs) per move if Fischer. 0 otherwise.
+   LONG     timeLeftMS;              // Time left in milliseconds (e.g. UCI). Overrides "timeLeft" if
+   LONG     timeIncMS;               // > 0, and then "timeIncMS" is the increment per move.
+   LONG     moveTimeMS;              // Fixed time per move in milliseconds if > 0 (time mode only).
+   LONG64   nodeLimit;               // Stop after this many nodes (moves searched) if > 0.
    INT      moveTime;                // Avg. time assigned to each move (used for ELO adjustment).
    INT      depth;                   // Depth/level if fixed depth, mate finder or novice.
    INT      playingStyle;            // The playing style.
@@ -210,7 +236,13 @@ typedef struct
 
    //--- Transposition Tables ---
    TRANS    *TransTables;            // Transposition table buffer (nil if disabled).
-   LONG     transSize;               // Size in bytes of transposition tables (0 if disabled).
+   ULONG64  transSize;               // Size in bytes of transposition tables (0 if disabled).
+
+   //--- SMP ---
+   INT      threads;                 // Number of search threads (1 = no helper threads).
+
+   //--- Search Trace ---
+   TRACE    *Trace;                  // Trace recorder (nil if disabled). Portable engine only.
 } PARAM;
 
 
@@ -220,6 +252,11 @@ typedef struct
    BOOL  taskRunning;
    INT   state;                      // Stopped, root, running, stopping, paused
    BOOL  aborted;                    // Was search aborted?
+#ifdef __engine_threads
+   volatile INT hostRequest;         // Stop/abort requested by the host thread (state_Stopping or
+                                     // state_Stopped), enforced by Engine_Periodic. -1 if none.
+   BOOL  threadActive;               // Has the engine thread been started (and not yet joined)?
+#endif
 
    ULONG rflags;                     // Global flags stored in the rFlags register for faster access.
 } RUN_STATE;
@@ -230,7 +267,7 @@ typedef struct
 // by the creator/host, and is used to identify the specific engine in the "Callback" message
 // handler (in  Chess, the refID is actually a pointer to the "owning" game window).
 
-typedef struct
+typedef struct _ENGINE
 {
    ULONG           refID;    // Unique logical, engine ID (reference constant) supplied by host.
    ULONG           localID;  // Index in Global->Engine[] of this instance
@@ -240,6 +277,13 @@ typedef struct
    PARAM           P;        // Engine search parameters (level/time/mode, flags...)
    RUN_STATE       R;        // Engine run state information.
    ULONG           msgQueue; // Outbound message "queue" (one bit per message type).
+#ifdef __engine_threads
+   ULONG           msgSync;  // Sync message awaiting Engine_ReplyMsg() (0 if none).
+   BOOL            hostWaiting; // Is the host blocked in Engine_WaitMsg()?
+   pthread_t       thread;   // The engine thread.
+   pthread_mutex_t msgLock;  // Protects msgCond (and the sync message handshake).
+   pthread_cond_t  msgCond;  // Signalled when the host or engine must wake up.
+#endif
 
    BOARD_STATE     B;        // Board state. Incrementally updated during search.
    ATTACK_STATE    A;        // Attack state. Incrementally update during search.
@@ -248,6 +292,10 @@ typedef struct
    TIME_STATE      T;        // Time allocation state.
    TRANS_STATE     Tr;       // Transposition tables.
    SEARCH_STATE    S;        // Nodes of current branch in search tree.
+   SMP_STATE       SMP;      // Lazy SMP helper engines/threads.
+#ifndef __engine_asm
+   TABLEBASE_CACHE TBCache;  // Last decompressed tablebase block.
+#endif
 
    CHAR            debugStr[1000];
 } ENGINE;
@@ -259,8 +307,9 @@ typedef struct
 
 typedef struct _GLOBAL
 {
-   // Engine message bit table. If bit "i" is set, messages are pending for Engine[i].
-   ULONG  msgBitTab;         
+   // Engine message bit table. If bit "i" is set, messages are pending for Engine[i] (64 bits
+   // wide, since the headless build allows up to 64 engines).
+   ULONG64 msgBitTab;
 
    // Engine table (list of active engines):
    INT    engineCount;
@@ -275,5 +324,26 @@ typedef struct _GLOBAL
    PERFORMMOVE_COMMON P;
    HASHCODE_COMMON    H;
    PIECEVAL_COMMON    V;
+   ENDGAMEDB_COMMON   D;
+#ifndef __engine_asm
+   TABLEBASE_COMMON   TB;
+#endif
    EVAL_COMMON        E;  // Must be last (because of KPKData and 32K limitation)
 } GLOBAL;
+
+/*---------------------------------- Precomputed Engine Tables -----------------------------------*/
+// A snapshot of the read only tables that Engine_InitSystem computes (incl. the KPK data). If the
+// host passes one to Engine_InitSystem (e.g. generated at build time, see "GenTables.c"), the
+// tables are simply copied into the GLOBAL structure instead of being computed at startup.
+
+typedef struct
+{
+   ULONG              size;      // = sizeof(ENGINE_TABLES) (the snapshot is ignored otherwise).
+   BOARD_COMMON       B;
+   ATTACK_COMMON      A;
+   MOVEGEN_COMMON     M;
+   PERFORMMOVE_COMMON P;
+   HASHCODE_COMMON    H;
+   PIECEVAL_COMMON    V;
+   EVAL_COMMON        E;
+} ENGINE_TABLES;
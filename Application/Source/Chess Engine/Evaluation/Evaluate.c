@@ -47,7 +47,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // ----------------------------------------------
 // If N->m is a pawn move, a pawn capture or a promotion (i.e. if N->m changes the pawn structure),
 // NN->pawnStructEval is computed from scratch by the "EvalpawnStruct" routine. Otherwise we simply
-// copy N->pawnStructEval to NN->pawnStructEval.
+// copy N->pawnStructEval to NN->pawnStructEval. In the portable engine "EvalPawnStruct" first
+// looks up the pawn key NN->pawnKey in the pawn hash table.
 //
 // endGameEval (The special endgame evaluation)
 // --------------------------------------------
@@ -58,9 +59,16 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // ### optimization : If move looks very "bad" and it's going to be skipped by the selection scheme
 // anyway, make "fast" evaluation.
 
-static asm INT EvalMovePV   (void);
-static asm INT EvalPawnStruct (void);
-static asm INT EvalEndGame    (void);
+#ifdef __engine_asm
+static asm INT EvalMovePV     (void);
+static asm INT EvalPawnStruct (register ENGINE *_E, register NODE *_N);
+static asm INT EvalEndGame    (register ENGINE *_E, register NODE *_N);
+#else
+static INT EvalMovePV     (ENGINE *E, NODE *N);
+static INT EvalPawnStruct (ENGINE *E, NODE *N);
+static INT EvalEndGame    (ENGINE *E, NODE *N);
+static HKEY CalcPawnKey   (ENGINE *E);
+#endif
 
 static void EvalPawnStructRoot (ENGINE *E);
 
@@ -82,11 +90,14 @@ void CalcEvaluateState (ENGINE *E)       // NOTE: Must be called AFTER "CalcPiec
       
       // Calc pawn structure evaluation:
       EvalPawnStructRoot(E);
-      EvalPawnStruct();
+#ifndef __engine_asm
+      N->pawnKey = CalcPawnKey(E);
+#endif
+      EvalPawnStruct(E, N);
 
       // Calc end game evaluation (turn PN->m temporarily into capture to force recomputation!):
       PN->m.cap++;
-      N->endGameEval = EvalEndGame();
+      N->endGameEval = EvalEndGame(E, N);
       PN->m.cap--;
 
       // Finally calc total evaluation for root node:
@@ -108,7 +119,9 @@ void CalcEvaluateState (ENGINE *E)       // NOTE: Must be called AFTER "CalcPiec
 // The "EvalMove" routine is the heart of the evaluation routine. It evaluates the current move
 // incrementally and updates the evaluation components and total at the next node.
 
-asm INT EvalMove (void)
+#ifdef __engine_asm
+
+asm INT EvalMove (register ENGINE *_E, register NODE *_N)
 {
 // #define eval rLocal1
 
@@ -140,7 +153,7 @@ asm INT EvalMove (void)
 #define pPassSq(n)  (NODE.PassSqW - sizeof(NODE) + n)(rNode)
 #define PassSq(n)   (NODE.PassSqW + n)(rNode)
 
-asm void Evaluate (void)
+asm void Evaluate (register ENGINE *_E, register NODE *_N)
 {
    frame_begin0
 
@@ -288,6 +301,93 @@ static asm INT EvalMovePV (void)
    blr
 } /* EvalMovePV */
 
+#else
+
+// C versions of EvalMove(), Evaluate() and EvalMovePV() (see the assembler versions above).
+
+INT EvalMove (ENGINE *E, NODE *N)
+{
+   INT eval = EvalMovePV(E, N);
+
+   if (N->player == white) eval = -eval;                  // NN->totalEval is seen from the
+   return (NN->totalEval = eval);                         // opponent (i.e. NN->player).
+} /* EvalMove */
+
+
+void Evaluate (ENGINE *E, NODE *N)
+{
+   INT capSelVal;
+
+   //--- Evaluate pawn structure ---
+   // If last move did NOT affect the pawn structure, we simply copy the pawn structure evaluation
+   // of the current node (including the PassSq[] tables).
+
+   if (! (PN->m.piece & 0x06) ||
+       (PN->m.cap != empty && (! (PN->m.cap & 0x06) || ! (E->B.pieceCount & 0xFFF0FFF0))))
+   {
+      HASHCODE_COMMON *H  = &(E->Global->H);
+      MOVE            *pm = &(PN->m);
+      HKEY            key = PN->pawnKey;
+
+      if (pieceType(pm->piece) == pawn)                   // Update pawn key (as UpdateDrawState).
+      {  key ^= H->HashCode[pm->piece][pm->from];
+         if (! (pm->type & mtype_Promotion))
+            key ^= H->HashCode[pm->piece][pm->to];
+         if (pm->type == mtype_EP)
+            key ^= H->HashCode[N->player + pawn][pm->to + N->pawnDir];
+      }
+      if (pieceType(pm->cap) == pawn)
+         key ^= H->HashCode[pm->cap][pm->to];
+
+      N->pawnKey = key;
+      EvalPawnStruct(E, N);
+   }
+   else
+   {
+      for (INT i = 0; i < 10; i++)
+         N->PassSqW[i] = PN->PassSqW[i],
+         N->PassSqB[i] = PN->PassSqB[i];
+      N->pawnStructEval = PN->pawnStructEval;
+      N->pawnKey = PN->pawnKey;
+   }
+
+   //--- Evaluate end game ---
+
+   capSelVal = N->endGameEval = EvalEndGame(E, N);
+
+   //--- Total Evaluation ---
+
+   N->totalEval = N->pvSumEval + N->mobEval + N->pawnStructEval + N->endGameEval;
+   if (N->player != white)
+      N->totalEval = -N->totalEval,
+      capSelVal = -capSelVal;
+   N->capSelVal = (capSelVal > 0 ? 0 : capSelVal);
+} /* Evaluate */
+
+
+static INT EvalMovePV (ENGINE *E, NODE *N)
+{
+   INT (*PieceVal)[pvSize] = E->V.PieceVal;
+   INT dPV = PieceVal[N->m.piece][N->m.to] - PieceVal[N->m.piece][N->m.from];
+
+   if (N->m.cap)
+      dPV -= PieceVal[N->m.cap][N->m.to];
+
+   switch (N->m.type)
+   {
+      case mtype_Normal : break;
+      case mtype_O_O    : dPV = E->V.o_oPV[N->player]; break;
+      case mtype_O_O_O  : dPV = E->V.o_o_oPV[N->player]; break;
+      case mtype_EP     : dPV -= PieceVal[pawn + black - N->player][N->m.to - N->pawnDir]; break;
+      default           : dPV += PieceVal[N->m.type & mtype_Promotion][N->m.to];
+   }
+
+   N->dPV = dPV;
+   return (NN->pvSumEval = N->pvSumEval + dPV);
+} /* EvalMovePV */
+
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -334,6 +434,13 @@ static void EvalPawnStructRoot (ENGINE *E)
    }
 
    E->S.rootNode->PassSqW[0] = E->S.rootNode->PassSqB[0] = 0;
+
+#ifndef __engine_asm
+   if (e->pawnHashPhase != f)                             // The pawn hash entries depend on the
+   {  memset(e->PawnHash, 0, sizeof(e->PawnHash));         // tables above.
+      e->pawnHashPhase = f;
+   }
+#endif
 } /* EvalPawnStructRoot */
 
 /*------------------------------- General Pawn Structure Evaluation ------------------------------*/
@@ -343,6 +450,8 @@ static void EvalPawnStructRoot (ENGINE *E)
 // routines EvalRuleOfSquare() and EvalKPK().
 // The evaluation values (punishments) below are multiplied by 4 (<< 2) during evaluation.
 
+#ifdef __engine_asm
+
 #define sum    rLocal1                // Friendly occupied files so far (bit list).
 #define back   rLocal2                // Files with friendly backward pawns so far (bit list).
 #define dob    rLocal3                // Files with friendly doubled pawns so far (bit list).
@@ -368,7 +477,7 @@ static void EvalPawnStructRoot (ENGINE *E)
 
 asm void GetPassedPawns (register INT _rank, register INT _pass1);
 
-asm INT EvalPawnStruct (void)
+asm INT EvalPawnStruct (register ENGINE *_E, register NODE *_N)
 {
    #define evalRankW(LN,L,n,pasRank) \
       lbz     pwn, pw(n)                         ;                                            \
@@ -602,6 +711,174 @@ asm void GetPassedPawns (register INT _rank, register INT _pass1)
 #undef pw
 #undef pb
 
+#else
+
+// Stores the passed pawns "pass" on the rank "rank" in descending file order at "Psq" and returns
+// the new end of the list.
+
+static BYTE *GetPassedPawns (ENGINE *E, BYTE *Psq, INT rank, RANKBITS pass)
+{
+   do
+   {  INT file = E->Global->A.HighBit[pass];
+      *(Psq++) = rank | file;
+      pass ^= bit(file);
+   } while (pass);
+
+   return Psq;
+} /* GetPassedPawns */
+
+
+// Looks up the pawn structure in the pawn hash table, and only evaluates it (and stores the result)
+// if not found. Since the passed pawn lists are only computed if the opponent has no officers,
+// these "officer" flags are XOR'ed into the pawn key.
+
+static INT CalcPawnStruct (ENGINE *E, NODE *N, BOOL wOffi, BOOL bOffi);
+
+static INT EvalPawnStruct (ENGINE *E, NODE *N)
+{
+   BOOL     wOffi = ((E->B.pieceCount & 0x0000FFF0) != 0);
+   BOOL     bOffi = ((E->B.pieceCount & 0xFFF00000) != 0);
+   ULONG64  key   = N->pawnKey ^ (wOffi ? 1 : 0) ^ (bOffi ? 2 : 0);
+   PAWNHASH *h    = &(E->E.PawnHash[key & (pawnHashSize - 1)]);
+
+   E->S.pawnHashProbes++;
+
+   if (h->key == key)
+   {
+      E->S.pawnHashHits++;
+      for (INT i = 0; i < 10; i++)
+         N->PassSqW[i] = h->PassSqW[i],
+         N->PassSqB[i] = h->PassSqB[i];
+      return (N->pawnStructEval = h->pawnStructEval);
+   }
+
+   h->key = key;
+   h->pawnStructEval = CalcPawnStruct(E, N, wOffi, bOffi);
+   for (INT i = 0; i < 10; i++)
+      h->PassSqW[i] = N->PassSqW[i],
+      h->PassSqB[i] = N->PassSqB[i];
+   return h->pawnStructEval;
+} /* EvalPawnStruct */
+
+
+static INT CalcPawnStruct (ENGINE *E, NODE *N, BOOL wOffi, BOOL bOffi)
+{
+   EVAL_COMMON *G     = &(E->Global->E);
+   EVAL_STATE  *V     = &(E->E);
+   RANKBITS    *pw    = E->B.PawnStructW - 1;             // pw[n] = White pawns on rank n.
+   RANKBITS    *pb    = E->B.PawnStructB - 1;             // pb[n] = Black pawns on rank n.
+   INT         peval  = 0;
+   RANKBITS    sum, sum_, back, dob, pass, iso, blk, ps;
+   BYTE        *Psq;
+
+   //--- WHITE Pawn Structure ---
+
+   sum  = pw[2];
+   pass = pb[2];
+   dob  = sum_ = 0;
+   back = G->IsoPawns[sum];
+   Psq  = N->PassSqB;
+   if (pass && ! wOffi)
+      Psq = GetPassedPawns(E, Psq, 0x10, pass);
+
+   for (INT n = 3; n <= 7; n++)
+   {
+      blk = G->BlkPawnsN[sum];
+      if (pw[n])
+      {  iso  = G->IsoPawns[pw[n]];
+         dob |= sum & pw[n];
+         sum |= pw[n];
+         back = (iso & blk) | (back & ~pw[n]);
+      }
+      sum_ |= pb[n];
+      if ((ps = pb[n] & blk & ~sum))
+      {  pass |= ps;
+         if (! wOffi)
+            Psq = GetPassedPawns(E, Psq, (n < 7 ? n - 1 : 5) << 4, ps);
+      }
+   }
+   *Psq = 0;
+
+   iso = G->IsoPawns[sum];
+   peval -= V->IsoVal[iso];
+   if (dob)
+   {  peval -= V->DobVal[dob];
+      if (dob & iso)
+      {  peval -= V->DobIsoVal[dob & iso];
+         back ^= dob & iso;                               // Don't eval again as backward
+      }
+   }
+   if (back)
+   {  peval -= V->IsoBackVal[back];
+      if (back & ~sum_)
+         peval -= V->IsoBackVal_[back & ~sum_];
+   }
+   if (pass)
+      peval -= V->PassedVal[pass];
+
+   //--- BLACK Pawn Structure ---
+
+   sum  = pb[7];
+   pass = pw[7];
+   dob  = sum_ = 0;
+   back = G->IsoPawns[sum];
+   Psq  = N->PassSqW;
+   if (pass && ! bOffi)
+      Psq = GetPassedPawns(E, Psq, 0x60, pass);
+
+   for (INT n = 6; n >= 2; n--)
+   {
+      blk = G->BlkPawnsN[sum];
+      if (pb[n])
+      {  iso  = G->IsoPawns[pb[n]];
+         dob |= sum & pb[n];
+         sum |= pb[n];
+         back = (iso & blk) | (back & ~pb[n]);
+      }
+      sum_ |= pw[n];
+      if ((ps = pw[n] & blk & ~sum))
+      {  pass |= ps;
+         if (! bOffi)
+            Psq = GetPassedPawns(E, Psq, (n > 2 ? n - 1 : 2) << 4, ps);
+      }
+   }
+   *Psq = 0;
+
+   iso = G->IsoPawns[sum];
+   peval += V->IsoVal[iso];
+   if (dob)
+   {  peval += V->DobVal[dob];
+      if (dob & iso)
+      {  peval += V->DobIsoVal[dob & iso];
+         back ^= dob & iso;
+      }
+   }
+   if (back)
+   {  peval += V->IsoBackVal[back];
+      if (back & ~sum_)
+         peval += V->IsoBackVal_[back & ~sum_];
+   }
+   if (pass)
+      peval += V->PassedVal[pass];
+
+   return (N->pawnStructEval = 4*peval);
+} /* CalcPawnStruct */
+
+// Computes the pawn key of the current board from scratch (as "CalcHashKey").
+
+static HKEY CalcPawnKey (ENGINE *E)
+{
+   HKEY key = 0;
+
+   for (SQUARE sq = a1; sq <= h8; sq++)
+      if (onBoard(sq) && pieceType(E->B.Board[sq]) == pawn)
+         key ^= E->Global->H.HashCode[E->B.Board[sq]][sq];
+
+   return key;
+} /* CalcPawnKey */
+
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -652,11 +929,13 @@ asm void GetPassedPawns (register INT _rank, register INT _pass1)
 //         if KKNN it's a draw
 //         otherwise it's a forced win (the cases KKN and KKB are handled by the draw check).
 
+#ifdef __engine_asm
+
 static asm INT EvalRuleOfSquare (void);
 static asm INT EvalKPK (COLOUR pawnColor);
 static asm INT OppColBishops (void);
 
-asm INT EvalEndGame (void)
+asm INT EvalEndGame (register ENGINE *_E, register NODE *_N)
 {
    lbz     rTmp4, node(PassSqW)
    lbz     rTmp5, node(PassSqB)
@@ -1105,6 +1384,190 @@ static asm INT OppColBishops (void)
    blr
 } /* OppColBishops */
 
+#else
+
+static INT EvalRuleOfSquare (ENGINE *E, NODE *N);
+static INT EvalKPK (ENGINE *E, NODE *N, COLOUR pawnColour);
+static INT OppColBishops (ENGINE *E, NODE *N);
+
+static INT EvalEndGame (ENGINE *E, NODE *N)
+{
+   ULONG pieceCount = E->B.pieceCount;
+   INT   pWhite, pBlack;
+
+   if (N->PassSqW[0] || N->PassSqB[0])
+   {
+      if (pieceCount == 0x00000001) return EvalKPK(E, N, white);
+      if (pieceCount == 0x00010000) return EvalKPK(E, N, black);
+      return EvalRuleOfSquare(E, N);
+   }
+
+   if (pieceCount & 0xEC00EC00) return 0;                  // Too much material
+   if (! (PN->m.cap & 0x000F) && ! (PN->m.type & 0x008F))  // Not a capture, promotion or ep
+      return PN->endGameEval;
+
+   //--- Check Pawns ---
+
+   pWhite = pieceCount & 0xFFFF;
+   pBlack = (pieceCount >> 16) & 0xFFFF;
+
+   if ((pWhite & 0x000F) && (pBlack & 0x000F))             // Both sides have pawns
+   {
+      return ((pieceCount & 0xFFF0FFF0) == 0x01000100 ? OppColBishops(E, N) : 0);
+   }
+   else if (pWhite & 0x000F)                               // Only white has pawns
+   {
+      if ((pWhite & 0xFE0C) || (pBlack & 0xFC00)) return 0;
+      if (pBlack == 0x0220)
+      {  if (pWhite & 0xFFF0) return 200;
+         if (pWhite == 0x0001) return 450;
+         if (pWhite == 0x0002) return 400;
+         return 350;
+      }
+      if ((pBlack & 0x0F00) != 0x0100) return 0;
+      if (pWhite & 0x0100) return (pWhite & 0x0002 ? 0 : -100);
+      if (! (pWhite & 0x0002)) return 175;
+      if (! (pWhite & 0x0001)) return 125;
+      return 0;
+   }
+   else if (pBlack & 0x000F)                               // Only black has pawns
+   {
+      if ((pBlack & 0xFE0C) || (pWhite & 0xFC00)) return 0;
+      if (pWhite == 0x0220)
+      {  if (pBlack & 0xFFF0) return -200;
+         if (pBlack == 0x0001) return -450;
+         if (pBlack == 0x0002) return -400;
+         return -350;
+      }
+      if ((pWhite & 0x0F00) != 0x0100) return 0;
+      if (pBlack & 0x0100) return (pBlack & 0x0002 ? 0 : 100);
+      if (! (pBlack & 0x0002)) return -175;
+      if (! (pBlack & 0x0001)) return -125;
+      return 0;
+   }
+
+   //--- Check Officers ---
+
+   if ((pWhite & 0xFFF0) && (pBlack & 0xFFF0))             // Both sides have officers
+   {
+      INT val = -(N->pvSumEval >> 1);
+      return (val < -75 ? -75 : (val > 75 ? 75 : val));
+   }
+   else if (pWhite & 0xFFF0)                               // Only White has officers
+      return (pWhite == 0x0220 ? 30 - N->pvSumEval : 200);
+   else                                                    // Only Black has officers
+      return (pBlack == 0x0220 ? -30 - N->pvSumEval : -200);
+} /* EvalEndGame */
+
+
+static INT EvalRuleOfSquare (ENGINE *E, NODE *N)
+{
+   signed char *RTab = (signed char *)E->Global->E.RuleOfSquareTab;
+   SQUARE wksq = E->B.PieceLoc[white];
+   SQUARE bksq = E->B.PieceLoc[black];
+   SQUARE sq, sqMax, sqMin;
+   INT    diff, rankSum;
+
+   //--- Check WHITE Passed Pawns ---
+
+   sqMax = h1 - 0x10;
+
+   for (BYTE *Psq = N->PassSqW; (sq = *Psq); Psq++)
+   {
+      diff = RTab[wksq - sq + 0x10];                      // Check king block/support of prom. sq.
+      if (diff < 0) sq -= 0x10, diff++;
+      if (N->player == black) sq -= 0x10;
+
+      if (sq > sqMax && ((diff == 0 && wksq >= a7) || sq >= RTab[sq - bksq]))
+         sqMax = sq | 0x07;
+   }
+
+   //--- Check BLACK Passed Pawns ---
+
+   sqMin = a8 + 0x10;
+
+   for (BYTE *Psq = N->PassSqB; (sq = *Psq); Psq++)
+   {
+      diff = RTab[sq - bksq + 0x10];
+      if (diff < 0) sq += 0x10, diff++;
+      if (N->player == white) sq += 0x10;
+
+      if (sq < sqMin && ((diff == 0 && bksq <= h2) || 0x70 - (sq & 0x70) >= RTab[wksq - sq]))
+         sqMin = sq & 0x70;
+   }
+
+   //--- Evaluate/Compare WHITE & BLACK ---
+
+   sqMax &= 0xFFF0;                                       // 16*rankW (-16 if none).
+   sqMin -= 0x70;                                         // -16*rankB (+16 if none).
+   rankSum = sqMax + sqMin;
+
+   if (rankSum > 0)
+      return (rankSum > 0x10 || N->player == black ? sqMax + 500 : 0);
+   else if (rankSum < 0)
+      return (rankSum < -0x10 || N->player == white ? sqMin - 500 : 0);
+   return 0;
+} /* EvalRuleOfSquare */
+
+
+static INT EvalKPK (ENGINE *E, NODE *N, COLOUR pawnColour)
+{
+   GLOBAL *G = E->Global;
+   SQUARE psq, ksq, ksq_;
+   INT    val;
+   LONG   n;
+
+   if (pawnColour == white)
+   {
+      psq = N->PassSqW[0];
+      if (E->B.Board[psq] != wPawn) psq -= 0x10;          // "double move"
+      ksq  = E->B.PieceLoc[white];
+      ksq_ = E->B.PieceLoc[black];
+   }
+   else
+   {
+      psq = N->PassSqB[0];
+      if (E->B.Board[psq] != bPawn) psq += 0x10;          // "double move"
+      ksq  = E->B.PieceLoc[black] ^ 0x70;
+      ksq_ = E->B.PieceLoc[white] ^ 0x70;
+      psq ^= 0x70;
+   }
+
+   if (file(psq) > 3)
+   {  psq ^= 0x07;
+      ksq ^= 0x07;
+      ksq_ ^= 0x07;
+   }
+
+   val = ((psq & 0x70) >> 2) - (G->V.Closeness[psq + 0x10 - ksq_] >> 1);
+
+   n = ((((psq & 0x70) >> 2) - 4) | (psq & 0x07)) << 6;
+   n = (n | ((ksq & 0x70) >> 1) | (ksq & 0x07)) << 6;
+   n = (n | ((ksq_ & 0x70) >> 1) | (ksq_ & 0x07)) << 1;
+   if (N->player != pawnColour) n |= 1;
+
+   if (G->E.kpkData[n >> 3] & bit(n & 0x07)) val += 600;
+   if (pawnColour == black) val = -val;
+
+   return val - N->pvSumEval - N->pawnStructEval;
+} /* EvalKPK */
+
+
+static INT OppColBishops (ENGINE *E, NODE *N)
+{
+   SQUARE wsq, bsq;
+   INT    i, x;
+
+   for (i = 1; (wsq = N->PieceLoc[i]) < 0; i++);
+   for (i = 1; (bsq = N->PieceLoc_[i]) < 0; i++);
+
+   x = wsq ^ bsq;
+   if (! ((x ^ (x >> 4)) & 0x01)) return 0;
+   return (-N->pvSumEval) >> 1;
+} /* OppColBishops */
+
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -1112,6 +1575,16 @@ static asm INT OppColBishops (void)
 /*                                                                                                */
 /**************************************************************************************************/
 
+// Must be called when a new engine is created/allocated.
+
+void InitEvaluateState (ENGINE *E)
+{
+#ifndef __engine_asm
+   E->E.pawnHashPhase = -1;
+#endif
+} /* InitEvaluateState */
+
+
 void InitEvaluateModule (GLOBAL *Global, PTR kpkData)
 {
    EVAL_COMMON *E = &(Global->E);
@@ -35,7 +35,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 void CalcEvaluateState (ENGINE *E);
 
-asm INT  EvalMove (void);
-asm void Evaluate (void);
-
+#ifdef __engine_asm
+asm INT  EvalMove (register ENGINE *_E, register NODE *_N);
+asm void Evaluate (register ENGINE *_E, register NODE *_N);
+#else
+INT  EvalMove (ENGINE *E, NODE *N);
+void Evaluate (ENGINE *E, NODE *N);
+#endif
+
+void InitEvaluateState (ENGINE *E);
 void InitEvaluateModule (GLOBAL *Global, PTR kpkData);
@@ -40,6 +40,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define rookMob   2
 #define bishopMob 3
 
+#define pawnHashSize 8192               // Number of pawn hash entries (must be a power of 2).
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -47,6 +49,17 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
+// The portable engine caches the pawn structure evaluation (and the passed pawn lists) in a small
+// hash table, which is indexed by the pawn key of the position (see "EvalPawnStruct").
+
+typedef struct   /* 32 bytes */
+{
+   ULONG64  key;                        // Pawn key incl. "officer" flags (0 if empty).
+   INT      pawnStructEval;             // Pawn structure evaluation (seen from WHITE).
+   BYTE     PassSqW[10],                // Passed pawn lists (see NODE.PassSqW/PassSqB).
+            PassSqB[10];
+} PAWNHASH;
+
 // Central pawns are penalized more heavily: 7/8 for a, h; 8/8 for b, g; 9/8 for c, d, e and f.
 
 typedef struct
@@ -57,6 +70,10 @@ typedef struct
             DobVal[256],                // Punishment of doubled pawns.
             DobIsoVal[256],             // Extra punishment for isolated and doubled pawns.
             PassedVal[256];             // Bonus for passed pawns.
+#ifndef __engine_asm
+   INT      pawnHashPhase;              // Game phase of the pawn hash entries (-1 if none).
+   PAWNHASH PawnHash[pawnHashSize];     // Pawn structure hash table.
+#endif
 } EVAL_STATE;
 
 
@@ -195,7 +195,21 @@ static void ComputeBaseVal (ENGINE *E)
 } /* ComputeBaseVal */
 
 /*------------------------------------ Resetting Piece Values ------------------------------------*/
-// Initializes the piece value tables through "BaseVal" and the basic piece value tables.
+// Initializes the piece value tables through "BaseVal" and the basic piece value tables. The
+// tables are computed a rank at a time for each piece type: Along a rank, the 8 squares of a piece
+// value table, of a 64 square base table and of the closeness to a king ("Closeness[sq - kingSq]")
+// are all contiguous. With GCC/Clang each rank is computed as a vector of 8 INTs (i.e. 128 bits:
+// SSE2, NEON or AltiVec depending on the target), otherwise by the equivalent scalar loop. Both
+// wrap around identically (as the INT piece values).
+
+#ifdef __GNUC__
+   typedef INT PVROW __attribute__((vector_size(8*sizeof(INT))));
+
+   static inline PVROW LoadRow (INT *P) { PVROW v; __builtin_memcpy(&v, P, sizeof(PVROW)); return v; }
+   static inline void StoreRow (INT *P, PVROW v) { __builtin_memcpy(P, &v, sizeof(PVROW)); }
+#endif
+
+static void ResetRankPV (INT PV[], INT Tab[], BOOL mirror, INT base, INT factor, INT Cl[]);
 
 static void ResetPieceVal (ENGINE *E)
 {
@@ -206,30 +220,56 @@ static void ResetPieceVal (ENGINE *E)
    INT    kcf  = G->V.Kcf[V->phase];
    SQUARE wkSq = kingLocW(E);
    SQUARE bkSq = kingLocB(E);
-   INT    i    = 0;
 
-   for (SQUARE sq = a1; sq <= h8; sq++)
-      if (onBoard(sq))
-      {
-         INT cl = closeness(sq, bkSq);
-         V->PieceVal[wPawn][sq]   = GV->PawnPV[63 - i] + (rank(sq) == 7 ? 0 : V->BaseVal[wPawn]);
-         V->PieceVal[wKnight][sq] = GV->KnightPV[63 - i] + V->BaseVal[wKnight] + 2*cl;
-         V->PieceVal[wBishop][sq] = GV->BishopPV[63 - i] + V->BaseVal[wBishop] + 2*cl;
-         V->PieceVal[wRook][sq]   = GV->RookPV[63 - i]   + V->BaseVal[wRook] + cl;
-         V->PieceVal[wQueen][sq]  = GV->QueenPV[63 - i]  + V->BaseVal[wQueen] + 4*cl; //*(1 + V->phase/3);
-         V->PieceVal[wKing][sq]   = kcf*V->PawnCentrePV[i];
-
-         cl = closeness(sq, wkSq);
-         V->PieceVal[bPawn][sq]   = -GV->PawnPV[i] + (rank(sq) == 0 ? 0 : V->BaseVal[bPawn]);
-         V->PieceVal[bKnight][sq] = -GV->KnightPV[i] + V->BaseVal[bKnight] - 2*cl;
-         V->PieceVal[bBishop][sq] = -GV->BishopPV[i] + V->BaseVal[bBishop] - 2*cl;
-         V->PieceVal[bRook][sq]   = -GV->RookPV[i]   + V->BaseVal[bRook] - cl;
-         V->PieceVal[bQueen][sq]  = -GV->QueenPV[i]  + V->BaseVal[bQueen] - 4*cl; //(1 + V->phase/3);
-         V->PieceVal[bKing][sq]   = -kcf*V->PawnCentrePV[i];
-         i++;
-      }
+   for (INT r = 0; r <= 7; r++)
+   {
+      SQUARE sq  = r << 4;                       // First square of the rank.
+      INT    i   = r << 3;                       // Index of "sq" in the 64 square tables. White
+      INT    iw  = 63 - 7 - i;                   // uses the mirrored square 63 - i.
+      INT    *Cl = &GV->Closeness[sq - bkSq];    // Closeness to the enemy king.
+
+      ResetRankPV(&V->PieceVal[wPawn][sq],   &GV->PawnPV[iw],   true, (r == 7 ? 0 : V->BaseVal[wPawn]), 0, Cl);
+      ResetRankPV(&V->PieceVal[wKnight][sq], &GV->KnightPV[iw], true, V->BaseVal[wKnight], 2, Cl);
+      ResetRankPV(&V->PieceVal[wBishop][sq], &GV->BishopPV[iw], true, V->BaseVal[wBishop], 2, Cl);
+      ResetRankPV(&V->PieceVal[wRook][sq],   &GV->RookPV[iw],   true, V->BaseVal[wRook],   1, Cl);
+      ResetRankPV(&V->PieceVal[wQueen][sq],  &GV->QueenPV[iw],  true, V->BaseVal[wQueen],  4, Cl); //*(1 + V->phase/3);
+
+      Cl = &GV->Closeness[sq - wkSq];
+
+      ResetRankPV(&V->PieceVal[bPawn][sq],   &GV->PawnPV[i],   false, (r == 0 ? 0 : V->BaseVal[bPawn]), 0, Cl);
+      ResetRankPV(&V->PieceVal[bKnight][sq], &GV->KnightPV[i], false, V->BaseVal[bKnight], -2, Cl);
+      ResetRankPV(&V->PieceVal[bBishop][sq], &GV->BishopPV[i], false, V->BaseVal[bBishop], -2, Cl);
+      ResetRankPV(&V->PieceVal[bRook][sq],   &GV->RookPV[i],   false, V->BaseVal[bRook],   -1, Cl);
+      ResetRankPV(&V->PieceVal[bQueen][sq],  &GV->QueenPV[i],  false, V->BaseVal[bQueen],  -4, Cl); //(1 + V->phase/3);
+
+      ResetRankPV(&V->PieceVal[wKing][sq], nil, false, 0, kcf,  &V->PawnCentrePV[i]);
+      ResetRankPV(&V->PieceVal[bKing][sq], nil, false, 0, -kcf, &V->PawnCentrePV[i]);
+   }
 } /* ResetPieceVal */
 
+
+// Sets the piece values of the 8 squares of a rank: PV[f] = base + Tab[7 - f] + factor*Cl[f] for
+// white pieces ("mirror"), and base - Tab[f] + factor*Cl[f] for black pieces (Tab may be nil).
+
+static void ResetRankPV (INT PV[], INT Tab[], BOOL mirror, INT base, INT factor, INT Cl[])
+{
+#ifdef __GNUC__
+   PVROW v = factor*LoadRow(Cl) + base;
+
+   if (! Tab)
+      ;
+   else if (mirror)
+      v += (PVROW){ Tab[7], Tab[6], Tab[5], Tab[4], Tab[3], Tab[2], Tab[1], Tab[0] };
+   else
+      v -= LoadRow(Tab);
+
+   StoreRow(PV, v);
+#else
+   for (INT f = 0; f <= 7; f++)
+      PV[f] = base + factor*Cl[f] + (! Tab ? 0 : (mirror ? Tab[7 - f] : -Tab[f]));
+#endif
+} /* ResetRankPV */
+
 /*------------------------------ Compute Pawn Structure Information ------------------------------*/
 // Computes the "PawnDataW[]" and "PawnDataB[]" tables from scratch.
 
@@ -955,17 +995,22 @@ static void ComputeMateWhitePV (ENGINE *E)         // Computes piece values if w
    }
 
    SQUARE kingSq = kingLocW(E);
-   INT    i = 0;
-   for (SQUARE sq = a1; sq <= h8; sq++)
-      if (onBoard(sq))
-      {  
-         V->PieceVal[bKnight][sq] = -3*closeness(sq, kingSq) - 3*G->V.KingPV[i] + V->BaseVal[bKnight];
-         for (PIECE p = bBishop; p <= bQueen; p++)      
-            V->PieceVal[p][sq] = V->BaseVal[p];
-         V->PieceVal[bKing][sq] = -5*closeness(sq, kingSq) - 2*G->V.MKingPV[i];
-         V->PieceVal[wKing][sq] = c*wKingPV[i];
-         i++;
-      }
+   for (INT r = 0; r <= 7; r++)                                  // A rank at a time (see
+   {                                                             // ResetPieceVal).
+      SQUARE sq = r << 4;
+      INT    i  = r << 3;
+      INT    *Cl = &G->V.Closeness[sq - kingSq];
+
+      for (INT f = 0; f <= 7; f++)
+         V->PieceVal[bKnight][sq + f] = -3*Cl[f] - 3*G->V.KingPV[i + f] + V->BaseVal[bKnight];
+      for (PIECE p = bBishop; p <= bQueen; p++)
+         for (INT f = 0; f <= 7; f++)
+            V->PieceVal[p][sq + f] = V->BaseVal[p];
+      for (INT f = 0; f <= 7; f++)
+         V->PieceVal[bKing][sq + f] = -5*Cl[f] - 2*G->V.MKingPV[i + f];
+      for (INT f = 0; f <= 7; f++)
+         V->PieceVal[wKing][sq + f] = c*wKingPV[i + f];
+   }
 }   /* ComputeMateWhitePV */
 
 
@@ -990,17 +1035,22 @@ static void ComputeMateBlackPV (ENGINE *E)         // Computes piece values if b
    }
 
    SQUARE kingSq = kingLocB(E);
-   INT    i = 0;
-   for (SQUARE sq = a1; sq <= h8; sq++)
-      if (onBoard(sq))
-      {  
-         V->PieceVal[wKnight][sq] = 3*closeness(sq, kingSq) + 3*G->V.KingPV[i] + V->BaseVal[wKnight];
-         for (PIECE p = wBishop; p <= wQueen; p++)      
-            V->PieceVal[p][sq] = V->BaseVal[p];
-         V->PieceVal[wKing][sq] = 5*closeness(sq, kingSq) + 2*G->V.MKingPV[i];
-         V->PieceVal[bKing][sq] = c*bKingPV[i];
-         i++;
-      }
+   for (INT r = 0; r <= 7; r++)                                  // A rank at a time (see
+   {                                                             // ResetPieceVal).
+      SQUARE sq = r << 4;
+      INT    i  = r << 3;
+      INT    *Cl = &G->V.Closeness[sq - kingSq];
+
+      for (INT f = 0; f <= 7; f++)
+         V->PieceVal[wKnight][sq + f] = 3*Cl[f] + 3*G->V.KingPV[i + f] + V->BaseVal[wKnight];
+      for (PIECE p = wBishop; p <= wQueen; p++)
+         for (INT f = 0; f <= 7; f++)
+            V->PieceVal[p][sq + f] = V->BaseVal[p];
+      for (INT f = 0; f <= 7; f++)
+         V->PieceVal[wKing][sq + f] = 5*Cl[f] + 2*G->V.MKingPV[i + f];
+      for (INT f = 0; f <= 7; f++)
+         V->PieceVal[bKing][sq + f] = c*bKingPV[i + f];
+   }
 } /* ComputeMateBlackPV */
 
 /*---------------------------------------- Playing Styles ------------------------------------*/
@@ -1036,14 +1086,19 @@ static void ComputePlayingStylePV (ENGINE *E)
    for (PIECE p = pawn; p <= queen; p++)
    {
       INT *PV = V->PieceVal[p + c];
-      for (SQUARE sq = a1; sq <= h8; sq++)
-         if (onBoard(sq))
+      INT norm = 0;
+
+      for (SQUARE sq = a1; sq <= h8; sq += 0x10)                 // A rank at a time (see
+      {                                                          // ResetPieceVal).
+         INT *Cl = &G->V.Closeness[sq - kingSq];
+         for (INT i = 0; i <= 7; i++)
          {
-            INT dv = f*G->V.Closeness[sq - kingSq];
-            PV[sq] += dv;
-            if (B->Board[sq] == p + c)
-               V->styleNormPV += dv;
+            INT dv = f*Cl[i];
+            PV[sq + i] += dv;
+            norm += (B->Board[sq + i] == p + c ? dv : 0);
          }
+      }
+      V->styleNormPV += norm;
    }
 } /* ComputePlayingStylePV */
 
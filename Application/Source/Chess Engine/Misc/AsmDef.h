@@ -24,6 +24,18 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
 
+/*----------------------------------------- Engine Back End --------------------------------------*/
+// The time critical engine routines (move generation, perform/retract move, evaluation, the node
+// search e.t.c.) are written in PowerPC assembly, but each of them also has a portable C version.
+// The assembly versions are used when "__engine_asm" is defined, i.e. when compiling for PowerPC
+// (unless "__engine_portable" is defined). Routines called from C take the engine and the current
+// node as explicit parameters (ENGINE *E, NODE *N). The assembly versions simply ignore these
+// (they use rEngine and rNode instead), so the C call sites are identical for both back ends.
+
+#if defined(__POWERPC__) && ! defined(__engine_portable)
+   #define __engine_asm
+#endif
+
 /*--------------------------------------- Register Usage -----------------------------------------*/
 //
 // General Purpose Register (GPR) conventions:
@@ -29,12 +29,65 @@ IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISI
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include "EndGameDB.f"
+#include "EndgameDB.f"
+#include "Tablebase.f"
 #include "Engine.f"
+#include "Time.f"
 
 #define nonWinVal      61
 
 
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                         DATABASE FILES                                         */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static CHAR *EdbName[edbCount] = { "KQKR", "KQKB", "KQKN", "KRKB", "KRKN", "KBNK", "KBBK" };
+
+void InitEndgameDBModule (GLOBAL *Global)
+{
+   for (INT db = 0; db < edbCount; db++)
+   {  Global->D.Data[db] = nil;
+      Global->D.Size[db] = 0;
+   }
+} /* InitEndgameDBModule */
+
+
+CHAR *Engine_EndgameDBName (INT db)
+{
+   return (db >= 0 && db < edbCount ? EdbName[db] : nil);
+} /* Engine_EndgameDBName */
+
+
+// Installs (or removes if "data" is nil) the contents of a database file. Must not be called while
+// any engine is running.
+
+BOOL Engine_SetEndgameDB (GLOBAL *Global, INT db, PTR data, ULONG size)
+{
+   if (db < 0 || db >= edbCount) return false;
+
+   Global->D.Data[db] = (data && size > 0 ? data : nil);
+   Global->D.Size[db] = (data ? size : 0);
+   return true;
+} /* Engine_SetEndgameDB */
+
+
+// Each database entry is a 6 bit value, packed 4 to a 3 byte group (big endian). Returns -1 if
+// the database isn't loaded or the position is outside the file.
+
+static INT ProbeData (GLOBAL *Global, INT db, LONG pos)
+{
+   ULONG i = (pos/4)*3;
+   PTR   p = Global->D.Data[db];
+
+   if (! p || i + 3 > Global->D.Size[db]) return -1;
+
+   ULONG res = ((ULONG)p[i] << 24) | ((ULONG)p[i + 1] << 16) | ((ULONG)p[i + 2] << 8);
+   return (res >> (26 - 6*(pos % 4))) & 0x003F;
+} /* ProbeData */
+
+
 /**************************************************************************************************/
 /*                                                                                                */
 /*                                     CONSULT ENDGAME DATABASES                                  */
@@ -47,20 +100,32 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // true is returned. Otherwise false is returned (in which case the engine should analyze the
 // position itself).
 
+#ifdef __engine_asm
 asm ULONG asmPieceCount (void);
+#else
+#define asmPieceCount() (E->B.pieceCount)      // No "copyback" register in the portable engine.
+#endif
 
-static BOOL Consult_KxKy (ENGINE *E, CHAR *edbName, SQUARE wK, SQUARE wX, SQUARE bK, SQUARE bX, COLOUR player);
+static BOOL Consult_KxKy (ENGINE *E, INT db, SQUARE wK, SQUARE wX, SQUARE bK, SQUARE bX, COLOUR player);
+#ifndef __engine_asm
+static BOOL ConsultTablebases (ENGINE *E);
+#endif
 
 BOOL ConsultEndGameDB (ENGINE *E)
 {
-   if ((asmPieceCount() & 0xECCFECCF) ||
-       E->S.mainDepth > 1 ||
-       ! E->S.edbPresent ||
+   if (E->S.mainDepth > 1 ||
        ! E->P.useEndgameDB ||
        E->P.playingMode == mode_Novice ||
        E->P.playingMode == mode_Mate)
       return false;
 
+#ifndef __engine_asm
+   if (ConsultTablebases(E)) return true;
+#endif
+
+   if ((asmPieceCount() & 0xECCFECCF) || ! E->S.edbPresent)
+      return false;
+
    NODE   *N = E->S.rootNode;
    PIECE  *Board = E->B.Board;
    SQUARE *PieceLocW = E->B.PieceLocW;
@@ -77,57 +142,57 @@ BOOL ConsultEndGameDB (ENGINE *E)
       // --- KQKR ---
       case 0x10001000 :
          if (Board[wX] == wQueen && Board[bX] == bRook)
-            return Consult_KxKy(E, "KQKR", wK, wX, bK, bX, N[1].player);
+            return Consult_KxKy(E, edb_KQKR, wK, wX, bK, bX, N[1].player);
          else if (Board[wX] == wRook && Board[bX] == bQueen)
-            return Consult_KxKy(E, "KQKR", bK, bX, wK, wX, N[1].opponent);
+            return Consult_KxKy(E, edb_KQKR, bK, bX, wK, wX, N[1].opponent);
          else
             return false;
 
       // --- KQK/KRK [white] ---
       case 0x00001000 :
          if (Board[wX] == wQueen)
-            return Consult_KxKy(E, "KQKR", wK, wX, bK, bK, N[1].player);
+            return Consult_KxKy(E, edb_KQKR, wK, wX, bK, bK, N[1].player);
          else
-            return E->P.proVersion && Consult_KxKy(E, "KRKN", wK, wX, bK, bK, N[1].player);
+            return E->P.proVersion && Consult_KxKy(E, edb_KRKN, wK, wX, bK, bK, N[1].player);
 
       // --- KQK/KRK [black] ---
       case 0x10000000 :
          if (Board[bX] == bQueen)
-            return Consult_KxKy(E, "KQKR", bK, bX, wK, wK, N[1].opponent);
+            return Consult_KxKy(E, edb_KQKR, bK, bX, wK, wK, N[1].opponent);
          else
-            return E->P.proVersion && Consult_KxKy(E, "KRKN", bK, bX, wK, wK, N[1].opponent);         
+            return E->P.proVersion && Consult_KxKy(E, edb_KRKN, bK, bX, wK, wK, N[1].opponent);         
 
       // --- KQKB/KRKB [white] ---
       case 0x01001000 :
          if (! E->P.proVersion) return false;
          if (Board[wX] == wQueen)
-            return Consult_KxKy(E, "KQKB", wK, wX, bK, bX, N[1].player);
+            return Consult_KxKy(E, edb_KQKB, wK, wX, bK, bX, N[1].player);
          else
-            return Consult_KxKy(E, "KRKB", wK, wX, bK, bX, N[1].player);
+            return Consult_KxKy(E, edb_KRKB, wK, wX, bK, bX, N[1].player);
 
       // --- KQKB/KRKB [black] ---
       case 0x10000100 :
          if (! E->P.proVersion) return false;
          if (Board[bX] == bQueen)
-            return Consult_KxKy(E, "KQKB", bK, bX, wK, wX, N[1].opponent);
+            return Consult_KxKy(E, edb_KQKB, bK, bX, wK, wX, N[1].opponent);
          else
-            return Consult_KxKy(E, "KRKB", bK, bX, wK, wX, N[1].opponent);
+            return Consult_KxKy(E, edb_KRKB, bK, bX, wK, wX, N[1].opponent);
 
       // --- KQKN/KRKN [white] ---
       case 0x01101000 :
          if (! E->P.proVersion) return false;
          if (Board[wX] == wQueen)
-            return Consult_KxKy(E, "KQKN", wK, wX, bK, bX, N[1].player);
+            return Consult_KxKy(E, edb_KQKN, wK, wX, bK, bX, N[1].player);
          else
-            return Consult_KxKy(E, "KRKN", wK, wX, bK, bX, N[1].player);
+            return Consult_KxKy(E, edb_KRKN, wK, wX, bK, bX, N[1].player);
 
       // --- KQKN/KRKN [black] ---
       case 0x10000110 :
          if (! E->P.proVersion) return false;
          if (Board[bX] == bQueen)
-            return Consult_KxKy(E, "KQKN", bK, bX, wK, wX, N[1].opponent);
+            return Consult_KxKy(E, edb_KQKN, bK, bX, wK, wX, N[1].opponent);
          else
-            return Consult_KxKy(E, "KRKN", bK, bX, wK, wX, N[1].opponent);
+            return Consult_KxKy(E, edb_KRKN, bK, bX, wK, wX, N[1].opponent);
 
       // --- KBNK [white] ---
       case 0x00000210 :
@@ -135,7 +200,7 @@ BOOL ConsultEndGameDB (ENGINE *E)
             if (Board[PieceLocW[i]] == wBishop) xB = PieceLocW[i];
          for (i = 1; i <= E->B.LastOffi[white]; i++)
             if (Board[PieceLocW[i]] == wKnight) xN = PieceLocW[i];
-         return Consult_KxKy(E, "KBNK", wK, xB, xN, bK, N[1].player);
+         return Consult_KxKy(E, edb_KBNK, wK, xB, xN, bK, N[1].player);
 
       // --- KBNK [black] ---
       case 0x02100000 :
@@ -143,7 +208,7 @@ BOOL ConsultEndGameDB (ENGINE *E)
             if (Board[PieceLocB[i]] == bBishop) xB = PieceLocB[i];
          for (i = 1; i <= E->B.LastOffi[black]; i++)
             if (Board[PieceLocB[i]] == bKnight) xN = PieceLocB[i];
-         return Consult_KxKy(E, "KBNK", bK, xB, xN, wK, N[1].opponent);
+         return Consult_KxKy(E, edb_KBNK, bK, xB, xN, wK, N[1].opponent);
 
       // --- KBBK [white] ---
       case 0x00000200 :
@@ -152,7 +217,7 @@ BOOL ConsultEndGameDB (ENGINE *E)
          xB = PieceLocW[i++];
          for (; Board[PieceLocW[i]] != wBishop; i++);
          xN = PieceLocW[i];
-         return Consult_KxKy(E, "KBBK", wK, xB, xN, bK, N[1].player);
+         return Consult_KxKy(E, edb_KBBK, wK, xB, xN, bK, N[1].player);
 
       // --- KBBK [black] ---
       case 0x02000000 :
@@ -161,7 +226,7 @@ BOOL ConsultEndGameDB (ENGINE *E)
          xB = PieceLocB[i++];
          for (; Board[PieceLocB[i]] != bBishop; i++);
          xN = PieceLocB[i];
-         return Consult_KxKy(E, "KBBK", bK, xB, xN, wK, N[1].opponent);
+         return Consult_KxKy(E, edb_KBBK, bK, xB, xN, wK, N[1].opponent);
 
       default :
          return false;
@@ -169,12 +234,16 @@ BOOL ConsultEndGameDB (ENGINE *E)
 }   /* ConsultEndGameDB */
 
 
+#ifdef __engine_asm
+
 asm ULONG asmPieceCount (void)
 {
    mr rTmp1, rPieceCount
    blr
 } /* asmPieceCount */
 
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -200,7 +269,7 @@ static SQUARE Transpose7 (SQUARE sq);
 // Then we build the database index, and consult the database (if present). If successful, we
 // update RootNode->val and return true, otherwise we simply return false.
 
-static BOOL Consult_KxKy (ENGINE *E, CHAR *edbName, SQUARE wK, SQUARE wX, SQUARE bK, SQUARE bX, COLOUR thePlayer)
+static BOOL Consult_KxKy (ENGINE *E, INT db, SQUARE wK, SQUARE wX, SQUARE bK, SQUARE bX, COLOUR thePlayer)
 {
    INT    f = file(wK), r = rank(wK);
    SQUARE (*T)(SQUARE sq);
@@ -232,14 +301,26 @@ static BOOL Consult_KxKy (ENGINE *E, CHAR *edbName, SQUARE wK, SQUARE wX, SQUARE
    pos <<= 6; pos += packSquare(bX);
    pos <<= 1; pos += (thePlayer >> 4);
 
-   // Finally we open the database and retrieve the designated entry:
+   // Finally we retrieve the designated entry. If the host hasn't installed the database, we ask
+   // the host to probe it (it may also install the database in the process):
 
-   CopyStr(edbName, E->S.edbName);
-   E->S.edbPos = pos;
-   E->S.edbResult = -1;
-   SendMsg_Sync(E, msg_ProbeEndgDB);   // MUST be a SYNC call, i.e. we wait for host app to
-                                       // probe Endgame Database.
-   INT n = E->S.edbResult;
+   LONG64 t0 = MicroTimer();
+   INT    n;
+
+   if (E->Global->D.Data[db])
+      n = ProbeData(E->Global, db, pos);
+   else
+   {
+      CopyStr(EdbName[db], E->S.edbName);
+      E->S.edbPos = pos;
+      E->S.edbResult = -1;
+      SendMsg_Sync(E, msg_ProbeEndgDB);   // MUST be a SYNC call, i.e. we wait for host app to
+                                          // probe Endgame Database.
+      n = (E->Global->D.Data[db] ? ProbeData(E->Global, db, pos) : E->S.edbResult);
+   }
+
+   E->S.edbProbes++;
+   E->S.edbMicroSecs += MicroTimer() - t0;
 
    if (n == -1)
    {
@@ -269,6 +350,40 @@ static BOOL Consult_KxKy (ENGINE *E, CHAR *edbName, SQUARE wK, SQUARE wX, SQUARE
    return false;
 } /* Consult_KxKy */
 
+/*----------------------------------------- Tablebases -------------------------------------------*/
+// If the DTM tablebases (see "Tablebase.h") cover the position, the root node score is updated
+// just like for the K*K* databases. Since ply 1 positions are always probed, drawn positions get
+// the draw score (the search doesn't probe the WDL tables if the root is in the DTM tables).
+
+#ifndef __engine_asm
+
+static BOOL ConsultTablebases (ENGINE *E)
+{
+   LONG64 t0 = MicroTimer();
+   INT    v;
+
+   if (E->Global->TB.count == 0 || ! TB_ProbeBoard(E, tbKind_DTM, E->S.rootNode[1].player, &v) ||
+       v == tbDtmIllegal)
+      return false;
+
+   E->S.edbProbes++;
+   E->S.edbMicroSecs += MicroTimer() - t0;
+
+   clrMove(E->S.rootNode[1].m);
+   clrMove(E->S.rootNode[1].BestLine[0]);
+
+   if (tbDtmIsWin(v))
+      E->S.rootNode->val = 2*tbDtmMoves(v) - maxVal;
+   else if (tbDtmIsLoss(v))
+      E->S.rootNode->val = maxVal - (2*tbDtmMoves(v) + 1);
+   else
+      E->S.rootNode->val = drawVal;
+
+   return true;
+} /* ConsultTablebases */
+
+#endif
+
 /*-------------------------------------- Square Transposition ------------------------------------*/
 
 static SQUARE Transpose0 (SQUARE sq) { return square(file(sq),     rank(sq)    ); }
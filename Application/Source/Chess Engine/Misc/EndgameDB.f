@@ -33,4 +33,5 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
+void InitEndgameDBModule (GLOBAL *Global);
 BOOL ConsultEndGameDB (ENGINE *E);
@@ -0,0 +1,67 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "General.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & MACROS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The K*K* endgame databases (the file names are the database names, e.g. "KQKR"):
+
+enum ENDGAME_DB
+{
+   edb_KQKR = 0,
+   edb_KQKB = 1,
+   edb_KQKN = 2,
+   edb_KRKB = 3,
+   edb_KRKN = 4,
+   edb_KBNK = 5,
+   edb_KBBK = 6,
+
+   edbCount = 7
+};
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        TYPE DEFINITIONS                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The host may hand the contents of each database file to the engine (Engine_SetEndgameDB), e.g.
+// a memory mapped file. The engine then decodes the packed results itself instead of asking the
+// host to probe the database (msg_ProbeEndgDB). The data is read only and shared by all engines,
+// so it must not be changed or released while any engine is running.
+
+typedef struct
+{
+   PTR   Data[edbCount];                 // Database file contents (nil if not loaded).
+   ULONG Size[edbCount];                 // File size (bytes).
+} ENDGAMEDB_COMMON;
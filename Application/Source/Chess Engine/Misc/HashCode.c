@@ -97,6 +97,8 @@ LIB_CLASS ProbePosLib (LIBRARY *lib, COLOUR player, HKEY pos)
    LONG min   = 0;
    LONG max   = count - 1;
 
+   pos = libKey(pos);
+
    while (min <= max)
    {
       LONG i = (min + max)/2;
@@ -122,6 +124,9 @@ void InitHashCodeModule (GLOBAL *Global)                 // Initializes transpos
    HASHCODE_COMMON *H = &(Global->H);
 
    H->randKey = 310660507;
+#ifdef __hkey64
+   H->randKeyHi = 0x9E3779B97F4A7C15ULL;
+#endif
 
    for (PIECE p = pawn; p <= king; p++)
       for (SQUARE sq = a1; sq <= h8; sq++)
@@ -145,9 +150,20 @@ void InitHashCodeModule (GLOBAL *Global)                 // Initializes transpos
 } /* InitHashCodeModule */
 
 
+// With 64 bit keys the low order 32 bits are the original 32 bit hash codes, so the 32 bit keys of
+// old libraries are simply the low order part of the 64 bit keys (see "PosLibrary.c"). The high
+// order 32 bits are taken from a separate xorshift generator.
+
 static HKEY RandKey (GLOBAL *Global)
 {
    Global->H.randKey *= 1103515245;
    Global->H.randKey += 12345;
+#ifdef __hkey64
+   Global->H.randKeyHi ^= Global->H.randKeyHi >> 12;
+   Global->H.randKeyHi ^= Global->H.randKeyHi << 25;
+   Global->H.randKeyHi ^= Global->H.randKeyHi >> 27;
+   return ((Global->H.randKeyHi * 0x2545F4914F6CDD1DULL) & 0xFFFFFFFF00000000ULL) | Global->H.randKey;
+#else
    return Global->H.randKey;
+#endif
 } /* RandKey */
@@ -25,6 +25,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 
 #include "Move.h"
+#include "AsmDef.h"
 
 
 /**************************************************************************************************/
@@ -75,11 +76,19 @@ enum LIB_SET
 /*                                                                                                */
 /**************************************************************************************************/
 
-typedef ULONG  HKEY;
+#ifdef __engine_asm
+   typedef ULONG   HKEY;                     // 32 bit keys (the assembler engine depends on it).
+#else
+   #define __hkey64 1
+   typedef ULONG64 HKEY;                     // 64 bit Zobrist keys. The low order 32 bits are
+#endif                                       // identical to the 32 bit keys (see "RandKey").
 
 typedef struct
 {
    ULONG randKey;
+#ifdef __hkey64
+   ULONG64 randKeyHi;                        // Generator of the high order 32 bits.
+#endif
 
    HKEY HashCode[pieces][128];               // Hash codes for each piece on each square. Used
                                              // for incremental update of "hashKey".
@@ -94,7 +103,7 @@ typedef struct
 typedef struct       // Library file (and memory) format:
 {
    CHAR  info[1024];
-   ULONG flags;      // For future use
+   ULONG flags;      // Format version (bits 0..7, see "libFormat_Current"). Rest for future use.
    LONG  unused[32]; // For future use
 
    LONG  size;       // Logical size in bytes of library
@@ -110,17 +119,29 @@ typedef struct       // Library file (and memory) format:
                      // LIB_AUX[bAuxCount];    48 bytes per entry
 } LIBRARY;
 
+// The library entries hold the low order 32 bits of the hash keys, which are the 32 bit keys of
+// earlier versions (see "RandKey"). The library format is thus the same for 32 and 64 bit keys.
+// The application computes the keys with the (32 bit) assembler engine, so full 64 bit entries
+// would require a new format. Libraries with a newer format version than "libFormat_Current" are
+// therefore refused when loaded rather than misread.
+
+#define libFormat_Mask     0x00FF
+#define libFormat_Key32    0        // Entries hold libKey() (all libraries so far).
+#define libFormat_Current  libFormat_Key32
+
+#define libKey(hkey)    ((ULONG)(hkey))
+
 
 typedef struct       // 8 bytes 
 {
-   HKEY  pos;
+   ULONG pos;        // libKey() of the position.
    ULONG flags;      // E.g. open key classification (bits 0..3)
 } LIB_POS;
 
 
 typedef struct       // 48 bytes 
 {
-   HKEY  pos;
+   ULONG pos;        // libKey() of the position.
    CHAR  eco[libECOLength + 1];
    CHAR  comment[libCommentLength + 1];
 } LIB_AUX;
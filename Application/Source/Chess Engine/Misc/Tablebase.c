@@ -0,0 +1,388 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Tablebase.f"
+#include "Engine.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          INSTALL TABLES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#ifndef __engine_asm
+
+static ULONG GetLong (PTR p)                      // Big endian.
+{
+   return ((ULONG)p[0] << 24) | ((ULONG)p[1] << 16) | ((ULONG)p[2] << 8) | (ULONG)p[3];
+} /* GetLong */
+
+
+void InitTablebaseModule (GLOBAL *Global)
+{
+   Global->TB.Table = nil;
+   Global->TB.count = 0;
+} /* InitTablebaseModule */
+
+
+// Checks the header of a table file (the contents of which must remain valid while installed) and
+// fills in the table descriptor. Returns false if it isn't a valid table.
+
+BOOL Engine_OpenTablebase (TABLEBASE *T, PTR data, ULONG size)
+{
+   if (! data || size < tbHeaderSize || GetLong(data) != tbFileMagic) return false;
+
+   T->kind   = data[4];
+   T->pieceCount = data[5];
+   if ((T->kind != tbKind_WDL && T->kind != tbKind_DTM) || T->pieceCount < 3 || T->pieceCount > tbMaxPieces)
+      return false;
+
+   PIECE  Piece[tbMaxPieces];
+   SQUARE Sq[tbMaxPieces];
+   INT    kings = 0;
+
+   T->pawns = false;
+   for (INT i = 0; i < T->pieceCount; i++)
+   {
+      T->Piece[i] = Piece[i] = data[8 + i];
+      Sq[i] = i;
+      if (pieceType(Piece[i]) == pawn) T->pawns = true;
+      if (pieceType(Piece[i]) == king) kings++;
+      if (pieceType(Piece[i]) < pawn || pieceType(Piece[i]) > king || (Piece[i] & ~pieces)) return false;
+   }
+
+   TB_SortPieces(Piece, Sq, T->pieceCount);           // Must be in index order.
+   for (INT i = 0; i < T->pieceCount; i++)
+      if (Sq[i] != i) return false;
+   if (kings != 2 || T->Piece[0] != wKing) return false;
+
+   T->key        = TB_MaterialKey(T->Piece, T->pieceCount);
+   T->entries    = GetLong(data + 16);
+   T->blockCount = GetLong(data + 24);
+   T->data       = data;
+   T->size       = size;
+
+   return (T->entries == TB_Entries(T->pieceCount, T->pawns) &&
+           GetLong(data + 20) == tbBlockSize &&
+           T->blockCount == (T->entries + tbBlockSize - 1)/tbBlockSize &&
+           tbHeaderSize + 4*(T->blockCount + 1) <= size &&
+           GetLong(data + tbHeaderSize + 4*T->blockCount) <= size);
+} /* Engine_OpenTablebase */
+
+
+// Installs the tables (or removes them if "count" is 0). The table array is sorted in place and
+// must remain valid while installed. Must not be called while any engine is running.
+
+void Engine_SetTablebases (GLOBAL *Global, TABLEBASE Table[], INT count)
+{
+   for (INT i = 1; i < count; i++)                // Insertion sort by key and kind.
+   {
+      TABLEBASE T = Table[i];
+      INT j;
+      for (j = i; j > 0 && (Table[j - 1].key > T.key || (Table[j - 1].key == T.key && Table[j - 1].kind > T.kind)); j--)
+         Table[j] = Table[j - 1];
+      Table[j] = T;
+   }
+
+   Global->TB.Table = (count > 0 ? Table : nil);
+   Global->TB.count = Max(0, count);
+} /* Engine_SetTablebases */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                             INDEXING                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The material key holds the number of pieces of each type and colour (except kings) in 3 bit
+// fields (white in bits 0..14, black in bits 15..29).
+
+#define flipKey(key)     ((((key) & 0x7FFF) << 15) | ((key) >> 15))
+#define pieceOrder(p)    (pieceColour(p) + king - pieceType(p))
+
+static INT wkRankOffset[4] = { 0,3,5,6 };
+static INT TriangleSq[10]  = { 0,1,2,3, 9,10,11, 18,19, 27 };   // a1,b1,c1,d1, b2,c2,d2, c3,d3, d4
+
+ULONG TB_MaterialKey (PIECE Piece[], INT n)
+{
+   ULONG key = 0;
+
+   for (INT i = 0; i < n; i++)
+      if (pieceType(Piece[i]) != king)
+         key += 1L << (3*(pieceType(Piece[i]) - 1) + (pieceColour(Piece[i]) ? 15 : 0));
+   return key;
+} /* TB_MaterialKey */
+
+
+// Sorts the pieces (and their squares) into index order (stable, i.e. pieces of the same type
+// keep their order).
+
+void TB_SortPieces (PIECE Piece[], SQUARE Sq[], INT n)
+{
+   for (INT i = 1; i < n; i++)
+   {
+      PIECE p = Piece[i];
+      SQUARE sq = Sq[i];
+      INT j;
+      for (j = i; j > 0 && pieceOrder(Piece[j - 1]) > pieceOrder(p); j--)
+         Piece[j] = Piece[j - 1], Sq[j] = Sq[j - 1];
+      Piece[j] = p;
+      Sq[j] = sq;
+   }
+} /* TB_SortPieces */
+
+
+ULONG TB_Entries (INT n, BOOL pawns)
+{
+   return ((ULONG)(pawns ? 32 : 10) << (6*(n - 1))) << 1;         // (Both sides to move).
+} /* TB_Entries */
+
+
+// Computes the index of the position where the pieces T->Piece[] are on the squares Sq[] (0x88).
+// The position is first mirrored so the white king lies in the a1-d1-d4 triangle (pawnless
+// tables) or on the a-d files. If the white king is on the a1-d4 diagonal, the first piece off
+// the diagonal is put below it, so symmetric positions have the same index.
+
+ULONG TB_Index (TABLEBASE *T, SQUARE Sq[], COLOUR player)
+{
+   INT n = T->pieceCount, S[tbMaxPieces], i, k;
+
+   if (n < 3) return 0;                           // (Never, Engine_OpenTablebase only accepts
+                                                  // tables with 3 or more pieces).
+   for (i = 0; i < n; i++)
+      S[i] = (rank(Sq[i]) << 3) + file(Sq[i]);
+
+   if ((S[0] & 7) > 3)                            // Mirror files.
+      for (i = 0; i < n; i++) S[i] ^= 7;
+
+   if (T->pawns)
+      k = ((S[0] >> 3) << 2) + (S[0] & 7);
+   else
+   {
+      if ((S[0] >> 3) > 3)                        // Mirror ranks.
+         for (i = 0; i < n; i++) S[i] ^= 56;
+
+      BOOL transpose = ((S[0] >> 3) > (S[0] & 7));
+      if ((S[0] >> 3) == (S[0] & 7))
+         for (i = 1; i < n; i++)
+            if ((S[i] >> 3) != (S[i] & 7))
+            {  transpose = ((S[i] >> 3) > (S[i] & 7));
+               break;
+            }
+      if (transpose)                              // Mirror in the a1-h8 diagonal.
+         for (i = 0; i < n; i++) S[i] = ((S[i] & 7) << 3) + (S[i] >> 3);
+
+      k = (S[0] & 7) + wkRankOffset[S[0] >> 3];
+   }
+
+   ULONG index = k;                               // The positions with black to move follow
+   for (i = 1; i < n; i++)                        // those with white to move (which compresses
+      index = (index << 6) + S[i];                // better than interleaving them).
+   return index + (player == black ? T->entries >> 1 : 0);
+} /* TB_Index */
+
+
+// The inverse of TB_Index (for indices that TB_Index doesn't return, the position is invalid).
+
+void TB_Position (TABLEBASE *T, ULONG index, SQUARE Sq[], COLOUR *player)
+{
+   *player = (index >= T->entries >> 1 ? black : white);
+   if (*player == black) index -= T->entries >> 1;
+
+   for (INT i = T->pieceCount - 1; i > 0; i--, index >>= 6)
+      Sq[i] = square(index & 7, (index >> 3) & 7);
+
+   INT s = (T->pawns ? ((index >> 2) << 3) + (index & 3) : TriangleSq[index]);
+   Sq[0] = square(s & 7, s >> 3);
+} /* TB_Position */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           READ ENTRIES                                         */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Each block is compressed with PackBits: A control byte c < 128 is followed by c + 1 literal
+// bytes, and a control byte c >= 128 by a single byte to be repeated c - 125 times.
+
+static BOOL Unpack (PTR s, PTR end, BYTE *d, ULONG count)
+{
+   while (count > 0 && s < end)
+   {
+      ULONG c = *(s++), n = (c < 128 ? c + 1 : c - 125);
+
+      if (n > count || s + (c < 128 ? n : 1) > end) return false;
+      count -= n;
+
+      if (c < 128)
+         while (n--) *(d++) = *(s++);
+      else
+      {  while (n--) *(d++) = *s;
+         s++;
+      }
+   }
+   return (count == 0);
+} /* Unpack */
+
+
+INT TB_Read (TABLEBASE *T, TABLEBASE_CACHE *C, ULONG index)
+{
+   if (T->blockCount == 0) return T->data[index];
+
+   ULONG block = index/tbBlockSize;
+
+   if (C->T != T || C->block != block)
+   {
+      PTR   offset = T->data + tbHeaderSize + 4*block;
+      ULONG start = GetLong(offset), end = GetLong(offset + 4);
+      ULONG count = MinL(tbBlockSize, T->entries - block*tbBlockSize);
+
+      C->T = nil;
+      if (start > end || end > T->size || ! Unpack(T->data + start, T->data + end, C->Data, count))
+         return (T->kind == tbKind_WDL ? tbWdl_Illegal : tbDtmIllegal);
+
+      C->T     = T;
+      C->block = block;
+   }
+
+   return C->Data[index % tbBlockSize];
+} /* TB_Read */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                              PROBING                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+TABLEBASE *TB_Find (GLOBAL *Global, ULONG key, INT kind)
+{
+   INT lo = 0, hi = Global->TB.count - 1;
+
+   while (lo <= hi)
+   {
+      INT       mid = (lo + hi) >> 1;
+      TABLEBASE *T  = &Global->TB.Table[mid];
+
+      if (T->key == key && T->kind == kind) return T;
+      if (T->key < key || (T->key == key && T->kind < kind)) lo = mid + 1;
+      else hi = mid - 1;
+   }
+   return nil;
+} /* TB_Find */
+
+
+// Looks up the position with the "n" pieces Piece[] (in any order, incl. the kings) on Sq[].
+// Returns false if there's no table for the material. The cache "C" is only needed for
+// compressed tables.
+
+BOOL TB_Lookup (GLOBAL *Global, TABLEBASE_CACHE *C, INT kind, INT n, PIECE Piece[], SQUARE Sq[], COLOUR player, INT *value)
+{
+   ULONG     key = TB_MaterialKey(Piece, n);
+   TABLEBASE *T  = TB_Find(Global, key, kind);
+   BOOL      flip = false;
+
+   if (! T && ! (T = TB_Find(Global, flipKey(key), kind), flip = true, T)) return false;
+   if (T->pieceCount != n) return false;
+
+   PIECE  P[tbMaxPieces];
+   SQUARE S[tbMaxPieces];
+
+   for (INT i = 0; i < n; i++)                    // Reverse colours (and mirror ranks) if the
+   {  P[i] = (flip ? Piece[i] ^ black : Piece[i]);  // stronger side is black.
+      S[i] = (flip ? Sq[i] ^ 0x70 : Sq[i]);
+   }
+   if (flip) player ^= black;
+   TB_SortPieces(P, S, n);
+
+   *value = TB_Read(T, C, TB_Index(T, S, player));
+   return true;
+} /* TB_Lookup */
+
+
+// Probes the current board position of the engine (with "player" to move).
+
+BOOL TB_ProbeBoard (ENGINE *E, INT kind, COLOUR player, INT *value)
+{
+   PIECE  Piece[tbMaxPieces];
+   SQUARE Sq[tbMaxPieces];
+   INT    n = 0;
+
+   for (COLOUR c = white; c <= black; c += 0x10)
+      for (INDEX i = 0; i <= E->B.LastPiece[c]; i++)
+      {
+         SQUARE sq = E->B.PieceLoc[c + i];
+         if (sq == nullSq) continue;
+         if (n == tbMaxPieces) return false;
+         Piece[n] = E->B.Board[sq];
+         Sq[n++]  = sq;
+      }
+
+   return TB_Lookup(E->Global, &E->TBCache, kind, n, Piece, Sq, player, value);
+} /* TB_ProbeBoard */
+
+/*----------------------------------------- Search Probes ----------------------------------------*/
+// The WDL tables are probed at every node with few enough pieces, unless the root position is
+// itself in the DTM tables (in which case ConsultEndGameDB() uses these at the root instead,
+// since the WDL scores don't tell the engine how to make progress). Wins are scored below the
+// mate values, but above any evaluation.
+
+#define tablebasePieces(pc)  (((pc) & 0x0F) + (((pc) >> 8) & 0x0F) + (((pc) >> 12) & 0x0F) + \
+                              (((pc) >> 16) & 0x0F) + (((pc) >> 24) & 0x0F) + (((pc) >> 28) & 0x0F))
+
+BOOL TB_SearchProbing (ENGINE *E)
+{
+   PARAM *P = (E->SMP.Master ? &E->SMP.Master->P : &E->P);   // (Helpers don't use the EDB).
+   INT   v;
+
+   E->S.tbHits = 0;
+   E->TBCache.T = nil;
+
+   if (E->Global->TB.count == 0 || ! P->useEndgameDB ||
+       P->playingMode == mode_Novice || P->playingMode == mode_Mate)
+      return false;
+
+   return (tablebasePieces(E->B.pieceCount) > tbMaxPieces - 2 || ! TB_ProbeBoard(E, tbKind_DTM, E->B.player, &v));
+} /* TB_SearchProbing */
+
+
+BOOL TB_ProbeSearch (ENGINE *E, NODE *N)
+{
+   INT v;
+
+   if (tablebasePieces(E->B.pieceCount) > tbMaxPieces - 2 ||
+       ! TB_ProbeBoard(E, tbKind_WDL, N->player, &v) || v == tbWdl_Illegal)
+      return false;
+
+   E->S.tbHits++;
+   if (v == tbWdl_Win)       N->score = tbWinVal - N->depth;
+   else if (v == tbWdl_Loss) N->score = N->depth - tbWinVal;
+   else                      N->score = drawVal;
+   return true;
+} /* TB_ProbeSearch */
+
+#endif
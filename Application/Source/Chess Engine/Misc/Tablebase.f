@@ -0,0 +1,62 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "Engine.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        FUNCTION PROTOTYPES                                     */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Search hook: Probes the WDL tables at node N if enabled for the search (E->S.tbProbing). The
+// assembler engine doesn't support tablebases.
+
+#ifndef __engine_asm
+   #define TB_ProbeNode(E,N)    ((E)->S.tbProbing && TB_ProbeSearch(E, N))
+#else
+   #define TB_ProbeNode(E,N)    false
+#endif
+
+#ifndef __engine_asm
+
+void  InitTablebaseModule (GLOBAL *Global);
+
+ULONG TB_MaterialKey (PIECE Piece[], INT n);
+void  TB_SortPieces (PIECE Piece[], SQUARE Sq[], INT n);
+ULONG TB_Entries (INT n, BOOL pawns);
+ULONG TB_Index (TABLEBASE *T, SQUARE Sq[], COLOUR player);
+void  TB_Position (TABLEBASE *T, ULONG index, SQUARE Sq[], COLOUR *player);
+INT   TB_Read (TABLEBASE *T, TABLEBASE_CACHE *C, ULONG index);
+
+TABLEBASE *TB_Find (GLOBAL *Global, ULONG key, INT kind);
+BOOL  TB_Lookup (GLOBAL *Global, TABLEBASE_CACHE *C, INT kind, INT n, PIECE Piece[], SQUARE Sq[], COLOUR player, INT *value);
+BOOL  TB_ProbeBoard (ENGINE *E, INT kind, COLOUR player, INT *value);
+BOOL  TB_SearchProbing (ENGINE *E);
+BOOL  TB_ProbeSearch (ENGINE *E, NODE *N);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "Board.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & MACROS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Endgame tablebases for all 3-5 piece material signatures (e.g. "KRKP"), as built by the
+// "sigma-tbgen" tool. Each signature has a WDL table (win/draw/loss) which is probed during the
+// search, and a DTM table (distance to mate) which is probed at the root. Portable engine only.
+
+#define tbMaxPieces      5               // Max pieces (incl. kings).
+#define tbBlockSize      8192            // Entries per compressed block.
+#define tbFileMagic      0x53544231      // 'STB1'
+#define tbHeaderSize     32
+
+enum TB_KIND
+{
+   tbKind_WDL = 0,                       // File extension ".stw".
+   tbKind_DTM = 1                        // File extension ".stm".
+};
+
+// WDL entries (from the point of view of the side to move):
+
+enum TB_WDL
+{
+   tbWdl_Loss    = 0,
+   tbWdl_Draw    = 1,
+   tbWdl_Win     = 2,
+   tbWdl_Illegal = 3
+};
+
+// DTM entries: The side to move mates in n moves (n = 1..tbMaxDtm), or is mated in n moves
+// (n = 0..tbMaxDtm, 0 = checkmated). Longer mates are stored as tbMaxDtm.
+
+#define tbMaxDtm         126
+#define tbDtmDraw        0x00
+#define tbDtmWin(n)      (n)
+#define tbDtmLoss(n)     (0x80 + (n))
+#define tbDtmIllegal     0xFF
+#define tbDtmIsWin(v)    ((v) >= 1 && (v) <= tbMaxDtm)
+#define tbDtmIsLoss(v)   ((v) >= 0x80 && (v) <= 0x80 + tbMaxDtm)
+#define tbDtmMoves(v)    ((v) & 0x7F)
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        TYPE DEFINITIONS                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// A table holds one entry per position of the signature. The pieces are ordered as in Piece[]
+// (white king, white pieces in descending order, black king, black pieces), and the signature is
+// oriented so white is the stronger side (positions with a stronger black side are probed with
+// colours reversed). The index is built from the squares of the pieces and the side to move,
+// after mirroring the position so the white king lies in the a1-d1-d4 triangle (or on files a-d
+// if there are pawns). En passant and castling rights are ignored.
+//
+// Table file format (numbers are big endian): A tbHeaderSize byte header (magic, kind, piece
+// count, Piece[], entry and block counts), the file offsets of the blocks (blockCount + 1), and
+// the blocks, each tbBlockSize entries compressed with PackBits.
+
+typedef struct
+{
+   ULONG key;                            // Material key (see TB_MaterialKey).
+   INT   kind;                           // tbKind_WDL or tbKind_DTM.
+   INT   pieceCount;                     // Number of pieces (incl. kings).
+   BOOL  pawns;                          // Any pawns (only left/right mirroring)?
+   PIECE Piece[tbMaxPieces];             // The pieces in index order.
+   ULONG entries;                        // Number of entries (positions).
+   ULONG blockCount;                     // Number of blocks (0 if "data" holds the raw entries).
+   PTR   data;                           // Table file contents (or raw entries).
+   ULONG size;
+} TABLEBASE;
+
+// The tables are installed by the host (Engine_SetTablebases) and shared read only by all engines.
+
+typedef struct
+{
+   TABLEBASE *Table;                     // Sorted by key and kind.
+   INT       count;
+} TABLEBASE_COMMON;
+
+// Each engine decompresses a block at a time into its own cache.
+
+typedef struct
+{
+   TABLEBASE *T;                         // Table of cached block (nil if none).
+   ULONG     block;
+   BYTE      Data[tbBlockSize];
+} TABLEBASE_CACHE;
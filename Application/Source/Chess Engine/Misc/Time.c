@@ -35,6 +35,23 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Time.f"
 
 
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                              CLOCK                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The search timing uses the monotonic micro second clock instead of Timer(), which is both
+// expensive (an out-of-process call under OS X) and only has a 1/60 sec resolution.
+
+LONG64 MicroTimer (void)
+{
+   LONG64 t;
+   MicroSecs(&t);
+   return t;
+} /* MicroTimer */
+
+
 /**************************************************************************************************/
 /*                                                                                                */
 /*                                         TIME ALLOCATION/CONTROL                                */
@@ -54,27 +71,50 @@ void AllocateTime (ENGINE *E)                // Allocates time for the forthcomi
          maxTicks,                           // Time left on players clock.
          Tm[4];                              // Time dependant on move type of BestLine[0].
 
+   if (E->P.moveTimeMS > 0)                              // Fixed time per move (e.g. UCI "movetime").
+   {
+      LONG64 limit = MicroTimer() + 1000*(LONG64)E->P.moveTimeMS;
+
+      for (INT i = timer_Recap; i <= timer_Sacri; i++)
+         T->NormalTime[i] = T->IterationTime[i] = limit;
+      T->timer = timer_Normal;
+      T->nominalTime = T->maxTime = T->ultraTime = limit;
+      return;
+   }
+
    if (movesLeft == allMoves)                            // Moves to play within time limit.
       movesLeft = Max(60 - E->P.lastMoveNo/2, 15);       // If "all moves" always assume at least 15 moves left
 
-   avgTicks = (60*(secsLeft - 2))/movesLeft + 1;         // Average time pr. move to next control.
+   if (E->P.timeLeftMS > 0)                              // Time in milliseconds (e.g. UCI): As below,
+   {                                                     // but with the safety margins scaled down
+      LONG msLeft    = E->P.timeLeftMS - MinL(2000, E->P.timeLeftMS/10);   // in fast games.
+      LONG ticksLeft = (60*(LONG64)msLeft)/1000;
+      avgTicks = ticksLeft/movesLeft + 1 + (60*(LONG64)E->P.timeIncMS)/1000;
+      maxTicks = MaxL(1, ticksLeft - MinL(30*Min(30,movesLeft), ticksLeft/2));
+   }
+   else
+   {
+      avgTicks = (60*(secsLeft - 2))/movesLeft + 1;      // Average time pr. move to next control.
+//    maxTicks = MaxL(10, 60*(secsLeft - Min(30,movesLeft)));  // Maximum time for current move: At
+      maxTicks = MaxL(6, 60*(secsLeft - 2) - 30*Min(30,movesLeft));  // Maximum time for current move: At
+   }                                                     // least one 1/10 sec pr. move.
    nomTicks = MaxL(15, 35 - movesPlayed)*avgTicks/10;    // Time for current move.
-// maxTicks = MaxL(10, 60*(secsLeft - Min(30,movesLeft)));  // Maximum time for current move: At
-   maxTicks = MaxL(6, 60*(secsLeft - 2) - 30*Min(30,movesLeft));  // Maximum time for current move: At
-                                                         // least one 1/10 sec pr. move.
+
    Tm[timer_Recap]  = nomTicks/4 + 30;                   // Forced recaptures.
    Tm[timer_Forced] = nomTicks/2 + 30;                   // Other forced moves.
    Tm[timer_Normal] = nomTicks;                          // Normal moves.
    Tm[timer_Sacri]  = (3*nomTicks)/2;                    // Sacrifices.
 
+   LONG64 now = MicroTimer();
+
    for (INT i = timer_Recap; i <= timer_Sacri; i++)
-   {  T->NormalTime[i]    = MinL(maxTicks, Tm[i]) + Timer();
-      T->IterationTime[i] = MinL(maxTicks, (5*Tm[i])/6) + Timer();
+   {  T->NormalTime[i]    = now + ticksToMicroSecs(MinL(maxTicks, Tm[i]));
+      T->IterationTime[i] = now + ticksToMicroSecs(MinL(maxTicks, (5*Tm[i])/6));
    }
 
-   T->timer       = timer_Normal;                         // Initially select normal timer.
-   T->maxTime     = MinL(maxTicks, 3*nomTicks) + Timer(); // Emergency brakes.
-   T->ultraTime   = MinL(maxTicks, 6*nomTicks) + Timer();
+   T->timer       = timer_Normal;                                  // Initially select normal timer.
+   T->maxTime     = now + ticksToMicroSecs(MinL(maxTicks, 3*nomTicks));  // Emergency brakes.
+   T->ultraTime   = now + ticksToMicroSecs(MinL(maxTicks, 6*nomTicks));
    T->nominalTime = T->NormalTime[timer_Normal];
 } /* AllocateTime */
 
@@ -100,7 +140,7 @@ void AdjustTimeLimit (ENGINE *E)                 // Adjusts the time limit for t
 
 BOOL TimeOut (ENGINE *E)
 {
-   LONG timer = Timer();
+   LONG64 timer = MicroTimer();
    if (timer < E->T.nominalTime ||
        E->P.playingMode != mode_Time ||
        E->P.backgrounding ||
@@ -117,7 +157,7 @@ BOOL TimeOut (ENGINE *E)
 
 BOOL TimeForAnotherIteration (ENGINE *E)
 {
-   return (E->P.backgrounding || Timer() <= E->T.IterationTime[E->T.timer]);
+   return (E->P.backgrounding || MicroTimer() <= E->T.IterationTime[E->T.timer]);
 } /* TimeForAnotherIteration */
 
 
@@ -127,8 +167,10 @@ BOOL TimeForAnotherIteration (ENGINE *E)
 /*                                                                                                */
 /**************************************************************************************************/
 
-void PauseTimeAdjust (ENGINE *E, LONG pauseDuration)       // If the program has been paused we
+void PauseTimeAdjust (ENGINE *E, LONG pauseTicks)          // If the program has been paused we
 {                                                          // must adjust the time limits.
+   LONG64 pauseDuration = ticksToMicroSecs(pauseTicks);
+
    for (INT i = timer_Recap; i <= timer_Sacri; i++)
       E->T.NormalTime[i]    += pauseDuration,
       E->T.IterationTime[i] += pauseDuration;
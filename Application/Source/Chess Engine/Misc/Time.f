@@ -33,8 +33,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
+LONG64 MicroTimer (void);
 void AllocateTime (ENGINE *E);
 void AdjustTimeLimit (ENGINE *E);
 BOOL TimeOut (ENGINE *E);
 BOOL TimeForAnotherIteration (ENGINE *E);
-void PauseTimeAdjust (ENGINE *E, LONG pauseDuration);
+void PauseTimeAdjust (ENGINE *E, LONG pauseTicks);
@@ -33,6 +33,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 enum TIMER { timer_Recap, timer_Forced, timer_Normal, timer_Sacri };
 
+#define ticksToMicroSecs(t)  ((LONG64)(t)*1000000/60)
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -42,14 +44,14 @@ enum TIMER { timer_Recap, timer_Forced, timer_Normal, timer_Sacri };
 
 typedef struct
 {
-   INT   timer;                             // Timer selector. Is set according to the type of
+   INT    timer;                            // Timer selector. Is set according to the type of
                                             // the best move found so far during the search:
                                             // forced recaptures, other forced moves, normal
                                             // moves and sacrifices. 
-   ULONG NormalTime[4],                     // Normal time limits for the 4 move types (ticks).
-         nominalTime,                       // Equals "NormalTime[timer]".
-         IterationTime[4],                  // Limits for another iteration for each move type.
-         maxTime,                           // Emergency brake if the best move is loosing.
-         ultraTime;                         // "Ultra" emergency brake. Stops the search no
+   LONG64 NormalTime[4],                    // Normal time limits for the 4 move types (MicroTimer()).
+          nominalTime,                      // Equals "NormalTime[timer]".
+          IterationTime[4],                 // Limits for another iteration for each move type.
+          maxTime,                          // Emergency brake if the best move is loosing.
+          ultraTime;                        // "Ultra" emergency brake. Stops the search no
                                             // matter what.
 } TIME_STATE;
@@ -96,8 +96,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // (3) In the quiescence search, phases A - E, J, K and optionally I are performed.
 
 
+#ifdef __engine_asm
 static asm void ProcessMove (void);
 static asm void AddSacrifice (void);
+#else
+static void ProcessMove (ENGINE *E, NODE *N);
+static void AddSacrifice (ENGINE *E, NODE *N);
+#endif
 
 
 /**************************************************************************************************/
@@ -121,30 +126,30 @@ void GenRootMoves (ENGINE *E)
 
    Asm_Begin(E);
 
-      AnalyzeThreats();                            // Compute escapeSq, ALoc/SLoc etc.
+      AnalyzeThreats(E, N);                        // Compute escapeSq, ALoc/SLoc etc.
 
       if (N->check)
       {
          N->m.dply = 1;                            // CHECK EVASION.
-         SearchCheckEvasion();
+         SearchCheckEvasion(E, N);
       }
       else 
       {
          N->m.dply = 0;                            // [0] FORCED MOVES (dply = 0):
-         SearchEnPriseCaptures();                  // Generate en prise captures, queen
-         SearchPromotions();                       // promotions and safe recaptures.
-         SearchRecaptures();
+         SearchEnPriseCaptures(E, N);              // Generate en prise captures, queen
+         SearchPromotions(E, N);                   // promotions and safe recaptures.
+         SearchRecaptures(E, N);
 
          N->m.dply = 1;                            // [1] NON-FORCED MOVES (dply = 1):
-         SearchSafeCaptures();                     // Generate normal moves and (forced)
+         SearchSafeCaptures(E, N);                 // Generate normal moves and (forced)
          N->eply = 0;
-         SearchEscapes();                          // escapes.
+         SearchEscapes(E, N);                      // escapes.
          N->m.dply = 1;
-         SearchCastling();                         // Generate castling if not in check.
+         SearchCastling(E, N);                     // Generate castling if not in check.
 
          N->m.dply = 2;                            // [2] GENERATE QUIET MOVES (dply = 2):
-         SearchNonCaptures();                      // Generate non-captures.
-         SearchSacrifices();                       // Generate sacrifice moves.
+         SearchNonCaptures(E, N);                  // Generate non-captures.
+         SearchSacrifices(E, N);                   // Generate sacrifice moves.
       }
 
    Asm_End();
@@ -161,7 +166,7 @@ static void GenOneRootMove (register ENGINE *E)      // Stores the generated mov
    SEARCH_STATE *S = &E->S;
    NODE *N = E->S.rootNode;
 
-   PerformMove();
+   PerformMove(E, N);
 
    if (! N->Attack_[N->PieceLoc[0]])                 // If move is strictly legal
    {  
@@ -170,10 +175,12 @@ static void GenOneRootMove (register ENGINE *E)      // Stores the generated mov
       S->numRootMoves++;
    }
 
-   RetractMove();
+   RetractMove(E, N);
 } /* GenOneRootMove */
 
 
+#ifdef __engine_asm
+
 /**************************************************************************************************/
 /*                                                                                                */
 /*                                     PROCESS GENERATED MOVES                                    */
@@ -214,7 +221,7 @@ asm void SearchPromotion1 (void);
 
 /*---------------------------------- Search All En Prise Captures --------------------------------*/
 
-asm void SearchEnPriseCaptures (void)     // Generates and searches all en prise captures, i.e.
+asm void SearchEnPriseCaptures (register ENGINE *_E, register NODE *_N)     // Generates and searches all en prise captures, i.e.
 {                                         // captures of undefended and/or higher valued pieces.
    #define PL  rLocal1
    #define i   rLocal2
@@ -400,7 +407,7 @@ asm void SearchEnPriseCaptures1 (register SQUARE _sq, register SQUARE _sq4, regi
 // promotions are searched immediately, whereas under-promotions are added to the sacrifice 
 // buffer.
 
-asm void SearchPromotions (void)
+asm void SearchPromotions (register ENGINE *_E, register NODE *_N)
 {
    #define search_prom_pawns(psx,rto,L1,L2) \
       lbz     rTmp1, (psx)(rEngine)       ; /* bits = PawnStructX[rfrom];               */ \
@@ -503,7 +510,7 @@ asm void SearchEnPassant (void);
 // prise captures) of the piece on "sq" are searched and N->recapSq is set to "sq". Otherwise
 // N->recapSq is set to "nullSq" and en passant moves (if any) are searched.
 
-asm void SearchRecaptures (void)
+asm void SearchRecaptures (register ENGINE *_E, register NODE *_N)
 {
    lhz     rTmp5, pmove(cap)
    li      rTmp9, gen_C                   // N->gen = gen_C;
@@ -598,7 +605,7 @@ asm void SearchEnPassant (void)
 // checked individually for each potential capture. Also, sacrifice captures are stored in the
 // sacrifice buffer.
 
-asm void SearchSafeCaptures (void)    
+asm void SearchSafeCaptures (register ENGINE *_E, register NODE *_N)    
 {
    #define PL     rLocal1
    #define i      rLocal2
@@ -830,7 +837,7 @@ asm void SearchNonCaptures1 (register SQUARE _sq1);
 // Searches non-capture moves by the piece on N->escapeSq (which must not be a nullSq).
 // NOTE: Changes m.dPly, which should be reset afterwards to 1.
 
-asm void SearchEscapes (void)
+asm void SearchEscapes (register ENGINE *_E, register NODE *_N)
 {
    lha     rTmp1, node(escapeSq)          // If (N->escapeSq == nullSq) return;
    li      rTmp9, gen_E                   // N->gen = gen_E;
@@ -856,7 +863,7 @@ asm void SearchEscapes (void)
 
 asm void SearchKiller (register MOVE* _killer, register INT _gen);
 
-asm void SearchKillers (void)
+asm void SearchKillers (register ENGINE *_E, register NODE *_N)
 {
 @1 lhz     rTmp3, node(killer1Active)      // if (killer1Active)
    addi    rTmp1, rNode, NODE.killer1      //    SearchKiller(&killer1, gen_F1);
@@ -948,7 +955,7 @@ asm void SearchKiller (register MOVE* _killer, register INT _gen)
 // Searches castling moves. May not be called if the player is in check.
 // NOTE: Assumes Big Endian
 
-asm void SearchCastling (void)
+asm void SearchCastling (register ENGINE *_E, register NODE *_N)
 {
    cmpi    cr0,0,rPlayer,white            // if (player == white)
    bne     @BLACK
@@ -1096,7 +1103,7 @@ asm void SearchPawn         (register SQUARE _sq1, register SQUARE _sq2);
 // Searches all normal, non-captures in the following order: Attacked pieces (from "ALoc[]"), safe
 // pieces (from "SLoc[]") and finally the king.
 
-asm void SearchNonCaptures (void)
+asm void SearchNonCaptures (register ENGINE *_E, register NODE *_N)
 {
    #define Loc rLocal1
 
@@ -1531,7 +1538,7 @@ asm void SearchPawn (register SQUARE _sq1, register SQUARE _sq2)
 // Searches all moves of "SBuf" pertaining to the current node. N->m.dply must already have been
 // set appropriately (it will not be changed).
 
-asm void SearchSacrifices (void)
+asm void SearchSacrifices (register ENGINE *_E, register NODE *_N)
 {
    #define sm rLocal1
 
@@ -1597,7 +1604,7 @@ asm void SearchCheckP (void);
 // Searches safe non-capturing checks (both direct and indirect check). Pawns to 7th or 8th rank are
 // not searched.
                
-asm void SearchSafeChecks (void)
+asm void SearchSafeChecks (register ENGINE *_E, register NODE *_N)
 {
    #define ksq  rLocal1                      // Location of enemy king
    #define Aksq rLocal2                      // &AttackP[ksq]
@@ -2093,7 +2100,7 @@ asm void SearchCheckP (void)
 // This routines searches all non-capturing pawn moves to the 6th and 7th rank (including
 // sacrifices).
 
-asm void SearchFarPawns (void)
+asm void SearchFarPawns (register ENGINE *_E, register NODE *_N)
 {
    #define search_far_pawns(psx,rto,L1,L2,L3) \
       lbz     rTmp1, (psx)(rEngine)       ; /* bits = PawnStructX[rfrom];               */ \
@@ -2160,7 +2167,7 @@ asm void SearchInterpositions1 (void);
 // and searches all strictly legal (except ep which are always tried) check evasion moves
 // (including sacrifices).
 
-asm void SearchCheckEvasion (void)
+asm void SearchCheckEvasion (register ENGINE *_E, register NODE *_N)
 {
    #define ksq    rLocal1                     // Location of king
    #define csq    rLocal2                     // Location of checking piece
@@ -2488,6 +2495,1096 @@ asm void SearchInterpositions1 (void)
    #undef Data
 } /* SearchInterpositions1 */
 
+#else
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                     PORTABLE MOVE GENERATION                                   */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// C versions of the assembler move generators above. The moves are generated (and the N->m
+// fields are set) in exactly the same order as by the assembler versions, so both engine back
+// ends search identical trees. After a cutoff (N->cutoff, see "SearchMoveC") the generators
+// return at once, leaving N->m etc. exactly as the long jump of the assembler version does.
+
+static void SearchEnPriseCaptures1 (ENGINE *E, NODE *N, SQUARE sq);
+static void SearchPromotion1       (ENGINE *E, NODE *N);
+static void SearchSafeCaptures1    (ENGINE *E, NODE *N, SQUARE sq);
+static void SearchEnPassant        (ENGINE *E, NODE *N);
+static void SearchNonCaptures1     (ENGINE *E, NODE *N, SQUARE sq);
+
+#define moreBits(a)  ((a) & ((a) - 1))         // Is more than one bit set in "a"?
+
+/*------------------------------------------ Process Move ----------------------------------------*/
+
+static void ProcessMove (ENGINE *E, NODE *N)
+{
+   switch (E->R.state)
+   {
+      case state_Running : SearchMove(E, N); break;
+      case state_Root    : GenOneRootMove(E); break;
+   }
+} /* ProcessMove */
+
+/*----------------------------------------- Add Sacrifice ----------------------------------------*/
+
+static void AddSacrifice (ENGINE *E, NODE *N)
+{
+   if (! N->storeSacri) return;
+
+   MOVE *sm = E->S.bufTop++;
+   sm->piece = N->m.piece;
+   sm->from  = N->m.from;
+   sm->to    = N->m.to;
+   sm->cap   = N->m.cap;
+   sm->type  = N->m.type;
+   sm->dir   = N->m.dir;
+} /* AddSacrifice */
+
+/*-------------------------------------- [A] En Prise Captures -----------------------------------*/
+
+void SearchEnPriseCaptures (ENGINE *E, NODE *N)
+{
+   N->m.type = mtype_Normal;
+   N->gen = gen_A;
+
+   for (INT i = 1; i <= N->lastPiece_; i++)
+   {
+      SQUARE sq = N->PieceLoc_[i];
+      if (sq >= 0 && N->Attack[sq])
+      {  SearchEnPriseCaptures1(E, N, sq);
+         if (N->cutoff) return;
+      }
+   }
+} /* SearchEnPriseCaptures */
+
+
+static void SearchEnPriseQRB (ENGINE *E, NODE *N, INT bits, PIECE piece)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+
+   if (! bits) return;
+   N->m.piece = piece;
+
+   while (bits)
+   {
+      INT    j    = G->A.LowBit[bits];
+      SQUARE dir  = G->B.QueenDir[j];
+      SQUARE from = N->m.to;
+
+      while (Board[from -= dir] == empty);
+      N->m.dir  = dir;
+      N->m.from = from;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+      bits ^= bit(j);
+   }
+} /* SearchEnPriseQRB */
+
+
+static void SearchEnPriseCaptures1 (ENGINE *E, NODE *N, SQUARE sq)
+{
+   GLOBAL *G = E->Global;
+   ATTACK d  = N->Attack_[sq];
+   ATTACK a  = N->Attack[sq];
+   PIECE  pcap;
+   INT    bits;
+
+   N->m.to  = sq;
+   N->m.cap = E->B.Board[sq];
+   pcap = pieceType(N->m.cap);
+
+   //--- Capture with pawns (incl. promotions) ---
+
+   if (offBoard(sq + N->pawnDir))
+   {
+      if (a & pMaskL)
+      {  N->m.piece = pawn + N->player;
+         N->m.from  = sq - (N->pawnDir - 1);
+         SearchPromotion1(E, N);
+         if (N->cutoff) return;
+      }
+      if (a & pMaskR)
+      {  N->m.piece = pawn + N->player;
+         N->m.from  = sq - (N->pawnDir + 1);
+         SearchPromotion1(E, N);
+         if (N->cutoff) return;
+      }
+   }
+   else
+   {
+      if (d && pcap == pawn) return;
+
+      if (a & pMaskL)
+      {  N->m.piece = pawn + N->player;
+         N->m.from  = sq - (N->pawnDir - 1);
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+      }
+      if (a & pMaskR)
+      {  N->m.piece = pawn + N->player;
+         N->m.from  = sq - (N->pawnDir + 1);
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+      }
+   }
+
+   //--- Capture with knights ---
+
+   if (d && pcap <= bishop) return;
+
+   if ((bits = nBits(a)))
+   {
+      N->m.piece = knight + N->player;
+      while (bits)
+      {  INT j = G->A.LowBit[bits];
+         N->m.from = sq - G->B.KnightDir[j];
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+         bits ^= bit(j);
+      }
+   }
+
+   //--- Capture with bishops, rooks and queens ---
+
+   SearchEnPriseQRB(E, N, bBits(a), bishop + N->player);
+   if (N->cutoff) return;
+
+   if (d && pcap <= rook) return;
+   SearchEnPriseQRB(E, N, rBits(a), rook + N->player);
+   if (N->cutoff) return;
+
+   if (d) return;
+   SearchEnPriseQRB(E, N, qBits(a), queen + N->player);
+   if (N->cutoff) return;
+
+   //--- Capture with king ---
+
+   if (a & kMask)
+   {  N->m.piece = king + N->player;
+      N->m.from  = N->PieceLoc[0];
+      ProcessMove(E, N);
+   }
+} /* SearchEnPriseCaptures1 */
+
+/*----------------------------------------- [B] Promotions ---------------------------------------*/
+
+void SearchPromotions (ENGINE *E, NODE *N)
+{
+   PIECE  *Board = E->B.Board;
+   INT    bits   = (N->player == white ? E->B.PawnStructW[6] : E->B.PawnStructB[1]);
+   SQUARE rto    = (N->player == white ? 0x70 : 0x00);
+
+   N->gen = gen_B;
+
+   while (bits)
+   {
+      INT    f  = E->Global->A.HighBit[bits];
+      SQUARE to = rto + f;
+
+      bits ^= bit(f);
+      if (Board[to] != empty) continue;
+
+      N->m.cap   = empty;
+      N->m.piece = pawn + N->player;
+      N->m.to    = to;
+      N->m.from  = to - N->pawnDir;
+      SearchPromotion1(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchPromotions */
+
+
+static void SearchPromotion1 (ENGINE *E, NODE *N)
+{
+   static const PIECE UnderProm[3] = { rook, knight, bishop };
+
+   N->m.type = queen + N->player;
+   ProcessMove(E, N);
+   if (N->cutoff) return;
+   N->m.type = mtype_Normal;
+
+   for (INT i = 0; i < 3; i++)
+   {
+      MOVE *sm = E->S.bufTop++;
+      sm->piece = N->m.piece;
+      sm->from  = N->m.from;
+      sm->to    = N->m.to;
+      sm->cap   = N->m.cap;
+      sm->type  = UnderProm[i] + N->player;
+   }
+} /* SearchPromotion1 */
+
+/*----------------------------------------- [C] Recaptures ---------------------------------------*/
+
+void SearchRecaptures (ENGINE *E, NODE *N)
+{
+   N->gen = gen_C;
+
+   if (PN->m.cap)
+   {
+      SQUARE sq = N->recapSq = PN->m.to;
+
+      if (N->Attack[sq] && N->Attack_[sq])
+      {  N->m.type = mtype_Normal;
+         SearchSafeCaptures1(E, N, sq);
+      }
+   }
+   else
+   {
+      N->recapSq = nullSq;
+      SearchEnPassant(E, N);
+   }
+} /* SearchRecaptures */
+
+
+static void SearchEnPassant (ENGINE *E, NODE *N)
+{
+   PIECE *Board = E->B.Board;
+
+   if ((PN->m.piece & 0x06) || PN->m.to != PN->m.from - 2*N->pawnDir) return;
+
+   for (SQUARE hdir = -1; hdir <= 1; hdir += 2)
+   {
+      SQUARE sq = PN->m.to + hdir;
+
+      if (Board[sq] == pawn + N->player)
+      {  N->m.from  = sq;
+         N->m.piece = pawn + N->player;
+         N->m.to    = PN->m.to + N->pawnDir;
+         N->m.type  = mtype_EP;
+         N->m.cap   = empty;
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+      }
+   }
+} /* SearchEnPassant */
+
+/*---------------------------------------- [D] Safe Captures -------------------------------------*/
+
+void SearchSafeCaptures (ENGINE *E, NODE *N)
+{
+   N->gen = gen_D;
+   N->m.type = mtype_Normal;
+
+   for (INT i = 1; i <= N->lastPiece_; i++)
+   {
+      SQUARE sq = N->PieceLoc_[i];
+      if (sq >= 0 && sq != N->recapSq && N->Attack[sq] && N->Attack_[sq])
+      {  SearchSafeCaptures1(E, N, sq);
+         if (N->cutoff) return;
+      }
+   }
+} /* SearchSafeCaptures */
+
+
+static void SearchSafeQRB (ENGINE *E, NODE *N, INT bits, PIECE piece, INT xMtrl, INT capMtrl, INT maxMtrl, ATTACK ap)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+
+   if (! bits) return;
+   N->m.piece = piece;
+
+   while (bits)
+   {
+      INT    j    = G->A.LowBit[bits];
+      SQUARE dir  = G->B.QueenDir[j];
+      SQUARE from = N->m.to;
+
+      while (Board[from -= dir] == empty);
+      N->m.dir  = dir;
+      N->m.from = from;
+
+      if (capMtrl == xMtrl ||
+          (maxMtrl >= xMtrl && (moreBits(ap) || (N->Attack[from] & G->A.RayBit[j]))))
+         ProcessMove(E, N);
+      else
+         AddSacrifice(E, N);
+      if (N->cutoff) return;
+
+      bits ^= bit(j);
+   }
+} /* SearchSafeQRB */
+
+
+static void SearchSafeCaptures1 (ENGINE *E, NODE *N, SQUARE sq)
+{
+   GLOBAL *G  = E->Global;
+   ATTACK ap  = N->Attack[sq];
+   ATTACK d   = N->Attack_[sq];
+   INT    capMtrl, maxMtrl, bits;
+
+   N->m.to  = sq;
+   N->m.cap = E->B.Board[sq];
+
+   capMtrl = G->B.Mtrl[N->m.cap];
+   maxMtrl = capMtrl + (d & pMask  ? pawnMtrl :
+                        d & bnMask ? knightMtrl :
+                        d & rMask  ? rookMtrl : queenMtrl);
+
+   switch (capMtrl < knightMtrl ? pawnMtrl : capMtrl)
+   {
+      case pawnMtrl :
+         if (ap & pMaskL)
+         {  N->m.piece = pawn + N->player;
+            N->m.from  = sq - (N->pawnDir - 1);
+            ProcessMove(E, N);
+            if (N->cutoff) return;
+         }
+         if (ap & pMaskR)
+         {  N->m.piece = pawn + N->player;
+            N->m.from  = sq - (N->pawnDir + 1);
+            ProcessMove(E, N);
+            if (N->cutoff) return;
+         }
+
+      case knightMtrl :
+         if ((bits = nBits(ap)))
+         {
+            N->m.piece = knight + N->player;
+            while (bits)
+            {  INT j = G->A.LowBit[bits];
+               N->m.from = sq - G->B.KnightDir[j];
+               if (capMtrl == knightMtrl || (maxMtrl >= knightMtrl && moreBits(ap)))
+                  ProcessMove(E, N);
+               else
+                  AddSacrifice(E, N);
+               if (N->cutoff) return;
+               bits ^= bit(j);
+            }
+         }
+         SearchSafeQRB(E, N, bBits(ap), bishop + N->player, bishopMtrl, capMtrl, maxMtrl, ap);
+         if (N->cutoff) return;
+
+      case rookMtrl :
+         SearchSafeQRB(E, N, rBits(ap), rook + N->player, rookMtrl, capMtrl, maxMtrl, ap);
+         if (N->cutoff) return;
+
+      default :
+         SearchSafeQRB(E, N, qBits(ap), queen + N->player, queenMtrl, capMtrl, maxMtrl, ap);
+   }
+} /* SearchSafeCaptures1 */
+
+/*------------------------------------------ [E] Escapes -----------------------------------------*/
+
+void SearchEscapes (ENGINE *E, NODE *N)
+{
+   if (N->escapeSq == nullSq) return;
+
+   N->gen = gen_E;
+   N->m.cap  = empty;
+   N->m.type = mtype_Normal;
+   N->m.dply = N->eply;
+   SearchNonCaptures1(E, N, N->escapeSq);
+} /* SearchEscapes */
+
+/*---------------------------------------- [F] Killer Moves --------------------------------------*/
+
+static void SearchKiller (ENGINE *E, NODE *N, MOVE *killer, INT gen)
+{
+   PIECE *Board = E->B.Board;
+
+   N->gen = gen;
+   if (killer->piece != Board[killer->from] || killer->cap != Board[killer->to]) return;
+
+   if (killer->type == mtype_Normal)
+   {
+      PIECE p = pieceType(killer->piece);
+
+      if (p < knight)
+      {  if (killer->to == killer->from + 2*N->pawnDir && Board[killer->from + N->pawnDir] != empty)
+            return;
+      }
+      else if (p == king)
+      {  if (N->Attack_[killer->to])
+            return;
+      }
+      else if (p > knight)
+      {  for (SQUARE sq = killer->from + killer->dir; sq != killer->to; sq += killer->dir)
+            if (Board[sq] != empty) return;
+      }
+   }
+
+   N->m.piece = killer->piece;
+   N->m.from  = killer->from;
+   N->m.to    = killer->to;
+   N->m.cap   = killer->cap;
+   N->m.type  = killer->type;
+   N->m.dir   = killer->dir;
+   ProcessMove(E, N);
+} /* SearchKiller */
+
+
+void SearchKillers (ENGINE *E, NODE *N)
+{
+   if (N->killer1Active) SearchKiller(E, N, &N->killer1, gen_F1);
+   if (N->cutoff) return;
+   if (N->killer2Active) SearchKiller(E, N, &N->killer2, gen_F2);
+} /* SearchKillers */
+
+/*---------------------------------------- [G] Castling ------------------------------------------*/
+
+static void SearchCastling1 (ENGINE *E, NODE *N, PIECE piece, SQUARE from, SQUARE to, INT type)
+{
+   N->m.piece = piece;
+   N->m.from  = from;
+   N->m.to    = to;
+   N->m.cap   = empty;
+   N->m.type  = type;
+   ProcessMove(E, N);
+} /* SearchCastling1 */
+
+
+void SearchCastling (ENGINE *E, NODE *N)
+{
+   PIECE  *Board      = E->B.Board;
+   INT    *HasMovedTo = E->B.HasMovedTo;
+   ATTACK *A_         = N->Attack_;
+
+   if (N->player == white)
+   {
+      if (Board[e1] != wKing || HasMovedTo[e1]) return;
+      N->gen = gen_G;
+
+      if (Board[h1] == wRook && Board[f1] == empty && Board[g1] == empty &&
+          ! HasMovedTo[h1] && ! A_[f1] && ! A_[g1])
+         SearchCastling1(E, N, wKing, e1, g1, mtype_O_O);
+      if (N->cutoff) return;
+
+      if (Board[a1] == wRook && Board[b1] == empty && Board[c1] == empty && Board[d1] == empty &&
+          ! HasMovedTo[a1] && ! A_[c1] && ! A_[d1])
+         SearchCastling1(E, N, wKing, e1, c1, mtype_O_O_O);
+   }
+   else
+   {
+      if (Board[e8] != bKing || HasMovedTo[e8]) return;
+      N->gen = gen_G;
+
+      if (Board[h8] == bRook && Board[f8] == empty && Board[g8] == empty &&
+          ! HasMovedTo[h8] && ! A_[f8] && ! A_[g8])
+         SearchCastling1(E, N, bKing, e8, g8, mtype_O_O);
+      if (N->cutoff) return;
+
+      if (Board[a8] == bRook && Board[b8] == empty && Board[c8] == empty && Board[d8] == empty &&
+          ! HasMovedTo[a8] && ! A_[c8] && ! A_[d8])
+         SearchCastling1(E, N, bKing, e8, c8, mtype_O_O_O);
+   }
+} /* SearchCastling */
+
+/*---------------------------------------- [H] Non Captures --------------------------------------*/
+
+static void SearchKing   (ENGINE *E, NODE *N, SQUARE from);
+static void SearchQRB    (ENGINE *E, NODE *N, SQUARE from, INT i0, INT i1, ATTACK smattMask, ATTACK PieceBit[]);
+static void SearchKnight (ENGINE *E, NODE *N, SQUARE from);
+static void SearchPawn   (ENGINE *E, NODE *N, SQUARE from);
+
+void SearchNonCaptures (ENGINE *E, NODE *N)
+{
+   N->gen = gen_H;
+   N->m.cap  = empty;
+   N->m.type = mtype_Normal;
+
+   for (INT i = 0; N->ALoc[i] >= 0; i++)
+   {  SearchNonCaptures1(E, N, N->ALoc[i]);
+      if (N->cutoff) return;
+   }
+   for (INT i = 0; N->SLoc[i] >= 0; i++)
+   {  SearchNonCaptures1(E, N, N->SLoc[i]);
+      if (N->cutoff) return;
+   }
+
+   N->m.from  = N->PieceLoc[0];
+   N->m.piece = king + N->player;
+   SearchKing(E, N, N->m.from);
+} /* SearchNonCaptures */
+
+
+static void SearchNonCaptures1 (ENGINE *E, NODE *N, SQUARE sq)
+{
+   ATTACK_COMMON *A = &E->Global->A;
+
+   N->m.from  = sq;
+   N->m.piece = E->B.Board[sq];
+
+   switch (pieceType(N->m.piece))
+   {
+      case pawn   : SearchPawn(E, N, sq); break;
+      case knight : SearchKnight(E, N, sq); break;
+      case bishop : SearchQRB(E, N, sq, 0, 3, 0x06000000, A->BishopBit); break;
+      case rook   : SearchQRB(E, N, sq, 4, 7, 0x06FF0F00, A->RookBit); break;
+      case queen  : SearchQRB(E, N, sq, 0, 7, 0x06FFFF00, A->QueenBit); break;
+      default     : SearchKing(E, N, sq);
+   }
+} /* SearchNonCaptures1 */
+
+
+static void SearchKing (ENGINE *E, NODE *N, SQUARE from)
+{
+   PIECE  *Board   = E->B.Board;
+   SQUARE *KingDir = E->Global->B.KingDir;
+
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE to = from + KingDir[i];
+      if (Board[to] == empty && ! N->Attack_[to])
+      {  N->m.to = to;
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+      }
+   }
+} /* SearchKing */
+
+// Queen/rook/bishop moves to squares attacked by a smaller opponent piece (smattMask) are
+// sacrifices, and so are moves to defended squares which are only covered by the moving piece
+// itself in that direction (unless the piece is x-rayed from behind).
+
+static void SearchQRB (ENGINE *E, NODE *N, SQUARE from, INT i0, INT i1, ATTACK smattMask, ATTACK PieceBit[])
+{
+   PIECE  *Board = E->B.Board;
+   ATTACK aFrom  = N->Attack[from];
+
+   for (INT i = i0; i <= i1; i++)
+   {
+      SQUARE dir = E->Global->B.QueenDir[i];
+      SQUARE to  = from + dir;
+
+      if (Board[to] != empty) continue;
+      N->m.dir = dir;
+
+      do
+      {
+         ATTACK d = N->Attack_[to];
+
+         N->m.to = to;
+         if ((d & smattMask) || (d && ! (aFrom & (0x0101 << i)) && N->Attack[to] == PieceBit[i]))
+            AddSacrifice(E, N);
+         else
+            ProcessMove(E, N);
+         if (N->cutoff) return;
+         to += dir;
+      } while (Board[to] == empty);
+   }
+} /* SearchQRB */
+
+
+static void SearchKnight (ENGINE *E, NODE *N, SQUARE from)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE to = from + G->B.KnightDir[i];
+      ATTACK d;
+
+      if (Board[to] != empty) continue;
+
+      d = N->Attack_[to];
+      N->m.to = to;
+      if (d && ((d & pMask) || N->Attack[to] == G->A.KnightBit[i]))
+         AddSacrifice(E, N);
+      else
+         ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchKnight */
+
+
+static void SearchPawn (ENGINE *E, NODE *N, SQUARE from)
+{
+   PIECE  *Board  = E->B.Board;
+   SQUARE dir     = N->pawnDir;
+   BOOL   isWhite = (N->player == white);
+   ATTACK xRay;
+
+   if (isWhite ? from >= 0x60 : from < 0x20) return;         // Pawn moves to 8th rank are
+   if (Board[from + dir] != empty) return;                    // generated elsewhere.
+
+   xRay = N->Attack[from];
+
+   if ((isWhite ? from < 0x20 : from >= 0x60) && Board[from + 2*dir] == empty)
+   {
+      N->m.to = from + 2*dir;
+      if (! (xRay & (isWhite ? wForwardMask : bForwardMask)) && N->Attack_[N->m.to] && ! N->Attack[N->m.to])
+         AddSacrifice(E, N);
+      else
+         ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+
+   N->m.to = from + dir;
+   if (! (xRay & wForwardMask) && N->Attack_[N->m.to] && ! N->Attack[N->m.to])   // NB: wForwardMask
+      AddSacrifice(E, N);                                                         // for both colours
+   else                                                                           // (as the asm).
+   {
+      if (isWhite ? from >= 0x40 : from < 0x40)
+         N->m.dply = 0;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+      N->m.dply = 2;                                          // Important to restore
+   }
+} /* SearchPawn */
+
+/*----------------------------------------- [I] Sacrifices ---------------------------------------*/
+
+void SearchSacrifices (ENGINE *E, NODE *N)
+{
+   N->gen = gen_I;
+
+   for (MOVE *sm = N->bufStart; sm < E->S.bufTop; sm++)
+   {
+      N->m.piece = sm->piece;
+      N->m.from  = sm->from;
+      N->m.to    = sm->to;
+      N->m.cap   = sm->cap;
+      N->m.type  = sm->type;
+      N->m.dir   = sm->dir;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchSacrifices */
+
+/*----------------------------------------- [J] Safe Checks --------------------------------------*/
+
+static void SearchCheckQRB  (ENGINE *E, NODE *N, SQUARE ksq);
+static void SearchCheckQRB1 (ENGINE *E, NODE *N, SQUARE to, ATTACK a);
+static void SearchIndCheck  (ENGINE *E, NODE *N, SQUARE ksq, PIECE piece, SQUARE from, SQUARE idir);
+static void SearchCheckN    (ENGINE *E, NODE *N, SQUARE ksq);
+static void SearchCheckP    (ENGINE *E, NODE *N, SQUARE ksq);
+
+void SearchSafeChecks (ENGINE *E, NODE *N)
+{
+   SQUARE ksq = N->PieceLoc_[0];
+
+   N->m.cap  = empty;
+   N->m.type = mtype_Normal;
+   N->gen = gen_J;
+
+   SearchCheckQRB(E, N, ksq);
+   if (N->cutoff) return;
+   SearchCheckN(E, N, ksq);
+   if (N->cutoff) return;
+   SearchCheckP(E, N, ksq);
+} /* SearchSafeChecks */
+
+
+static void SearchCheckQRB (ENGINE *E, NODE *N, SQUARE ksq)
+{
+   PIECE *Board = E->B.Board;
+
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE dir     = E->Global->B.QueenDir[i];
+      ATTACK dirMask = (i < 4 ? qbMask : qrMask);
+      SQUARE to      = ksq;
+
+      while (Board[to -= dir] == empty)                       // Direct checks
+         if (N->Attack[to] & dirMask)
+         {  SearchCheckQRB1(E, N, to, N->Attack[to]);
+            if (N->cutoff) return;
+         }
+
+      if (Board[to] != edge && pieceColour(Board[to]) == N->player && (N->Attack[to] & (0x0101 << i)))
+      {  SearchIndCheck(E, N, ksq, Board[to], to, dir);       // Indirect checks
+         if (N->cutoff) return;
+      }
+   }
+} /* SearchCheckQRB */
+
+// Note that the attack word "a" of the (empty) target square is passed on in full, so the QRB
+// moves to "to" in all directions are searched (like the assembler version). If the target square
+// is defended, the moving piece must be supported by another piece.
+
+static void SearchCheckQRB1 (ENGINE *E, NODE *N, SQUARE to, ATTACK a)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   ATTACK d      = N->Attack_[to];
+   INT    bits;
+
+   if (d & pMask) return;
+
+   if (d & bnMask)
+   {  if (! (a &= bMask)) return;
+   }
+   else if (d & rMask)
+   {  if (! (a &= rbMask)) return;
+   }
+
+   N->m.to = to;
+
+   for (bits = qrbBits(a); bits; )
+   {
+      INT    j    = G->A.LowBit[bits];
+      SQUARE dir  = G->B.QueenDir[j];
+      SQUARE from = to;
+
+      bits ^= bit(j);
+      while (Board[from -= dir] == empty);
+      if (d && ! (a & ~G->A.RayBit[j])) continue;
+
+      N->m.from  = from;
+      N->m.dir   = dir;
+      N->m.piece = Board[from];
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchCheckQRB1 */
+
+
+static void SearchIndCheck (ENGINE *E, NODE *N, SQUARE ksq, PIECE piece, SQUARE from, SQUARE idir)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   SQUARE dir, to, *Dir;
+
+   N->m.piece = piece;
+   N->m.from  = from;
+
+   switch (pieceType(piece))
+   {
+      case pawn :
+         if (idir == N->pawnDir || idir == -N->pawnDir) return;
+         N->m.to = to = from + N->pawnDir;
+         if (Board[to] != empty || offBoard(to + 2*N->pawnDir)) return;
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+         if (! offBoard(from - 2*N->pawnDir)) return;          // Double step from 2nd rank.
+         to += N->pawnDir;
+         if (Board[to] != empty) return;
+         N->m.to = to;
+         ProcessMove(E, N);
+         break;
+
+      case knight :                                            // Skip direct knight checks
+         for (INT i = 0; (dir = G->B.KnightDir[i]); i++)       // (searched elsewhere).
+         {  to = from + dir;
+            if (Board[to] != empty || (G->A.AttackDir[to - ksq] & nDirMask)) continue;
+            N->m.to = to;
+            ProcessMove(E, N);
+            if (N->cutoff) return;
+         }
+         break;
+
+      case bishop :
+      case rook :
+         Dir = (pieceType(piece) == bishop ? G->B.BishopDir : G->B.RookDir);
+         for (INT i = 0; (dir = Dir[i]); i++)
+         {
+            N->m.dir = dir;
+            for (to = from + dir; Board[to] == empty; to += dir)
+            {
+               INT fdir = G->A.AttackDir[ksq - to];
+
+               if (fdir & bDirMask)                            // Skip direct checks.
+               {  SQUARE sq = to;
+                  fdir >>= 5;
+                  while (Board[sq += fdir] == empty);
+                  if (Board[sq] == bKing - N->player) continue;
+               }
+               N->m.to = to;
+               ProcessMove(E, N);
+               if (N->cutoff) return;
+            }
+         }
+         break;
+
+      default :
+         for (INT i = 0; (dir = G->B.KingDir[i]); i++)
+         {  if (dir == idir || dir == -idir) continue;
+            to = from + dir;
+            if (Board[to] != empty || N->Attack_[to]) continue;
+            N->m.to = to;
+            ProcessMove(E, N);
+            if (N->cutoff) return;
+         }
+   }
+} /* SearchIndCheck */
+
+
+static void SearchCheckN (ENGINE *E, NODE *N, SQUARE ksq)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE to = ksq + G->B.KnightDir[i];
+      ATTACK a  = N->Attack[to];
+      INT    bits;
+
+      if (Board[to] != empty || ! (a & nMask)) continue;
+
+      ATTACK d = N->Attack_[to];
+      if (d && ((d & pMask) || ! moreBits(a))) continue;
+
+      N->m.piece = knight + N->player;
+      N->m.to    = to;
+
+      for (bits = nBits(a); bits; )
+      {  INT j = G->A.LowBit[bits];
+         bits ^= bit(j);
+         N->m.from = to - G->B.KnightDir[j];
+         if (N->m.from != N->escapeSq)
+         {  ProcessMove(E, N);
+            if (N->cutoff) return;
+         }
+      }
+   }
+} /* SearchCheckN */
+
+
+static void SearchCheckP (ENGINE *E, NODE *N, SQUARE ksq)
+{
+   PIECE *Board = E->B.Board;
+   PIECE p      = pawn + N->player;
+
+   if (ksq + N->player < 0x30 || ksq + N->player > 0x57) return;
+
+   for (SQUARE hdir = -1; hdir <= 1; hdir += 2)
+   {
+      SQUARE to   = ksq - N->pawnDir + hdir;
+      SQUARE from = to - N->pawnDir;
+
+      if (Board[to] != empty) continue;
+
+      if (Board[from] != p)
+      {  if (Board[from] != empty || (ksq & 0x70) + N->player != 0x40) continue;
+         from -= N->pawnDir;
+         if (Board[from] != p) continue;
+      }
+
+      N->m.to    = to;
+      N->m.from  = from;
+      N->m.piece = p;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchCheckP */
+
+/*-------------------------------- [K] Pawn Moves to 6th & 7th Rank ------------------------------*/
+
+static void SearchFarPawns1 (ENGINE *E, NODE *N, INT bits, SQUARE rto)
+{
+   while (bits)
+   {
+      INT    f  = E->Global->A.HighBit[bits];
+      SQUARE to = rto + f;
+
+      bits ^= bit(f);
+      if (E->B.Board[to] != empty) continue;
+
+      N->m.cap   = empty;
+      N->m.type  = mtype_Normal;
+      N->m.piece = pawn + N->player;
+      N->m.to    = to;
+      N->m.from  = to - N->pawnDir;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchFarPawns1 */
+
+
+void SearchFarPawns (ENGINE *E, NODE *N)
+{
+   N->gen = gen_K;
+
+   if (N->player == white)
+   {  SearchFarPawns1(E, N, E->B.PawnStructW[5], 0x60);
+      if (N->cutoff) return;
+      SearchFarPawns1(E, N, E->B.PawnStructW[4], 0x50);
+   }
+   else
+   {  SearchFarPawns1(E, N, E->B.PawnStructB[2], 0x10);
+      if (N->cutoff) return;
+      SearchFarPawns1(E, N, E->B.PawnStructB[3], 0x20);
+   }
+} /* SearchFarPawns */
+
+/*---------------------------------------- [L] Check Evasion -------------------------------------*/
+
+static void SearchAllKingMoves    (ENGINE *E, NODE *N, SQUARE ksq, SQUARE csq, SQUARE cdir);
+static void SearchInterpositions1 (ENGINE *E, NODE *N, SQUARE isq);
+
+void SearchCheckEvasion (ENGINE *E, NODE *N)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   SQUARE ksq    = N->PieceLoc[0];
+   SQUARE csq    = ksq;
+   SQUARE cdir   = 0;
+   ATTACK a      = N->Attack_[ksq];
+   BOOL   doubleCheck;
+
+   N->m.type = mtype_Normal;
+   N->gen = gen_L;
+
+   //--- Find checking piece ---
+
+   if (a & pMask)
+   {  if (! (doubleCheck = ((a & qrbMask) != 0)))
+         csq = ksq + N->pawnDir + (((a & pMask) >> 24) - 3);
+   }
+   else if (a & nMask)
+   {  if (! (doubleCheck = ((a & qrbMask) != 0)))
+         csq = ksq - G->B.KnightDir[G->A.LowBit[nBits(a)]];
+   }
+   else
+   {  QRB_DATA *q = &G->M.QRBdata[qrbBits(a)];
+      if (! (doubleCheck = (q->offset != 0)))
+      {  cdir = q->dir;
+         while (Board[csq -= cdir] == empty);
+      }
+   }
+
+   //--- Search evasions ---
+
+   if (doubleCheck)
+      SearchAllKingMoves(E, N, ksq, csq, cdir);
+   else
+   {
+      if (N->Attack[csq])
+      {  SearchEnPriseCaptures1(E, N, csq);
+         if (N->cutoff) return;
+         if (N->Attack_[csq])
+            SearchSafeCaptures1(E, N, csq);
+         if (N->cutoff) return;
+      }
+
+      SearchAllKingMoves(E, N, ksq, csq, cdir);
+      if (N->cutoff) return;
+      SearchEnPassant(E, N);
+      if (N->cutoff) return;
+
+      if (cdir)
+      {  N->m.cap  = empty;
+         N->m.type = mtype_Normal;
+         for (SQUARE isq = ksq - cdir; isq != csq; isq -= cdir)
+         {  SearchInterpositions1(E, N, isq);
+            if (N->cutoff) return;
+         }
+      }
+
+      SearchSacrifices(E, N);
+   }
+} /* SearchCheckEvasion */
+
+
+static void SearchAllKingMoves (ENGINE *E, NODE *N, SQUARE ksq, SQUARE csq, SQUARE cdir)
+{
+   PIECE  *Board   = E->B.Board;
+   SQUARE *KingDir = E->Global->B.KingDir;
+
+   N->m.from  = ksq;
+   N->m.piece = king + N->player;
+
+   for (INT i = 7; i >= 0; i--)                               // Captures
+   {
+      SQUARE dir = KingDir[i], to = ksq + dir;
+      PIECE  cap;
+
+      if (dir == cdir || to == csq || offBoard(to)) continue;
+      cap = Board[to];
+      if (cap == empty || pieceColour(cap) == N->player || N->Attack_[to]) continue;
+
+      N->m.to  = to;
+      N->m.cap = cap;
+      N->m.dir = dir;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+
+   N->m.cap = empty;
+
+   for (INT i = 7; i >= 0; i--)                               // Non captures
+   {
+      SQUARE dir = KingDir[i], to = ksq + dir;
+
+      if (dir == cdir || offBoard(to) || Board[to] != empty || N->Attack_[to]) continue;
+
+      N->m.to  = to;
+      N->m.dir = dir;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchAllKingMoves */
+
+
+static void SearchInterpositions1 (ENGINE *E, NODE *N, SQUARE isq)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   PIECE  p      = pawn + N->player;
+   SQUARE from   = isq - N->pawnDir;
+   ATTACK a;
+   INT    bits;
+
+   N->m.to = isq;
+
+   //--- Move pawns in between ---
+
+   if (Board[from] == empty)
+   {
+      if ((isq & 0x70) == N->player + 0x30 && Board[from - N->pawnDir] == p)
+      {  N->m.piece = p;
+         N->m.from  = from - N->pawnDir;
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+      }
+   }
+   else if (Board[from] == p)
+   {
+      N->m.from  = from;
+      N->m.piece = p;
+      if (! offBoard(isq + N->pawnDir))
+         ProcessMove(E, N);
+      else
+         SearchPromotion1(E, N);
+      if (N->cutoff) return;
+   }
+
+   //--- Move knights in between ---
+
+   a = N->Attack[isq];
+
+   if ((bits = nBits(a)))
+   {
+      N->m.piece = knight + N->player;
+      while (bits)
+      {  INT j = G->A.LowBit[bits];
+         N->m.from = isq - G->B.KnightDir[j];
+         ProcessMove(E, N);
+         if (N->cutoff) return;
+         bits ^= bit(j);
+      }
+   }
+
+   //--- Move sliding pieces in between ---
+
+   if (! (a & qrbMask)) return;
+
+   for (bits = qrbBits(a); bits; )
+   {
+      INT    j    = G->A.LowBit[bits];
+      SQUARE dir  = G->B.QueenDir[j];
+
+      bits ^= bit(j);
+      from = isq;
+      while (Board[from -= dir] == empty);
+
+      N->m.piece = Board[from];
+      N->m.dir   = dir;
+      N->m.from  = from;
+      ProcessMove(E, N);
+      if (N->cutoff) return;
+   }
+} /* SearchInterpositions1 */
+
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
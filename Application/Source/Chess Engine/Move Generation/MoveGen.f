@@ -34,17 +34,32 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 void GenRootMoves (ENGINE *E);
 
-asm void SearchEnPriseCaptures (void);
-asm void SearchPromotions (void);
-asm void SearchRecaptures (void);
-asm void SearchSafeCaptures (void);
-asm void SearchEscapes (void);
-asm void SearchKillers (void);
-asm void SearchCastling (void);
-asm void SearchNonCaptures (void);
-asm void SearchSacrifices (void);
-asm void SearchSafeChecks (void);
-asm void SearchFarPawns (void);
-asm void SearchCheckEvasion (void);
+#ifdef __engine_asm
+asm void SearchEnPriseCaptures (register ENGINE *_E, register NODE *_N);
+asm void SearchPromotions (register ENGINE *_E, register NODE *_N);
+asm void SearchRecaptures (register ENGINE *_E, register NODE *_N);
+asm void SearchSafeCaptures (register ENGINE *_E, register NODE *_N);
+asm void SearchEscapes (register ENGINE *_E, register NODE *_N);
+asm void SearchKillers (register ENGINE *_E, register NODE *_N);
+asm void SearchCastling (register ENGINE *_E, register NODE *_N);
+asm void SearchNonCaptures (register ENGINE *_E, register NODE *_N);
+asm void SearchSacrifices (register ENGINE *_E, register NODE *_N);
+asm void SearchSafeChecks (register ENGINE *_E, register NODE *_N);
+asm void SearchFarPawns (register ENGINE *_E, register NODE *_N);
+asm void SearchCheckEvasion (register ENGINE *_E, register NODE *_N);
+#else
+void SearchEnPriseCaptures (ENGINE *E, NODE *N);
+void SearchPromotions (ENGINE *E, NODE *N);
+void SearchRecaptures (ENGINE *E, NODE *N);
+void SearchSafeCaptures (ENGINE *E, NODE *N);
+void SearchEscapes (ENGINE *E, NODE *N);
+void SearchKillers (ENGINE *E, NODE *N);
+void SearchCastling (ENGINE *E, NODE *N);
+void SearchNonCaptures (ENGINE *E, NODE *N);
+void SearchSacrifices (ENGINE *E, NODE *N);
+void SearchSafeChecks (ENGINE *E, NODE *N);
+void SearchFarPawns (ENGINE *E, NODE *N);
+void SearchCheckEvasion (ENGINE *E, NODE *N);
+#endif
 
 void InitMoveGenModule (GLOBAL *Global);
@@ -66,6 +66,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //         AddPieceAttack(from);
 //         AddBlockAttack(to); (or AddPieceAttack(to) if it's a capture)
 
+#ifdef __engine_asm
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -145,7 +146,7 @@ asm void PerformRookMove   (void);
 asm void PerformQueenMove  (void);
 asm void PerformKingMove   (void);
 
-asm void PerformMove (void)
+asm void PerformMove (register ENGINE *_E, register NODE *_N)
 {
 // lhz     rTmp9, move(to)                  // E->V.MobVal[N->m.to] = N->destMob;
 // lhz     rTmp8, node(destMob)
@@ -178,7 +179,7 @@ asm void RetractRookMove   (void);
 asm void RetractQueenMove  (void);
 asm void RetractKingMove   (void);
 
-asm void RetractMove (void)
+asm void RetractMove (register ENGINE *_E, register NODE *_N)
 {
 // lhz     rTmp9, move(to)                  // E->V.MobVal[N->m.to] = N->oldDestMob;
 // lhz     rTmp8, node(oldDestMob)
@@ -1593,6 +1594,501 @@ asm void RetractKingMove (void)
    #undef mtype
 } /* RetractKingMove */
 
+#else
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       PORTABLE PERFORM/RETRACT                                 */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// C versions of the assembler routines above. They perform exactly the same steps in the same
+// order, so the incrementally updated attack tables and mobility values are identical for both
+// engine back ends.
+
+static void PerformPawnMove   (ENGINE *E, NODE *N);
+static void PerformKnightMove (ENGINE *E, NODE *N);
+static void PerformRookMove   (ENGINE *E, NODE *N);
+static void PerformQueenMove  (ENGINE *E, NODE *N);
+static void PerformKingMove   (ENGINE *E, NODE *N);
+
+static void RetractPawnMove   (ENGINE *E, NODE *N);
+static void RetractKnightMove (ENGINE *E, NODE *N);
+static void RetractRookMove   (ENGINE *E, NODE *N);
+static void RetractQueenMove  (ENGINE *E, NODE *N);
+static void RetractKingMove   (ENGINE *E, NODE *N);
+
+/*-------------------------------------- Generic Perform Move ------------------------------------*/
+
+void PerformMove (ENGINE *E, NODE *N)
+{
+   switch (pieceType(N->m.piece))
+   {
+      case pawn   : PerformPawnMove(E, N); break;
+      case knight : PerformKnightMove(E, N); break;
+      case bishop :
+      case rook   : PerformRookMove(E, N); break;
+      case queen  : PerformQueenMove(E, N); break;
+      case king   : PerformKingMove(E, N); break;
+   }
+} /* PerformMove */
+
+/*-------------------------------------- Generic Retract Move ------------------------------------*/
+
+void RetractMove (ENGINE *E, NODE *N)
+{
+   switch (pieceType(N->m.piece))
+   {
+      case pawn   : RetractPawnMove(E, N); break;
+      case knight : RetractKnightMove(E, N); break;
+      case bishop :
+      case rook   : RetractRookMove(E, N); break;
+      case queen  : RetractQueenMove(E, N); break;
+      case king   : RetractKingMove(E, N); break;
+   }
+} /* RetractMove */
+
+/*-------------------------------------- Captured Pieces -----------------------------------------*/
+// Counterparts of the "check_remove_cap" and "check_replace_cap" macros. "CapturePiece" removes
+// the captured piece from the piece tables (it's still on the board) and returns the mobility
+// change, and "UncapturePiece" puts it back (it must already have been put back on the board).
+
+static INT CapturePiece (ENGINE *E, NODE *N)
+{
+   SQUARE to  = N->m.to;
+   INDEX  inx = E->B.PLinx[to];
+
+   E->B.pieceCount -= E->Global->B.PieceCountBit[N->m.cap];
+   N->capInx = inx;
+   N->PieceLoc_[inx] = nullSq;
+   return UpdPieceAttack(E, to);
+} /* CapturePiece */
+
+
+static void UncapturePiece (ENGINE *E, NODE *N)
+{
+   SQUARE to = N->m.to;
+
+   E->B.PLinx[to] = N->capInx;
+   E->B.pieceCount += E->Global->B.PieceCountBit[N->m.cap];
+   N->PieceLoc_[N->capInx] = to;
+   UpdPieceAttack(E, to);
+} /* UncapturePiece */
+
+
+static INT RemoveCapture (ENGINE *E, NODE *N)        // Returns mobility change to be subtracted
+{
+   return (N->m.cap ? CapturePiece(E, N) : UpdBlockAttack(E, N, N->m.to));
+} /* RemoveCapture */
+
+
+static void ReplaceCapture (ENGINE *E, NODE *N)
+{
+   E->B.Board[N->m.to] = N->m.cap;
+
+   if (N->m.cap)
+      UncapturePiece(E, N);
+   else
+      UpdBlockAttack(E, N, N->m.to);
+} /* ReplaceCapture */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       PORTABLE PAWN MOVES                                      */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void UpdPawnAttack (NODE *N, SQUARE sq)
+{
+   ATTACK *A = N->Attack + sq + N->pawnDir;
+
+   A[-1] ^= pMaskL;
+   A[+1] ^= pMaskR;
+} /* UpdPawnAttack */
+
+/*-------------------------------------- Perform Pawn Moves --------------------------------------*/
+
+static void PerformPawnMove (ENGINE *E, NODE *N)
+{
+   BOARD_STATE *B    = &E->B;
+   SQUARE      from  = N->m.from, to = N->m.to;
+   INT         type  = N->m.type;
+   RANKBITS    *PS   = (N->player == white ? B->PawnStructW : B->PawnStructB);
+   INT         mobSum = N->mobEval;
+
+   mobSum -= RemoveCapture(E, N);
+
+   B->PLinx[to]    = B->PLinx[from];                 // Move the pawn.
+   B->Board[from]  = empty;
+   B->Board[to]    = pawn + N->player;
+   N->PieceLoc[B->PLinx[to]] = to;
+   mobSum += UpdBlockAttack(E, N, from);
+
+   UpdPawnAttack(N, from);
+   PS[rank(from)] ^= bit(file(from));
+
+   if (! (type & mtype_Promotion))                  // Non-promotion:
+   {
+      PS[rank(to)] ^= bit(file(to));
+      UpdPawnAttack(N, to);
+
+      if (type == mtype_EP)                          // Remove en passant captured pawn.
+      {
+         SQUARE sq  = to - N->pawnDir;
+         INDEX  inx;
+
+         mobSum -= UpdPieceAttack(E, sq);
+         mobSum += UpdBlockAttack(E, N, sq);
+         inx = B->PLinx[sq];
+         B->pieceCount -= (1L << (black - N->player));
+         B->Board[sq] = empty;
+         N->capInx = inx;
+         N->PieceLoc_[inx] = nullSq;
+      }
+   }
+   else                                              // Promotion: Swap the promoted pawn with
+   {                                                 // the first pawn in the piece list.
+      INDEX i, j = B->PLinx[to];
+
+      B->pieceCount -= (1L << N->player);
+      B->pieceCount += E->Global->B.PieceCountBit[type & mtype_Promotion];
+      i = ++B->LastOffi[N->player];
+      N->promInx = j;
+
+      if (i != j)
+      {
+         SQUARE sq = N->PieceLoc[i];
+         B->PLinx[to] = i;
+         N->PieceLoc[i] = to;
+         N->PieceLoc[j] = sq;
+         if (sq != nullSq) B->PLinx[sq] = j;
+      }
+
+      B->Board[to] = type;
+      mobSum += UpdPieceAttack(E, to);
+   }
+
+   NN->mobEval = mobSum;
+} /* PerformPawnMove */
+
+/*-------------------------------------- Retract Pawn Moves --------------------------------------*/
+
+static void RetractPawnMove (ENGINE *E, NODE *N)
+{
+   BOARD_STATE *B   = &E->B;
+   SQUARE      from = N->m.from, to = N->m.to;
+   INT         type = N->m.type;
+   RANKBITS    *PS  = (N->player == white ? B->PawnStructW : B->PawnStructB);
+
+   PS[rank(from)] ^= bit(file(from));
+
+   if (! (type & mtype_Promotion))                  // Non-promotion:
+   {
+      PS[rank(to)] ^= bit(file(to));
+      UpdPawnAttack(N, to);
+
+      if (type == mtype_EP)                          // Put back en passant captured pawn.
+      {
+         SQUARE sq = to - N->pawnDir;
+
+         UpdBlockAttack(E, N, sq);
+         B->PLinx[sq] = N->capInx;
+         B->pieceCount += (1L << (black - N->player));
+         B->Board[sq] = (black - N->player) + pawn;
+         N->PieceLoc_[N->capInx] = sq;
+         UpdPieceAttack(E, sq);
+      }
+   }
+   else                                              // Promotion: Swap back pawns.
+   {
+      INDEX i = B->LastOffi[N->player]--, j = N->promInx;
+
+      B->pieceCount -= E->Global->B.PieceCountBit[type & mtype_Promotion];
+      B->pieceCount += (1L << N->player);
+
+      if (i != j)
+      {
+         SQUARE sq = N->PieceLoc[j];
+         B->PLinx[to] = j;
+         N->PieceLoc[j] = to;
+         N->PieceLoc[i] = sq;
+         if (sq != nullSq) B->PLinx[sq] = i;
+      }
+
+      UpdPieceAttack(E, to);
+   }
+
+   B->PLinx[from] = B->PLinx[to];                    // Move the pawn back.
+   B->Board[from] = pawn + N->player;
+   N->PieceLoc[B->PLinx[from]] = from;
+   UpdBlockAttack(E, N, from);
+   UpdPawnAttack(N, from);
+
+   ReplaceCapture(E, N);
+} /* RetractPawnMove */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                      PORTABLE KNIGHT MOVES                                     */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void PerformKnightMove (ENGINE *E, NODE *N)
+{
+   BOARD_STATE *B   = &E->B;
+   SQUARE      from = N->m.from, to = N->m.to;
+   INT         mobSum = N->mobEval;
+
+   mobSum -= RemoveCapture(E, N);
+
+   B->PLinx[to]   = B->PLinx[from];
+   B->Board[from] = empty;
+   B->Board[to]   = knight + N->player;
+   N->PieceLoc[B->PLinx[to]] = to;
+   mobSum += UpdBlockAttack(E, N, from);
+
+   UpdKnightAttack(N->Attack, from);
+   UpdKnightAttack(N->Attack, to);
+
+   NN->mobEval = mobSum;
+} /* PerformKnightMove */
+
+
+static void RetractKnightMove (ENGINE *E, NODE *N)
+{
+   BOARD_STATE *B   = &E->B;
+   SQUARE      from = N->m.from, to = N->m.to;
+
+   UpdBlockAttack(E, N, from);
+   B->PLinx[from] = B->PLinx[to];
+   B->Board[from] = knight + N->player;
+   N->PieceLoc[B->PLinx[from]] = from;
+
+   ReplaceCapture(E, N);
+
+   UpdKnightAttack(N->Attack, from);
+   UpdKnightAttack(N->Attack, to);
+} /* RetractKnightMove */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                PORTABLE ROOK/BISHOP/QUEEN MOVES                                */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Rook, bishop and queen moves are handled similarily. First the attack "through" the origin and
+// destination squares in each of the transversal directions "tdir" (i.e. not along the line of
+// movement) is updated. Then the attack along the line of movement is updated.
+
+static INT UpdTransAttack (ENGINE *E, NODE *N, SQUARE tdir, ATTACK tbit, ATTACK tbit_, INT dm)
+{
+   PIECE  *Board = E->B.Board;
+   ATTACK *A     = N->Attack;
+   SQUARE from   = N->m.from, to = N->m.to;
+   INT    dmob   = 0;
+
+   dmob -= UpdRayAttack(Board, A, from, tdir, tbit, dm);
+   dmob += UpdRayAttack(Board, A, to, tdir, tbit, dm);
+   dmob -= UpdRayAttack(Board, A, from, -tdir, tbit_, dm);
+   dmob += UpdRayAttack(Board, A, to, -tdir, tbit_, dm);
+   return dmob;
+} /* UpdTransAttack */
+
+
+static INT PerformLineMove (ENGINE *E, NODE *N, PIECE piece, ATTACK mbit, ATTACK mbit_, INT dm)
+{
+   BOARD_STATE *B    = &E->B;
+   ATTACK      *A    = N->Attack;
+   SQUARE      from  = N->m.from, to = N->m.to, mdir = N->m.dir;
+   INT         dmob  = 0;
+
+   A[to] ^= mbit;
+   B->Board[to] = piece;
+   B->PLinx[to] = B->PLinx[from];
+   N->PieceLoc[B->PLinx[to]] = to;
+
+   if (! N->m.cap)
+      dmob -= UpdBlockAttack(E, N, to);
+   else
+      dmob += UpdRayAttack(B->Board, A, to, mdir, mbit, dm);
+
+   for (SQUARE sq = from + mdir; sq != to; sq += mdir)
+      A[sq] ^= (mbit | mbit_);
+
+   dmob += UpdBlockAttack(E, N, from);
+   A[from] ^= mbit_;
+   B->Board[from] = empty;
+   return dmob;
+} /* PerformLineMove */
+
+
+static void RetractLineMove (ENGINE *E, NODE *N, PIECE piece, ATTACK mbit, ATTACK mbit_)
+{
+   BOARD_STATE *B    = &E->B;
+   ATTACK      *A    = N->Attack;
+   SQUARE      from  = N->m.from, to = N->m.to, mdir = N->m.dir;
+
+   A[from] ^= mbit_;
+   B->Board[from] = piece;
+   UpdBlockAttack(E, N, from);
+
+   for (SQUARE sq = from + mdir; sq != to; sq += mdir)
+      A[sq] ^= (mbit | mbit_);
+
+   if (! N->m.cap)
+      UpdBlockAttack(E, N, to);
+   else
+      UpdRayAttack(B->Board, A, to, mdir, mbit, 0);
+
+   A[to] ^= mbit;
+   B->Board[to] = N->m.cap;
+   B->PLinx[from] = B->PLinx[to];
+   N->PieceLoc[B->PLinx[from]] = from;
+
+   if (N->m.cap)
+      UncapturePiece(E, N);
+} /* RetractLineMove */
+
+/*------------------------------------ Perform/Retract Rook/Bishop -------------------------------*/
+
+static void PerformRookMove (ENGINE *E, NODE *N)
+{
+   RBDATA *RD     = &E->Global->P.RBUpdData[N->m.dir];
+   INT    dm      = (N->player == white ? RD->dm : -RD->dm);
+   INT    mobSum  = N->mobEval;
+
+   if (N->m.cap)
+      mobSum -= CapturePiece(E, N);
+
+   mobSum += UpdTransAttack(E, N, RD->tdir/2, RD->tbit, RD->tbit_, dm);
+   mobSum += PerformLineMove(E, N, N->m.piece, RD->mbit, RD->mbit_, dm);
+   E->B.HasMovedTo[N->m.to]++;
+
+   NN->mobEval = mobSum;
+} /* PerformRookMove */
+
+
+static void RetractRookMove (ENGINE *E, NODE *N)
+{
+   RBDATA *RD = &E->Global->P.RBUpdData[N->m.dir];
+
+   UpdTransAttack(E, N, RD->tdir/2, RD->tbit, RD->tbit_, 0);
+   RetractLineMove(E, N, N->m.piece, RD->mbit, RD->mbit_);
+   E->B.HasMovedTo[N->m.to]--;
+} /* RetractRookMove */
+
+/*---------------------------------------- Perform/Retract Queen ---------------------------------*/
+
+static void PerformQueenMove (ENGINE *E, NODE *N)
+{
+   QDATA  *Q      = &E->Global->P.QUpdData[N->m.dir];
+   INT    dm      = (N->player == white ? queenMob : -queenMob);
+   INT    mobSum  = N->mobEval;
+
+   if (N->m.cap)
+      mobSum -= CapturePiece(E, N);
+
+   mobSum += UpdTransAttack(E, N, Q->tdir0/2, Q->tbit0, Q->tbit0_, dm);
+   mobSum += UpdTransAttack(E, N, Q->tdir1/2, Q->tbit1, Q->tbit1_, dm);
+   mobSum += UpdTransAttack(E, N, Q->tdir2/2, Q->tbit2, Q->tbit2_, dm);
+   mobSum += PerformLineMove(E, N, queen + N->player, Q->mbit, Q->mbit_, dm);
+
+   NN->mobEval = mobSum;
+} /* PerformQueenMove */
+
+
+static void RetractQueenMove (ENGINE *E, NODE *N)
+{
+   QDATA *Q = &E->Global->P.QUpdData[N->m.dir];
+
+   UpdTransAttack(E, N, Q->tdir0/2, Q->tbit0, Q->tbit0_, 0);
+   UpdTransAttack(E, N, Q->tdir1/2, Q->tbit1, Q->tbit1_, 0);
+   UpdTransAttack(E, N, Q->tdir2/2, Q->tbit2, Q->tbit2_, 0);
+   RetractLineMove(E, N, queen + N->player, Q->mbit, Q->mbit_);
+} /* RetractQueenMove */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       PORTABLE KING MOVES                                      */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// In case of castling the rook move is performed/retracted first by temporarily converting the
+// current move to the corresponding rook move. Note that "m.dir" is left as the rook direction
+// (exactly as in the assembler version).
+
+static void CastleRook (ENGINE *E, NODE *N, BOOL perform)
+{
+   SQUARE from = N->m.from, to = N->m.to;
+
+   N->m.piece = rook + N->player;
+   if (N->m.type == mtype_O_O)
+      N->m.from = to + 1, N->m.dir = -1;
+   else
+      N->m.from = to - 2, N->m.dir = +1;
+   N->m.to = to + N->m.dir;
+
+   if (perform)
+      PerformRookMove(E, N);
+   else
+      RetractRookMove(E, N);
+
+   N->m.from  = from;
+   N->m.to    = to;
+   N->m.piece = king + N->player;
+} /* CastleRook */
+
+
+static void PerformKingMove (ENGINE *E, NODE *N)
+{
+   BOARD_STATE *B   = &E->B;
+   SQUARE      from = N->m.from, to = N->m.to;
+   INT         mobSum = N->mobEval;
+
+   if (N->m.type != mtype_Normal)
+   {  CastleRook(E, N, true);
+      mobSum = NN->mobEval;
+   }
+
+   mobSum -= RemoveCapture(E, N);
+
+   B->HasMovedTo[to]++;
+   N->PieceLoc[0] = to;
+   B->Board[from] = empty;
+   B->Board[to]   = king + N->player;
+   mobSum += UpdBlockAttack(E, N, from);
+
+   UpdKingAttack(N->Attack, from);
+   UpdKingAttack(N->Attack, to);
+
+   NN->mobEval = mobSum;
+} /* PerformKingMove */
+
+
+static void RetractKingMove (ENGINE *E, NODE *N)
+{
+   BOARD_STATE *B   = &E->B;
+   SQUARE      from = N->m.from, to = N->m.to;
+
+   UpdKingAttack(N->Attack, to);
+   UpdKingAttack(N->Attack, from);
+
+   UpdBlockAttack(E, N, from);
+   B->HasMovedTo[to]--;
+   N->PieceLoc[0] = from;
+   B->Board[from] = king + N->player;
+
+   ReplaceCapture(E, N);
+
+   if (N->m.type != mtype_Normal)
+      CastleRook(E, N, false);
+} /* RetractKingMove */
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
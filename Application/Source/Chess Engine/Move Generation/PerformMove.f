@@ -33,7 +33,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void PerformMove (void);
-asm void RetractMove (void);
+#ifdef __engine_asm
+asm void PerformMove (register ENGINE *_E, register NODE *_N);
+asm void RetractMove (register ENGINE *_E, register NODE *_N);
+#else
+void PerformMove (ENGINE *E, NODE *N);
+void RetractMove (ENGINE *E, NODE *N);
+#endif
 
 void InitPerformMoveModule (GLOBAL *Global);
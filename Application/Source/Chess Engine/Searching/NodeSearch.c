@@ -30,7 +30,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "Engine.h"
-#include "TaskScheduler.h"
+#ifdef __engine_threads
+   #include <time.h>
+#else
+   #include "TaskScheduler.h"
+#endif
 
 #include "Search.f"
 #include "SearchMisc.f"
@@ -46,11 +50,26 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "TransTables.f"
 #include "Engine.f"
 #include "HashCode.f"
+#include "Trace.f"
+#include "Tablebase.f"
 
 
 static void SearchNodeC (register ENGINE *E, register NODE *N);
 static void SearchMoveC (register ENGINE *E, register NODE *N);
-static asm void ExitNode (void);
+#ifdef __engine_asm
+static asm void ExitNode (register ENGINE *_E, register NODE *_N);
+#endif
+
+// Cutoffs in "SearchMoveC" exit the node at once. The assembler version long jumps directly to the
+// exit point of "SearchNode" (see "ExitNode"). The portable version instead sets N->cutoff and
+// returns, whereupon the (portable) move generators return at once, and "SearchNodeC" returns
+// via "ExitOnCutoff" after each move generator call.
+
+#ifdef __engine_asm
+   #define ExitOnCutoff(N)
+#else
+   #define ExitOnCutoff(N)     if ((N)->cutoff) return
+#endif
 
 
 /**************************************************************************************************/
@@ -68,9 +87,11 @@ static asm void ExitNode (void);
 // ON EXIT: N->BestLine and N->score holds the best line and value found by the search at node "N".
 // Also PN->val is set to -N->score.
 
+#ifdef __engine_asm
+
 void __exit_node (void);      // Entry point for exiting node directly in case of cutoff:
 
-asm void SearchNode (void)
+asm void SearchNode (register ENGINE *_E, register NODE *_N)
 {
    //--- Increment node (and swap color dependant registers) ---
 
@@ -120,29 +141,54 @@ entry      __exit_node                                  // Entry point in case o
    blr
 } /* SearchNode */
 
+#else
+
+void SearchNode (ENGINE *E, NODE *N)
+{
+   E->S.currNode = NN;                                  // N++;
+   SearchNodeC(E, NN);                                  // Call C-Search routine.
+   E->S.currNode = N;                                   // N--;
+} /* SearchNode */
+
+#endif
+
 /*----------------------------------------- Search Node ------------------------------------------*/
 
 void SearchNodeC (register ENGINE *E, register NODE *N)
 {
+   INT exitKind;                                         // Reason for exiting node (see "Trace.h").
 
    /* - - - - - - - - - - - - - - - - - - - Periodics - - - - - - - - - - - - - - - - - - - - */
-   // Only check for periodics every rarely because Timer() is a VERY expensive call under
-   // OS X!! (probably because it's an out-of-process call).
+   // Only check for periodics every "pollNodes" nodes, which Engine_Periodic adapts to the
+   // measured NPS (so the clock is read about every millisecond, whatever the speed).
 
    if (--E->S.periodicCounter <= 0)
    {
       Engine_Periodic(E);
-      E->S.periodicCounter = E->S.npsTarget >> 6;
+      E->S.periodicCounter = E->S.pollNodes;
 
-      if (E->P.reduceStrength)     // Reduce ELO strength
-      {
-         while (E->S.moveCount >= E->S.npsTarget*((Timer() - E->S.startTime)/60))
+      if (E->P.reduceStrength)     // Reduce ELO strength: Wait until the node budget (npsTarget)
+      {                            // has caught up with the move count.
+         LONG64 wait;
+         while (E->R.state == state_Running &&
+                (wait = 1000000*E->S.moveCount/E->S.npsTarget - (MicroTimer() - E->S.startMicroTime)) >= 0)
+         {
+#ifdef __engine_threads
+            struct timespec t = { 0, 1000*(long)(wait < pollMicroSecs ? wait + 1 : pollMicroSecs) };
+            nanosleep(&t, nil);    // Sleep at most one poll interval, so stop requests are seen.
+#endif
             Engine_Periodic(E);
+         }
       }
    }
 
    /* - - - - - - - - - - - - - - - - - Compute Parameters - - - - - - - - - - - - - - - - - -*/
 
+#ifndef __engine_asm
+   N->cutoff = false;
+#endif
+   Stats_Count(E, nodes);
+   Trace_Enter(E, N);
    N->alpha = N->alpha0;
    if (N->ply < 0) N->ply = 0;                           // Adjust "ply" counter to the
    else if (N->ply > N->maxPly) N->ply = N->maxPly;      // interval [0..maxPly].
@@ -155,19 +201,25 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
       SendMsg_Async(E, msg_NewNode);
    #endif
 
-   UpdateDrawState();                                    // Return in case of a true draw or
+   UpdateDrawState(E, N);                                // Return in case of a true draw or
    if (N->drawType != drawType_None)                     // first repetition (unless depth = 2).
    {
       N->score = drawVal;
+      exitKind = trace_Draw;
       if (N->depth != 2 || N->drawType >= drawType_Rep2)
          goto exit;
    }
 
-   if (ProbeTransTab())                                  // Probe transposition table.
+   exitKind = trace_TransCut;
+   if (ProbeTransTab(E, N))                              // Probe transposition table.
    {
+      Stats_Count(E, transCuts);
       goto exit;
    }
 
+   exitKind = trace_Tablebase;
+   if (TB_ProbeNode(E, N)) goto exit;                    // Probe endgame tablebases.
+
    N->check = (N->Attack_[N->PieceLoc[0]] > 0);          // Is the player in check?
 
    if (! N->check && N->ply > 0)                         // Undo futile extensions.
@@ -181,14 +233,17 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
    }
 
    N->quies = (N->ply <= 0 && ! N->check);               // Is this a quiescence node?
-   AnalyzeThreats();                                     // Analyze threats.
-	Evaluate();															// Compute static evalutation.
+   Stats_Add(E, quiesNodes, N->quies);
+   AnalyzeThreats(E, N);                                 // Analyze threats.
+	Evaluate(E, N);															// Compute static evalutation.
 
+   exitKind = trace_Leaf;
    if (N->bottomNode || (N->isMateDepth && ! N->check))  // Return if bottom node or max mate
    {  N->score = N->totalEval;                           // depth reached.
       goto exit;
    }
 
+   exitKind = (N->drawType == drawType_None ? trace_StandPat : trace_Draw);
    if (N->quies)                                         // Compute worst case evaluation.
    {
       if (N->drawType == drawType_None)
@@ -217,21 +272,25 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
    N->gen       = N->bestGen = gen_None;                 // Reset current/best move generator.
    N->firstMove = true;                                  // We are about to search first move
    N->canMove   = false;                                 // and none has been searched yet.
-   PrepareKillers();                                     // Prepare killer table.
-   if (N->alphaPly <= 0) ComputeSelBaseVal();            // Compute selective base value.
+   PrepareKillers(E, N);                                 // Prepare killer table.
+   if (N->alphaPly <= 0) ComputeSelBaseVal(E, N);        // Compute selective base value.
 
    /* - - - - - - - - - - - - - - - - - - - - Search Node - - - - - - - - - - - - - - - - - - */
 
+   exitKind = trace_Exit;
+
    if (! isNull(N->rfm))                                 // Search refutation move (if any).
    {
       SearchMoveC(E, N);
+      ExitOnCutoff(N);
    }
 
    if (N->check)                                         // --- CHECK EVASION ---
    {
       N->m.dply = 0;
       N->storeSacri = true;                              // Search and extend check evasion
-      SearchCheckEvasion();                              // moves (including sacrifices).
+      SearchCheckEvasion(E, N);                          // moves (including sacrifices).
+      ExitOnCutoff(N);
       if (N->score == N->loseVal &&                      // Force cutoff at previous node in
           PN->beta > -N->loseVal)                        // case of mate.
          PN->beta = -N->loseVal;
@@ -240,12 +299,16 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
    {
       N->m.dply = 1;                                     // Forced moves (dply = 0).
       N->storeSacri = (N->maxPly > 0);                   // Store sacrifices?
-      SearchEnPriseCaptures();                           // Search forced captures and queen
+      SearchEnPriseCaptures(E, N);                       // Search forced captures and queen
+      ExitOnCutoff(N);
       N->m.dply = 0;                                     // Forced moves (dply = 0).
-      SearchPromotions();                                // promotions.
-      SearchRecaptures();
+      SearchPromotions(E, N);                            // promotions.
+      ExitOnCutoff(N);
+      SearchRecaptures(E, N);
+      ExitOnCutoff(N);
       N->m.dply = 1;                                     // Non-forced moves (dply = 1).
-      SearchSafeCaptures();                              // Search non-forced, safe captures.
+      SearchSafeCaptures(E, N);                          // Search non-forced, safe captures.
+      ExitOnCutoff(N);
 
       if (! N->quies)                                    // --- FULL WIDTH SEARCH ---
       {
@@ -254,15 +317,20 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
             if (N->totalEval < N->alpha - 30 ||               // Do not extend search, if escapes
                 N->totalEval - N->threatEval > N->beta + 30)  // are not forced/interesting.
                N->eply = 1;
-            SearchEscapes();
+            SearchEscapes(E, N);
+            ExitOnCutoff(N);
          }
 
-         SearchCastling();                               // Search castling, killer and safe non-captures.
+         SearchCastling(E, N);                           // Search castling, killer and safe non-captures.
+         ExitOnCutoff(N);
          N->m.dply = 2;                                  // Quiet moves (dply = 2):
-         SearchKillers();
-         SearchNonCaptures();
+         SearchKillers(E, N);
+         ExitOnCutoff(N);
+         SearchNonCaptures(E, N);
+         ExitOnCutoff(N);
          N->selMargin -= 50;                             // Search sacrifices and punish use- 
-         SearchSacrifices();                             // less sacrifices during selection.
+         SearchSacrifices(E, N);                         // less sacrifices during selection.
+         ExitOnCutoff(N);
 
          if (! N->canMove) N->score = drawVal;           // If we are stalemate return drawVal.
       }
@@ -273,30 +341,37 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
             if (N->totalEval < N->alpha - 30)
                N->escapeSq = nullSq;
             else
-               N->storeSacri = false,                    // Don't search sacrifice escapes.
-               SearchEscapes();
+            {  N->storeSacri = false;                    // Don't search sacrifice escapes.
+               SearchEscapes(E, N);
+               ExitOnCutoff(N);
+            }
          }
 
-         SearchSafeChecks();                             // Search safe checks
-         SearchFarPawns();                               // Pawn moves to the 6th or 7th rank.
+         SearchSafeChecks(E, N);                         // Search safe checks
+         ExitOnCutoff(N);
+         SearchFarPawns(E, N);                           // Pawn moves to the 6th or 7th rank.
+         ExitOnCutoff(N);
          if (N->depth - E->S.mainDepth <= 1)             // Search shallow sacrifices.
          {  if (N->program) N->selMargin -= 50;          // Punish the program's sacrifices.
-            SearchSacrifices();
+            SearchSacrifices(E, N);
+            ExitOnCutoff(N);
          }
       }
       else                                               // --- QUIESCENCE SEARCH (DEEP) ---
       {
          if (N->depth < E->S.checkDepth)  //### Experiment
-            SearchSafeChecks();
-//       SearchFarPawns();                               // Pawn moves to the 6th or 7th rank.
+         {  SearchSafeChecks(E, N);
+            ExitOnCutoff(N);
+         }
+//       SearchFarPawns(E, N);                               // Pawn moves to the 6th or 7th rank.
       }
    }
 
    /* - - - - - - - - - - - - - - - - - - - - Exit Node - - - - - - - - - - - - - - - - - - - */
-   // Cut Off results in a jump "here" (to the same code in the "CutOff" routine):
+   // A cutoff performs the same steps in "SearchMoveC" and then exits the node directly:
 
-   UpdateKillers();                                      // Update killer table.
-   if (N->score != 0) StoreTransTab();                   // Update transposition table.
+   UpdateKillers(E, N);                                  // Update killer table.
+   if (N->score != 0) StoreTransTab(E, N);               // Update transposition table.
 
 // E->S.genMoveCount += (E->S.bufTop - N->bufStart);
    E->S.bufTop = N->bufStart;                            // Restore old state of "SBuf".
@@ -304,6 +379,7 @@ void SearchNodeC (register ENGINE *E, register NODE *N)
 exit:
    N->pvNode  = false;                                   // This is no longer a PV node.
    PN->val = -N->score;                                  // "Return" score.
+   Trace_Exit(E, N, exitKind);
 
 #ifdef __debug_Search
    SendMsg_Async(E, msg_EndNode);
@@ -321,7 +397,9 @@ exit:
 /*----------------------------------------- Search Move ------------------------------------------*/
 // This routine searches one move. Is called directly by the various move generator routines.
 
-asm void SearchMove (void)
+#ifdef __engine_asm
+
+asm void SearchMove (register ENGINE *_E, register NODE *_N)
 {
    mr      rTmp1, rEngine
    mr      rTmp2, rNode
@@ -329,20 +407,32 @@ asm void SearchMove (void)
    blr
 } /* SearchMove */
 
+#else
+
+void SearchMove (ENGINE *E, NODE *N)
+{
+   SearchMoveC(E, N);
+} /* SearchMove */
+
+#endif
+
 
 static void SearchMoveC (register ENGINE *E, register NODE *N)
 {
+#ifdef __engine_stats
+   BOOL firstMove = N->firstMove;                        // (Is cleared by the search below).
+#endif
    E->S.moveCount++;
 
    /* - - - - - - - - - - - - - - - - Prepare Move Search - - - - - - - - - - - - - - - - - -*/
 
    if (N->firstMove && ! isNull(N->rfm))
-      if (! N->pvNode && ! GetTransMove()) return;       // Retrieve refutation move
+      if (! N->pvNode && ! GetTransMove(E, N)) return;   // Retrieve refutation move
       else N->m = N->rfm;
-   else if (KillerRefCollision())                        // Handle killer/refutation move
+   else if (KillerRefCollision(E, N))                    // Handle killer/refutation move
       return;                                            // collision.
 
-   EvalMove();                                           // Compute move evaluation (pvSum and mobility only).
+   EvalMove(E, N);                                       // Compute move evaluation (pvSum and mobility only).
    NN->ply = N->ply - Min(N->m.dply, 1);                 // Decrement ply-counter at next node.
  
 #ifdef __debug_Search
@@ -353,8 +443,9 @@ static void SearchMoveC (register ENGINE *E, register NODE *N)
    // Check selection/forward pruning (Note: It's very important that we NEVER prune the moves
    // in the PV line (otherwise the NN->pvNode is not cleared properly).
 
-   if (N->alphaPly <= 0 && N->depth >= 2 && ! (N->pvNode && N->firstMove) && ! SelectMove())
+   if (N->alphaPly <= 0 && N->depth >= 2 && ! (N->pvNode && N->firstMove) && ! SelectMove(E, N))
    {
+      Stats_CountGen(E, N, pruned);
       N->firstMove = false;
       N->canMove = true;      // Not strictly true but works in most cases!!
       return;
@@ -362,15 +453,16 @@ static void SearchMoveC (register ENGINE *E, register NODE *N)
 
    /* - - - - - - - - - - - - - - Perform, Search and Retract Move - - - - - - - - - - - - - */
 
-   PerformMove();                                        // Perform move.
+   PerformMove(E, N);                                    // Perform move.
 
       if (N->Attack_[N->PieceLoc[0]])                    // Skip search if it's illegal.
-      {  RetractMove();
+      {  RetractMove(E, N);
          N->firstMove = false;
          return;
       }
 
       N->canMove = true;                                 // Strictly legal move -> Now we REALLY can move
+      Stats_CountGen(E, N, tried);
 
       if (N->isMateDepth)                                // If mate finder and the "loosing" side
       {                                                  // is not mate at the mate depth, exit
@@ -381,22 +473,22 @@ static void SearchMoveC (register ENGINE *E, register NODE *N)
           ! N->pvNode)                                   // If first move or not PV node
       {
          NN->alpha0 = -N->beta;                          // search with full window...
-         SearchNode();
+         SearchNode(E, N);
          N->firstMove = false;
       }
       else                                               // ...otherwise search with minimal
       {
          NN->alpha0 = -N->alpha - 1;                     // window and re-search if fail high.
-         SearchNode();
+         SearchNode(E, N);
 
          if (N->val > N->alpha)
          {  NN->alpha0 = -N->beta;
             NN->ply = N->ply - Min(N->m.dply, 1);
-            SearchNode();
+            SearchNode(E, N);
          }
       }
 
-   RetractMove();                                        // Retract move.
+   RetractMove(E, N);                                    // Retract move.
 
    /* - - - - - - - - - - - - - - - - - - End Move Search - - - - - - - - - - - - - - - - - -*/
 
@@ -404,14 +496,17 @@ static void SearchMoveC (register ENGINE *E, register NODE *N)
    {                                                     // best line.
       N->score   = N->val;
       N->bestGen = N->gen;
-      UpdateBestLine();
+      UpdateBestLine(E, N);
 
       if (N->score > N->alpha)                           // If new score better than alpha value...
       {
          if (N->score >= N->beta)                        // then if cutoff then return score and exit node:
          {
-            UpdateKillers();                             //    Update killer table.
-            StoreTransTab();                             //    Update transposition table.
+            Stats_CountGen(E, N, cutoffs);
+            Stats_AddGen(E, N, firstCutoffs, firstMove);
+            Trace_Exit(E, N, trace_Cutoff);
+            UpdateKillers(E, N);                         //    Update killer table.
+            StoreTransTab(E, N);                         //    Update transposition table.
             E->S.bufTop = N->bufStart;                   //    Restore old state of "SBuf".
             N->pvNode   = false;                         //    This is no longer a PV node.
             PN->val     = -N->score;                     //    "Return" score.
@@ -420,7 +515,12 @@ static void SearchMoveC (register ENGINE *E, register NODE *N)
             SendMsg_Async(E, msg_Cutoff);
            // if (showTree) UntraceMove(N);
          #endif
-            ExitNode();                                  //    Exit node (long jump).
+         #ifdef __engine_asm
+            ExitNode(E, N);                              //    Exit node (long jump).
+         #else
+            N->cutoff = true;                            //    Exit node (via the move generators
+            return;                                      //    and "ExitOnCutoff").
+         #endif
          }
          else                                            // else simply update alpha and beta values
          {  N->alpha = N->score;
@@ -444,9 +544,11 @@ static void SearchMoveC (register ENGINE *E, register NODE *N)
 // Cutoffs are handled by jumping out of the current "SearchMove" call and back to the exit point
 // of the calling "SearchNode" routine. In praxis this is achieved by calling the "ExitNode" routine
 // which restores the processor state and then long jumps directly to the "__exit_node" entry point
-// in the "SearchNode" routine.
+// in the "SearchNode" routine. The portable version returns normally instead (see "ExitOnCutoff").
+
+#ifdef __engine_asm
 
-static asm void ExitNode (void)      // Restore processor state (lr, rSP, rLocal1 - rLocal7):
+static asm void ExitNode (register ENGINE *_E, register NODE *_N)   // Restore processor state (lr, rSP, rLocal1 - rLocal7):
 {
    lwz     r0, NODE.cutEnv.lr(rNode)
    lmw     rLocal7, NODE.cutEnv.gpr(rNode)
@@ -455,3 +557,5 @@ static asm void ExitNode (void)      // Restore processor state (lr, rSP, rLocal
    b       __exit_node
 } /* ExitNode */
 
+#endif
+
@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Engine.h"
+
+#include "SMP.f"
+#include "Search.f"
+#include "Engine.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                            LAZY SMP                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// If P.threads > 1, the master engine starts P.threads - 1 of its helper engines once the root
+// moves have been generated. Each helper runs MainSearch() in its own OS thread on a copy of the
+// master's search parameters, and shares the master's transposition tables (which is the only
+// communication between the threads). Odd numbered helpers start one ply deeper, so the threads
+// don't all search the same iteration. Helpers never send messages to the host, and keep
+// iterating until the master stops them at the end of its search. The master then adopts the
+// result of the helper with the deepest completed iteration if it is deeper than its own.
+//
+// The helpers' "stop" flag and published move count are the only engine fields accessed by two
+// threads during the search, so they are read and written with __atomic builtins.
+//
+// Helper threads are only available in builds with "__engine_smp" (pthreads). Otherwise
+// Engine_AddHelper() fails and all searches are single threaded.
+
+#ifdef __engine_smp
+
+static void StopHelpers (ENGINE *E);
+
+/*------------------------------------------ Begin Search ----------------------------------------*/
+// Called by MainSearch() after PrepareSearch() (both for the master and for the helpers).
+
+static void *HelperThread (void *data);
+
+void SMP_BeginSearch (ENGINE *E)
+{
+   SMP_STATE *M = &E->SMP;
+
+   M->depthDone = 0;
+   M->activeHelpers = 0;
+   M->helperMoveCount = 0;
+
+   if (M->Master)                                  // Helper: Stagger the start depth.
+   {  if (odd(M->helperNo))
+      {  NODE *N = E->S.rootNode;
+         N->ply++;
+         N->alphaPly++;
+         N->betaPly++;
+      }
+      return;
+   }
+
+   INT n = Min(E->P.threads - 1, M->helperCount);
+
+   if (n <= 0 || E->UCI || E->S.numRootMoves <= 1 || E->S.libMovesOnly || E->P.reduceStrength ||
+       E->P.playingMode == mode_Mate || E->P.playingMode == mode_Novice ||
+       E->P.lastMoveNo + maxSearchDepth + 3 > smpDrawDataSize)
+      return;
+
+   pthread_attr_t attr;
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, smpStackSize);
+
+   for (INT i = 0; i < n; i++)
+   {
+      ENGINE *H = M->Helper[i];
+
+      H->P = E->P;
+      H->P.backgrounding = false;
+      H->P.useEndgameDB  = false;
+      H->P.Library       = nil;
+      H->P.threads       = 1;
+      H->P.Trace         = nil;
+      H->P.DrawData      = H->SMP.DrawData;
+      for (INT j = 0; j <= E->P.lastMoveNo; j++)
+         H->SMP.DrawData[j] = E->P.DrawData[j];
+      for (INT j = 0; j < E->S.numRootMoves; j++)
+         H->S.Ignore[j] = E->S.Ignore[j];
+
+      H->SMP.stop = false;
+      H->SMP.moveCount = 0;
+      H->R.taskRunning = true;
+      if (pthread_create(&H->SMP.thread, &attr, HelperThread, (void*)H) != 0)
+      {  H->R.taskRunning = false;
+         break;
+      }
+      M->activeHelpers++;
+   }
+
+   pthread_attr_destroy(&attr);
+} /* SMP_BeginSearch */
+
+
+static void *HelperThread (void *data)
+{
+   ENGINE *H = (ENGINE*)data;
+
+   MainSearch(H);
+   __atomic_store_n(&H->SMP.moveCount, H->S.moveCount, __ATOMIC_RELAXED);
+   return nil;
+} /* HelperThread */
+
+/*----------------------------------------- End Iteration ----------------------------------------*/
+// Called when an iteration has been completed. Records the result (the master only needs the
+// depth, since its own main line is used unless a helper got further).
+
+void SMP_EndIteration (ENGINE *E)
+{
+   SMP_STATE *M = &E->SMP;
+
+   M->depthDone = E->S.mainDepth;
+   if (! M->Master) return;
+
+   M->scoreDone = E->S.mainScore;
+   M->iMainDone = E->S.iMain;
+   for (INT d = 0; d < maxSearchDepth + 3; d++)
+      if (isNull(M->MainLine[d] = E->S.MainLine[d])) break;
+} /* SMP_EndIteration */
+
+/*------------------------------------------- End Search -----------------------------------------*/
+// Called by the master when its iterations are done (but before EndSearch()). Stops the helpers
+// and adopts the deepest helper result (unless the master's result is exact, i.e. all root moves
+// were resolved by the endgame databases, which the helpers don't probe at the root).
+
+void SMP_EndSearch (ENGINE *E)
+{
+   SMP_STATE *M = &E->SMP;
+
+   if (M->Master || M->activeHelpers == 0) return;
+
+   StopHelpers(E);
+
+   ENGINE *B = nil;
+   INT depth = M->depthDone;
+
+   for (INT i = 0; i < M->activeHelpers; i++)
+   {  ENGINE *H = M->Helper[i];
+      if (H->SMP.depthDone > depth && ! isNull(H->SMP.MainLine[0]))
+         depth = (B = H)->SMP.depthDone;
+   }
+
+   if (B && E->R.state != state_Stopped && E->S.multiPVCount == 1 && ! E->S.edbMovesOnly)
+   {  SEARCH_STATE *S = &E->S;
+
+      for (INT d = 0; d < maxSearchDepth + 3; d++)
+         if (isNull(S->MainLine[d] = B->SMP.MainLine[d])) break;
+      S->mainScore = S->bestScore = B->SMP.scoreDone;
+      S->scoreType = scoreType_True;
+      S->iMain     = B->SMP.iMainDone;
+      S->mainDepth = B->SMP.depthDone;
+      SendMsg_Async(E, msg_NewIteration);
+      SendMsg_Async(E, msg_NewMainLine);
+      SendMsg_Async(E, msg_NewScore);
+   }
+
+   M->activeHelpers = 0;
+} /* SMP_EndSearch */
+
+
+static void StopHelpers (ENGINE *E)
+{
+   SMP_STATE *M = &E->SMP;
+
+   for (INT i = 0; i < M->activeHelpers; i++)
+      __atomic_store_n(&M->Helper[i]->SMP.stop, true, __ATOMIC_RELEASE);   // See Engine_Periodic.
+
+   for (INT i = 0; i < M->activeHelpers; i++)
+   {  ENGINE *H = M->Helper[i];
+      pthread_join(H->SMP.thread, nil);
+      H->R.taskRunning = false;
+   }
+
+   SMP_Periodic(E);
+} /* StopHelpers */
+
+/*-------------------------------------------- Periodic ------------------------------------------*/
+// Called from Engine_Periodic() of the master. Collects the statistics of the helpers.
+
+void SMP_Periodic (ENGINE *E)
+{
+   SMP_STATE *M = &E->SMP;
+   LONG64    moveCount = 0;
+
+   for (INT i = 0; i < M->activeHelpers; i++)
+      moveCount += __atomic_load_n(&M->Helper[i]->SMP.moveCount, __ATOMIC_RELAXED);
+
+   M->helperMoveCount = moveCount;
+} /* SMP_Periodic */
+
+/*--------------------------------------------- Abort --------------------------------------------*/
+
+void SMP_Abort (ENGINE *E)
+{
+   if (E->SMP.Master || E->SMP.activeHelpers == 0) return;
+
+   StopHelpers(E);
+   E->SMP.activeHelpers = 0;
+} /* SMP_Abort */
+
+#else
+
+void SMP_BeginSearch (ENGINE *E) { E->SMP.depthDone = 0; }
+void SMP_EndIteration (ENGINE *E) { E->SMP.depthDone = E->S.mainDepth; }
+void SMP_EndSearch (ENGINE *E) { }
+void SMP_Periodic (ENGINE *E) { }
+void SMP_Abort (ENGINE *E) { }
+
+#endif
@@ -0,0 +1,77 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#ifdef __engine_smp
+#include <pthread.h>
+#endif
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & MACROS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#define maxSearchThreads  64                            // Max search threads per engine (incl. master).
+#define smpDrawDataSize   (1000 + maxSearchDepth + 3)   // Size of private draw table of helpers.
+#define smpStackSize      (8L*1024L*1024L)              // Stack size of helper threads.
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        TYPE DEFINITIONS                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Lazy SMP state. The "master" engine is the one created and started by the host. Its helper
+// engines (also allocated by the host) each search the same root position in a separate thread,
+// sharing the master's transposition tables. See "SMP.c".
+
+typedef struct
+{
+   //--- Master ---
+   INT            helperCount;                 // Number of helper engines attached.
+   struct _ENGINE *Helper[maxSearchThreads-1]; // The helper engines (see Engine_AddHelper).
+   INT            activeHelpers;               // Number of helpers running in current search.
+   LONG64         helperMoveCount;             // Total move count of the active helpers.
+
+   //--- Helper ---
+   struct _ENGINE *Master;                     // Master engine if this is a helper (else nil).
+   INT            helperNo;                    // Index in Master->SMP.Helper[].
+   BOOL           stop;                        // Set by the master when the helper must stop.
+   LONG64         moveCount;                   // S.moveCount as published to the master.
+#ifdef __engine_smp
+   pthread_t      thread;                      // The helper thread.
+#endif
+
+   //--- Result of last completed iteration ---
+   INT            depthDone;                   // Depth of last completed iteration (0 if none).
+   INT            scoreDone;                   // Score of last completed iteration.
+   INT            iMainDone;                   // Index in RootMoves[] of best move.
+   MOVE           MainLine[maxSearchDepth+3];  // Main line of last completed iteration (helpers).
+
+   DRAWDATA       DrawData[smpDrawDataSize];   // Private copy of P.DrawData (helpers only).
+} SMP_STATE;
@@ -32,7 +32,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "Engine.h"
-#include "TaskScheduler.h"
+#ifndef __engine_threads
+   #include "TaskScheduler.h"
+#endif
 
 #include "Search.f"
 #include "SearchMisc.f"
@@ -51,6 +53,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Engine.f"
 #include "HashCode.f"
 #include "EndgameDB.f"
+#include "SMP.f"
+#include "Trace.f"
+#include "Tablebase.f"
 
 
 //#define __dumpEloNps 1  //###
@@ -72,11 +77,14 @@ static void EndSearch(ENGINE *E);
 
 void MainSearch (ENGINE *E)
 {
-   E->msgQueue = 0;
-   E->R.taskRunning = true;
+#ifndef __engine_threads
+   E->msgQueue = 0;                  // (Owned by the host thread if "__engine_threads", and reset
+   E->R.taskRunning = true;          // by Engine_Start, which also sets "taskRunning" before the
+#endif                               // engine thread is created).
    SendMsg_Async(E, msg_BeginSearch);
 
 	PrepareSearch(E);
+   SMP_BeginSearch(E);
 	   
 	   do
 	   {  PrepareIteration(E);
@@ -87,11 +95,16 @@ void MainSearch (ENGINE *E)
          EndIteration(E);
       } while (AnotherIteration(E));
 
+   SMP_EndSearch(E);
 	EndSearch(E);
 
    SendMsg_Sync(E, msg_EndSearch);   // <-- Important: Must be a sync call so the msg queue is flushed
+#ifdef __engine_threads
+   __atomic_store_n(&E->R.taskRunning, false, __ATOMIC_SEQ_CST);
+#else
    E->R.taskRunning = false;
    E->msgQueue = 0;
+#endif
 } /* MainSearch */
 
 /*--------------------------------------- Special UCI Hooks --------------------------------------*/
@@ -167,6 +180,11 @@ static void PrepareSearch (ENGINE *E)
    SetPlayingStrength(E); // Must be done after time allocation.
    ConsultPosLibrary(E);  // Must be done here
 
+   E->S.multiPVCount = 1;
+   if (E->P.playingMode != mode_Mate && E->P.playingMode != mode_Novice && ! E->S.libMovesOnly)
+      E->S.multiPVCount = Max(1, Min(E->P.multiPV, Min(maxMultiPV, E->S.numRootMoves)));
+   E->S.pvCount = 0;
+
    // Display initially search results:
    SendMsg_Async(E, msg_NewIteration);
    SendMsg_Async(E, msg_NewMainLine);
@@ -225,6 +243,9 @@ static void PrepareSearchTree (ENGINE *E)          // Initializes the nodes of t
       N[d].killer2Count = 0;
       N[d].killer1Active = false;
       N[d].killer2Active = false;
+#ifndef __engine_asm
+      N[d].cutoff       = false;
+#endif
       clrMove(N[d].rfm);
       clrMove(N[d].killer1);
       clrMove(N[d].killer2);
@@ -287,12 +308,21 @@ static void PrepareMisc (ENGINE *E)               // Initialize miscellaneous va
 
    E->S.nodeCount    = 0;                         // Reset node count.
    E->S.moveCount    = 0;                         // Reset move count.
-   E->S.hashFull     = 0;                         // = 1000*E->Tr.transUsed/E->Tr.transSize
+#ifndef __engine_asm
+   E->S.pawnHashProbes = E->S.pawnHashHits = 0;
+#endif
+#ifdef __engine_stats
+   ClearBlock((PTR)&E->S.Stats, sizeof(SEARCH_STATS));
+#endif
+   Trace_BeginSearch(E);
+   E->S.hashFull     = 0;                         // See TransTabUsage().
    E->S.startTime    = Timer();
    E->S.searchTime   = 0;
    E->S.mainTime     = 0;
-   E->S.periodicTime = Timer() + 10;  //###
+   E->S.startMicroTime  = MicroTimer();
+   E->S.periodicTime    = E->S.startMicroTime + ticksToMicroSecs(10);
    E->S.periodicCounter = 0;
+   E->S.pollNodes       = minPollNodes;
    E->S.uciNps       = 0;
 
    E->S.bufTop       = E->S.SBuf;                 // Reset sacrifice buffer.
@@ -303,11 +333,23 @@ static void PrepareMisc (ENGINE *E)               // Initialize miscellaneous va
    E->S.libMovesOnly = false;
    E->S.edbPresent   = true;
    E->S.edbMovesOnly = true;
+   E->S.edbProbes    = 0;
+   E->S.edbMicroSecs = 0;
+#ifndef __engine_asm
+   E->S.tbProbing    = TB_SearchProbing(E);       // Must be done after CalcBoardState.
+#endif
 
-   ResetTransTab(E);
-   if (E->P.playingMode != mode_Mate)
-      StoreKBNKpositions(E);
+   if (! E->SMP.Master)                           // SMP helpers share the master's (already
+   {  ResetTransTab(E);                           // prepared) transposition tables.
+      if (E->P.playingMode != mode_Mate)
+         StoreKBNKpositions(E);
+   }
+#ifndef __engine_asm
    else
+      E->Tr.generation = E->SMP.Master->Tr.generation;
+#endif
+
+   if (E->P.playingMode == mode_Mate)
    {  E->S.rootNode[E->S.mateDepth].isMateDepth = true;
    }
 } /* PrepareMisc */
@@ -367,6 +409,11 @@ static void PrepareIteration (ENGINE *E)
 
    E->S.mainDepth = N[0].ply;
    E->S.currMove  = 0;
+#ifdef __engine_stats
+   E->S.Stats.iterations = E->S.mainDepth;
+   E->S.Stats.iterStart  = E->S.moveCount;
+#endif
+   Trace_Iteration(E);
 
    INT phase  = Max(5, Min(9, E->V.phase));           // Set the maximum quiescence depth
    INT maxPly = ((20 - phase)*E->S.mainDepth)/10;     // (i.e. maximum number of plies to
@@ -439,6 +486,7 @@ static void StorePrinVar (ENGINE *E)           // Stores the principal variation
 // Performs one iteration by searching all the root moves.
 
 static void NoviceAdjust (ENGINE *E);
+static void UpdateMultiPV (ENGINE *E);
 
 static void SearchRootNode (ENGINE *E)
 {
@@ -451,6 +499,7 @@ static void SearchRootNode (ENGINE *E)
       S->nodeCount++;
 
       S->mainScore = N->score = N->loseVal; //(E->P.playingMode == mode_Infinite ? -1 : N->loseVal); //###
+      S->pvCount = 0;
       NN->beta = -N->alpha;
 
    #ifdef __debug_Search
@@ -462,7 +511,7 @@ static void SearchRootNode (ENGINE *E)
       for (S->currMove = 0; S->currMove < S->numRootMoves && E->R.state == state_Running; S->currMove++, R++)
       {
          S->moveCount++;
-         Engine_Periodic(E);
+         Engine_Poll(E);
 
          N->m   = S->RootMoves[R->i];                           // Retrieve next root move to be searched
          N->gen = N->m.misc;
@@ -478,17 +527,17 @@ static void SearchRootNode (ENGINE *E)
 
          NN->ply = N->ply - Min(N->m.dply, 1);                  // Decrement ply-counter at next node.
 
-         EvalMove();                                            // Compute move evaluation
+         EvalMove(E, N);                                        // Compute move evaluation
 
          //--- Perform, Search & Retract Move ---
 
-         PerformMove();
+         PerformMove(E, N);
 
             if (S->libMovesOnly)
             {
                // Perform a quick 1-ply search (in case of transposition errors in the book)
                NN->alpha0 = -N->beta;
-               SearchNode();
+               SearchNode(E, N);
 
                // If it's not a "bad" value (i.e. above -50), then replace with random value
                if (N->val > -50)
@@ -503,31 +552,34 @@ static void SearchRootNode (ENGINE *E)
             {
                S->edbMovesOnly = false;
 
-               if (S->currMove == 0 || ! E->P.pvSearch)         // If first move or not PV node
+               if (S->currMove == 0 || ! E->P.pvSearch ||       // If first move or not PV node
+                   (S->multiPVCount > 1 && S->pvCount < S->multiPVCount))
                {
                   NN->alpha0 = -N->beta;                        // search with full window...
-                  SearchNode();
+                  SearchNode(E, N);
                }
                else                                             // ...otherwise search with minimal
                {
                   NN->alpha0 = -N->alpha - 1;                   // window and re-search if fail high.
-                  SearchNode();
+                  SearchNode(E, N);
                   if (N->val > N->alpha)
                   {  NN->alpha0 = -N->beta;
                      NN->ply = N->ply - Min(N->m.dply, 1);
-                     SearchNode();
+                     SearchNode(E, N);
                   }
                }
             }
 
-         RetractMove();
+         RetractMove(E, N);
 
          //--- Update Score ---
 
          if (E->P.playingMode == mode_Novice && ! S->libMovesOnly)  // Screw up value if novice mode.
             NoviceAdjust(E);
 
-         if (N->val > N->score && E->R.state == state_Running)  // Update alpha values and main
+         if (S->multiPVCount > 1)
+            UpdateMultiPV(E);
+         else if (N->val > N->score && E->R.state == state_Running)  // Update alpha values and main
          {                                                      // line if necessary...
             if (E->P.nondeterm && ! S->libMovesOnly &&          // Apply nondeterministic content
                 N->val > mateLoseVal && N->val < mateWinVal)    // factor (if not mate win/lose).
@@ -535,7 +587,7 @@ static void SearchRootNode (ENGINE *E)
             S->mainScore = S->bestScore = N->score = N->alpha = R->val = N->val;
             S->scoreType = (S->libMovesOnly ? scoreType_Book : scoreType_True);
             NN->beta = -N->alpha;
-            UpdateBestLine();
+            UpdateBestLine(E, N);
             S->iMain = R->i;
 
             if (S->currMove > 0 || S->mainDepth == 1)
@@ -559,6 +611,78 @@ static void SearchRootNode (ENGINE *E)
    Asm_End();
 } /* SearchRootNode */
 
+/*------------------------------------ Multi PV Root Node Search ---------------------------------*/
+// In multi PV mode the K best root moves are kept (sorted) in PVLine[]/PVScore[]. Root moves are
+// searched with a full window until K lines have been found, and thereafter with a minimal window
+// around the score of the K'th line (which then acts as the root alpha). All lines thus share a
+// single iterative deepening run (and transposition table) rather than K separate searches.
+
+static void ReportMultiPV (ENGINE *E);
+
+static void UpdateMultiPV (ENGINE *E)
+{
+   SEARCH_STATE *S = &E->S;
+   NODE         *N = S->rootNode;
+   ROOTTAB      *R = &S->RootTab[S->currMove];
+
+   if (N->val <= N->alpha || E->R.state != state_Running) return;
+
+   INT k = Min(S->pvCount, S->multiPVCount - 1);          // Insert new line (dropping the
+   for (; k > 0 && S->PVScore[k - 1] < N->val; k--)       // K'th line if all K are taken).
+   {  S->PVScore[k] = S->PVScore[k - 1];
+      for (INT d = 0; d < maxSearchDepth + 3; d++)
+         if (isNull(S->PVLine[k][d] = S->PVLine[k - 1][d])) break;
+   }
+
+   MOVE *L = S->PVLine[k];
+   L[0] = N->m;
+   for (INT d = 0; d < maxSearchDepth + 2; d++)
+      if (isNull(L[d + 1] = NN->BestLine[d])) break;
+   S->PVScore[k] = R->val = N->val;
+
+   if (S->pvCount < S->multiPVCount) S->pvCount++;
+   if (S->pvCount == S->multiPVCount)
+      N->alpha = S->PVScore[S->pvCount - 1];
+   NN->beta = -N->alpha;
+
+   if (k == 0)                                            // New best line.
+   {  S->mainScore = S->bestScore = N->score = N->val;
+      S->scoreType = scoreType_True;
+      UpdateBestLine(E, N);
+      S->iMain = R->i;
+
+      if (S->currMove > 0 || S->mainDepth == 1)
+         E->S.mainTime = Timer() - E->S.startTime;
+
+      if (N->score >= maxVal - 1 - N->ply)                // Terminate search if a fast mate
+      {  E->R.state = state_Stopping;                     // is found.
+         E->R.aborted = false;
+      }
+   }
+
+   ReportMultiPV(E);
+   AdjustTimeLimit(E);
+} /* UpdateMultiPV */
+
+// Sends each line to the host as in the UCI "info multipv" protocol, i.e. with S->multiPV,
+// S->MainLine and S->bestScore temporarily referring to line k. Must therefore be synchronous.
+
+static void ReportMultiPV (ENGINE *E)
+{
+   SEARCH_STATE *S = &E->S;
+
+   for (INT k = 0; k < S->pvCount; k++)
+   {  S->multiPV   = k + 1;
+      S->MainLine  = S->PVLine[k];
+      S->bestScore = S->PVScore[k];
+      SendMsg_Sync(E, msg_NewMainLine | msg_NewScore);
+   }
+
+   S->multiPV   = 1;
+   S->MainLine  = S->rootNode->BestLine;
+   S->bestScore = S->mainScore;
+} /* ReportMultiPV */
+
 
 static void SearchRootNodeMate (ENGINE *E)
 {
@@ -582,7 +706,7 @@ static void SearchRootNodeMate (ENGINE *E)
       for (S->currMove = 0; S->currMove < S->numRootMoves && E->R.state == state_Running; S->currMove++, R++)
       {
          S->moveCount++;
-         Engine_Periodic(E);
+         Engine_Poll(E);
 
          N->m   = S->RootMoves[R->i];                           // Retrieve next root move to be searched
          N->gen = N->m.misc;
@@ -598,20 +722,20 @@ static void SearchRootNodeMate (ENGINE *E)
 
          NN->ply = N->ply - Min(N->m.dply, 1);                  // Decrement ply-counter at next node.
 
-         EvalMove();                                            // Compute move evaluation
+         EvalMove(E, N);                                        // Compute move evaluation
 
          //--- Perform, Search & Retract Move ---
 
-         PerformMove();
+         PerformMove(E, N);
 
             if (! ConsultEndGameDB(E))
             {
                S->edbMovesOnly = false;
                NN->alpha0 = -N->beta;                        // search with full window...
-               SearchNode();
+               SearchNode(E, N);
             }
 
-         RetractMove();
+         RetractMove(E, N);
 
          //--- Update Score ---
 
@@ -620,7 +744,7 @@ static void SearchRootNodeMate (ENGINE *E)
             S->mainScore = S->bestScore = N->score = N->alpha = R->val = N->val;
             S->scoreType = scoreType_True;
             NN->beta = -N->alpha;
-            UpdateBestLine();
+            UpdateBestLine(E, N);
             S->iMain = R->i;
 
             R->val = 1 - maxVal;
@@ -663,6 +787,12 @@ static void SearchRootNodeMate (ENGINE *E)
 static void EndIteration (ENGINE *E)              // End current iteration.
 {
    E->S.prevScore = E->S.mainScore;
+#ifdef __engine_stats
+   E->S.Stats.IterMoves[E->S.mainDepth] = E->S.moveCount - E->S.Stats.iterStart;
+#endif
+
+   if (E->S.currMove >= E->S.numRootMoves)        // Record result if all root moves were searched.
+      SMP_EndIteration(E);
 } /* EndIteration */
 
 
@@ -682,6 +812,11 @@ static BOOL AnotherIteration (ENGINE *E)          // Should we perform one more
 
    if (E->S.mainDepth == maxSearchDepth)          // Stop if maximum search depth has been reached.
       return false;
+
+#ifdef __engine_smp
+   if (E->SMP.Master)                             // SMP helpers continue until stopped by the
+      return ! __atomic_load_n(&E->SMP.stop, __ATOMIC_ACQUIRE);   // master.
+#endif
  
    if (E->P.backgrounding)
       return ! E->R.aborted;
@@ -722,6 +857,7 @@ static void EndSearch (ENGINE *E)
    E->S.Ignore[E->S.iMain] = true;             // Update ignore list so next best can be applied.
 
    E->S.searchTime = Timer() - E->S.startTime; // Calc elapsed search time (in Ticks).
+   Trace_EndSearch(E);
    RecalcPlayingStrength(E);
 
    SendMsg_Async(E, msg_NewNodeCount);         // Print final node count.
@@ -918,7 +1054,7 @@ INT AdjustELO (ENGINE *E)
 
    // Reduce strength if small hash tables (default setting 10 MB hash)
    diff -= 5*transDoubleVal;
-   LONG t = E->P.transSize/1024;
+   LONG t = (LONG)(E->P.transSize/1024);
    while (t > 80) t >>= 1, diff += transDoubleVal;
 
    return Min(diff, 200);
@@ -1005,6 +1141,139 @@ static void NoviceAdjust (ENGINE *E)
 } /* NoviceAdjust */
 
 
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                   PERFT (MOVE GENERATOR TEST)                                  */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Engine_Perft() counts the leaf nodes of the strictly legal move tree of the given depth below
+// the position in the search parameters (E->P). It uses the same move generators and the same
+// PerformMove()/RetractMove() as the search, by pointing E->S.rootNode at each node in turn and
+// calling GenRootMoves(). Runs synchronously in the calling task (no messages are sent).
+// If "Divide" is non-nil, the leaf count below each root move E->S.RootMoves[i] is returned in
+// Divide[i] (for i = 0..E->S.numRootMoves - 1).
+
+static void PrepareTestRoot (ENGINE *E);
+static LONG64 PerftNode (ENGINE *E, NODE *N, INT depth, LONG64 Divide[]);
+
+LONG64 Engine_Perft (ENGINE *E, INT depth, LONG64 Divide[])
+{
+   PrepareTestRoot(E);
+   CalcPieceValState(E);
+   CalcEvaluateState(E);
+
+   LONG64 count = PerftNode(E, E->S.rootNode, depth, Divide);
+
+   GenRootMoves(E);                             // Restore root node and RootMoves[] (overwritten
+   E->R.state = state_Stopped;                  // by the sub trees).
+   return count;
+} /* Engine_Perft */
+
+
+static LONG64 PerftNode (ENGINE *E, NODE *N, INT depth, LONG64 Divide[])
+{
+   SEARCH_STATE *S = &E->S;
+
+   if (depth <= 0) return 1;
+
+   S->rootNode = S->currNode = N;
+   N->check     = (N->Attack_[N->PieceLoc[0]] > 0);
+   N->bufStart  = S->SBuf;
+   N->storeSacri = true;
+   GenRootMoves(E);
+
+   INT  n = S->numRootMoves;
+   MOVE Moves[maxLegalMoves];
+   for (INT i = 0; i < n; i++) Moves[i] = S->RootMoves[i];
+
+   if (depth == 1 && ! Divide) return n;
+
+   LONG64 count = 0;
+
+   for (INT i = 0; i < n; i++)
+   {
+      LONG64 sub;
+
+      N->m   = Moves[i];
+      N->gen = N->m.misc;
+      S->currNode = N;
+      Asm_Begin(E);
+         PerformMove(E, N);
+      Asm_End();
+      sub = PerftNode(E, N + 1, depth - 1, nil);
+      S->currNode = N;
+      Asm_Begin(E);
+         RetractMove(E, N);
+      Asm_End();
+
+      if (Divide) Divide[i] = sub;
+      count += sub;
+   }
+
+   S->rootNode = S->currNode = N;
+   return count;
+} /* PerftNode */
+
+
+// Sets up the root of the position in the search parameters (like PrepareSearch), up to the
+// piece value computation.
+
+static void PrepareTestRoot (ENGINE *E)
+{
+   E->R.state = state_Root;
+   E->S.rootNode = (E->P.player == white ? E->S.whiteNode : E->S.blackNode);
+   E->S.currNode = E->S.rootNode;
+
+   CalcBoardState(E);
+   CalcAttackState(E);
+   CalcTransState(E);
+   CalcRunFlags(E);
+   PrepareSearchTree(E);
+   PrepareMisc(E);
+} /* PrepareTestRoot */
+
+/*---------------------------------- Piece Value Micro Benchmark ---------------------------------*/
+// Engine_BenchPieceVal() computes the root piece value tables (CalcPieceValState) of the position
+// in the search parameters "count" times, and returns the total time in micro seconds. A checksum
+// of the resulting tables (BaseVal[], PieceVal[] of the 64 squares, the castling bonuses and
+// sumPV) is returned in "checksum", so any rewrite of the computation can be checked against the
+// original tables.
+
+#define fnvPrime    16777619UL
+#define fnv(h,x)    (((h) ^ (UINT)(x))*fnvPrime)
+
+LONG64 Engine_BenchPieceVal (ENGINE *E, LONG count, ULONG *checksum)
+{
+   PIECEVAL_STATE *V = &E->V;
+
+   PrepareTestRoot(E);
+
+   LONG64 t0 = MicroTimer();
+   for (LONG i = 0; i < count; i++)
+      CalcPieceValState(E);
+   LONG64 t = MicroTimer() - t0;
+
+   ULONG h = 2166136261UL;                      // FNV-1a over the 16 bit values.
+
+   for (COLOUR c = white; c <= black; c += black)
+      for (PIECE p = c + pawn; p <= c + king; p++)
+      {  h = fnv(h, V->BaseVal[p]);
+         for (SQUARE sq = a1; sq <= h8; sq++)
+            if (onBoard(sq)) h = fnv(h, V->PieceVal[p][sq]);
+      }
+
+   for (COLOUR c = white; c <= black; c += black)
+      h = fnv(h, V->o_oPV[c]), h = fnv(h, V->o_o_oPV[c]), h = fnv(h, V->KingRight[c]);
+   h = fnv(h, V->sumPV);
+   h = fnv(h, V->styleNormPV);
+
+   *checksum = h & 0xFFFFFFFFUL;
+   E->R.state = state_Stopped;
+   return t;
+} /* Engine_BenchPieceVal */
+
+
 /**************************************************************************************************/
 /*                                                                                                */
 /*                                     SEARCH STATE INITIALIZATION                                */
@@ -1021,6 +1290,15 @@ void InitSearchState (ENGINE *E)
    ATTACK_STATE *A = &E->A;
    NODE         *N = S->_Nodes;
 
+#ifndef __engine_asm
+   // Allocate the best lines in the PV table: The line of node k holds at most the moves of nodes
+   // k..maxSearchDepth + 1 and the terminating null move, and is stored from index k of a row.
+   // UpdateBestLine() swaps the rows of node k and k + 1, so each node keeps a whole row.
+
+   for (INT k = 0; k <= maxSearchDepth + 2; k++)
+      N[k].BestLine = &S->PVTable[k*pvRowSize + k];
+#endif
+
    // Initialize main line e.t.c.:
 
    S->numRootMoves = 0;
@@ -35,8 +35,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 void MainSearch (register ENGINE *E);
 
-asm void SearchNode (void);
-asm void SearchMove (void);
+#ifdef __engine_asm
+asm void SearchNode (register ENGINE *_E, register NODE *_N);
+asm void SearchMove (register ENGINE *_E, register NODE *_N);
+#else
+void SearchNode (ENGINE *E, NODE *N);
+void SearchMove (ENGINE *E, NODE *N);
+#endif
 
 void InitSearchState (ENGINE *E);
 void InitSearchModule (GLOBAL *Global);
@@ -29,6 +29,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Attack.h"
 #include "Move.h"
 #include "HashCode.h"
+#include "AsmDef.h"
 
 
 /**************************************************************************************************/
@@ -44,9 +45,16 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define mateWinVal           (maxVal - 1000)     // Non mate values lie in the interval
 #define mateLoseVal          (-mateWinVal)       // [mateLoseVal+1 .. mateWinVal-1]
 #define drawVal              0
+#define tbWinVal             (mateWinVal - 100)  // Tablebase win (minus the depth).
 #define resignVal            -600
 #define maxLegalMoves        300
+#define maxMultiPV           8                   // Max number of lines in multi PV analysis.
 #define sacrificeBufferSize  700
+#define pollMicroSecs        1000                // Target interval between periodic polls (and
+#define minPollNodes         64                  // time checks), and limits for the corresponding
+#define maxPollNodes         100000              // node interval (see "Engine_Periodic").
+#define pvRowSize            (maxSearchDepth + 4)                        // PV table (one row
+#define pvTableSize          ((maxSearchDepth + 3)*pvRowSize)            // per node).
 
 enum DRAW_TYPE
 {
@@ -80,18 +88,20 @@ enum DRAW_TYPE
 /*                                                                                                */
 /**************************************************************************************************/
 
+#ifdef __engine_asm
 typedef struct
 {
    LONG lr;               // Link register (return address of calling routine)
    LONG sp;               // Stack pointer (SP = r1)  
    LONG gpr[7];           // rLocal1..rLocal7 (r25..r31)
 } CUTENV;
+#endif
 
 /*-------------------------------------- Draw Information ----------------------------------------*/
 
-typedef struct            // 8 bytes
+typedef struct            // 8 bytes (16 bytes with 64 bit keys)
 {
-   HKEY   hashKey;        // 32 bit hash key of position resulting from previous move.
+   HKEY   hashKey;        // Hash key of position resulting from previous move.
    INT    irr;            // Index in "DrawTab"/"Game" of latest irreversible move.
    INT    repCount;       // Repetition count: Number of times this position has
                           // occured previously.
@@ -191,16 +201,28 @@ typedef struct
    /* - - - - - - - - - - - - - - - - - - - - MISC - - - - - - - - - - - - - - - - - - - - - -*/
 
    MOVE     *bufStart;                   // Old top of sacrifice buffer.
+#ifdef __engine_asm
    CUTENV   cutEnv;                      // Long-jump environment. Is used to restore processor
                                          // state (i.e. registers r16..r31, SP and instruction
                                          // address) in case of cutoff.
+#else
+   BOOL     cutoff;                      // Cutoff at this node? If so the move generators return
+                                         // at once, and the node is exited (see "NodeSearch.c").
+#endif
 
    /* - - - - - - - - - - - - - - - - - TRANSPOSITION TABLES  - - - - - - - - - - - - - - - - */
 
    HKEY     hashKey;                     // Hashkey for this position (= drawData->hashKey)
+#ifdef __engine_asm
    TRANS    *trans1, *trans2,            // Transposition table entries of current position
                                          // (set by "ProbeTransTab" at "start" of node).
             *tmove;
+#else
+   TRANSBUCKET *trans;                   // Transposition table bucket of current position
+                                         // (set by "ProbeTransTab" at "start" of node).
+   ULONG64  tdata;                       // Copy of the entry data holding the refutation move.
+   HKEY     pawnKey;                     // Hashkey of the pawns only (set by "Evaluate").
+#endif
 
    /* - - - - - - - - - - - - - - - DEPTH DEPENDANT CONSTANTS - - - - - - - - - - - - - - - - */
 
@@ -226,12 +248,21 @@ typedef struct
             pawnDir;                     // Also in register "rPawnDir".
    INT      lastPiece, lastPiece_;
    ATTACK   *Attack, *Attack_;           // Also in registers "rAttack" and "rAttack_".
+#ifdef __engine_asm
    TRANS    *TransTab1, *TransTab2;      // Pointers to transposition tables of side to move.
+#else
+   TRANSBUCKET *TransTab;                // Pointer to transposition table of side to move.
+#endif
 
    /* - - - - - - - - - - - - - - - - - - BEST LINE - - - - - - - - - - - - - - - - - - - - - */
 
+#ifdef __engine_asm
    MOVE     BestLine[maxSearchDepth+3];  // Best line found so far during search of current node
-
+#else
+   MOVE     *BestLine;                   // Best line found so far during search of current node.
+                                         // Points into E->S.PVTable, which keeps the lines out
+                                         // of the nodes (so the nodes only hold the hot fields).
+#endif
 } NODE;
 
 /*--------------------------------------- Root Move list -----------------------------------------*/
@@ -243,6 +274,56 @@ typedef struct
    INT   val;                            // Search score for this move.
 } ROOTTAB;
 
+/*--------------------------------------- Search Statistics --------------------------------------*/
+// Optional instrumentation of the portable engine, which is only compiled if "__engine_stats" is
+// defined (otherwise the counters are left out and the "Stats_" macros compile to nothing). The
+// counters are kept by the master thread only, and are reset at the start of each search.
+
+#ifdef __engine_stats
+
+#ifdef __engine_asm
+   #error "The search statistics require the portable engine"
+#endif
+
+#define statsGenCount        16                  // Move generators gen_None..gen_Null (see
+#define statsGenRfm          14                  // "MoveGen.h"). The refutation move is searched
+                                                 // before the generators (N->gen = gen_None), and
+                                                 // is counted as gen_Rfm.
+typedef struct
+{
+   LONG64  tried;                                // Moves searched (legal and not pruned).
+   LONG64  pruned;                               // Moves discarded by the selection.
+   LONG64  cutoffs;                              // Beta cutoffs.
+   LONG64  firstCutoffs;                         // Beta cutoffs by the first move of the node.
+} GEN_STATS;
+
+typedef struct
+{
+   LONG64    nodes;                              // Calls to SearchNode() (excl. the root node).
+   LONG64    quiesNodes;                         // Quiescence nodes.
+   LONG64    transProbes;                        // Transposition table probes, entries found
+   LONG64    transHits;                          // and nodes cut off by the entry score.
+   LONG64    transCuts;
+   GEN_STATS Gen[statsGenCount];                 // Move counts per move generator.
+   INT       iterations;                         // Iterations started (= last mainDepth).
+   LONG64    iterStart;                          // moveCount at start of current iteration.
+   LONG64    IterMoves[maxSearchDepth + 1];      // Moves searched in each iteration [1..50].
+} SEARCH_STATS;
+
+#define Stats_Count(E,field)       (E)->S.Stats.field++
+#define Stats_Add(E,field,n)       (E)->S.Stats.field += (n)
+#define Stats_CountGen(E,N,field)  (E)->S.Stats.Gen[(N)->gen ? (N)->gen : statsGenRfm].field++
+#define Stats_AddGen(E,N,field,n)  (E)->S.Stats.Gen[(N)->gen ? (N)->gen : statsGenRfm].field += (n)
+
+#else
+
+#define Stats_Count(E,field)
+#define Stats_Add(E,field,n)
+#define Stats_CountGen(E,N,field)
+#define Stats_AddGen(E,N,field,n)
+
+#endif
+
 /*------------------------------------- SEARCH_STATE Data Structure ------------------------------*/
 
 typedef struct search_state
@@ -276,16 +357,31 @@ typedef struct search_state
    LONG64  nodeCount;                    // Nodes searched so far (calls to SearchNode()).
    LONG64  moveCount;                    // Moves searched so far (calls to SearchMove()).
    INT     hashFull;                     // Hash full (in permile)
+#ifndef __engine_asm
+   LONG64  pawnHashProbes;               // Pawn hash table probes/hits so far (this thread only).
+   LONG64  pawnHashHits;
+#endif
+#ifdef __engine_stats
+   SEARCH_STATS Stats;                   // Search statistics (see above).
+#endif
 
    BOOL    libMovesOnly;                 // Only library moves should be searched.
 
+   //--- Multi PV ---
+   INT     multiPVCount;                 // Number of lines searched (1 = normal search).
+   INT     pvCount;                      // Lines found so far in the current iteration.
+   INT     PVScore[maxMultiPV];          // Scores of these lines (in descending order).
+   MOVE    PVLine[maxMultiPV][maxSearchDepth + 3];   // The lines themselves (null move terminated).
+
    //--- Timers ---
    ULONG   startTime;                    // Timer() at start of search.
    ULONG   searchTime;                   // Number elapsed ticks (1/60th sec) at end of search.
    ULONG   mainTime;                     // Elapsed ticks until engine settled/decided on it's final move.
-   INT     periodicCounter;              // Limits number of calls to "Timer()" (which is VERY expensive under
-                                         // OS X!! Probably because it's an out-of-process system call).
-   ULONG   periodicTime;                 // Next "tick" where periodic stuff will be performed
+   LONG64  startMicroTime;               // MicroTimer() at start of search.
+   LONG    periodicCounter;              // Nodes left until next call to "Engine_Periodic()".
+   LONG    pollNodes;                    // Nodes between calls, adapted to the measured NPS so the
+                                         // clock is polled about every "pollMicroSecs".
+   LONG64  periodicTime;                 // Next MicroTimer() where periodic stuff will be performed
                                          // (e.g. Engine_CallBack and Task_Switch()).
    ULONG   uciNps;                       // NPS if UCI engine (Sigma does its own calculation)
 
@@ -301,6 +397,12 @@ typedef struct search_state
    CHAR    edbName[5];                   // "Passed" to host app via callback
    LONG    edbPos;                       // "Passed" to host app via callback
    INT     edbResult;                    // "Returned" from host app
+   LONG    edbProbes;                    // Number of database probes in this search, and
+   LONG64  edbMicroSecs;                 // their total duration (incl. host probes).
+#ifndef __engine_asm
+   BOOL    tbProbing;                    // Probe the WDL tablebases in the search?
+   LONG    tbHits;                       // Number of successful tablebase probes.
+#endif
 
    //--- ELO Strength Control ---
    INT     eloAdjust;                    // ELO adjustment (depending on time controls)
@@ -319,4 +421,7 @@ typedef struct search_state
    NODE    _Nodes[maxSearchDepth + 3];   // The actual search "tree". Should normally not be
                                          // accessed directly. Rather access should done via
                                          // "rootNode".
+#ifndef __engine_asm
+   MOVE    PVTable[pvTableSize];         // The best lines of the nodes (see InitSearchState).
+#endif
 } SEARCH_STATE;
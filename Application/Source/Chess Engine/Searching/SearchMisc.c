@@ -32,6 +32,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "SearchMisc.f"
 
+#ifdef __engine_asm
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -39,7 +41,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void UpdateBestLine (void)
+asm void UpdateBestLine (register ENGINE *_E, register NODE *_N)
 {
    addi    rTmp1, rNode,(NODE.BestLine - 4)                 // L1 = N->BestLine;
    lwz     rTmp4, move(piece)
@@ -73,7 +75,7 @@ asm void UpdateBestLine (void)
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void UpdateDrawState (void)
+asm void UpdateDrawState (register ENGINE *_E, register NODE *_N)
 {
    #define dt     rTmp10
    #define newkey rTmp9
@@ -249,7 +251,7 @@ asm void UpdateDrawState (void)
 // "Prepares" the killers by setting the "killerActive" flags and making sure the most popular
 // killer is searched first (i.e. "killer1").
 
-asm void PrepareKillers (void)
+asm void PrepareKillers (register ENGINE *_E, register NODE *_N)
 {
    lwz     rTmp1, node(check)                   // if (N->check || N->quies)
    lwz     rTmp3, node(killer1Count)
@@ -273,7 +275,7 @@ asm void PrepareKillers (void)
 // Each move must be compared against the killers and the refutation move, so we don't search a
 // move more than once.
 
-asm BOOL KillerRefCollision (void)
+asm BOOL KillerRefCollision (register ENGINE *_E, register NODE *_N)
 {
    lhz    rTmp1, node(killer1Active)
    lhz    rTmp2, node(killer2Active)
@@ -345,7 +347,7 @@ asm BOOL KillerRefCollision (void)
 // Updates the killer table upon exit from a node: If a killer worked again, its popularity count is
 // increased by 1. Otherwise replace "killer2" by the best move if it's a non capture or a sacrifice.
 
-asm void UpdateKillers (void)
+asm void UpdateKillers (register ENGINE *_E, register NODE *_N)
 {
    lwz     rTmp1, node(check)                // if (quies ||check || bestGen < killer1Gen)
    lhz     rTmp2, node(bestGen)              //    return;
@@ -396,3 +398,155 @@ asm void UpdateKillers (void)
    stw     rTmp9, node(killer1Count)         // }
    blr
 } /* UpdateKillers */
+
+#else
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                   PORTABLE SEARCH UTILITIES                                    */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#define sameMove(m1,m2) ((m1).from == (m2).from && (m1).to == (m2).to && (m1).piece == (m2).piece && \
+                         (m1).cap == (m2).cap && (m1).type == (m2).type)
+#define copyKiller(k,m) ((k).piece = (m).piece, (k).from = (m).from, (k).to = (m).to, \
+                         (k).cap = (m).cap, (k).type = (m).type, (k).dir = (m).dir)
+
+/*--------------------------------------- Update Best Line ---------------------------------------*/
+// The line of node k is stored from index k of a row of E->S.PVTable (see "InitSearchState"), so
+// inside the tree the node simply swaps rows with its child and puts N->m in front of the child's
+// line. The root node copies the line instead, since S->MainLine refers to its row.
+
+void UpdateBestLine (ENGINE *E, NODE *N)
+{
+   MOVE *L1 = N->BestLine;
+   MOVE *L2 = NN->BestLine;
+
+   if (N != E->S.rootNode)
+   {  NN->BestLine = L1 + 1;
+      N->BestLine  = L2 - 1;
+      L2[-1] = N->m;
+      return;
+   }
+
+   *(L1++) = N->m;
+   do
+      *(L1++) = *L2;
+   while (! isNull(*(L2++)));
+} /* UpdateBestLine */
+
+/*--------------------------------------- Update Draw State --------------------------------------*/
+
+void UpdateDrawState (ENGINE *E, NODE *N)
+{
+   HASHCODE_COMMON *H  = &(E->Global->H);
+   DRAWDATA        *dt = N->drawData;
+   MOVE            *pm = &(PN->m);
+   HKEY            key = (dt - 1)->hashKey;
+
+   N->drawType = drawType_None;
+
+   //--- Compute hash key for current position ---
+
+   key ^= H->HashCode[pm->piece][pm->from] ^ H->HashCode[pm->piece][pm->to];
+   if (pm->cap)
+      key ^= H->HashCode[pm->cap][pm->to];
+
+   if (pm->type != mtype_Normal)
+   {
+      if (pm->type & mtype_Promotion)
+         key ^= H->HashCode[pm->type][pm->to];
+      else if (pm->type == mtype_O_O)
+         key ^= (N->player == white ? H->o_oHashCodeB : H->o_oHashCodeW);
+      else if (pm->type == mtype_O_O_O)
+         key ^= (N->player == white ? H->o_o_oHashCodeB : H->o_o_oHashCodeW);
+      else
+         key ^= H->HashCode[N->player + pawn][pm->to + N->pawnDir];
+   }
+
+   dt->hashKey = N->hashKey = key;
+
+   //--- Update Draw State ---
+
+   if (pm->cap || pm->type != mtype_Normal || pieceType(pm->piece) == pawn)
+   {
+      ULONG pc = E->B.pieceCount;
+
+      dt->irr      = N->gameDepth;
+      dt->repCount = 0;
+      if (pc & 0xFE0FFE0F) return;                 // Exit if more than one B or N of either colour
+      if (! ((pc + (pc >> 16)) & 0x0E00))          // KK, KNK or KBK
+         N->drawType = drawType_InsuffMtrl;
+   }
+   else
+   {
+      INT rev = N->gameDepth - (dt->irr = (dt - 1)->irr);
+
+      if (rev >= 100)
+         N->drawType = drawType_50;
+      else
+      {
+         INT n = rev/2 - 1;
+         for (DRAWDATA *dt1 = dt - 2; n > 0; n--)
+            if ((dt1 -= 2)->hashKey == key)
+            {  N->drawType = dt->repCount = dt1->repCount + 1;
+               return;
+            }
+         dt->repCount = 0;
+      }
+   }
+} /* UpdateDrawState */
+
+/*--------------------------------------- Killer Handling ----------------------------------------*/
+
+void PrepareKillers (ENGINE *E, NODE *N)
+{
+   if (N->check || N->quies)
+      N->killer1Active = N->killer2Active = false;
+   else
+   {  N->killer1Active = (N->killer1Count != 0);
+      N->killer2Active = (N->killer2Count != 0);
+   }
+} /* PrepareKillers */
+
+
+BOOL KillerRefCollision (ENGINE *E, NODE *N)
+{
+   if (N->killer1Active && N->gen != gen_F1 && sameMove(N->m, N->killer1))
+   {
+      N->killer1Active = false;
+      if (N->gen > gen_F1) return true;
+   }
+   else if (N->killer2Active && N->gen != gen_F2 && sameMove(N->m, N->killer2))
+   {
+      N->killer2Active = false;
+      if (N->gen > gen_F2) return true;
+   }
+
+   return sameMove(N->m, N->rfm);
+} /* KillerRefCollision */
+
+
+void UpdateKillers (ENGINE *E, NODE *N)
+{
+   if (N->check || N->quies || N->bestGen < gen_F1 || N->bestGen == gen_G) return;
+
+   if (N->bestGen == gen_F1)
+      N->killer1Count++;
+   else if (N->bestGen == gen_F2)
+      N->killer2Count++;
+   else if (N->BestLine[0].to != PN->m.to)
+   {
+      if (N->killer1Count > N->killer2Count)
+      {  N->killer2Count = N->killer1Count;
+         copyKiller(N->killer2, N->killer1);
+      }
+      copyKiller(N->killer1, N->BestLine[0]);
+      N->killer1Count = 1;
+   }
+} /* UpdateKillers */
+
+#undef sameMove
+#undef copyKiller
+
+#endif
@@ -33,9 +33,22 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void UpdateBestLine     (void);
-asm void UpdateDrawState    (void);
+#ifdef __engine_asm
 
-asm void PrepareKillers     (void);
-asm BOOL KillerRefCollision (void);
-asm void UpdateKillers      (void);
+asm void UpdateBestLine     (register ENGINE *_E, register NODE *_N);
+asm void UpdateDrawState    (register ENGINE *_E, register NODE *_N);
+
+asm void PrepareKillers     (register ENGINE *_E, register NODE *_N);
+asm BOOL KillerRefCollision (register ENGINE *_E, register NODE *_N);
+asm void UpdateKillers      (register ENGINE *_E, register NODE *_N);
+
+#else
+
+void UpdateBestLine     (ENGINE *E, NODE *N);
+void UpdateDrawState    (ENGINE *E, NODE *N);
+
+void PrepareKillers     (ENGINE *E, NODE *N);
+BOOL KillerRefCollision (ENGINE *E, NODE *N);
+void UpdateKillers      (ENGINE *E, NODE *N);
+
+#endif
@@ -31,6 +31,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Selection.f"
 
+#ifdef __engine_asm
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -38,7 +40,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void ComputeSelBaseVal (void)
+asm void ComputeSelBaseVal (register ENGINE *_E, register NODE *_N)
 {
 @ENDGAME
    cmpi    cr5,0, rPlayer,white                 // if ("opponent has no officers and player has pawns")
@@ -91,7 +93,7 @@ asm void ComputeSelBaseVal (void)
 
 static asm BOOL Turbulent (register INT mval);
 
-asm BOOL SelectMove (void)
+asm BOOL SelectMove (register ENGINE *_E, register NODE *_N)
 {
    #define diff  rTmp10
 
@@ -575,3 +577,200 @@ static asm BOOL IndirectThreat (register ATTACK qrbAtt)
 /*------------------------------------------------------------------------------------------------*/
 
 #undef tp
+
+#else
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                    PORTABLE (C) VERSIONS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// C versions of the above selection routines (identical semantics).
+
+/*--------------------------------- Computing Selective Base Value -------------------------------*/
+
+void ComputeSelBaseVal (ENGINE *E, NODE *N)
+{
+   ULONG pieceCount = E->B.pieceCount;
+   BOOL  noSelection;
+
+   if (N->player == white)                         // Turn off selection if "opponent has no
+      noSelection = (! (pieceCount & 0xFFF00000) && (pieceCount & 0x0000000F)) ||
+                    E->B.PawnStructW[6];           // officers and player has pawns", or if
+   else                                            // "player has pawns on 7th".
+      noSelection = (! (pieceCount & 0x0000FFF0) && (pieceCount & 0x000F0000)) ||
+                    E->B.PawnStructB[1];
+
+   if (noSelection)
+   {
+      N->selMargin = maxVal;
+   }
+   else
+   {
+      N->selMargin = E->P.selMargin*(N->ply - 1);
+      if (PN->escapeSq >= 0 && PN->m.from != PN->escapeSq && N->Attack[PN->escapeSq])
+         N->selMargin += PN->threatEval;
+   }
+} /* ComputeSelBaseVal */
+
+/*---------------------------------------- Forward Prune Moves -----------------------------------*/
+
+static BOOL Turbulent (ENGINE *E, NODE *N, LONG mval);
+
+BOOL SelectMove (ENGINE *E, NODE *N)
+{
+   LONG diff;
+
+   //--- Never prune special moves ---
+
+   if (N->m.type || N->gen == gen_J) return true;
+
+   //--- Calc evaluation difference ---
+
+   diff = N->selMargin - NN->totalEval - N->alpha;
+   if (N->m.cap) diff += 40 - N->capSelVal;
+   if (pieceType(N->m.piece) == pawn) diff += 35;
+
+   if (diff > 0) return true;
+   return Turbulent(E, N, -diff);
+} /* SelectMove */
+
+/*---------------------------------------- Turbulence Checking -----------------------------------*/
+
+static BOOL DirectThreat (ENGINE *E, NODE *N, PIECE tp);
+static BOOL IndirectThreat (ENGINE *E, NODE *N, PIECE tp, ATTACK qrb);
+
+static BOOL Turbulent (ENGINE *E, NODE *N, LONG mval)
+{
+   PIECE  tp;
+   ATTACK a;
+
+   if (mval <= 350)
+      tp = (mval < 150 ? pawn : knight);
+   else
+      tp = (mval < 550 ? rook : (mval < 950 ? queen : king));
+   tp += black - N->player;                        // tp = enemy(tp);
+
+   if (DirectThreat(E, N, tp)) return true;
+
+   a = N->Attack[N->m.from] & qrbMask;
+   return (a && IndirectThreat(E, N, tp, a));
+} /* Turbulent */
+
+/*------------------------------------------ Direct Threats --------------------------------------*/
+// Scans from "to" in the direction "dir" and checks if the first piece hit is an enemy piece in
+// the range tp..pmax, which is either worth at least "pfree" or is undefended.
+
+static BOOL ScanThreatQRB (ENGINE *E, NODE *N, SQUARE to, SQUARE dir, PIECE tp, PIECE pmax, PIECE pfree)
+{
+   PIECE  *Board = E->B.Board;
+   SQUARE sq     = to;
+   PIECE  p;
+
+   while ((p = Board[sq += dir]) == empty);
+   return (p >= tp && p <= pmax && (p >= pfree || ! N->Attack_[sq]));
+} /* ScanThreatQRB */
+
+
+static BOOL DirectThreat (ENGINE *E, NODE *N, PIECE tp)
+{
+   GLOBAL *G     = E->Global;
+   SQUARE to     = N->m.to;
+   PIECE  *B     = &E->B.Board[to];
+   ATTACK *A     = &N->Attack_[to];
+   PIECE  eKing  = king + black - N->player;
+   PIECE  p;
+   SQUARE dir;
+
+   if (G->V.Closeness[to - N->PieceLoc_[0]] >= 7) return true;
+
+   switch (pieceType(N->m.piece))
+   {
+      case pawn :
+         // NB: Tests bit 2 of the source square (like the assembler version).
+         if ((((to - N->pawnDir) & 0x04) << 2) != N->player) return true;
+         B += N->pawnDir;
+         A += N->pawnDir;
+         for (INT i = -1; i <= 1; i += 2)
+         {  p = B[i];
+            if (p >= tp && p <= eKing && (p >= eKing - 4 || ! A[i])) return true;
+         }
+         break;
+
+      case knight :
+         for (INT i = 0; i < 8; i++)
+         {  dir = G->B.KnightDir[i];
+            p = B[dir];
+            if (p >= tp && p <= eKing && (p >= eKing - 2 || ! A[dir])) return true;
+         }
+         break;
+
+      case bishop :
+      case rook :
+         if (tp <= eKing - 1 && (*A & (pieceType(N->m.piece) == bishop ? 0x0F : 0xF0))) return true;
+         {
+            PIECE pfree = (pieceType(N->m.piece) == bishop ? eKing - 2 : eKing - 1);
+
+            dir = N->m.dir;
+            if (N->m.cap && ScanThreatQRB(E, N, to, dir, tp, eKing, pfree)) return true;
+            dir = G->B.Turn90[dir];
+            if (ScanThreatQRB(E, N, to, dir, tp, eKing, pfree)) return true;
+            if (ScanThreatQRB(E, N, to, -dir, tp, eKing, pfree)) return true;
+         }
+         break;
+
+      case queen :
+         for (INT i = 0; (dir = G->B.QueenDir[i]); i++)
+         {  if (dir == N->m.dir ? ! N->m.cap : dir == -N->m.dir) continue;
+            if (ScanThreatQRB(E, N, to, dir, tp, eKing, eKing)) return true;
+         }
+         break;
+
+      case king :
+         if (tp > eKing - 2) break;
+         for (INT i = 0; i < 8; i++)
+         {  dir = G->B.KingDir[i];
+            p = B[dir];
+            if (p >= tp && p <= eKing - 2 && ! A[dir]) return true;
+         }
+   }
+
+   return false;
+} /* DirectThreat */
+
+/*----------------------------------------- Indirect Threats -------------------------------------*/
+// Checks if "N->m" poses an indirect threat (i.e. if moving the piece uncovers an attack by a
+// friendly queen, rook or bishop). "qrb" = Attack[m->from] & qrbMask.
+
+static BOOL IndirectThreat (ENGINE *E, NODE *N, PIECE tp, ATTACK qrb)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   PIECE  eKing  = king + black - N->player;
+
+   for (INT bits = qrbBits(qrb); bits; )
+   {
+      QRB_DATA *q   = &G->M.QRBdata[bits];
+      SQUARE   adir = q->dir;
+      SQUARE   sq   = N->m.from;
+      PIECE    ip;
+
+      bits ^= bit(G->A.LowBit[bits]);
+      if (adir == N->m.dir || adir == -N->m.dir) continue;
+
+      while ((ip = Board[sq += adir]) == empty);
+      if (ip < tp || ip > eKing) continue;
+      if (ip == eKing || ! N->Attack_[sq]) return true;
+
+      switch (pieceType(ip))
+      {
+         case queen : if (qrb & rbMask & q->rayBit) return true; break;
+         case rook  : if (qrb & bMask & q->rayBit) return true; break;
+      }
+   }
+
+   return false;
+} /* IndirectThreat */
+
+#endif
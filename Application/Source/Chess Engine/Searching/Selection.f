@@ -33,5 +33,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void ComputeSelBaseVal (void);
-asm BOOL SelectMove        (void);
+#ifdef __engine_asm
+asm void ComputeSelBaseVal (register ENGINE *_E, register NODE *_N);
+asm BOOL SelectMove        (register ENGINE *_E, register NODE *_N);
+#else
+void ComputeSelBaseVal (ENGINE *E, NODE *N);
+BOOL SelectMove        (ENGINE *E, NODE *N);
+#endif
@@ -38,11 +38,13 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
+#ifdef __engine_asm
+
 static asm void AnalyzeThreats0 (void);
 static asm void AnalyzeThreats1 (void);
 static asm void AnalyzeThreats2 (void);
 
-asm void AnalyzeThreats (void)
+asm void AnalyzeThreats (register ENGINE *_E, register NODE *_N)
 {
    lhz     rTmp1, node(quies)                  // if (! N->quies)
    lhz     rTmp2, node(check)
@@ -356,3 +358,145 @@ asm void AnalyzeThreats2 (void)
    #undef PL
    #undef sq
 } /* AnalyzeThreats2 */
+
+#else
+
+static void AnalyzeThreats0 (ENGINE *E, NODE *N);
+static void AnalyzeThreats1 (ENGINE *E, NODE *N);
+static void AnalyzeThreats2 (ENGINE *E, NODE *N);
+
+void AnalyzeThreats (ENGINE *E, NODE *N)
+{
+   if (! N->quies)
+   {
+      if (! N->check)
+         AnalyzeThreats0(E, N);
+      else
+      {  N->threatEval = maxVal;
+         N->escapeSq   = nullSq;
+      }
+   }
+   else if (N->maxPly > 0)
+      AnalyzeThreats1(E, N);
+   else
+      AnalyzeThreats2(E, N);
+} /* AnalyzeThreats */
+
+/*--------------------------------------- Full Width Analysis ------------------------------------*/
+
+static void AnalyzeThreats0 (ENGINE *E, NODE *N)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   SQUARE *AL    = N->ALoc;
+   SQUARE *SL    = N->SLoc;
+   SQUARE tsq    = nullSq;
+   INT    tply   = 1;
+   INT    tval   = 0;
+   ATTACK ka     = 0;
+
+   for (INT i = 1; i <= N->lastPiece; i++)
+   {
+      SQUARE sq = N->PieceLoc[i];
+      ATTACK a;
+
+      if (sq < 0) continue;
+
+      if (! (a = N->Attack_[sq]))
+         *(SL++) = sq;
+      else if (tsq != nullSq)
+         *(AL++) = sq;
+      else if (a & G->A.SmattMask[Board[sq]])
+         tsq = sq, tply = 0;
+      else if (! N->Attack[sq])                   // Attacked but not defended
+         tsq = sq;
+      else
+         *(AL++) = sq;
+   }
+
+   *AL = *SL = nullSq;
+   N->eply     = tply;
+   N->escapeSq = tsq;
+
+   if (tsq != nullSq)
+      tval = G->B.Mtrl100[Board[tsq]];
+
+   if (N->player == white ? (E->B.PawnStructB[1] | E->B.PawnStructB[2])   // Opponent has far pawns
+                          : (E->B.PawnStructW[5] | E->B.PawnStructW[6]))
+      tval += 900;
+
+   for (INT i = 0; i < 8; i++)                     // Mate threat if more than one attack on the
+      ka |= N->Attack_[N->PieceLoc[0] + G->B.KingDir[i]];   // squares around the king.
+   if (ka & (ka - 1))
+      tval = maxVal;
+
+   N->threatEval = tval;
+} /* AnalyzeThreats0 */
+
+/*------------------------------- Quiescence Analysis incl. Escapes ------------------------------*/
+
+static void AnalyzeThreats1 (ENGINE *E, NODE *N)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+   INT    tval   = 0;
+
+   N->escapeSq = nullSq;
+   N->eply     = 1;
+
+   for (INT i = 1; i <= N->lastPiece; i++)
+   {
+      SQUARE sq = N->PieceLoc[i];
+      ATTACK a;
+
+      if (sq < 0 || ! (a = N->Attack_[sq])) continue;
+
+      if (tval == 0)
+      {
+         if ((a &= G->A.SmattMask[Board[sq]]))
+         {
+            INT smattMtrl = (a & pMask ? pawnMtrl : (a & bnMask ? knightMtrl : rookMtrl));
+
+            N->threatEval = 100*(G->B.Mtrl[Board[sq]] - smattMtrl);
+            N->escapeSq   = sq;
+            N->eply       = 0;
+            return;
+         }
+         else if (! N->Attack[sq])
+            tval = N->hungVal1;
+      }
+      else if (! N->Attack[sq] || (a & G->A.SmattMask[Board[sq]]))
+      {
+         tval = N->hungVal2;
+         break;
+      }
+   }
+
+   N->threatEval = tval;
+} /* AnalyzeThreats1 */
+
+/*------------------------------- Quiescence Analysis excl. Escapes ------------------------------*/
+// NB: The first hung piece found (i.e. attacked by a smaller piece) sets "threatEval" to hungVal2
+// (exactly as the assembler version, whose "tval == 0" test reads the wrong condition field).
+
+static void AnalyzeThreats2 (ENGINE *E, NODE *N)
+{
+   GLOBAL *G     = E->Global;
+   PIECE  *Board = E->B.Board;
+
+   N->escapeSq   = nullSq;
+   N->eply       = 1;
+   N->threatEval = 0;
+
+   for (INT i = 1; i <= N->lastPiece; i++)
+   {
+      SQUARE sq = N->PieceLoc[i];
+
+      if (sq >= 0 && (N->Attack_[sq] & G->A.SmattMask[Board[sq]]))
+      {  N->threatEval = N->hungVal2;
+         return;
+      }
+   }
+} /* AnalyzeThreats2 */
+
+#endif
@@ -33,4 +33,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-asm void AnalyzeThreats (void);
+#ifdef __engine_asm
+asm void AnalyzeThreats (register ENGINE *_E, register NODE *_N);
+#else
+void AnalyzeThreats (ENGINE *E, NODE *N);
+#endif
@@ -0,0 +1,135 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : TRACE.C                                                                              */
+/* Purpose : Search trace recorder (portable engine only). Records node entries/exits of a search */
+/*           into a ring buffer supplied by the host, e.g. for profiling deep searches offline.   */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Engine.h"
+
+#include "Trace.f"
+#include "Time.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          TRACE CLOCK                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// See "Trace.h".
+
+#ifndef __engine_asm
+
+void Trace_BeginSearch (ENGINE *E)
+{
+   TRACE *T = E->P.Trace;
+
+   if (! T) return;
+
+   T->count          = 0;
+   T->startMicroTime = MicroTimer();
+   T->startTime      = TraceClock();
+} /* Trace_BeginSearch */
+
+
+void Trace_EndSearch (ENGINE *E)
+{
+   TRACE *T = E->P.Trace;
+
+   if (! T) return;
+
+   T->endTime      = TraceClock();
+   T->endMicroTime = MicroTimer();
+} /* Trace_EndSearch */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          RECORD EVENTS                                         */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static inline TRACE_EVENT *NewEvent (TRACE *T, INT kind, INT depth)
+{
+   ULONG64     n = T->count++;
+   TRACE_EVENT *e = &T->Events[n & T->mask];
+
+   if (! (n & (traceStampInterval - 1)))
+      e->time = (ULONG)((TraceClock() - T->startTime) >> traceClockShift);
+   e->kind  = kind;
+   e->depth = depth;
+   return e;
+} /* NewEvent */
+
+
+static inline void SetEventMove (TRACE_EVENT *e, MOVE *m, INT gen)
+{
+   e->gen   = gen | (pieceType(m->type & mtype_Promotion) << 4);
+   e->piece = m->piece;
+   e->from  = m->from;
+   e->to    = m->to;
+} /* SetEventMove */
+
+
+void Trace_Iteration (ENGINE *E)
+{
+   if (! E->P.Trace) return;
+
+   TRACE_EVENT *e = NewEvent(E->P.Trace, trace_Iteration, E->S.mainDepth);
+
+   e->gen   = gen_None;
+   e->piece = empty;
+   e->from  = 0;
+   e->to    = 0;
+   e->alpha = E->S.rootNode->alpha;
+   e->beta  = E->S.rootNode->beta;
+   e->value = E->S.prevScore;
+} /* Trace_Iteration */
+
+
+void TraceEnter (ENGINE *E, NODE *N)               // The move leading to the node is PN->m.
+{
+   TRACE_EVENT *e = NewEvent(E->P.Trace, trace_Enter, N->depth);
+
+   SetEventMove(e, &PN->m, PN->gen);
+   e->alpha = N->alpha0;
+   e->beta  = N->beta;
+   e->value = N->ply;
+} /* TraceEnter */
+
+
+void TraceExit (ENGINE *E, NODE *N, INT kind)      // The best (or cutoff) move is BestLine[0].
+{
+   TRACE_EVENT *e = NewEvent(E->P.Trace, kind, N->depth);
+
+   SetEventMove(e, &N->BestLine[0], (isNull(N->BestLine[0]) ? (INT)gen_None : N->bestGen));
+   e->value = N->score;
+} /* TraceExit */
+
+#endif
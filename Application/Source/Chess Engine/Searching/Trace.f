@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "Engine.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & MACROS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The recorder is only called if tracing is enabled for the search (i.e. E->P.Trace != nil). The
+// assembler engine doesn't support tracing.
+
+#ifndef __engine_asm
+   #define Trace_Enter(E,N)      if ((E)->P.Trace) TraceEnter(E, N)
+   #define Trace_Exit(E,N,kind)  if ((E)->P.Trace) TraceExit(E, N, kind)
+#else
+   #define Trace_Enter(E,N)
+   #define Trace_Exit(E,N,kind)
+   #define Trace_BeginSearch(E)
+   #define Trace_EndSearch(E)
+   #define Trace_Iteration(E)
+#endif
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          FUNCTION PROTOTYPES                                   */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#ifndef __engine_asm
+void Trace_BeginSearch (ENGINE *E);
+void Trace_EndSearch (ENGINE *E);
+void Trace_Iteration (ENGINE *E);
+void TraceEnter (ENGINE *E, NODE *N);
+void TraceExit (ENGINE *E, NODE *N, INT kind);
+#endif
@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "General.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & MACROS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Trace event kinds. A node is entered with a "trace_Enter" event and left with one of the exit
+// events (which give the reason the node was exited):
+
+enum TRACE_EVENT_KIND
+{
+   trace_Iteration = 1,       // Start of new iteration (depth = main depth).
+   trace_Enter     = 2,       // Node entered.
+   trace_Exit      = 3,       // Node exited after searching all moves (fail low or true score).
+   trace_Cutoff    = 4,       // Beta cutoff (by the move/generator of the event).
+   trace_TransCut  = 5,       // Transposition table cutoff.
+   trace_Draw      = 6,       // Draw by repetition or the 50 move rule.
+   trace_Leaf      = 7,       // Bottom node or mate depth reached (static evaluation).
+   trace_StandPat  = 8,       // Stand pat cutoff in quiescence search.
+   trace_Tablebase = 9        // Endgame tablebase hit.
+};
+
+#define traceIsExit(kind)     ((kind) >= trace_Exit)
+
+// The trace clock must be very cheap to read (MicroTimer() would slow down the search noticeably).
+// On x86 the CPU time stamp counter is used instead, which the host then converts to micro seconds
+// using the MicroTimer() values at the start/end of the search. Even so, reading the clock costs
+// more than recording the rest of an event, so only every traceStampInterval'th event is time
+// stamped, and the times of the events in between are interpolated (see "TraceDump.c"). The time
+// stamps hold the clock relative to the start of the search in units of 2^traceClockShift ticks
+// (32 bits, i.e. about 20 s between two time stamps with a 3 GHz counter).
+
+#define traceStampInterval  8
+
+#if defined(__x86_64__) || defined(__i386__)
+   #define TraceClock()     ((LONG64)__builtin_ia32_rdtsc())
+   #define traceClockShift  4
+#else
+   #define TraceClock()     MicroTimer()
+   #define traceClockShift  0
+#endif
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        TYPE DEFINITIONS                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// A search trace is recorded into a ring buffer of fixed size TRACE_EVENT records, which is
+// allocated by the host and passed to the engine via PARAM.Trace. If the buffer overflows, the
+// oldest events are overwritten (i.e. only the last part of the search is kept). See "Trace.c".
+
+typedef struct            // 16 bytes
+{
+   ULONG  time;           // Trace clock (see traceClockShift), if the number of the event in the
+                          // search is a multiple of traceStampInterval.
+   BYTE   kind;           // Event kind (trace_Iteration, trace_Enter or an exit event).
+   BYTE   depth;          // Node depth (N->depth), or main depth if trace_Iteration.
+   BYTE   gen;            // Move generator (bit 0..3, see "MoveGen.h") and promotion piece
+                          // type (bit 4..6, 0 if none) of the move below.
+   BYTE   piece;          // Move leading to the node (enter), or the best/cutoff move (exit).
+   BYTE   from;           // The piece is "empty" if there is no move.
+   BYTE   to;
+   INT    alpha;          // Search window (N->alpha0, N->beta). Enter/Iteration events only.
+   INT    beta;
+   INT    value;          // Remaining nominal depth (N->ply) if enter, otherwise the score.
+} TRACE_EVENT;
+
+#define traceEventPromotion(e) ((e)->gen >> 4 ? ((e)->piece & black) | ((e)->gen >> 4) : empty)
+
+typedef struct
+{
+   TRACE_EVENT *Events;                  // The ring buffer.
+   ULONG64     mask;                     // Capacity - 1 (the capacity must be a power of 2).
+   ULONG64     count;                    // Events recorded in the search (incl. overwritten).
+   LONG64      startTime, endTime;       // Trace clock at start/end of search, and the
+   LONG64      startMicroTime,           // corresponding MicroTimer() values (for converting
+               endMicroTime;             // the trace clock to micro seconds).
+} TRACE;
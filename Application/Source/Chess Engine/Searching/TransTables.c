@@ -44,6 +44,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // the specified engine (in the engine parameter block). Additionally, the transposition table
 // pointers in the search nodes are initialized.
 
+#ifdef __engine_asm
+
 void CalcTransState (ENGINE *E)                  
 {
    TRANS_STATE *T = &E->Tr;
@@ -153,6 +155,12 @@ asm void ResetTransTab (ENGINE *E)
 } /* ResetTransTab */
 
 
+INT TransTabUsage (ENGINE *E)                    // Fraction of the entries used (in permille).
+{
+   return (INT)((1000*(LONG64)E->Tr.transUsed)/E->Tr.transSize);
+} /* TransTabUsage */
+
+
 /**************************************************************************************************/
 /*                                                                                                */
 /*                                      PROBE TRANSPOSITION TABLE                                 */
@@ -170,7 +178,7 @@ asm void ResetTransTab (ENGINE *E)
 // move exists, then rfm.piece = the moving piece, and the reset of the rfm fields are subsequently
 // set by "GetTransMove" (which may then NOT be called if rfm.piece = empty).
 
-asm BOOL ProbeTransTab (void)
+asm BOOL ProbeTransTab (register ENGINE *_E, register NODE *_N)
 {
    #define hashkey  rTmp10
    #define hashmask rTmp5
@@ -343,7 +351,7 @@ asm BOOL ProbeTransTab (void)
 // may be searched (i.e. if it is both pseudo-legal and applicable at the current node). If so, the
 // move is stored in "rfm". May NOT be called if rfm is a null move (i.e. if rfm.piece = empty).
 
-asm BOOL GetTransMove (void)
+asm BOOL GetTransMove (register ENGINE *_E, register NODE *_N)
 {
    #define tm        rTmp10
    #define tfrom     rTmp9
@@ -461,7 +469,7 @@ asm BOOL GetTransMove (void)
 // Stores the current position (score, ply counters, flags, best move) in the transposition table,
 // thus overriding the previous entry.
 
-asm void StoreTransTab (void)
+asm void StoreTransTab (register ENGINE *_E, register NODE *_N)
 {
    #define trn      rTmp10
    #define thashkey rTmp9
@@ -588,3 +596,282 @@ asm void StoreTransTab (void)
    #undef bgen
 
 } /* StoreTransTab */
+
+#else
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                PORTABLE TRANSPOSITION TABLE ACCESS                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The portable routines use 2 tables (one for each side to move) of cache line aligned buckets
+// holding 4 entries each (see "TransTables.h"). The "key" field of an entry is the full hash key
+// XOR'ed with the "data" field, so an entry torn by a concurrent store from another search thread
+// fails the key check and is ignored. Entries of previous searches (generations) still provide
+// refutation moves, but their scores are never used (the evaluation depends on the root position,
+// e.g. the piece value tables).
+//
+// The entries only hold the low order bits of the generation, so their age is computed modulo
+// trans_GenMask + 1 (see "transAge"), and the tables are never cleared once allocated. Old entries
+// are replaced first, but an entry which survives trans_GenMask + 1 searches without being
+// replaced is taken for a current one (its score is then merely slightly stale).
+
+#define transScore(d)   ((INT)(d))
+#define transPly(d)     ((signed char)((d) >> 16))
+#define transMaxPly(d)  ((signed char)((d) >> 24))
+#define transFrom(d)    ((SQUARE)(((d) >> 32) & 0xFF))
+#define transTo(d)      ((SQUARE)(((d) >> 40) & 0xFF))
+#define transFlags(d)   ((ULONG)((d) >> trans_FlagsShift) & 0x07FF)
+#define transGen(d)     ((INT)((d) >> trans_GenShift))
+#define transAge(T,d)   ((INT)(((T)->generation - transGen(d)) & trans_GenMask))
+
+#define trans_MoveMask  (trans_ShQuiesBit | trans_DPlyMask | trans_CapMask | trans_PieceMask)
+
+/*-------------------------------------- Calc Trans State ----------------------------------------*/
+
+void CalcTransState (ENGINE *E)
+{
+   TRANS_STATE *T = &E->Tr;
+
+   BYTE    *tab = (BYTE*)E->P.TransTables;               // Align tables on cache line boundary.
+   ULONG   skip = (64 - ((size_t)tab & 63)) & 63;
+   ULONG64 free = (tab && E->P.transSize > skip ? (E->P.transSize - skip)/sizeof(TRANSBUCKET) : 0);
+   HKEY    n    = ((HKEY)1 << 10);                       // Minimum number of buckets per table.
+
+   if (2*n > free)                                       // A minimum of 2*2^10 buckets are required.
+   {
+      T->transTabOn    = false;
+
+      T->transSize     = 0;
+      T->hashIndexMask = 0;
+      T->generation    = 0;
+      T->resume        = false;
+
+      T->TransTabW     = nil;
+      T->TransTabB     = nil;
+   }
+   else
+   {
+      T->transTabOn = true;
+
+      while (4*n <= free) n *= 2;                         // Calc the number of buckets per table.
+
+      TRANSBUCKET *TabW = (TRANSBUCKET*)(tab + skip);
+      if (TabW != T->TransTabW || n - 1 != T->hashIndexMask)
+      {  T->generation = 0;                               // New tables must be cleared.
+         T->resume     = false;
+      }
+
+      T->transSize     = 2*n*trans_BucketSize;
+      T->hashIndexMask = n - 1;
+      T->TransTabW     = TabW;
+      T->TransTabB     = TabW + n;
+   }
+
+   for (INT d = 0; d <= maxSearchDepth + 2; d++)       // Finally update search nodes.
+      E->S.whiteNode[d - 2].TransTab = (even(d) ? T->TransTabW : T->TransTabB);
+} /* CalcTransState */
+
+/*---------------------------------- Reset Transposition Tables ----------------------------------*/
+// Starts a new generation, which invalidates the scores of all existing entries. The tables are
+// only cleared when they are new. A resumed snapshot (see "Engine_ResumeTransTab") simply
+// continues its generation.
+
+void ResetTransTab (ENGINE *E)
+{
+   TRANS_STATE *T = &E->Tr;
+
+   if (! T->transTabOn) return;
+
+   if (T->resume && T->generation > 0)
+      T->resume = false;
+   else
+   {  if (T->generation == 0)
+         memset(T->TransTabW, 0, T->transSize*sizeof(TRANS));
+      T->generation++;
+   }
+} /* ResetTransTab */
+
+/*------------------------------------------ Usage -----------------------------------------------*/
+// Returns the fraction (in permille) of entries used by the current generation. Since the tables
+// are shared by the SMP helpers, this is estimated from the first 1000 entries rather than counted
+// by each search thread (the tables hold at least 8192 entries, see "CalcTransState").
+
+INT TransTabUsage (ENGINE *E)
+{
+   TRANS_STATE *T = &E->Tr;
+   TRANS       *t = T->TransTabW->Entry;
+   INT         used = 0;
+
+   for (INT i = 0; i < 1000; i++, t++)
+   {  ULONG64 data = t->data;
+      if (data && transAge(T, data) == 0) used++;
+   }
+   return used;
+} /* TransTabUsage */
+
+/*---------------------------------------- Probe Trans Table -------------------------------------*/
+
+static BOOL ProbeTransEntry (ENGINE *E, NODE *N, ULONG64 data)
+{
+   ULONG flags = transFlags(data);
+
+   if (transAge(&E->Tr, data) == 0 &&
+       transPly(data) >= N->ply && transMaxPly(data) >= N->maxPly)
+   {
+      INT score = transScore(data);
+
+      if (score >= mateWinVal) score -= N->depth;
+      else if (score <= mateLoseVal) score += N->depth;
+      N->score = score;
+
+      if (flags & trans_TrueScoreBit) return true;
+      else if (flags & trans_CutoffBit) { if (score >= N->beta) return true; }
+      else if (score <= N->alpha0) return true;
+   }
+
+   if (flags & trans_PieceMask)
+   {  N->tdata = data;
+      N->rfm.piece = (flags & trans_PieceMask) + N->player;
+   }
+   return false;
+} /* ProbeTransEntry */
+
+
+BOOL ProbeTransTab (ENGINE *E, NODE *N)
+{
+   N->trans = N->TransTab + (N->hashKey & E->Tr.hashIndexMask);
+
+   if (! (E->R.rflags & rflag_TransTabOn) || N->drawType != drawType_None)
+   {  if (! N->pvNode) clrMove(N->rfm);
+      return false;
+   }
+   if (N->pvNode) return false;
+
+   clrMove(N->rfm);
+   Stats_Count(E, transProbes);
+
+   TRANS *t = N->trans->Entry;
+   for (INT i = 0; i < trans_BucketSize; i++, t++)
+   {
+      ULONG64 data = t->data;
+      if (data && (t->key ^ data) == N->hashKey)
+      {  Stats_Count(E, transHits);
+         return ProbeTransEntry(E, N, data);
+      }
+   }
+   return false;
+} /* ProbeTransTab */
+
+/*----------------------------------------- Get Trans Move ---------------------------------------*/
+// NB: Non-capturing pawn moves are always rejected (exactly as in the assembler version, whose
+// "front square empty" test checks the wrong condition field).
+
+BOOL GetTransMove (ENGINE *E, NODE *N)
+{
+   ULONG64 data  = N->tdata;
+   PIECE   *Board = E->B.Board;
+   MOVE    *m     = &N->rfm;
+   ULONG   flags  = transFlags(data);
+   INT     adir;
+
+   if (flags & trans_CapMask)
+      m->cap = ((flags & trans_CapMask) >> 3) + black - N->player;
+   else if (N->quies && (N->maxPly == 0 || ! (flags & trans_ShQuiesBit)))
+      goto NullM;
+   else
+      m->cap = empty;
+
+   m->from = transFrom(data);
+   m->to   = transTo(data);
+   m->dply = (flags & trans_DPlyMask) >> 6;
+   m->type = mtype_Normal;
+   m->dir  = E->Global->A.AttackDir[m->to - m->from] >> 5;
+
+   if (Board[m->from] != m->piece || Board[m->to] != m->cap)     // (rfm.piece set by Probe).
+      goto NullM;
+
+   // The move must also fit the piece, since a matching key doesn't guarantee that the entry
+   // belongs to the current position (hash collisions).
+
+   adir = E->Global->A.AttackDir[m->to - m->from];
+
+   switch (pieceType(m->piece))
+   {
+      case knight : if (adir & nDirMask) return true; break;
+      case pawn   : if (m->cap && (adir & E->Global->A.AttackDirMask[m->piece])) return true; break;
+      case king   : if (m->from + m->dir == m->to && ! N->Attack_[m->to]) return true; break;
+      default     :
+         if (! (adir & E->Global->A.AttackDirMask[m->piece])) goto NullM;
+         for (SQUARE sq = m->from + m->dir; sq != m->to; sq += m->dir)
+            if (Board[sq] != empty) goto NullM;
+         return true;
+   }
+
+NullM:
+   clrMove(*m);
+   return false;
+} /* GetTransMove */
+
+/*---------------------------------------- Store Trans Table -------------------------------------*/
+// Overwrites the entry of the same position if present. Otherwise the entry with the lowest
+// "ply" is replaced, where entries of older generations count as 8 plies lower per generation
+// (of age, see "transAge").
+
+void StoreTransTab (ENGINE *E, NODE *N)
+{
+   if (! (E->R.rflags & rflag_TransTabOn) || N->drawType != drawType_None) return;
+
+   TRANS_STATE *T   = &E->Tr;
+   ULONG64     key  = N->hashKey;
+   TRANS       *t   = N->trans->Entry, *r = t;
+   ULONG64     old  = 0;
+   INT         rval = maxVal;
+
+   for (INT i = 0; i < trans_BucketSize; i++, t++)
+   {
+      ULONG64 data = t->data;
+      if (data && (t->key ^ data) == key) { r = t, old = data; break; }
+
+      INT val = (data ? transPly(data) - 8*transAge(T, data) : -maxVal);
+      if (val < rval) r = t, rval = val;
+   }
+
+   ULONG flags = 0;
+   INT   score;
+
+   if (N->score >= N->beta)
+      flags |= trans_CutoffBit, score = N->beta;
+   else if (N->score > N->alpha0)
+      flags |= trans_TrueScoreBit, score = N->score;
+   else
+      score = N->alpha0;
+
+   if (score >= mateWinVal) score += N->depth;
+   else if (score <= mateLoseVal) score -= N->depth;
+
+   ULONG64 move = 0;
+   MOVE    *m   = &N->BestLine[0];
+
+   if (pieceType(m->piece) != empty && m->type == mtype_Normal)
+   {
+      move   = ((ULONG64)(BYTE)m->from << 32) | ((ULONG64)(BYTE)m->to << 40);
+      flags |= pieceType(m->piece) | ((m->cap << 3) & trans_CapMask) | ((m->dply << 6) & trans_DPlyMask);
+      if (N->bestGen == gen_E || N->bestGen == gen_J)
+         flags |= trans_ShQuiesBit;
+   }
+   else if (transFlags(old) & trans_PieceMask)            // Keep the move of the same position.
+   {
+      move   = old & 0x0000FFFF00000000ULL;
+      flags |= transFlags(old) & trans_MoveMask;
+   }
+
+   ULONG64 data = (ULONG64)(UINT)score | ((ULONG64)(BYTE)N->ply << 16) |
+                  ((ULONG64)(BYTE)N->maxPly << 24) | move |
+                  ((ULONG64)flags << trans_FlagsShift) | ((ULONG64)(T->generation & trans_GenMask) << trans_GenShift);
+   r->key  = key ^ data;
+   r->data = data;
+} /* StoreTransTab */
+
+#endif
@@ -34,9 +34,23 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /**************************************************************************************************/
 
 void CalcTransState (ENGINE *E);
+INT  TransTabUsage (ENGINE *E);
+
+#ifdef __engine_asm
+
 asm void ResetTransTab  (ENGINE *E);
 
-asm BOOL ProbeTransTab  (void);
-asm BOOL GetTransMove   (void);
-asm void StoreTransTab  (void);
+asm BOOL ProbeTransTab  (register ENGINE *_E, register NODE *_N);
+asm BOOL GetTransMove   (register ENGINE *_E, register NODE *_N);
+asm void StoreTransTab  (register ENGINE *_E, register NODE *_N);
+
+#else
+
+void ResetTransTab  (ENGINE *E);
+
+BOOL ProbeTransTab  (ENGINE *E, NODE *N);
+BOOL GetTransMove   (ENGINE *E, NODE *N);
+void StoreTransTab  (ENGINE *E, NODE *N);
+
+#endif
 
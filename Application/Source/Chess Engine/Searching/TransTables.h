@@ -33,9 +33,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /*                                                                                                */
 /**************************************************************************************************/
 
-#define trans_MinSize  (10*4*(1L << 11))
+#define trans_MinSize  (sizeof(TRANS)*4*(1L << 11))
 
-// Transposition record layout (10 bytes):
+// Transposition record layout of the assembler version (10 bytes):
 //
 //  BYTE 0..3 : HKEY + flags (and m.piece & m.cap)
 //    Bit 0..20  (31..9) : The "rest" of hash key, used after indexing/lookup to verify hashing.
@@ -74,6 +74,29 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define trans_CapMask              0x0038  // Bit  26..28
 #define trans_PieceMask            0x0007  // Bit  29..31
 
+// Transposition record layout of the portable version (16 bytes). The entries are grouped in
+// cache line aligned buckets of 4 entries, which are indexed by the low order part of the hash
+// key:
+//
+//  key  : The FULL hash key XOR'ed with "data". An entry is only accepted if "key ^ data" equals
+//          the hash key of the position, so entries torn by concurrent stores from SMP helper
+//          threads are simply ignored (no locking needed).
+//
+//  data : Bit  0..15 : score of stored position
+//          Bit 16..23 : ply of stored position
+//          Bit 24..31 : maxPly of stored position
+//          Bit 32..39 : from square of stored move
+//          Bit 40..47 : to square of stored move
+//          Bit 48..58 : flags, m.piece & m.cap (trans_ShQuiesBit...trans_PieceMask as above)
+//          Bit 59..63 : generation (search number & trans_GenMask) of entry
+//
+//          An empty entry has data = 0.
+
+#define trans_BucketSize              4     // Entries per bucket (64 bytes)
+#define trans_FlagsShift             48
+#define trans_GenShift               59
+#define trans_GenMask                31
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -83,6 +106,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 /*--------------------------------- Transposition Table Entries ----------------------------------*/
 
+#ifdef __engine_asm
+
 typedef struct   /* 10 bytes */
 {
    BYTE data[10];
@@ -94,21 +119,53 @@ typedef struct   /* 10 bytes */
 */
 } TRANS;
 
+typedef LONG TRANSCOUNT;
+
+#else
+
+typedef LONG64 TRANSCOUNT;                    // Entry counts (may exceed 2^31).
+
+typedef struct   /* 16 bytes */
+{
+   ULONG64 key;                               // Hash key ^ data.
+   ULONG64 data;
+} TRANS;
+
+typedef struct   /* 64 bytes (must be aligned on cache line boundary) */
+{
+   TRANS   Entry[trans_BucketSize];
+} TRANSBUCKET;
+
+#endif
+
 /*--------------------------------- Transposition Table Pointers ---------------------------------*/
 
 typedef struct
 {
    BOOL  transTabOn;                          // Use transposition tables?
 
-   LONG  transSize;                           // Total number of ENTRIES in all 4 tables. Must
+   TRANSCOUNT transSize;                      // Total number of ENTRIES in all 4 tables. Must
                                               // be a power of 2 and at least 8192 (= 4*2^11).
    HKEY  hashIndexMask;                       // Bit mask masking out the low order index bits
                                               // ( 11 bits). Is equal to (transSize/4) - 1.
-   LONG  transUsed;                           // Number of used transposition entries
+#ifdef __engine_asm
+   TRANSCOUNT transUsed;                      // Number of used transposition entries
    TRANS *TransTab1W, *TransTab1B;            // The transposition tables which are indexed by
    TRANS *TransTab2W, *TransTab2B;            // (the loworder part of) the hash key. In table 1,
                                               // entries are only overridden if the "ply"-field
                                               // is lower. Entries are always overridden in table
                                               // 2. Both tables are divided in two parts: one for
                                               // each colour (side to move).
+#else
+   TRANSBUCKET *TransTabW, *TransTabB;        // The bucket tables (one for each side to move),
+                                              // which are indexed by (the loworder part of) the
+                                              // hash key. Here "transSize" is the number of
+                                              // entries and "hashIndexMask" the number of
+                                              // buckets - 1 of each table.
+   LONG  generation;                          // Current generation (1, 2, ...), which is
+                                              // incremented by "ResetTransTab" at the start of
+                                              // each search (0 = tables must be cleared).
+   BOOL  resume;                              // Continue current generation in next search
+                                              // (reloaded snapshot)?
+#endif
 } TRANS_STATE;
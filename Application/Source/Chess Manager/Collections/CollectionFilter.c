@@ -249,7 +249,7 @@ static BOOL Filter_PosExact (POS_FILTER *pf, CGame *game)
       }
 
       // Check if position matches on hash key and side to move. If so verify by doing a real
-      // board compare.
+      // board compare (the application's hash keys are 32 bit, see "HashCode.h").
 
       if (j >= jmin && hkey == pf->hkey &&
           (pf->sideToMove == posFilter_Any || pf->sideToMove == game->player))
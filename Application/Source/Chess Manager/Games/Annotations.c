@@ -30,9 +30,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "Annotations.h"
-#include "CUtility.h"
 #include "CMemory.h"
+#ifndef __sigma_headless
+#include "CUtility.h"
 #include "CFont.h"
+#endif
 
 
 INT AnnCharWidth[256];
@@ -274,10 +276,15 @@ INT WrapLines (CHAR *Text, INT charCount, INT CharWidth[], INT maxLineWidth, INT
 
 void InitAnnotationModule (void)
 {
+#ifdef __sigma_headless
+   for (INT c = 32; c < 256; c++)        // No fonts: Wrap as if Geneva 10 were fixed pitch.
+      AnnCharWidth[c] = 6;
+#else
    CFont font(font_Geneva, fontStyle_Plain, 10);
 
    for (INT c = 32; c < 256; c++)
       AnnCharWidth[c] = font.ChrWidth(c);
+#endif
 
 // AnnCharWidth['\t'] = 10;
 } /* InitAnnotationModule */
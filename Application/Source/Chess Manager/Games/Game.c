@@ -38,15 +38,19 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Game.h"
 #include "GameUtil.h"
-#include "Pgn.h"
+#include "PGN.h"
 #include "Annotations.h"
+#ifndef __sigma_headless
 #include "SigmaPrefs.h"
+#endif
 
 #include "Board.f"
 #include "Move.f"
 #include "HashCode.f"
 
+#ifndef __sigma_headless
 #include "PosLibrary.h"
+#endif
 
 /*----------------------------------------- Data Structures --------------------------------------*/
 // The engine only defines one global variable: The "Global" data structure which contains
@@ -196,7 +200,11 @@ void CGame::ClearGameInfo (void)                   // Clears game info completel
 
 void ResetGameInfo (GAMEINFO *Info)
 {
+#ifdef __sigma_headless
+   ClearGameInfo(Info);                  // No prefs file in the headless tools.
+#else
    *Info = Prefs.gameInfo;
+#endif
 } /* ResetGameInfo */
 
 
@@ -786,10 +794,15 @@ INT CGame::CalcGameResult (void)
       return result_Draw50;
    
    // Next check draw by repetition. This is done by looking back through the game record (in
-   // the draw information) at every second position and comparing hash keys:
+   // the draw information) at every second position and comparing hash keys (32 bit keys must
+   // also be verified by comparing the boards):
 
    for (INT n = 4; n <= revCount; n += 2)
+#ifdef __hkey64
+      if (D->hashKey == (D-n)->hashKey)                            // Position found!
+#else
       if (D->hashKey == (D-n)->hashKey && VerifyRepetition(n))    // Position found!
+#endif
       {
          D->repCount = (D-n)->repCount + 1;      // Increase repetition count.
          if (D->repCount == 2)                   // If position occured 2 times earlier, it's a
@@ -840,7 +853,7 @@ BOOL CGame::UpdateInfoResult (void)
 void CGame::CalcStatusStr (CHAR *str)   // Max length 100 chars
 {
    CHAR plStr[10];
-   CopyStr((player == white ? "White" : "Black"), plStr);
+   CopyStr((CHAR*)(player == white ? "White" : "Black"), plStr);
 
    if (! GameOver())
       Format(str, "%s to move", plStr);
@@ -1207,6 +1220,8 @@ void CGame::CalcCheckFlags (void)                   // This routine sets the che
 /*                                                                                                */
 /**************************************************************************************************/
 
+#ifndef __sigma_headless    // The game map is only used for displaying/printing the game record.
+
 INT CGame::CalcGameMap (INT toMove, GAMEMAP GMap[], BOOL isPrinting, BOOL isCollectionGame, BOOL isPublishing)
 {
    INT N = InsertGameMapHeader(GMap, isPrinting, isCollectionGame, isPublishing);
@@ -1326,6 +1341,8 @@ BOOL CGame::GameMapContainsDiagram (GAMEMAP GMap[], INT N)
    return SameStr(s, "[DIAGRAM]");
 } /* CGame::GameMapContainsDiagram */
 
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -1336,5 +1353,7 @@ BOOL CGame::GameMapContainsDiagram (GAMEMAP GMap[], INT N)
 void InitGameModule (void)
 {
    SetGameNotation("PNBRQK", moveNot_Short);
+#ifndef __sigma_headless
    InitGameFile5();
+#endif
 } /* InitGameModule */
@@ -31,7 +31,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Game.h"
 #include "Board.f"
-#include "Pgn.h"
+#include "PGN.h"
 
 
 /**************************************************************************************************/
@@ -37,7 +37,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "GameUtil.h"
+#ifndef __sigma_headless
 #include "SigmaPrefs.h"
+#endif
 
 #include "Board.f"
 #include "Move.f"
@@ -625,5 +627,9 @@ BOOL ParseScoreStr (CHAR s[], INT *score)   // Format: [
 
 INT CheckAbsScore (COLOUR player, INT score)
 {
+#ifdef __sigma_headless
+   return score;                         // Default prefs (scoreNot_NumRel).
+#else
    return (Prefs.AnalysisFormat.scoreNot != scoreNot_NumRel && player == black ? -score : score);
+#endif
 } /* CheckAbsScore */
@@ -293,6 +293,12 @@ PosLibrary::PosLibrary (CFile *libFile)
       {  delete file;
          file = nil;
       }
+      else if ((lib->flags & libFormat_Mask) > libFormat_Current)   // Created by a later version.
+      {  Mem_FreePtr((PTR)lib);
+         lib = nil;
+         delete file;
+         file = nil;
+      }
    }
 
    if (! file)
@@ -302,7 +308,7 @@ PosLibrary::PosLibrary (CFile *libFile)
       if (! lib) return;
 
       lib->info[0] = 0;
-      lib->flags   = 0;
+      lib->flags   = libFormat_Current;
       for (INT i = 0; i < 32; i++) lib->unused[i] = 0;
 
       lib->size = sizeof(LIBRARY);
@@ -341,6 +347,7 @@ LIB_CLASS PosLibrary::FindPos (COLOUR player, HKEY pos)
 BOOL PosLibrary::FindAux (COLOUR player, HKEY pos, CHAR eco[], CHAR comment[])
 {
    LIB_AUX *Data = libAuxData(player);
+   pos = libKey(pos);
 
    LONG count = (player == white ? lib->wAuxCount : lib->bAuxCount);
    LONG min   = 0;
@@ -403,6 +410,7 @@ BOOL PosLibrary::ClassifyPos (COLOUR player, HKEY pos, LIB_CLASS libClass, BOOL
 BOOL PosLibrary::AddPos (COLOUR player, HKEY pos, LIB_CLASS libClass, BOOL overwrite)
 {
    LIB_POS *Data = libPosData(player);
+   pos = libKey(pos);
 
    LONG count = (player == white ? lib->wPosCount : lib->bPosCount);
    LONG min   = 0;
@@ -438,6 +446,7 @@ BOOL PosLibrary::AddPos (COLOUR player, HKEY pos, LIB_CLASS libClass, BOOL overw
 BOOL PosLibrary::DelPos (COLOUR player, HKEY pos)
 {
    LIB_POS *Data = libPosData(player);
+   pos = libKey(pos);
 
    LONG count = (player == white ? lib->wPosCount : lib->bPosCount);
    LONG min   = 0;
@@ -465,6 +474,7 @@ BOOL PosLibrary::DelPos (COLOUR player, HKEY pos)
 BOOL PosLibrary::AddAux (COLOUR player, HKEY pos, CHAR eco[], CHAR comment[])
 {
    LIB_AUX *Data = libAuxData(player);
+   pos = libKey(pos);
 
    LONG count = (player == white ? lib->wAuxCount : lib->bAuxCount);
    LONG min   = 0;
@@ -498,6 +508,7 @@ storeAux:
 BOOL PosLibrary::DelAux (COLOUR player, HKEY pos)
 {
    LIB_AUX *Data = libAuxData(player);
+   pos = libKey(pos);
 
    LONG count = (player == white ? lib->wAuxCount : lib->bAuxCount);
    LONG min   = 0;
@@ -735,7 +746,7 @@ void PosLibrary::Lib5_Import (LIBRARY5 *lib5)
    //--- Initialize size, and position count stats ---
    lib->size = size6;
    lib->info[0] = 0;
-   lib->flags   = 0;
+   lib->flags   = libFormat_Current;
    for (INT i = 0; i < 32; i++) lib->unused[i] = 0;
 
    lib->wPosCount = lib5->wPosCount;
@@ -785,7 +796,7 @@ static void Lib5_Append (CFile *file)   // Simply appends all LIB positions to c
    if (file->Load(&bytes, &data) == fileError_NoError && data)
    {
       LIBRARY5* lib5 = (LIBRARY5*)data;
-      HKEY *Pos = (HKEY*)lib5->Data;
+      ULONG *Pos = (ULONG*)lib5->Data;
    
       for (INT i = 0; i < lib5->wPosCount; i++)
          posLib->ClassifyPos(white, *(Pos++), libClass_Level, false);
@@ -926,10 +937,17 @@ void PosLib_Open (CFile *file, BOOL displayPrompt)
    switch (file->fileType)
    {
       case 'LB6' :
+      {  PosLibrary *newPosLib = new PosLibrary(file);
+         if (! newPosLib->file)                 // Failed loading (or format not supported), so
+         {  delete newPosLib;                   // keep the current library.
+            NoteDialog(nil, "Error", "Failed loading the library. It may have been created by a later version of Sigma Chess...", cdialogIcon_Error);
+            return;
+         }
          if (posLib) delete posLib;
-         posLib = new PosLibrary(file);
+         posLib = newPosLib;
          sigmaApp->BroadcastMessage(msg_RefreshPosLib);
          break;
+      }
 
       case 'LB5' :
 #ifdef __libTest_AppendV5
@@ -109,11 +109,12 @@ LONG Level_CalcTotalTime (LEVEL *L, COLOUR player)
 LONG Level_CheckTimeControl (LEVEL *L, COLOUR player, INT played)
 {
    LONG extraTime = 0;
+   INT  limit, limit1, limit2;
 
    switch (L->mode)
    {
       case pmode_TimeMoves :
-         INT limit = L->TimeMoves.moves;
+         limit = L->TimeMoves.moves;
          if (limit != allMoves && played % limit == 0)
             extraTime += L->TimeMoves.time;
          if (L->TimeMoves.clockType == clock_Fischer)
@@ -121,8 +122,8 @@ LONG Level_CheckTimeControl (LEVEL *L, COLOUR player, INT played)
          break;
 
       case pmode_Tournament :
-         INT limit1 = L->Tournament.moves[0];
-         INT limit2 = L->Tournament.moves[1] + limit1;
+         limit1 = L->Tournament.moves[0];
+         limit2 = L->Tournament.moves[1] + limit1;
          if (played == limit1)
             extraTime += (player == white ? L->Tournament.wtime[1] : L->Tournament.btime[1]);
          else if (played == limit2)
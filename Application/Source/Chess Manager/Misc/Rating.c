@@ -124,11 +124,17 @@ INT Score_to_ELO (REAL score)  // score : [0..1] --> diff : [-1000..1000]
 
 REAL ELO_to_Score (INT diff)   // diff : [-1000..1000] --> score : [0..1]
 {
+   return ExpectedScore(diff);
+} /* ELO_to_Score */
+
+
+REAL ExpectedScore (REAL diff)  // As ELO_to_Score, but for fractional ELO differences (e.g. the
+{                               // SPRT bounds).
    if (diff >= 1000) return 1.0;
    else if (diff <= -1000) return 0.0;
 
-   return 1.0/(1.0 + pow(10.0,-((REAL)diff)/400.0));
-} /* ELO_to_Score */
+   return 1.0/(1.0 + pow(10.0,-diff/400.0));
+} /* ExpectedScore */
 
 
 INT UpdateELO (INT playerELO, INT opponentELO, REAL actualScore)  // actualScore [0..1]
@@ -146,3 +152,63 @@ INT UpdateELO (INT playerELO, INT opponentELO, REAL actualScore)  // actualScore
    return playerELO + K*((REAL)actualScore - expectedScore);
 } /* UpdateELO */
 
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                     PENTANOMIAL STATISTICS                                     */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Engine matches are played in game pairs (same opening, colours reversed), and "Penta[i]" is the
+// number of pairs in which the player scored i half points (i = 0..4). Since the two games of a
+// pair are correlated, the variance is computed from the pair scores rather than the game scores.
+
+static LONG PentaStats (LONG Penta[], REAL *score, REAL *var)   // Returns number of pairs, and
+{                                                               // the mean/variance of the pair
+   LONG pairs = 0;                                              // score (per game, i.e. [0..1]).
+   REAL sum = 0.0, sum2 = 0.0;
+
+   for (INT i = 0; i < pentaCount; i++)
+   {  pairs += Penta[i];
+      sum   += Penta[i]*(i/4.0);
+      sum2  += Penta[i]*(i/4.0)*(i/4.0);
+   }
+
+   *score = (pairs > 0 ? sum/pairs : 0.5);
+   *var   = (pairs > 0 ? sum2/pairs - (*score)*(*score) : 0.0);
+   return pairs;
+} /* PentaStats */
+
+
+INT Penta_ELO (LONG Penta[], INT *margin)   // Returns ELO difference and 95% confidence margin.
+{
+   REAL score, var;
+   LONG pairs = PentaStats(Penta, &score, &var);
+   REAL se    = (pairs > 0 && var > 0.0 ? sqrt(var/pairs) : 0.0);
+
+   *margin = (Score_to_ELO(score + 1.96*se) - Score_to_ELO(score - 1.96*se))/2;
+   return Score_to_ELO(score);
+} /* Penta_ELO */
+
+/*------------------------------------------- SPRT -----------------------------------------------*/
+// Sequential probability ratio test of H0 : "ELO difference = elo0" against H1 : "ELO difference
+// = elo1". The log likelihood ratio uses the normal approximation of the pair score (as the
+// Fishtest GSPRT), and the test stops when the LLR leaves the [lower, upper] interval (accepting
+// H0 below and H1 above). "alpha" and "beta" are the false positive and false negative rates.
+
+REAL Penta_LLR (LONG Penta[], REAL elo0, REAL elo1)
+{
+   REAL score, var;
+   LONG pairs = PentaStats(Penta, &score, &var);
+   REAL s0 = ExpectedScore(elo0), s1 = ExpectedScore(elo1);
+
+   if (pairs == 0 || var <= 0.0) return 0.0;   // E.g. only drawn pairs.
+   return pairs*(s1 - s0)*(2*score - s0 - s1)/(2*var);
+} /* Penta_LLR */
+
+
+void SPRT_Bounds (REAL alpha, REAL beta, REAL *lower, REAL *upper)
+{
+   *lower = log(beta/(1.0 - alpha));
+   *upper = log((1.0 - beta)/alpha);
+} /* SPRT_Bounds */
@@ -14,6 +14,8 @@
 #define kSigmaMinELO 1200
 #define kSigmaMaxELO 2500
 
+#define pentaCount   5    // Pentanomial outcomes of a game pair (0..4 half points).
+
 enum RATING_INDEX
 {
    rating_White = 0,
@@ -88,4 +90,9 @@ void UpdatePlayerRating (PLAYER_RATING *PR, BOOL playerWasWhite, REAL playerScor
 
 INT  Score_to_ELO (REAL score);
 REAL ELO_to_Score (INT diff);
+REAL ExpectedScore (REAL diff);
 INT  UpdateELO (INT playerELO, INT opponentELO, REAL actualScore);
+
+INT  Penta_ELO (LONG Penta[], INT *margin);
+REAL Penta_LLR (LONG Penta[], REAL elo0, REAL elo1);
+void SPRT_Bounds (REAL alpha, REAL beta, REAL *lower, REAL *upper);
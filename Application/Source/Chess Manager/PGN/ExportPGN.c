@@ -29,7 +29,9 @@ IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISI
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#ifndef __sigma_headless
 #include "SigmaPrefs.h"
+#endif
 #include "PGN.h"
 #include "Board.f"
 
@@ -98,10 +100,12 @@ LONG CPgn::WriteGame (CHAR *pgnBuf)
       WriteStr("\n");
    bufSize = pos;
 
-   // Mac newline converter:
+   // Mac newline converter (the headless tools write Unix text files):
+#ifndef __sigma_headless
    if (true)      //###
       for (LONG i = 0; i < bufSize; i++)
          if (buf[i] == 0x0A) buf[i] = 0x0D;
+#endif
 
    return bufSize;
 } /* CPgn::Write */
@@ -131,7 +135,7 @@ void CPgn::WriteTagSection (void)
 
    WriteTagStr("Event", game->Info.event);
    WriteTagStr("Site",  game->Info.site);
-   WriteTagStr("Date",  StrLen(game->Info.date) == 10 ? game->Info.date : "????.??.??");
+   WriteTagStr("Date",  StrLen(game->Info.date) == 10 ? game->Info.date : (CHAR*)"????.??.??");
    WriteTagStr("Round", game->Info.round);
    WriteTagStr("White", game->Info.whiteName);
    WriteTagStr("Black", game->Info.blackName);
@@ -302,7 +306,7 @@ void CPgn::WriteMoveNo (INT i, COLOUR player, BOOL forceWrite)
 {
    if (player == white || forceWrite)
    {  WriteInt(game->Init.moveNo + (game->Init.player == black ? i : i-1)/2);
-      WriteStr(player == white ? "." : "...");
+      WriteStr((CHAR*)(player == white ? "." : "..."));
       if (! (flags & pgnFlag_SkipMoveSep))
          WriteChar(' ');
    }
@@ -377,7 +381,7 @@ void CPgn::WriteAnnText (INT j)
       // Replace illegal/unwanted ascii chars with blanks:
       for (INT i = 0; i < charCount; i++, pos++)
       {  BYTE c = buf[pos];                                               // Important to be unsigned char
-         if (Prefs.PGN.keepNewLines && IsNewLine(c))
+         if (pgnKeepNewLines && IsNewLine(c))
             buf[pos] = '\n';
          else if (c < 32 || /*(c >= 128 && c <= 159) Sigma 6.1.4 bug fix ||*/ c == '{' || c == '}')
             buf[pos] = ' ';
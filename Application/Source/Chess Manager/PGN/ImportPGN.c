@@ -29,7 +29,9 @@ IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISI
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#ifndef __sigma_headless
 #include "SigmaPrefs.h"
+#endif
 #include "PGN.h"
 #include "Board.f"
 
@@ -682,7 +684,7 @@ BOOL CPgn::ParseAnnotation (BOOL keep)      // Read and store annotation record.
 //          SkipStringToken(); break;
          case '}' :
             if (keep && ! (flags & pgnFlag_SkipAnn))
-               game->SetAnnotation(game->currMove, (CHAR*)&buf[pos0], pos - pos0 - 1, ! Prefs.PGN.keepNewLines);
+               game->SetAnnotation(game->currMove, (CHAR*)&buf[pos0], pos - pos0 - 1, ! pgnKeepNewLines);
             return StripWhiteSpace();
       }
 
@@ -56,6 +56,12 @@ enum PGN_ERROR
 #define maxPGNLineLength   1000
 #define backSlash          0x5C
 
+#ifdef __sigma_headless
+#define pgnKeepNewLines    false                  // No prefs file in the headless tools.
+#else
+#define pgnKeepNewLines    Prefs.PGN.keepNewLines
+#endif
+
 
 /**************************************************************************************************/
 /*                                                                                                */
@@ -0,0 +1,582 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : ANNOTATE.C                                                                           */
+/* Purpose : Headless batch annotator. Analyzes the games of a PGN file in parallel (one engine   */
+/*           instance per worker thread) and writes the annotated games to a new PGN file.        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "EngineHost.h"
+#include "GameUtil.h"
+#include "PGN.h"
+
+#include "Engine.f"
+#include "Move.f"
+#include "Time.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The games are annotated exactly as by "Analyze Collection" in the application (see
+// "AnalyzeGameCol.c"), i.e. each position is searched for a fixed time and the actual move is
+// annotated with the engine's preferred line (and a "?" or "??" glyph) if it loses at least
+// "scoreLimit" compared with the best move. Existing annotations are removed. The options
+// correspond to the "Prefs.AutoAnalysis" settings (with the same defaults), and the annotation
+// text uses the default analysis format.
+//
+// Each worker thread owns an engine instance and repeatedly takes the next game from the shared
+// work queue. Finished games are written to the output file in the original order, so an
+// interrupted run can be resumed ("-resume") by skipping the games already in the output file.
+// Games that can't be parsed are copied unchanged.
+
+#define annTextSize    1000                        // Max annotation length.
+
+typedef struct
+{
+   LONG   start, size;                             // Location of the game in the PGN file.
+   CHAR   *out;                                    // Resulting PGN text.
+   LONG   outSize;
+   BOOL   done;                                    // Ready to be written?
+   BOOL   valid;                                   // Could the game be parsed?
+   INT    annCount;                                // Number of annotated moves.
+} ANN_GAME;
+
+typedef struct
+{
+   CHAR     *pgnFile, *outFile;
+   INT      depth;                                 // Fixed depth per position (if > 0), else
+   LONG     timeMS;                                // fixed time per position (milliseconds).
+   INT      engines;                               // Engine instances (worker threads).
+   INT      threads;                               // Search threads per engine instance.
+   ULONG64  hashBytes;                             // Transposition table size per instance.
+   BOOL     resume;                                // Skip games already in the output file?
+
+   BOOL     skipWhitePos, skipBlackPos;            // Prefs.AutoAnalysis settings.
+   BOOL     skipMatching;
+   BOOL     skipLowScore;
+   INT      scoreLimit;
+
+   CHAR     *pgn;                                  // The PGN file.
+   LONG     pgnSize;
+   INT      count;                                 // Number of games in the PGN file.
+   ANN_GAME *Game;
+   INT      next;                                  // Work queue (index of next game).
+   INT      nextOut;                               // Index of next game to write.
+   INT      first;                                 // First game to annotate (if resumed).
+   FILE     *out;
+   LONG64   startMicroSecs;
+   pthread_mutex_t lock;                           // Protects the queue, output and CGame resets.
+   INT      result;                                // Exit status.
+} ANNOTATOR;
+
+typedef struct
+{
+   ANNOTATOR *A;
+   ENGINE    *E;
+   CGame     *game;
+   pthread_t thread;
+} WORKER;
+
+typedef struct                                     // Search result of a game position (the
+{                                                  // relevant subset of ANALYSIS_STATE).
+   COLOUR player;
+   INT    gameMove;
+   INT    score;
+   MOVE   PV[maxSearchDepth + 1];
+} ANALYSIS;
+
+static BOOL   LoadGames       (ANNOTATOR *A);
+static BOOL   OpenOutput      (ANNOTATOR *A);
+static void   Annotate        (ANNOTATOR *A);
+static void   *WorkerThread   (void *data);
+static void   AnnotateGame    (WORKER *W, ANN_GAME *g);
+static void   AnalyzeMove     (WORKER *W, ANALYSIS *Prev, ANALYSIS *Analysis, INT move0, INT *annCount);
+static INT    BuildAnnotation (CGame *game, ANALYSIS *Analysis, CHAR *Text, BOOL includeAltScore, INT altScore);
+static void   CopyGame        (ANNOTATOR *A, ANN_GAME *g);
+static void   WriteGames      (ANNOTATOR *A);
+static void   Usage           (void);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          MAIN PROGRAM                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (int argc, char *argv[])
+{
+   ANNOTATOR A;
+
+   memset(&A, 0, sizeof(ANNOTATOR));
+   A.timeMS       = 5000;                          // Prefs.AutoAnalysis defaults.
+   A.engines      = 1;
+   A.threads      = 1;
+   A.hashBytes    = 16L*1024L*1024L;
+   A.skipMatching = true;
+   A.skipLowScore = true;
+   A.scoreLimit   = 25;
+
+   for (INT i = 1; i < argc; i++)
+      if (EqualStr(argv[i], "-depth") && i + 1 < argc)
+         A.depth = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-time") && i + 1 < argc)
+         A.timeMS = atol(argv[++i]), A.depth = 0;
+      else if (EqualStr(argv[i], "-engines") && i + 1 < argc)
+         A.engines = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-threads") && i + 1 < argc)
+         A.threads = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-hash") && i + 1 < argc)
+         A.hashBytes = (ULONG64)atoi(argv[++i])*1024L*1024L;
+      else if (EqualStr(argv[i], "-limit") && i + 1 < argc)
+         A.scoreLimit = atoi(argv[++i]), A.skipLowScore = true;
+      else if (EqualStr(argv[i], "-nolimit"))
+         A.skipLowScore = false;
+      else if (EqualStr(argv[i], "-matching"))
+         A.skipMatching = false;
+      else if (EqualStr(argv[i], "-skipwhite"))
+         A.skipWhitePos = true;
+      else if (EqualStr(argv[i], "-skipblack"))
+         A.skipBlackPos = true;
+      else if (EqualStr(argv[i], "-resume"))
+         A.resume = true;
+      else if (argv[i][0] == '-' || A.outFile)
+      {  Usage();
+         return 2;
+      }
+      else if (! A.pgnFile)
+         A.pgnFile = argv[i];
+      else
+         A.outFile = argv[i];
+
+   if (! A.outFile || A.depth < 0 || A.depth >= maxSearchDepth || (A.depth == 0 && A.timeMS <= 0) ||
+       A.engines < 1 || A.engines > maxEngines || A.threads < 1 || A.threads > maxSearchThreads)
+   {  Usage();
+      return 2;
+   }
+
+   Host_InitSystem();
+   if (! LoadGames(&A) || ! OpenOutput(&A))
+      A.result = 1;
+   else
+   {  Annotate(&A);
+      if (fclose(A.out) != 0)
+      {  fprintf(stderr, "sigma-annotate: cannot write \"%s\"\n", A.outFile);
+         A.result = 1;
+      }
+   }
+   Host_EndSystem();
+
+   free(A.Game);
+   free(A.pgn);
+   return A.result;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-annotate [-time ms | -depth n] [-engines n] [-threads n] [-hash mb]\n");
+   fprintf(stderr, "                      [-limit cp | -nolimit] [-matching] [-skipwhite] [-skipblack]\n");
+   fprintf(stderr, "                      [-resume] in.pgn out.pgn\n");
+} /* Usage */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           LOAD GAMES                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static BOOL LoadGames (ANNOTATOR *A)
+{
+   LONG *Start;
+
+   if (! (A->pgn = Host_ReadFile(A->pgnFile, &A->pgnSize)))
+   {  fprintf(stderr, "sigma-annotate: cannot read \"%s\"\n", A->pgnFile);
+      return false;
+   }
+
+   A->count = Host_SplitPGN(A->pgn, A->pgnSize, &Start);
+   if (A->count == 0)
+   {  fprintf(stderr, "sigma-annotate: no games found in \"%s\"\n", A->pgnFile);
+      return false;
+   }
+
+   A->Game = (ANN_GAME*)calloc(A->count, sizeof(ANN_GAME));
+   for (INT i = 0; i < A->count; i++)
+   {  A->Game[i].start = Start[i];
+      A->Game[i].size  = (i + 1 < A->count ? Start[i + 1] : A->pgnSize) - Start[i];
+   }
+   free(Start);
+   return true;
+} /* LoadGames */
+
+/*------------------------------------------ Resuming --------------------------------------------*/
+// Every game is written with a trailing blank line (and flushed), so a game at the end of the
+// output file without one was only partially written when the run was interrupted. It's removed
+// and annotated again.
+
+static BOOL OpenOutput (ANNOTATOR *A)
+{
+   CHAR *text;
+   LONG size, *Start;
+
+   if (A->resume && (text = Host_ReadFile(A->outFile, &size)))
+   {
+      INT  total = Host_SplitPGN(text, size, &Start), count = total;
+      LONG end   = 0;
+
+      if (count > 0 && (size < 2 || text[size - 1] != '\n' || text[size - 2] != '\n'))
+         count--;
+      if (count > A->count)
+         count = A->count;
+      if (count > 0)                               // Keep the separating blank line.
+      {  end = (count < total ? Start[count] : size);
+         while (end < size && IsNewLine(text[end])) end++;
+      }
+
+      free(Start);
+      free(text);
+
+      if (truncate(A->outFile, end) != 0)
+      {  fprintf(stderr, "sigma-annotate: cannot resume \"%s\"\n", A->outFile);
+         return false;
+      }
+      A->first = count;
+      A->out   = fopen(A->outFile, "ab");
+   }
+   else
+      A->out = fopen(A->outFile, "wb");
+
+   if (! A->out)
+   {  fprintf(stderr, "sigma-annotate: cannot create \"%s\"\n", A->outFile);
+      return false;
+   }
+   return true;
+} /* OpenOutput */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           ANNOTATE                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void Annotate (ANNOTATOR *A)
+{
+   INT    n = Min(A->engines, A->count - A->first);
+   WORKER *W = (WORKER*)calloc(Max(n, 1), sizeof(WORKER));
+
+   A->next = A->nextOut = A->first;
+
+   if (A->depth > 0)
+      printf("Sigma Chess annotation (%d games, depth %d, %d x %d threads, hash %lu MB)\n", A->count, A->depth, n, A->threads, (unsigned long)(A->hashBytes >> 20));
+   else
+      printf("Sigma Chess annotation (%d games, %ld ms, %d x %d threads, hash %lu MB)\n", A->count, (long)A->timeMS, n, A->threads, (unsigned long)(A->hashBytes >> 20));
+   if (A->first > 0)
+      printf("Resuming at game %d\n", A->first + 1);
+   fflush(stdout);
+
+   for (INT k = 0; k < n; k++)                     // The engines are created up front (the
+   {                                               // engine table isn't thread safe).
+      WORKER *w = &W[k];
+      w->A    = A;
+      w->E    = (ENGINE*)calloc(1, sizeof(ENGINE));
+      w->game = new CGame();
+      Engine_Create(&Global, w->E, k);
+
+      PARAM *P = &w->E->P;
+      P->playingMode  = (A->depth > 0 ? mode_FixDepth : mode_Time);
+      P->depth        = A->depth;
+      P->moveTimeMS   = A->timeMS;
+      P->useEndgameDB = false;
+
+      if (! Host_SetTransTables(w->E, A->hashBytes) || ! Host_SetThreads(w->E, A->threads))
+      {  fprintf(stderr, "sigma-annotate: cannot allocate engine %d\n", k + 1);
+         A->result = 1;
+         n = k + 1;
+         break;
+      }
+   }
+
+   A->startMicroSecs = MicroTimer();
+
+   if (A->result == 0)
+   {
+      pthread_mutex_init(&A->lock, nil);
+      for (INT k = 0; k < n; k++)
+         if (pthread_create(&W[k].thread, nil, WorkerThread, (void*)&W[k]) != 0)
+         {  fprintf(stderr, "sigma-annotate: cannot create worker thread\n");
+            A->result = 1;
+            n = k;
+            break;
+         }
+      for (INT k = 0; k < n; k++)
+         pthread_join(W[k].thread, nil);
+      pthread_mutex_destroy(&A->lock);
+
+      if (A->nextOut < A->count)
+         A->result = 1;
+      else
+      {  INT valid = 0, annCount = 0;
+         for (INT i = A->first; i < A->count; i++)
+            if (A->Game[i].valid) valid++, annCount += A->Game[i].annCount;
+         printf("Annotated %d games (%d annotations), %d copied unchanged, %.1f s\n",
+                valid, annCount, A->count - A->first - valid, (MicroTimer() - A->startMicroSecs)/1.0E6);
+      }
+   }
+
+   for (INT k = 0; k < Min(A->engines, A->count - A->first); k++)
+      if (W[k].E)
+      {  Host_SetTransTables(W[k].E, 0);
+         Host_SetThreads(W[k].E, 1);
+         Engine_Destroy(W[k].E);
+         free(W[k].E);
+         delete W[k].game;
+      }
+   free(W);
+} /* Annotate */
+
+
+static void *WorkerThread (void *data)
+{
+   WORKER    *W = (WORKER*)data;
+   ANNOTATOR *A = W->A;
+
+   for (;;)
+   {
+      pthread_mutex_lock(&A->lock);
+      INT i = (A->result == 0 ? A->next++ : A->count);
+      pthread_mutex_unlock(&A->lock);
+      if (i >= A->count) break;
+
+      AnnotateGame(W, &A->Game[i]);
+
+      pthread_mutex_lock(&A->lock);
+      A->Game[i].done = true;
+      WriteGames(A);
+      pthread_mutex_unlock(&A->lock);
+   }
+   return nil;
+} /* WorkerThread */
+
+/*---------------------------------------- Annotate Game -----------------------------------------*/
+// Mirrors GameWindow::AnalyzeGame() and AnalyzeGame_SearchCompleted(). The final position isn't
+// searched, and the analysis starts from the initial position.
+
+static void AnnotateGame (WORKER *W, ANN_GAME *g)
+{
+   ANNOTATOR *A    = W->A;
+   CGame     *game = W->game;
+   CHAR      *buf  = (CHAR*)malloc(g->size + 1);
+   ANALYSIS  *Prev = (ANALYSIS*)malloc(2*sizeof(ANALYSIS)), *Analysis = Prev + 1;
+
+   memcpy(buf, A->pgn + g->start, g->size);
+
+   pthread_mutex_lock(&A->lock);                   // (CGame::ResetGame isn't thread safe).
+   CPgn pgn(game);
+   pgn.ReadBegin(buf);
+   g->valid = pgn.ReadGame(g->size);
+   pthread_mutex_unlock(&A->lock);
+
+   if (g->valid)
+   {
+      game->UndoAllMoves();
+      game->ClrAnnotation();
+
+      INT move0 = game->currMove;
+      Prev->score = 0;
+      clrMove(Prev->PV[0]);
+
+      while (game->currMove < game->lastMove)
+      {
+         AnalyzeMove(W, Prev, Analysis, move0, &g->annCount);
+         game->RedoMove(true);
+         *Prev = *Analysis;
+      }
+
+      g->out     = (CHAR*)malloc(g->size + pgn_BufferSize + (LONG)game->lastMove*annTextSize);
+      g->outSize = CPgn(game).WriteGame(g->out);
+   }
+   else
+      CopyGame(A, g);
+
+   free(Prev);
+   free(buf);
+} /* AnnotateGame */
+
+
+// Searches the current position and then annotates the move leading to it (i.e. the actual
+// move in the previous position) if it's sufficiently worse than the engine's choice.
+
+static void AnalyzeMove (WORKER *W, ANALYSIS *Prev, ANALYSIS *Analysis, INT move0, INT *annCount)
+{
+   ANNOTATOR *A    = W->A;
+   ENGINE    *E    = W->E;
+   CGame     *game = W->game;
+   INT       c    = game->currMove;
+
+   Host_SetGame(E, game);
+   Host_Search(E);
+
+   Analysis->player   = game->player;
+   Analysis->gameMove = c;
+   Analysis->score    = Engine_BestScore(E);
+
+   INT n = 0;
+   for (MOVE *Line = Engine_MainLine(E); n < maxSearchDepth && ! isNull(Line[n]); n++)
+      Analysis->PV[n] = Line[n];
+   clrMove(Analysis->PV[n]);
+   CalcVariationFlags(game->Board, Analysis->PV);
+
+   // Check if we should skip moves for this player (in previous position)
+   if ((game->player == black && A->skipWhitePos) || (game->player == white && A->skipBlackPos))
+      return;
+
+   if (c < move0 + 2)
+      return;
+
+   // Skip if still in opening book
+   if (E->S.libMovesOnly)
+      return;
+
+   // Check if we should skip matching moves
+   MOVE *bestMove   = Prev->PV;
+   MOVE *actualMove = &(game->Record[c]);
+
+   if (A->skipMatching && EqualMove(bestMove, actualMove))
+      return;
+
+   // Calc score improvement and check if we should skip
+   INT scoreImprovement = Prev->score + Analysis->score;
+
+   if (A->skipLowScore && scoreImprovement < A->scoreLimit)
+      return;
+
+   CHAR Text[annTextSize];
+   INT  len = BuildAnnotation(game, Prev, Text, ! EqualMove(bestMove, actualMove), -Analysis->score);
+   game->SetAnnotation(c, Text, len, false);
+   (*annCount)++;
+
+   if (scoreImprovement > 150)
+      game->SetAnnotationGlyph(c, 4); // "??"
+   else if (scoreImprovement > 75)
+      game->SetAnnotationGlyph(c, 2); // "?"
+} /* AnalyzeMove */
+
+
+// Same as BuildAnalysisString() with the default analysis format (score and main line, short
+// format, relative numeric scores).
+
+static INT BuildAnnotation (CGame *game, ANALYSIS *Analysis, CHAR *Text, BOOL includeAltScore, INT altScore)
+{
+   CHAR  *s = Text;
+   MOVE  *M = Analysis->PV;
+
+   if (includeAltScore)
+   {  *(s++) = '(';
+      CalcScoreStr(s, CheckAbsScore(Analysis->player, altScore), scoreType_True);
+      s += StrLen(s);
+      *(s++) = ')';
+      *(s++) = ' ';
+   }
+   CalcScoreStr(s, CheckAbsScore(Analysis->player, Analysis->score), scoreType_True);
+   s += StrLen(s);
+   *(s++) = ' ';
+
+   if (! isNull(M[0]))
+   {
+      INT moveNo = game->Init.moveNo + (Analysis->gameMove + (game->Init.player >> 4))/2;
+
+      s += Format(s, "%d.", moveNo++);
+      if (pieceColour(M[0].piece) == black)
+         s += Format(s, "..");
+
+      for (INT i = 0; ! isNull(M[i]) && s - Text < annTextSize - 2*gameMoveStrLen; i++)
+      {
+         *(s++) = ' ';
+         if (i > 0 && pieceColour(M[i].piece) == white)
+            s += Format(s, "%d. ", moveNo++);
+         s += CalcGameMoveStrAlge(&M[i], s, false, false, true);
+      }
+   }
+
+   *s = 0;
+   return (s - Text);
+} /* BuildAnnotation */
+
+/*--------------------------------------------- Output -------------------------------------------*/
+// Unparseable games are copied as is (apart from surrounding blank space).
+
+static void CopyGame (ANNOTATOR *A, ANN_GAME *g)
+{
+   CHAR *s = A->pgn + g->start;
+   LONG n  = g->size;
+
+   while (n > 0 && (IsNewLine(*s) || *s == ' ')) s++, n--;
+   while (n > 0 && (IsNewLine(s[n - 1]) || s[n - 1] == ' ')) n--;
+
+   g->out = (CHAR*)malloc(n + 2);
+   memcpy(g->out, s, n);
+   g->out[n++] = '\n';
+   g->out[n++] = '\n';
+   g->outSize = n;
+} /* CopyGame */
+
+
+// Writes the finished games that are next in line (the caller must hold the lock).
+
+static void WriteGames (ANNOTATOR *A)
+{
+   while (A->nextOut < A->count && A->Game[A->nextOut].done && A->result == 0)
+   {
+      ANN_GAME *g = &A->Game[A->nextOut++];
+
+      if (fwrite(g->out, 1, g->outSize, A->out) != (size_t)g->outSize || fflush(A->out) != 0)
+      {  fprintf(stderr, "sigma-annotate: cannot write \"%s\"\n", A->outFile);
+         A->result = 1;
+      }
+      free(g->out);
+      g->out = nil;
+
+      INT n = A->nextOut - A->first;
+      fprintf(stderr, "Game %d of %d: ", A->nextOut, A->count);
+      if (g->valid)
+         fprintf(stderr, "%d annotation%s", g->annCount, (g->annCount == 1 ? "" : "s"));
+      else
+         fprintf(stderr, "invalid PGN, copied");
+      fprintf(stderr, " (%.1f s/game)\n", (MicroTimer() - A->startMicroSecs)/1.0E6/n);
+   }
+} /* WriteGames */
@@ -0,0 +1,343 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : BENCH.C                                                                              */
+/* Purpose : Headless engine benchmark. Searches a fixed set of positions to a fixed depth and    */
+/*           reports node counts and nodes per second.                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "EngineHost.h"
+
+#include "Engine.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       BENCHMARK POSITIONS                                      */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Node counts are deterministic for a given depth and hash size, so the total node count doubles
+// as a signature of the search (any change to it means the search tree has changed). This only
+// holds for single threaded searches (with "-threads n" the helper threads make them vary).
+
+static CHAR *BenchPos[] =
+{
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+   "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+   "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+   "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+   "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+   "2r3k1/pp3ppp/2n1p3/3pP3/3P4/P1B2N2/1P3PPP/2R3K1 b - - 0 22",
+   "8/8/4kpp1/3p1b2/p6P/2B5/6P1/6K1 b - - 0 47",
+   "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1",
+   nil
+};
+
+// Positions for the piece value micro benchmark (-pieceval): The benchmark positions and the
+// mating phases (lone king, KBNK) with a checksum of the root piece value tables, computed in all
+// five playing styles by the original (scalar) implementation.
+
+typedef struct
+{
+   CHAR  *fen;
+   ULONG checksum;
+} PIECEVAL_POS;
+
+static PIECEVAL_POS PieceValPos[] =
+{
+   { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x5045d3c3 },
+   { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 0xe12f8127 },
+   { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 0x0938fd62 },
+   { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 0x09483590 },
+   { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 0xda04b1ff },
+   { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 0xeb8e8d55 },
+   { "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4", 0x79686213 },
+   { "2r3k1/pp3ppp/2n1p3/3pP3/3P4/P1B2N2/1P3PPP/2R3K1 b - - 0 22", 0x99e927a8 },
+   { "8/8/4kpp1/3p1b2/p6P/2B5/6P1/6K1 b - - 0 47", 0x709a233a },
+   { "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1", 0xfadfcb37 },
+   { "8/8/8/3k4/8/8/8/KQ6 w - - 0 1", 0x7f10a725 },
+   { "8/8/8/8/4K3/8/3q4/k7 b - - 0 1", 0x36eaa8de },
+   { "8/8/8/4k3/8/8/8/2BNK3 w - - 0 1", 0x8e51b439 },
+   { nil, 0 }
+};
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          MAIN PROGRAM                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+typedef struct
+{
+   INT   depth;                      // Fixed search depth (plies).
+   ULONG64 hashBytes;                // Transposition table size (0 = off).
+   INT   threads;                    // Search threads (Lazy SMP).
+   INT   multiPV;                    // Number of best lines searched (multi PV analysis).
+   INT   fenCount;                   // Number of positions given on the command line (0 = default).
+   CHAR  **Fen;
+   CHAR  *ttLoad, *ttSave;           // Transposition table snapshot files (single position only).
+   CHAR  *statsFile;                 // Search statistics file (JSON lines, see "EngineHost.c").
+   CHAR  *traceFile;                 // Search trace file (see "sigma-trace").
+   LONG  traceEvents;                // Trace ring buffer size (0 = default).
+   LONG  pieceValCount;              // Piece value micro benchmark iterations (0 = search bench).
+   INT   result;                     // Exit status.
+} BENCH;
+
+static void BenchMain (BENCH *B);
+static void PieceValMain (BENCH *B);
+static void Usage (void);
+
+int main (int argc, char *argv[])
+{
+   BENCH B;
+
+   B.depth     = 7;
+   B.hashBytes = 16L*1024L*1024L;
+   B.threads   = 1;
+   B.multiPV   = 1;
+   B.fenCount  = 0;
+   B.Fen       = (CHAR**)calloc(argc, sizeof(CHAR*));
+   B.ttLoad    = nil;
+   B.ttSave    = nil;
+   B.statsFile = nil;
+   B.traceFile = nil;
+   B.traceEvents = 0;
+   B.pieceValCount = 0;
+   B.result    = 0;
+
+   for (INT i = 1; i < argc; i++)
+      if (EqualStr(argv[i], "-depth") && i + 1 < argc)
+         B.depth = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-hash") && i + 1 < argc)
+         B.hashBytes = (ULONG64)atoi(argv[++i])*1024L*1024L;
+      else if (EqualStr(argv[i], "-threads") && i + 1 < argc)
+         B.threads = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-multipv") && i + 1 < argc)
+         B.multiPV = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-ttload") && i + 1 < argc)
+         B.ttLoad = argv[++i];
+      else if (EqualStr(argv[i], "-ttsave") && i + 1 < argc)
+         B.ttSave = argv[++i];
+      else if (EqualStr(argv[i], "-stats") && i + 1 < argc)
+         B.statsFile = argv[++i];
+      else if (EqualStr(argv[i], "-trace") && i + 1 < argc)
+         B.traceFile = argv[++i];
+      else if (EqualStr(argv[i], "-events") && i + 1 < argc)
+         B.traceEvents = atol(argv[++i]);
+      else if (EqualStr(argv[i], "-pieceval") && i + 1 < argc)
+         B.pieceValCount = atol(argv[++i]);
+      else if (argv[i][0] == '-')
+      {  Usage();
+         return 2;
+      }
+      else
+         B.Fen[B.fenCount++] = argv[i];
+
+   if (B.depth < 1 || B.depth >= maxSearchDepth || B.threads < 1 || B.threads > maxSearchThreads ||
+       ((B.ttLoad || B.ttSave) && B.fenCount != 1) || B.pieceValCount < 0 ||
+       (B.pieceValCount > 0 && B.fenCount > 0))
+   {  Usage();
+      return 2;
+   }
+
+   if (B.pieceValCount > 0)
+      PieceValMain(&B);
+   else
+      BenchMain(&B);
+
+   free(B.Fen);
+   return B.result;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-bench [-depth n] [-hash mb] [-threads n] [-multipv n] [-stats file]\n");
+   fprintf(stderr, "                   [-trace file [-events n]] [fen ...]\n");
+   fprintf(stderr, "       sigma-bench [-depth n] [-hash mb] [-threads n] [-ttload file] [-ttsave file] fen\n");
+   fprintf(stderr, "       sigma-bench -pieceval iterations\n");
+} /* Usage */
+
+
+static void BenchMain (BENCH *B)
+{
+   ENGINE *E    = (ENGINE*)calloc(1, sizeof(ENGINE));
+   CHAR   **Fen = (B->fenCount > 0 ? B->Fen : BenchPos);
+   LONG64 totalNodes = 0, totalMicroSecs = 0;
+   LONG64 pawnProbes = 0, pawnHits = 0;
+   CHAR   mstr[10];
+
+   Host_InitSystem();
+   CGame *game = new CGame();
+   Engine_Create(&Global, E, 0);
+
+   E->P.playingMode  = mode_FixDepth;
+   E->P.depth        = B->depth;
+   E->P.multiPV      = B->multiPV;
+   E->P.useEndgameDB = false;
+   if (! Host_SetTransTables(E, B->hashBytes))
+   {  fprintf(stderr, "sigma-bench: cannot allocate transposition tables\n");
+      B->result = 1;
+      return;
+   }
+   if (! Host_SetThreads(E, B->threads))
+   {  fprintf(stderr, "sigma-bench: cannot create %d search threads\n", B->threads);
+      B->result = 1;
+      return;
+   }
+   if (B->statsFile && ! Host_SetStatsFile(B->statsFile))
+   {  fprintf(stderr, "sigma-bench: cannot write statistics to \"%s\" (requires SIGMA_SEARCH_STATS)\n", B->statsFile);
+      B->result = 1;
+      return;
+   }
+   if (B->traceFile && ! Host_SetTraceFile(B->traceFile, B->traceEvents))
+   {  fprintf(stderr, "sigma-bench: cannot write trace to \"%s\"\n", B->traceFile);
+      B->result = 1;
+      return;
+   }
+
+   printf("Sigma Chess engine benchmark (depth %d, hash %lu MB, threads %d, multipv %d)\n\n", B->depth, (unsigned long)(B->hashBytes >> 20), B->threads, B->multiPV);
+
+   for (INT i = 0; (B->fenCount > 0 ? i < B->fenCount : Fen[i] != nil); i++)
+   {
+      if (game->Read_EPD(Fen[i]) != epdErr_NoError)
+      {  fprintf(stderr, "sigma-bench: invalid FEN \"%s\"\n", Fen[i]);
+         B->result = 1;
+         continue;
+      }
+
+      Host_SetGame(E, game);
+      HKEY rootKey = E->P.DrawData[E->P.lastMoveNo].hashKey;
+
+      if (B->ttLoad && ! Host_LoadTransTables(E, B->ttLoad, rootKey))
+      {  fprintf(stderr, "sigma-bench: cannot load transposition tables from \"%s\"\n", B->ttLoad);
+         B->result = 1;
+         break;
+      }
+
+      UInt64 t0, t1;
+      MicroSecs(&t0);
+      Host_Search(E);
+      MicroSecs(&t1);
+
+      LONG64 nodes = Engine_MoveCount(E);         // As displayed by the GUI.
+      LONG64 usecs = (LONG64)(t1 - t0);
+      totalNodes     += nodes;
+      totalMicroSecs += usecs;
+      pawnProbes     += Engine_PawnHashProbes(E);
+      pawnHits       += Engine_PawnHashHits(E);
+
+      Host_MoveStr(&Engine_BestMove(E), mstr);
+      printf("%2d  nodes %10lld  time %7.3f s  best %-6s score %+6.2f\n",
+             i + 1, (long long)nodes, usecs/1.0E6, mstr, Engine_BestScore(E)/100.0);
+
+      for (INT k = 1; k < Engine_PVCount(E); k++)   // Remaining lines if multi PV.
+      {  Host_MoveStr(&Engine_PVLine(E,k)[0], mstr);
+         printf("    %d.                                 %-6s score %+6.2f\n", k + 1, mstr, Engine_PVScore(E,k)/100.0);
+      }
+
+      if (isNull(Engine_BestMove(E))) B->result = 1;
+
+      if (B->ttSave && ! Host_SaveTransTables(E, B->ttSave, rootKey))
+      {  fprintf(stderr, "sigma-bench: cannot save transposition tables to \"%s\"\n", B->ttSave);
+         B->result = 1;
+      }
+   }
+
+   printf("\nNodes  : %lld\n", (long long)totalNodes);
+   printf("Time   : %.3f s\n", totalMicroSecs/1.0E6);
+   printf("NPS    : %.0f\n", (totalMicroSecs > 0 ? totalNodes*1.0E6/totalMicroSecs : 0.0));
+   printf("Pawns  : %.1f %% hash hits (%lld probes)\n", (pawnProbes > 0 ? pawnHits*100.0/pawnProbes : 0.0), (long long)pawnProbes);
+
+   Host_SetStatsFile(nil);
+   Host_SetTraceFile(nil);
+   Host_SetTransTables(E, 0);
+   Host_SetThreads(E, 1);
+   Engine_Destroy(E);
+   Host_EndSystem();
+   delete game;
+   free(E);
+} /* BenchMain */
+
+
+// Piece value micro benchmark: Times the root piece value computation (CalcPieceValState) in each
+// position and playing style, and checks the resulting tables against the known checksums.
+
+static void PieceValMain (BENCH *B)
+{
+   ENGINE *E = (ENGINE*)calloc(1, sizeof(ENGINE));
+   LONG64 totalMicroSecs = 0;
+   INT    failed = 0, n = 0;
+
+   Host_InitSystem();
+   CGame *game = new CGame();
+   Engine_Create(&Global, E, 0);
+
+   printf("Sigma Chess piece value benchmark (%ld iterations per position and style)\n\n", (long)B->pieceValCount);
+
+   for (INT i = 0; PieceValPos[i].fen; i++)
+   {
+      PIECEVAL_POS *T = &PieceValPos[i];
+      LONG64 usecs = 0;
+      ULONG  checksum = 0;
+
+      game->Read_EPD(T->fen);
+
+      for (INT style = style_Chicken; style <= style_Desperado; style++)
+      {  ULONG h;
+         Host_SetGame(E, game);
+         E->P.playingStyle = style;
+         usecs += Engine_BenchPieceVal(E, B->pieceValCount, &h);
+         checksum = (checksum*31 + h) & 0xFFFFFFFFUL;
+         n++;
+      }
+
+      BOOL ok = (checksum == T->checksum);
+      printf("%2d  %7.3f us  checksum %08lx  %s", i + 1, usecs/(5.0*B->pieceValCount), (unsigned long)checksum, (ok ? "OK" : "FAILED"));
+      if (! ok) printf(" (expected %08lx)", (unsigned long)T->checksum), failed++;
+      printf("\n");
+      totalMicroSecs += usecs;
+   }
+
+   printf("\nTime   : %.3f us per position\n", totalMicroSecs/((REAL)n*B->pieceValCount));
+   if (failed > 0)
+   {  printf("FAILED : %d positions\n", failed);
+      B->result = 1;
+   }
+
+   Engine_Destroy(E);
+   Host_EndSystem();
+   delete game;
+   free(E);
+} /* PieceValMain */
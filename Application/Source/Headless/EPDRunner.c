@@ -0,0 +1,644 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : EPDRUNNER.C                                                                          */
+/* Purpose : Headless EPD test suite runner. Searches the positions of an EPD file in parallel    */
+/*           (one engine instance per worker thread) and scores the "bm"/"am" solutions.          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "EngineHost.h"
+#include "GameUtil.h"
+
+#include "Engine.f"
+#include "Time.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Each worker thread owns an engine instance (with its own transposition tables and search
+// threads) and repeatedly takes the next position from the shared work queue until the suite is
+// exhausted. A position is solved if the final best move is one of the "bm" moves (or none of
+// the "am" moves). The solution time is the time at which the engine switched to the final
+// solution (i.e. it doesn't count if it's later abandoned).
+
+#define epdLineSize  1000                          // Max EPD line length.
+#define epdOpSize    100                           // Max operand length (move lists and id).
+
+typedef struct
+{
+   CHAR   *line;                                   // The EPD line (position and operations).
+   CHAR   id[epdOpSize];                           // "id" operand.
+   CHAR   bm[epdOpSize], am[epdOpSize];            // "bm"/"am" move lists (SAN), empty if none.
+   BOOL   valid;                                   // Could the position be read?
+   BOOL   solved;
+   CHAR   best[gameMoveStrLen];                    // Best move found (SAN).
+   INT    depth, score;
+   LONG64 nodes, microSecs;
+   LONG64 solveNodes, solveMicroSecs;              // When the solution was found (-1 if unsolved).
+   LONG   edbProbes;                               // Endgame database probes (and their total
+   LONG64 edbMicroSecs;                            // duration).
+   LONG   tbHits;                                  // Tablebase hits in the search.
+} EPD_POS;
+
+typedef struct
+{
+   CHAR    *epdFile;
+   CHAR    *csvFile, *jsonFile;                    // Result files (optional).
+   CHAR    *edbDir;                                // Endgame database folder (nil = don't use).
+   INT     depth;                                  // Fixed depth per position (if > 0), else
+   LONG    timeMS;                                 // fixed time per position (milliseconds).
+   INT     engines;                                // Engine instances (worker threads).
+   INT     threads;                                // Search threads per engine instance.
+   ULONG64 hashBytes;                              // Transposition table size per instance.
+
+   INT     count;                                  // Number of positions in the suite.
+   EPD_POS *Pos;
+   INT     next;                                   // Work queue (index of next position).
+   pthread_mutex_t lock;                           // Protects "next" and the console output.
+   INT     result;                                 // Exit status.
+} RUNNER;
+
+typedef struct
+{
+   RUNNER    *R;
+   ENGINE    *E;
+   CGame     *game;
+   EPD_POS   *pos;                                 // Position currently being searched.
+   pthread_t thread;
+} WORKER;
+
+static BOOL   LoadSuite       (RUNNER *R);
+static void   ParseOperations (EPD_POS *pos);
+static void   RunSuite        (RUNNER *R);
+static void   *WorkerThread   (void *data);
+static void   SearchPos       (WORKER *W, EPD_POS *pos);
+static void   SearchMsg       (ENGINE *E, ULONG msg, PTR data);
+static BOOL   IsSolution      (CGame *game, MOVE *m, EPD_POS *pos, CHAR *san);
+static BOOL   InMoveList      (CHAR *san, CHAR *list);
+static void   PrintPos        (RUNNER *R, INT i);
+static void   PrintSummary    (RUNNER *R, LONG64 wallMicroSecs);
+static BOOL   WriteCSV        (RUNNER *R);
+static BOOL   WriteJSON       (RUNNER *R);
+static void   Usage           (void);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          MAIN PROGRAM                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (int argc, char *argv[])
+{
+   RUNNER R;
+
+   R.epdFile   = nil;
+   R.csvFile   = nil;
+   R.jsonFile  = nil;
+   R.edbDir    = nil;
+   R.depth     = 0;
+   R.timeMS    = 1000;
+   R.engines   = 1;
+   R.threads   = 1;
+   R.hashBytes = 16L*1024L*1024L;
+   R.count     = 0;
+   R.Pos       = nil;
+   R.next      = 0;
+   R.result    = 0;
+
+   for (INT i = 1; i < argc; i++)
+      if (EqualStr(argv[i], "-depth") && i + 1 < argc)
+         R.depth = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-time") && i + 1 < argc)
+         R.timeMS = atol(argv[++i]), R.depth = 0;
+      else if (EqualStr(argv[i], "-engines") && i + 1 < argc)
+         R.engines = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-threads") && i + 1 < argc)
+         R.threads = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-hash") && i + 1 < argc)
+         R.hashBytes = (ULONG64)atoi(argv[++i])*1024L*1024L;
+      else if (EqualStr(argv[i], "-csv") && i + 1 < argc)
+         R.csvFile = argv[++i];
+      else if (EqualStr(argv[i], "-json") && i + 1 < argc)
+         R.jsonFile = argv[++i];
+      else if (EqualStr(argv[i], "-edb") && i + 1 < argc)
+         R.edbDir = argv[++i];
+      else if (argv[i][0] == '-' || R.epdFile)
+      {  Usage();
+         return 2;
+      }
+      else
+         R.epdFile = argv[i];
+
+   if (! R.epdFile || R.depth < 0 || R.depth >= maxSearchDepth || (R.depth == 0 && R.timeMS <= 0) ||
+       R.engines < 1 || R.engines > maxEngines || R.threads < 1 || R.threads > maxSearchThreads)
+   {  Usage();
+      return 2;
+   }
+
+   if (! LoadSuite(&R))
+      return 1;
+
+   Host_InitSystem();
+   if (R.edbDir && Host_SetEndgameDB(R.edbDir) == 0)
+      fprintf(stderr, "sigma-epd: no endgame databases in \"%s\"\n", R.edbDir);
+   RunSuite(&R);
+   Host_EndSystem();
+
+   for (INT i = 0; i < R.count; i++)
+      free(R.Pos[i].line);
+   free(R.Pos);
+   return R.result;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-epd [-time ms | -depth n] [-engines n] [-threads n] [-hash mb]\n");
+   fprintf(stderr, "                 [-edb folder] [-csv file] [-json file] file.epd\n");
+} /* Usage */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          LOAD EPD SUITE                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Reads all positions of the EPD file (skipping blank lines and "#" comments). The positions
+// themselves are only parsed (by CGame::Read_EPD) when they are searched.
+
+static BOOL LoadSuite (RUNNER *R)
+{
+   FILE *file = fopen(R->epdFile, "r");
+   CHAR line[epdLineSize];
+   INT  size = 0;
+
+   if (! file)
+   {  fprintf(stderr, "sigma-epd: cannot open \"%s\"\n", R->epdFile);
+      return false;
+   }
+
+   while (fgets(line, epdLineSize, file))
+   {
+      INT n = StrLen(line);
+      while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r' || line[n - 1] == ' '))
+         line[--n] = 0;
+      if (n == 0 || line[0] == '#') continue;
+
+      if (R->count == size)
+      {  size = (size > 0 ? 2*size : 256);
+         R->Pos = (EPD_POS*)realloc(R->Pos, size*sizeof(EPD_POS));
+      }
+
+      EPD_POS *pos = &R->Pos[R->count++];
+      memset(pos, 0, sizeof(EPD_POS));
+      pos->line = strdup(line);
+      Format(pos->id, "%d", R->count);
+      ParseOperations(pos);
+   }
+   fclose(file);
+
+   if (R->count == 0)
+   {  fprintf(stderr, "sigma-epd: no positions found in \"%s\"\n", R->epdFile);
+      return false;
+   }
+   return true;
+} /* LoadSuite */
+
+static void CopyOperand (CHAR *t, CHAR *s, INT n)
+{
+   INT i = 0;
+
+   for (; n > 0 && i < epdOpSize - 1; s++, n--)
+      if (*s != '"') t[i++] = *s;
+   while (i > 0 && t[i - 1] == ' ') i--;
+   t[i] = 0;
+} /* CopyOperand */
+
+
+// Extracts the "bm", "am" and "id" operations (which follow the 4 position fields). Any move
+// counters (if the position is given as a full FEN string) are skipped.
+
+
+static void ParseOperations (EPD_POS *pos)
+{
+   CHAR *s = pos->line;
+
+   for (INT f = 0; f < 4; f++)                     // Skip the position fields.
+   {  while (*s == ' ') s++;
+      while (*s && *s != ' ') s++;
+   }
+
+   for (;;)
+   {
+      while (*s == ' ') s++;
+      if (! *s) return;
+
+      CHAR *op = s;                                // Opcode...
+      while (*s && *s != ' ' && *s != ';') s++;
+      INT opLen = s - op;
+      if (IsDigit(op[0])) continue;                // (FEN move counters).
+
+      while (*s == ' ') s++;                       // ...and operands (up to ';').
+      CHAR *arg = s;
+      for (BOOL quoted = false; *s && (quoted || *s != ';'); s++)
+         if (*s == '"') quoted = ! quoted;
+      INT argLen = s - arg;
+      if (*s) s++;
+
+      if (opLen == 2 && ! strncmp(op, "bm", 2))      CopyOperand(pos->bm, arg, argLen);
+      else if (opLen == 2 && ! strncmp(op, "am", 2)) CopyOperand(pos->am, arg, argLen);
+      else if (opLen == 2 && ! strncmp(op, "id", 2)) CopyOperand(pos->id, arg, argLen);
+   }
+} /* ParseOperations */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                            RUN SUITE                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void RunSuite (RUNNER *R)
+{
+   INT    n = Min(R->engines, R->count);
+   WORKER *W = (WORKER*)calloc(n, sizeof(WORKER));
+
+   if (R->depth > 0)
+      printf("Sigma Chess EPD test (%d positions, depth %d, %d x %d threads, hash %lu MB)\n\n", R->count, R->depth, n, R->threads, (unsigned long)(R->hashBytes >> 20));
+   else
+      printf("Sigma Chess EPD test (%d positions, %ld ms, %d x %d threads, hash %lu MB)\n\n", R->count, (long)R->timeMS, n, R->threads, (unsigned long)(R->hashBytes >> 20));
+
+   for (INT k = 0; k < n; k++)                     // The engines are created up front (the
+   {                                               // engine table isn't thread safe).
+      WORKER *w = &W[k];
+      w->R    = R;
+      w->E    = (ENGINE*)calloc(1, sizeof(ENGINE));
+      w->game = new CGame();
+      Engine_Create(&Global, w->E, k);
+
+      PARAM *P = &w->E->P;
+      P->playingMode  = (R->depth > 0 ? mode_FixDepth : mode_Time);
+      P->depth        = R->depth;
+      P->moveTimeMS   = R->timeMS;
+      P->useEndgameDB = (R->edbDir != nil);
+
+      if (! Host_SetTransTables(w->E, R->hashBytes) || ! Host_SetThreads(w->E, R->threads))
+      {  fprintf(stderr, "sigma-epd: cannot allocate engine %d\n", k + 1);
+         R->result = 1;
+         n = k + 1;
+         break;
+      }
+   }
+
+   LONG64 t0 = MicroTimer();
+
+   if (R->result == 0)
+   {
+      pthread_mutex_init(&R->lock, nil);
+      for (INT k = 0; k < n; k++)
+         if (pthread_create(&W[k].thread, nil, WorkerThread, (void*)&W[k]) != 0)
+         {  fprintf(stderr, "sigma-epd: cannot create worker thread\n");
+            R->result = 1;
+            n = k;
+            break;
+         }
+      for (INT k = 0; k < n; k++)
+         pthread_join(W[k].thread, nil);
+      pthread_mutex_destroy(&R->lock);
+
+      PrintSummary(R, MicroTimer() - t0);
+      if (R->csvFile && ! WriteCSV(R))
+      {  fprintf(stderr, "sigma-epd: cannot write \"%s\"\n", R->csvFile);
+         R->result = 1;
+      }
+      if (R->jsonFile && ! WriteJSON(R))
+      {  fprintf(stderr, "sigma-epd: cannot write \"%s\"\n", R->jsonFile);
+         R->result = 1;
+      }
+   }
+
+   for (INT k = 0; k < Min(R->engines, R->count); k++)
+      if (W[k].E)
+      {  Host_SetTransTables(W[k].E, 0);
+         Host_SetThreads(W[k].E, 1);
+         Engine_Destroy(W[k].E);
+         free(W[k].E);
+         delete W[k].game;
+      }
+   free(W);
+} /* RunSuite */
+
+
+static void *WorkerThread (void *data)
+{
+   WORKER *W = (WORKER*)data;
+   RUNNER *R = W->R;
+
+   for (;;)
+   {
+      pthread_mutex_lock(&R->lock);
+      INT i = R->next++;
+      pthread_mutex_unlock(&R->lock);
+      if (i >= R->count) break;
+
+      SearchPos(W, &R->Pos[i]);
+
+      pthread_mutex_lock(&R->lock);
+      PrintPos(R, i);
+      pthread_mutex_unlock(&R->lock);
+   }
+   return nil;
+} /* WorkerThread */
+
+/*-------------------------------------- Search Position -----------------------------------------*/
+
+static void SearchPos (WORKER *W, EPD_POS *pos)
+{
+   ENGINE *E    = W->E;
+   CGame  *game = W->game;
+
+   pos->solveNodes = pos->solveMicroSecs = -1;
+   CopyStr("-", pos->best);
+
+   pthread_mutex_lock(&W->R->lock);                // (CGame::ResetGame isn't thread safe).
+   pos->valid = (game->Read_EPD(pos->line) == epdErr_NoError && game->moveCount > 0);
+   pthread_mutex_unlock(&W->R->lock);
+   if (! pos->valid) return;
+
+   Host_SetGame(E, game);
+   W->pos = pos;
+
+   LONG64 t0 = MicroTimer();
+   Host_Search(E, SearchMsg, (PTR)W);
+   pos->microSecs = MicroTimer() - t0;
+   pos->nodes     = Engine_MoveCount(E);
+   pos->depth     = Engine_MainDepth(E);
+   pos->score     = Engine_BestScore(E);
+   pos->solved    = IsSolution(game, &Engine_BestMove(E), pos, pos->best);
+   pos->edbProbes    = Engine_EdbProbes(E);
+   pos->edbMicroSecs = Engine_EdbMicroSecs(E);
+   pos->tbHits       = Engine_TbHits(E);
+
+   if (! pos->solved)
+      pos->solveNodes = pos->solveMicroSecs = -1;
+   else if (pos->solveMicroSecs < 0)
+      pos->solveNodes = pos->nodes, pos->solveMicroSecs = pos->microSecs;
+} /* SearchPos */
+
+
+// Tracks the time (and node count) at which the main line last switched to a solution.
+
+static void SearchMsg (ENGINE *E, ULONG msg, PTR data)
+{
+   WORKER  *W   = (WORKER*)data;
+   EPD_POS *pos = W->pos;
+
+   if (msg != msg_NewMainLine || Engine_MainDepth(E) == 0) return;
+
+   MOVE m = Engine_BestMove(E);
+
+   if (! IsSolution(W->game, &m, pos, nil))
+      pos->solveNodes = pos->solveMicroSecs = -1;
+   else if (pos->solveMicroSecs < 0)
+   {  pos->solveNodes     = Engine_MoveCount(E);
+      pos->solveMicroSecs = MicroTimer() - E->S.startMicroTime;
+   }
+} /* SearchMsg */
+
+/*------------------------------------------ Scoring ---------------------------------------------*/
+// Returns true if "m" is a "bm" move (or not an "am" move) of the position. The SAN string of
+// the move is optionally returned in "san".
+
+static BOOL IsSolution (CGame *game, MOVE *m, EPD_POS *pos, CHAR *san)
+{
+   CHAR s[gameMoveStrLen];
+
+   Host_MoveStr(m, s);
+   MOVE *gm = Host_ParseMove(game, s);
+   if (! gm) return false;
+
+   MOVE mv = *gm;
+   CalcDisambFlags(&mv, game->Moves, game->moveCount);
+   s[CalcGameMoveStrAlge(&mv, s, false, true, false)] = 0;
+   if (san) CopyStr(s, san);
+
+   if (pos->bm[0]) return InMoveList(s, pos->bm);
+   if (pos->am[0]) return ! InMoveList(s, pos->am);
+   return false;
+} /* IsSolution */
+
+
+// Compares SAN strings ignoring check/mate indicators, glyphs and "=" in promotions (so e.g.
+// "exd8=Q+" matches "exd8Q"). Castling may also be written with zeros.
+
+static void NormalizeSAN (CHAR *s, CHAR *t)
+{
+   for (; *s && *s != ' '; s++)
+      if (*s == '0') *(t++) = 'O';
+      else if (! SearchChar(*s, "+#!?=")) *(t++) = *s;
+   *t = 0;
+} /* NormalizeSAN */
+
+
+static BOOL InMoveList (CHAR *san, CHAR *list)
+{
+   CHAR s[gameMoveStrLen], t[epdOpSize];
+
+   NormalizeSAN(san, s);
+
+   for (CHAR *l = list; *l; )
+   {
+      NormalizeSAN(l, t);
+      if (EqualStr(s, t)) return true;
+      while (*l && *l != ' ') l++;
+      while (*l == ' ') l++;
+   }
+   return false;
+} /* InMoveList */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                              OUTPUT                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void PrintPos (RUNNER *R, INT i)
+{
+   EPD_POS *pos = &R->Pos[i];
+   CHAR    *op  = "  ";
+
+   if (pos->bm[0]) op = "bm";
+   else if (pos->am[0]) op = "am";
+
+   if (! pos->valid)
+   {  printf("%4d  %-20.20s  invalid position\n", i + 1, pos->id);
+      return;
+   }
+
+   printf("%4d  %-20.20s  %s %-12.12s  best %-8s %-4s depth %2d  nodes %10lld  time %7.3f s",
+          i + 1, pos->id, op, (pos->bm[0] ? pos->bm : pos->am), pos->best,
+          (pos->solved ? "ok" : (op[0] != ' ' ? "--" : "")), pos->depth, (long long)pos->nodes,
+          pos->microSecs/1.0E6);
+   if (pos->solved)
+      printf("  found %7.3f s", pos->solveMicroSecs/1.0E6);
+   printf("\n");
+} /* PrintPos */
+
+
+static void PrintSummary (RUNNER *R, LONG64 wallMicroSecs)
+{
+   INT    scored = 0, solved = 0;
+   LONG64 nodes = 0, usecs = 0, solveNodes = 0, solveMicroSecs = 0;
+   LONG64 edbProbes = 0, edbMicroSecs = 0, tbHits = 0;
+
+   for (INT i = 0; i < R->count; i++)
+   {
+      EPD_POS *pos = &R->Pos[i];
+      if (! pos->valid) continue;
+
+      nodes += pos->nodes;
+      usecs += pos->microSecs;
+      edbProbes    += pos->edbProbes;
+      edbMicroSecs += pos->edbMicroSecs;
+      tbHits       += pos->tbHits;
+      if (pos->bm[0] || pos->am[0]) scored++;
+      if (pos->solved)
+      {  solved++;
+         solveNodes     += pos->solveNodes;
+         solveMicroSecs += pos->solveMicroSecs;
+      }
+   }
+
+   printf("\nSolved : %d of %d (%.1f %%)\n", solved, scored, (scored > 0 ? solved*100.0/scored : 0.0));
+   if (solved > 0)
+      printf("Found  : %.3f s, %lld nodes (average per solved position)\n", solveMicroSecs/1.0E6/solved, (long long)(solveNodes/solved));
+   printf("Nodes  : %lld\n", (long long)nodes);
+   printf("Time   : %.3f s search, %.3f s elapsed\n", usecs/1.0E6, wallMicroSecs/1.0E6);
+   printf("NPS    : %.0f\n", (usecs > 0 ? nodes*1.0E6/usecs : 0.0));
+   if (R->edbDir)
+   {  printf("EDB    : %lld probes (%.2f us average)\n", (long long)edbProbes, (edbProbes > 0 ? (REAL)edbMicroSecs/edbProbes : 0.0));
+      printf("TB     : %lld hits in search\n", (long long)tbHits);
+   }
+} /* PrintSummary */
+
+/*------------------------------------------ Result Files ----------------------------------------*/
+// One row/object per position (in file order). Solution times and node counts are empty (null)
+// for unsolved positions. Times are in milliseconds.
+
+static BOOL WriteCSV (RUNNER *R)
+{
+   FILE *file = fopen(R->csvFile, "w");
+   if (! file) return false;
+
+   fprintf(file, "n,id,bm,am,best,solved,depth,score,nodes,time_ms,solve_nodes,solve_time_ms\n");
+
+   for (INT i = 0; i < R->count; i++)
+   {
+      EPD_POS *pos = &R->Pos[i];
+      fprintf(file, "%d,\"%s\",\"%s\",\"%s\",%s,%d,", i + 1, pos->id, pos->bm, pos->am, pos->best, pos->solved);
+      if (pos->valid)
+         fprintf(file, "%d,%d,%lld,%.1f,", pos->depth, pos->score, (long long)pos->nodes, pos->microSecs/1000.0);
+      else
+         fprintf(file, ",,,,");
+      if (pos->solved)
+         fprintf(file, "%lld,%.1f\n", (long long)pos->solveNodes, pos->solveMicroSecs/1000.0);
+      else
+         fprintf(file, ",\n");
+   }
+
+   return (fclose(file) == 0);
+} /* WriteCSV */
+
+
+static void WriteJSONStr (FILE *file, CHAR *s)
+{
+   fputc('"', file);
+   for (; *s; s++)
+   {  if (*s == '"' || *s == '\\') fputc('\\', file);
+      fputc(*s, file);
+   }
+   fputc('"', file);
+} /* WriteJSONStr */
+
+
+static BOOL WriteJSON (RUNNER *R)
+{
+   FILE   *file   = fopen(R->jsonFile, "w");
+   INT    scored  = 0, solved = 0;
+   LONG64 nodes   = 0, usecs = 0;
+
+   if (! file) return false;
+
+   for (INT i = 0; i < R->count; i++)
+   {  EPD_POS *pos = &R->Pos[i];
+      if (pos->bm[0] || pos->am[0]) scored++;
+      if (pos->solved) solved++;
+      nodes += pos->nodes;
+      usecs += pos->microSecs;
+   }
+
+   fprintf(file, "{\n  \"file\": ");
+   WriteJSONStr(file, R->epdFile);
+   fprintf(file, ",\n  \"depth\": %d,\n  \"time_ms\": %ld,\n  \"engines\": %d,\n  \"threads\": %d,\n", R->depth, (long)(R->depth > 0 ? 0 : R->timeMS), R->engines, R->threads);
+   fprintf(file, "  \"positions\": %d,\n  \"scored\": %d,\n  \"solved\": %d,\n", R->count, scored, solved);
+   fprintf(file, "  \"nodes\": %lld,\n  \"search_time_ms\": %.1f,\n  \"results\": [\n", (long long)nodes, usecs/1000.0);
+
+   for (INT i = 0; i < R->count; i++)
+   {
+      EPD_POS *pos = &R->Pos[i];
+
+      fprintf(file, "    {\"n\": %d, \"id\": ", i + 1);
+      WriteJSONStr(file, pos->id);
+      fprintf(file, ", \"bm\": ");
+      WriteJSONStr(file, pos->bm);
+      fprintf(file, ", \"am\": ");
+      WriteJSONStr(file, pos->am);
+      fprintf(file, ", \"valid\": %s, \"best\": ", (pos->valid ? "true" : "false"));
+      WriteJSONStr(file, pos->best);
+      fprintf(file, ", \"solved\": %s, \"depth\": %d, \"score\": %d, \"nodes\": %lld, \"time_ms\": %.1f, ",
+              (pos->solved ? "true" : "false"), pos->depth, pos->score, (long long)pos->nodes, pos->microSecs/1000.0);
+      if (pos->solved)
+         fprintf(file, "\"solve_nodes\": %lld, \"solve_time_ms\": %.1f}", (long long)pos->solveNodes, pos->solveMicroSecs/1000.0);
+      else
+         fprintf(file, "\"solve_nodes\": null, \"solve_time_ms\": null}");
+      fprintf(file, (i + 1 < R->count ? ",\n" : "\n"));
+   }
+
+   fprintf(file, "  ]\n}\n");
+   return (fclose(file) == 0);
+} /* WriteJSON */
@@ -0,0 +1,731 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : ENGINEHOST.C                                                                         */
+/* Purpose : Minimal headless engine host: Engine/game module setup and a message loop which runs */
+/*           searches to completion (the counterpart of SigmaApplication/GameWindow in the GUI).  */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#include "EngineHost.h"
+#include "CMemory.h"
+#include "GameUtil.h"
+#include "Annotations.h"
+#include "PGN.h"
+
+#include "Engine.f"
+#include "Board.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          INIT/EXIT                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The read only engine tables (incl. the KPK database, which is a Mac resource in the GUI version)
+// are generated at build time by "GenTables.c", and are simply copied at startup. The K*K* endgame
+// databases are only available if installed with Host_SetEndgameDB().
+
+extern const ENGINE_TABLES *EngineTables;
+
+void Host_InitSystem (void)
+{
+   Toolbox_Init();
+   Engine_InitSystem(&Global, nil, EngineTables);
+   InitGameModule();
+   InitAnnotationModule();
+} /* Host_InitSystem */
+
+
+void Host_EndSystem (void)
+{
+   Engine_AbortAll(&Global);
+   Host_SetEndgameDB(nil);
+} /* Host_EndSystem */
+
+/*--------------------------------------- Endgame Databases --------------------------------------*/
+// The database files (named "KQKR" e.t.c.) and the tablebase files ("*.stw" and "*.stm", built by
+// "sigma-tbgen") in the given folder are memory mapped and installed in the engine, which then
+// probes them directly (i.e. without msg_ProbeEndgDB round trips to the host). The mappings are
+// read only and shared by all engines. Must not be called while any engine is running. Returns
+// the number of databases and tablebases found (0 if "dir" is nil, which unmaps them).
+
+#define maxTablebases 1024
+
+static TABLEBASE Tablebase[maxTablebases];
+static INT       tablebaseCount = 0;
+
+static INT SetTablebases (CHAR *dir);
+
+static PTR MapFile (CHAR *dir, CHAR *name, ULONG *size)
+{
+   CHAR path[1000];
+   snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+   int         fd = open(path, O_RDONLY);
+   struct stat st;
+   PTR         data = nil;
+   if (fd < 0) return nil;
+
+   if (fstat(fd, &st) == 0 && st.st_size > 0 && (ULONG64)st.st_size <= 0xFFFFFFFF)
+   {  data = (PTR)mmap(nil, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == (PTR)MAP_FAILED) data = nil;
+      *size = st.st_size;
+   }
+   close(fd);
+   return data;
+} /* MapFile */
+
+
+INT Host_SetEndgameDB (CHAR *dir)
+{
+   INT count = 0;
+
+   for (INT db = 0; db < edbCount; db++)
+   {
+      if (Global.D.Data[db])
+         munmap(Global.D.Data[db], Global.D.Size[db]);
+      Engine_SetEndgameDB(&Global, db, nil, 0);
+
+      ULONG size;
+      PTR   data = (dir ? MapFile(dir, Engine_EndgameDBName(db), &size) : nil);
+      if (data)
+         Engine_SetEndgameDB(&Global, db, data, size), count++;
+   }
+
+   return count + SetTablebases(dir);
+} /* Host_SetEndgameDB */
+
+
+static INT SetTablebases (CHAR *dir)
+{
+   Engine_SetTablebases(&Global, nil, 0);
+   for (INT i = 0; i < tablebaseCount; i++)
+      munmap(Tablebase[i].data, Tablebase[i].size);
+   tablebaseCount = 0;
+
+   DIR *folder = (dir ? opendir(dir) : nil);
+   if (! folder) return 0;
+
+   for (struct dirent *entry; (entry = readdir(folder)) && tablebaseCount < maxTablebases; )
+   {
+      CHAR  *name = entry->d_name;
+      INT   n = StrLen(name);
+      ULONG size;
+      PTR   data;
+
+      if (n <= 4 || (! EqualStr(name + n - 4, ".stw") && ! EqualStr(name + n - 4, ".stm")) ||
+          ! (data = MapFile(dir, name, &size)))
+         continue;
+
+      if (Engine_OpenTablebase(&Tablebase[tablebaseCount], data, size))
+         tablebaseCount++;
+      else
+         munmap(data, size);
+   }
+   closedir(folder);
+
+   Engine_SetTablebases(&Global, Tablebase, tablebaseCount);
+   return tablebaseCount;
+} /* SetTablebases */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           SEARCHING                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*------------------------------------------ Game State ------------------------------------------*/
+// Fills in the "Game state" part of the engine parameters (as GameWindow::SetSearchParam).
+
+void Host_SetGame (ENGINE *E, CGame *game)
+{
+   PARAM *P = &E->P;
+
+   CopyTable(game->Board, P->Board);
+   CopyTable(game->HasMovedTo, P->HasMovedTo);
+   P->player     = game->player;
+   P->lastMove   = game->Record[game->currMove];
+   P->lastMoveNo = game->currMove;
+   P->DrawData   = game->DrawData;
+} /* Host_SetGame */
+
+/*-------------------------------------- Transposition Tables ------------------------------------*/
+// The transposition tables of each engine live in a large reserved address range (see
+// Mem_ReserveLargePtr), of which only the part used by the tables is committed. The tables can
+// thus be resized in place, and a reloaded snapshot is simply mapped into the same range. The range
+// is sized to the largest tables the host may ask for (see Host_SetTransReserve), but never more
+// than the physical RAM (or the requested size, if larger). If it can't be reserved, smaller
+// ranges are tried, down to the requested size.
+
+typedef struct
+{
+   ENGINE  *E;                                     // Engine owning the block (nil if unused).
+   PTR     block;                                  // Reserved address range.
+   ULONG64 maxBytes;                               // Size of the reserved range.
+   ULONG64 bytes;                                  // Size of the committed/mapped part.
+   BOOL    snapshot;                               // Is a snapshot file mapped into the block?
+} HOST_TRANS;
+
+static HOST_TRANS HostTrans[maxEngines];
+static ULONG64    hostTransReserve = 0;           // Max address range reserved per engine (0 = RAM).
+
+// Sets the maximum table size (in bytes) the host may resize the tables to, and thus the address
+// range reserved per engine. 0 means the physical RAM. Affects subsequent reservations only.
+
+void Host_SetTransReserve (ULONG64 bytes)
+{
+   hostTransReserve = bytes;
+} /* Host_SetTransReserve */
+
+
+
+static HOST_TRANS *GetHostTrans (ENGINE *E, ULONG64 bytes)
+{
+   HOST_TRANS *T = nil;
+
+   for (INT i = 0; i < maxEngines && ! T; i++)
+      if (HostTrans[i].E == E) T = &HostTrans[i];
+   for (INT i = 0; i < maxEngines && ! T; i++)
+      if (! HostTrans[i].E) T = &HostTrans[i], T->E = E;
+
+   if (T && bytes > T->maxBytes)                   // Reserve a (larger) address range.
+   {
+      ULONG64 ram     = Mem_PhysicalBytes();
+      ULONG64 reserve = (hostTransReserve > 0 && hostTransReserve < ram ? hostTransReserve : ram);
+      if (reserve < bytes) reserve = bytes;
+
+      Mem_FreeLargePtr(T->block, T->maxBytes);
+      while (! (T->block = Mem_ReserveLargePtr(reserve)) && reserve/2 >= bytes)
+         reserve /= 2;
+      T->maxBytes = reserve;
+      T->bytes    = 0;
+      if (! T->block) T->maxBytes = 0, T = nil;
+   }
+   return T;
+} /* GetHostTrans */
+
+// (Re)sizes the transposition tables of the engine (in place if possible). Passing 0 disables
+// the tables and releases the memory. Must not be called while the engine is running.
+
+BOOL Host_SetTransTables (ENGINE *E, ULONG64 bytes)
+{
+   HOST_TRANS *T = GetHostTrans(E, 0);
+
+   E->P.TransTables = nil;
+   E->P.transSize   = 0;
+
+   if (! T) return (bytes == 0);
+
+   if (T->snapshot)                                // Unmap snapshot (the range remains reserved).
+   {  Mem_CommitLargePtr(T->block, T->bytes, 0);
+      T->bytes    = 0;
+      T->snapshot = false;
+   }
+
+   if (bytes == 0)
+   {  Mem_FreeLargePtr(T->block, T->maxBytes);
+      memset(T, 0, sizeof(HOST_TRANS));
+      return true;
+   }
+
+   if (! (T = GetHostTrans(E, bytes)) || ! Mem_CommitLargePtr(T->block, T->bytes, bytes))
+      return false;
+
+   T->bytes = bytes;
+   E->P.TransTables = (TRANS*)T->block;
+   E->P.transSize   = bytes;
+   return true;
+} /* Host_SetTransTables */
+
+/*--------------------------------- Transposition Table Snapshots --------------------------------*/
+// A snapshot file holds a header page followed by the (portable) transposition tables exactly as
+// they are laid out in memory. It is tagged with the hash key of the root position, and can only
+// be reloaded for that position. Reloaded tables are memory mapped (private, i.e. copy on write)
+// into the reserved block of the engine instead of being read into memory.
+
+#define snapshotMagic    "SIGMATT1"
+#define snapshotOffset   4096                      // Offset of the tables (page aligned).
+
+typedef struct
+{
+   CHAR    magic[8];                               // snapshotMagic
+   ULONG   entrySize;                              // sizeof(TRANS)
+   ULONG   generation;                             // Generation of the last search.
+   ULONG64 tableBytes;                             // Size of the tables.
+   HKEY    rootKey;                                // Hash key of the root position.
+} SNAPSHOT_HEADER;
+
+
+BOOL Host_SaveTransTables (ENGINE *E, CHAR *fileName, HKEY rootKey)
+{
+   TRANS_STATE *T = &E->Tr;
+
+   if (E->R.taskRunning || ! T->transTabOn || Engine_TransGeneration(E) <= 0) return false;
+
+   BYTE Page[snapshotOffset];
+   SNAPSHOT_HEADER *H = (SNAPSHOT_HEADER*)Page;
+
+   memset(Page, 0, snapshotOffset);
+   memcpy(H->magic, snapshotMagic, 8);
+   H->entrySize  = sizeof(TRANS);
+   H->generation = Engine_TransGeneration(E);
+   H->tableBytes = (ULONG64)T->transSize*sizeof(TRANS);
+   H->rootKey    = rootKey;
+
+   FILE *file = fopen(fileName, "wb");
+   if (! file) return false;
+
+   BOOL ok = (fwrite(Page, snapshotOffset, 1, file) == 1 &&
+              fwrite(T->TransTabW, H->tableBytes, 1, file) == 1);
+   if (fclose(file) != 0) ok = false;
+   return ok;
+} /* Host_SaveTransTables */
+
+
+BOOL Host_LoadTransTables (ENGINE *E, CHAR *fileName, HKEY rootKey)
+{
+   if (E->R.taskRunning) return false;
+
+   int fd = open(fileName, O_RDONLY);
+   if (fd < 0) return false;
+
+   SNAPSHOT_HEADER H;
+   struct stat     st;
+   HOST_TRANS      *T = nil;
+
+   if (fstat(fd, &st) == 0 && pread(fd, &H, sizeof(H), 0) == (ssize_t)sizeof(H) &&
+       memcmp(H.magic, snapshotMagic, 8) == 0 && H.entrySize == sizeof(TRANS) &&
+       H.rootKey == rootKey && H.tableBytes > 0 &&
+       (ULONG64)st.st_size >= snapshotOffset + H.tableBytes &&
+       Host_SetTransTables(E, 0) && (T = GetHostTrans(E, H.tableBytes)) != nil &&
+       mmap(T->block, H.tableBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, snapshotOffset) == MAP_FAILED)
+      T = nil;
+   close(fd);
+
+   if (! T) return false;
+
+   T->bytes         = H.tableBytes;
+   T->snapshot      = true;
+   E->P.TransTables = (TRANS*)T->block;
+   E->P.transSize   = H.tableBytes;
+
+   if (! Engine_ResumeTransTab(E, H.generation) ||
+       (ULONG64)E->Tr.transSize*sizeof(TRANS) != H.tableBytes)
+   {  Host_SetTransTables(E, 0);
+      return false;
+   }
+   return true;
+} /* Host_LoadTransTables */
+
+/*-------------------------------------------- Threads -------------------------------------------*/
+// Sets the number of search threads (Lazy SMP) by (re)allocating the helper engines. Must not be
+// called while the engine is running.
+
+BOOL Host_SetThreads (ENGINE *E, INT threads)
+{
+   ENGINE *Helper[maxSearchThreads - 1];
+   INT    count = E->SMP.helperCount;
+
+   for (INT i = 0; i < count; i++)                 // Detach the helpers before freeing them.
+      Helper[i] = E->SMP.Helper[i];
+   Engine_RemoveHelpers(E);
+   for (INT i = 0; i < count; i++)
+      free(Helper[i]);
+   E->P.threads = 1;
+
+   for (INT i = 1; i < threads; i++)
+   {
+      ENGINE *H = (ENGINE*)calloc(1, sizeof(ENGINE));
+      if (! H || ! Engine_AddHelper(E, H))
+      {  free(H);
+         return false;
+      }
+      E->P.threads++;
+   }
+
+   return true;
+} /* Host_SetThreads */
+
+/*--------------------------------------- Search Statistics --------------------------------------*/
+// If the engine is compiled with the search statistics (see "Search.h"), Host_Search appends the
+// statistics of each search to the stats file (one JSON object per line).
+
+#ifdef __engine_stats
+static FILE            *statsFile = nil;
+static pthread_mutex_t statsLock  = PTHREAD_MUTEX_INITIALIZER;   // Engines may search concurrently.
+#endif
+
+BOOL Host_SetStatsFile (CHAR *fileName)           // Opens (appends to) the stats file, or closes
+{                                                 // it if "fileName" is nil. Returns false if the
+#ifdef __engine_stats                             // file can't be opened or the statistics aren't
+   if (statsFile) fclose(statsFile);              // compiled.
+   statsFile = (fileName ? fopen(fileName, "a") : nil);
+   return (! fileName || statsFile);
+#else
+   return (! fileName);
+#endif
+} /* Host_SetStatsFile */
+
+#ifdef __engine_stats
+
+static REAL Ratio (LONG64 n, LONG64 d)
+{
+   return (d > 0 ? (REAL)n/d : 0.0);
+} /* Ratio */
+
+
+static void WriteSearchStats (ENGINE *E)
+{
+   static CHAR *GenName[statsGenCount] =
+      { "None", "A", "B", "C", "D", "E", "F1", "F2", "G", "H", "I", "J", "K", "L", "Rfm", "Null" };
+
+   SEARCH_STATS *S = Engine_SearchStats(E);
+   CHAR         line[10000], *s = line;
+   LONG64       cutoffs = 0, firstCutoffs = 0;
+
+   if (! statsFile) return;
+
+   for (INT g = 0; g < statsGenCount; g++)
+   {  cutoffs      += S->Gen[g].cutoffs;
+      firstCutoffs += S->Gen[g].firstCutoffs;
+   }
+
+   s += Format(s, "{\"depth\":%d,\"moves\":%lld,\"nodes\":%lld,\"quiesNodes\":%lld,\"quiesShare\":%.4f,",
+               Engine_MainDepth(E), (long long)E->S.moveCount, (long long)S->nodes,
+               (long long)S->quiesNodes, Ratio(S->quiesNodes, S->nodes));
+   s += Format(s, "\"tt\":{\"probes\":%lld,\"hits\":%lld,\"cuts\":%lld,\"hitRate\":%.4f,\"cutRate\":%.4f},",
+               (long long)S->transProbes, (long long)S->transHits, (long long)S->transCuts,
+               Ratio(S->transHits, S->transProbes), Ratio(S->transCuts, S->transProbes));
+   s += Format(s, "\"cutoffs\":%lld,\"firstCutoffRate\":%.4f,\"generators\":[",
+               (long long)cutoffs, Ratio(firstCutoffs, cutoffs));
+
+   for (INT g = 0, n = 0; g < statsGenCount; g++)
+   {
+      GEN_STATS *G = &S->Gen[g];
+      if (G->tried + G->pruned == 0) continue;
+      s += Format(s, "%s{\"gen\":\"%s\",\"tried\":%lld,\"pruned\":%lld,\"cutoffs\":%lld,\"firstCutoffs\":%lld,"
+                  "\"cutoffRate\":%.4f,\"firstCutoffRate\":%.4f}", (n++ > 0 ? "," : ""), GenName[g],
+                  (long long)G->tried, (long long)G->pruned, (long long)G->cutoffs, (long long)G->firstCutoffs,
+                  Ratio(G->cutoffs, G->tried), Ratio(G->firstCutoffs, G->cutoffs));
+   }
+
+   s += Format(s, "],\"iterations\":[");         // Effective branching factor = ratio of the
+   for (INT d = 1; d <= S->iterations; d++)       // moves searched in consecutive iterations.
+   {
+      s += Format(s, "%s{\"depth\":%d,\"moves\":%lld", (d > 1 ? "," : ""), d, (long long)S->IterMoves[d]);
+      if (d > 1 && S->IterMoves[d - 1] > 0)
+         s += Format(s, ",\"ebf\":%.3f", Ratio(S->IterMoves[d], S->IterMoves[d - 1]));
+      s += Format(s, "}");
+   }
+   s += Format(s, "]}\n");
+
+   pthread_mutex_lock(&statsLock);
+   fputs(line, statsFile);
+   fflush(statsFile);
+   pthread_mutex_unlock(&statsLock);
+} /* WriteSearchStats */
+
+#endif
+
+/*----------------------------------------- Search Trace -----------------------------------------*/
+// If a trace file is set, Host_Search records a trace of each search (see "Trace.h") into a ring
+// buffer of "traceEvents" events and then appends it to the trace file (see TRACE_FILE_HEADER).
+// The buffers of completed searches are kept for the next ones, so the searches don't pay for
+// allocating (and page faulting) a new buffer each time.
+
+#define traceDefaultEvents  0x100000     // 1M events (16 MB).
+
+static FILE            *traceFile   = nil;
+static LONG            traceEvents  = 0;
+static TRACE           *FreeTraces[maxEngines];
+static INT             freeTraces   = 0;
+static pthread_mutex_t traceLock    = PTHREAD_MUTEX_INITIALIZER;
+
+BOOL Host_SetTraceFile (CHAR *fileName, LONG events)   // Creates the trace file, or closes it if
+{                                                      // "fileName" is nil. The ring buffer size
+   if (traceFile) fclose(traceFile);                   // is rounded up to a power of 2.
+   traceFile = nil;
+
+   while (freeTraces > 0)
+   {  TRACE *T = FreeTraces[--freeTraces];
+      free(T->Events);
+      free(T);
+   }
+
+   if (! fileName) return true;
+   if (events <= 0) events = traceDefaultEvents;
+   for (traceEvents = 1; traceEvents < events && traceEvents < 0x40000000; traceEvents <<= 1);
+   traceFile = fopen(fileName, "wb");
+   return (traceFile != nil);
+} /* Host_SetTraceFile */
+
+
+static TRACE *NewTrace (void)
+{
+   TRACE *T = nil;
+
+   pthread_mutex_lock(&traceLock);
+   if (freeTraces > 0) T = FreeTraces[--freeTraces];
+   pthread_mutex_unlock(&traceLock);
+   if (T) return T;
+
+   T = (TRACE*)calloc(1, sizeof(TRACE));
+
+   if (T && ! (T->Events = (TRACE_EVENT*)malloc(traceEvents*sizeof(TRACE_EVENT))))
+   {  free(T);
+      return nil;
+   }
+   if (T) T->mask = traceEvents - 1;
+   return T;
+} /* NewTrace */
+
+
+static void FreeTrace (TRACE *T)
+{
+   BOOL kept = false;
+
+   pthread_mutex_lock(&traceLock);
+   if (freeTraces < maxEngines)
+   {  FreeTraces[freeTraces++] = T;
+      kept = true;
+   }
+   pthread_mutex_unlock(&traceLock);
+
+   if (! kept)
+   {  free(T->Events);
+      free(T);
+   }
+} /* FreeTrace */
+
+
+static void WriteTrace (ENGINE *E, TRACE *T)
+{
+   TRACE_FILE_HEADER H;
+   ULONG64           size = T->mask + 1;
+
+   H.magic          = traceFileMagic;
+   H.version        = traceFileVersion;
+   H.eventSize      = sizeof(TRACE_EVENT);
+   H.mainDepth      = Engine_MainDepth(E);
+   H.clockShift     = traceClockShift;
+   H.stampInterval  = traceStampInterval;
+   H.count          = (T->count < size ? T->count : size);
+   H.dropped        = T->count - H.count;
+   H.startTime      = T->startTime;
+   H.endTime        = T->endTime;
+   H.startMicroTime = T->startMicroTime;
+   H.endMicroTime   = T->endMicroTime;
+
+   ULONG64 first = (T->count - H.count) & T->mask;    // Index of oldest event in the ring buffer.
+   ULONG64 n1    = (first + H.count <= size ? H.count : size - first);
+
+   pthread_mutex_lock(&traceLock);
+   fwrite(&H, sizeof(H), 1, traceFile);
+   fwrite(&T->Events[first], sizeof(TRACE_EVENT), n1, traceFile);
+   fwrite(&T->Events[0], sizeof(TRACE_EVENT), H.count - n1, traceFile);
+   fflush(traceFile);
+   pthread_mutex_unlock(&traceLock);
+} /* WriteTrace */
+
+/*------------------------------------------ Run Search ------------------------------------------*/
+// Starts the engine (in its own thread) and runs the host side of the message loop in the calling
+// thread until the search has completed. Each pending message is passed to "MsgFunc" (if any), and
+// sync messages are then replied to. Host queries are answered with "unknown". While the engine
+// searches, "MsgFunc" may call Engine_Stop() (e.g. on msg_Periodic) but must not block.
+
+static void ProcessMessages (ENGINE *E, ULONG queue, HOST_MSGFUNC MsgFunc, PTR data);
+
+void Host_Search (ENGINE *E, HOST_MSGFUNC MsgFunc, PTR data)
+{
+   TRACE *T = (traceFile ? NewTrace() : nil);
+
+   E->P.Trace = T;
+   Engine_Start(E);
+
+   for (ULONG queue; (queue = Engine_WaitMsg(E)) != 0; )
+      ProcessMessages(E, queue, MsgFunc, data);
+
+#ifdef __engine_stats
+   WriteSearchStats(E);
+#endif
+
+   if (T)
+   {  E->P.Trace = nil;
+      WriteTrace(E, T);
+      FreeTrace(T);
+   }
+} /* Host_Search */
+
+
+static void ProcessMessages (ENGINE *E, ULONG queue, HOST_MSGFUNC MsgFunc, PTR data)
+{
+   if (queue & msg_ProbeEndgDB)
+      E->S.edbResult = -1;
+
+   if (MsgFunc)
+      for (ULONG msg = 1; msg <= msg_Cutoff; msg <<= 1)
+         if (queue & msg) (*MsgFunc)(E, msg, data);
+
+   Engine_ReplyMsg(E, queue);
+} /* ProcessMessages */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                               MISC                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Formats a move in coordinate (UCI) notation, e.g. "e2e4", "e1g1" or "e7e8q".
+
+void Host_MoveStr (MOVE *m, CHAR *s)
+{
+   if (isNull(*m))
+   {  CopyStr("0000", s);
+      return;
+   }
+
+   *(s++) = 'a' + file(m->from);
+   *(s++) = '1' + rank(m->from);
+   *(s++) = 'a' + file(m->to);
+   *(s++) = '1' + rank(m->to);
+   if (isPromotion(*m))
+      *(s++) = " pnbrqk"[pieceType(m->type)];
+   *s = 0;
+} /* Host_MoveStr */
+
+
+// Parses a move in coordinate (UCI) notation (see above), and returns the matching legal move in
+// the current position of the game (nil if none). Promotions default to queen promotions.
+
+MOVE *Host_ParseMove (CGame *game, CHAR *s)
+{
+   if (s[0] < 'a' || s[0] > 'h' || s[1] < '1' || s[1] > '8' ||
+       s[2] < 'a' || s[2] > 'h' || s[3] < '1' || s[3] > '8')
+      return nil;
+
+   SQUARE from = square(s[0] - 'a', s[1] - '1');
+   SQUARE to   = square(s[2] - 'a', s[3] - '1');
+   INT    prom = queen;
+
+   switch (s[4])
+   {
+      case 'n' : case 'N' : prom = knight; break;
+      case 'b' : case 'B' : prom = bishop; break;
+      case 'r' : case 'R' : prom = rook; break;
+   }
+
+   for (INT i = 0; i < game->moveCount; i++)
+   {
+      MOVE *m = &game->Moves[i];
+      if (m->from == from && m->to == to && (! isPromotion(*m) || pieceType(m->type) == prom))
+         return m;
+   }
+   return nil;
+} /* Host_ParseMove */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           PGN FILES                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#define pgnWindowSize  100000L                     // Max PGN game size (as for PGN import).
+
+// Locates the games of a PGN text with the PGN parser (through a window of "pgnWindowSize"
+// bytes, as the parser preprocesses the whole buffer). Must be called from the main thread
+// (CGame::ResetGame isn't thread safe). Game i runs from Start[i] to Start[i + 1]
+// (or the end of the text). Unparseable games are skipped to the next tag section, so they can be
+// copied as is.
+
+INT Host_SplitPGN (CHAR *text, LONG size, LONG **Start)
+{
+   CHAR  *buf  = (CHAR*)malloc(pgnWindowSize);
+   CGame *game = new CGame();
+   CPgn  pgn(game);
+   INT   count = 0, n = 0;
+   LONG  pos = 0;
+
+   *Start = nil;
+
+   while (pos < size)
+   {
+      LONG bytes = MinL(pgnWindowSize, size - pos);
+
+      memcpy(buf, text + pos, bytes);
+      pgn.ReadBegin(buf);
+      if (! pgn.ReadGame(bytes))
+      {  if (pgn.GetError() == pgnErr_EOFReached) break;
+         pgn.SkipGame();
+      }
+
+      if (count == n)
+      {  n = (n > 0 ? 2*n : 256);
+         *Start = (LONG*)realloc(*Start, n*sizeof(LONG));
+      }
+      (*Start)[count++] = pos;
+
+      if (pgn.GetBytesRead() <= 0) break;
+      pos += pgn.GetBytesRead();
+   }
+
+   delete game;
+   free(buf);
+   return count;
+} /* Host_SplitPGN */
+
+
+// Reads a whole file into a (malloc'ed) buffer. Returns nil if it can't be read.
+
+CHAR *Host_ReadFile (CHAR *fileName, LONG *size)
+{
+   FILE *file = fopen(fileName, "rb");
+   CHAR *text = nil;
+
+   *size = -1;
+   if (! file) return nil;
+
+   if (fseek(file, 0, SEEK_END) == 0 && (*size = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+   {  text = (CHAR*)malloc(*size + 1);
+      if (fread(text, 1, *size, file) != (size_t)*size)
+         free(text), text = nil;
+   }
+   fclose(file);
+   return text;
+} /* Host_ReadFile */
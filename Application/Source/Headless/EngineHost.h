@@ -0,0 +1,85 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "Engine.h"
+#include "Game.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        TYPE DEFINITIONS                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+typedef void (*HOST_MSGFUNC)(ENGINE *E, ULONG msg, PTR data);
+
+// A search trace file (see Host_SetTraceFile) holds one record per search: A TRACE_FILE_HEADER
+// followed by "count" TRACE_EVENT records in chronological order (see "Trace.h").
+
+#define traceFileMagic    0x53545243   // 'STRC'
+#define traceFileVersion  2
+
+typedef struct
+{
+   ULONG   magic;                        // traceFileMagic.
+   ULONG   version;                      // traceFileVersion.
+   ULONG   eventSize;                    // sizeof(TRACE_EVENT).
+   LONG    mainDepth;                    // Depth reached by the search.
+   LONG    clockShift;                   // traceClockShift and traceStampInterval of the
+   LONG    stampInterval;                // engine.
+   ULONG64 count;                        // Number of events in the record.
+   ULONG64 dropped;                      // Events overwritten in the ring buffer (the oldest,
+                                         // i.e. "dropped" is the number of the first event).
+   LONG64  startTime, endTime;           // Trace clock at start/end of search.
+   LONG64  startMicroTime, endMicroTime; // Corresponding MicroTimer() values.
+} TRACE_FILE_HEADER;
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          FUNCTION PROTOTYPES                                   */
+/*                                                                                                */
+/**************************************************************************************************/
+
+void Host_InitSystem (void);
+void Host_EndSystem (void);
+INT  Host_SetEndgameDB (CHAR *dir);
+
+void Host_SetGame (ENGINE *E, CGame *game);
+BOOL Host_SetTransTables (ENGINE *E, ULONG64 bytes);
+void Host_SetTransReserve (ULONG64 bytes);
+BOOL Host_SaveTransTables (ENGINE *E, CHAR *fileName, HKEY rootKey);
+BOOL Host_LoadTransTables (ENGINE *E, CHAR *fileName, HKEY rootKey);
+BOOL Host_SetThreads (ENGINE *E, INT threads);
+void Host_Search (ENGINE *E, HOST_MSGFUNC MsgFunc = nil, PTR data = nil);
+BOOL Host_SetStatsFile (CHAR *fileName);
+BOOL Host_SetTraceFile (CHAR *fileName, LONG events = 0);
+
+void  Host_MoveStr (MOVE *m, CHAR *s);
+MOVE *Host_ParseMove (CGame *game, CHAR *s);
+
+CHAR *Host_ReadFile (CHAR *fileName, LONG *size);
+INT   Host_SplitPGN (CHAR *text, LONG size, LONG **Start);
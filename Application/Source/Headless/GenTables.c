@@ -0,0 +1,272 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EngineHost.h"
+
+#include "Engine.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Build step that generates the read only engine tables (see ENGINE_TABLES in "Engine.h") as a C
+// source file, which is compiled into the headless engine host. At startup the host then simply
+// copies the tables instead of computing them (Engine_InitSystem). The KPK database, which is a Mac
+// resource in the GUI version, is computed here by retrograde analysis.
+//
+// The generated file contains the raw bytes of the tables, so it must be generated on a machine
+// with the same byte order and struct layout as the target (which is the case for a native build).
+
+#define kpkWin      1                    // KPK work entries (the pawn side wins).
+#define kpkUnknown  0
+#define kpkIllegal  2
+
+#define kpkEntries  (kpkDataSize*8)
+
+static BYTE  Work[kpkEntries];
+static BYTE  kpkData[kpkDataSize];
+
+static void SolveKPK (void);
+static BOOL WriteTables (CHAR *fileName);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                               MAIN                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (int argc, char *argv[])
+{
+   if (argc != 2)
+   {  fprintf(stderr, "usage: sigma-gentables output.c\n");
+      return 2;
+   }
+
+   SolveKPK();
+   Engine_InitSystem(&Global, kpkData);
+
+   if (! WriteTables(argv[1]))
+   {  fprintf(stderr, "sigma-gentables: cannot write \"%s\"\n", argv[1]);
+      return 1;
+   }
+   return 0;
+} /* main */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          KPK DATABASE                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The positions are indexed exactly as in EvalKPK() (see "Evaluate.c"): White has the pawn on the
+// a-d files (ranks 2-7), and the side to move is bit 0. A position is marked as won if White can
+// force promotion without losing the new queen (or rook) or stalemating Black. The remaining legal
+// positions are draws.
+
+static SQUARE KingDirs[8] = { -0x11, -0x10, -0x0F, -0x01, 0x01, 0x0F, 0x10, 0x11 };
+
+static LONG KPKIndex (SQUARE psq, SQUARE wk, SQUARE bk, COLOUR player)
+{
+   LONG n;
+
+   n = ((((psq & 0x70) >> 2) - 4) | (psq & 0x07)) << 6;
+   n = (n | ((wk & 0x70) >> 1) | (wk & 0x07)) << 6;
+   n = (n | ((bk & 0x70) >> 1) | (bk & 0x07)) << 1;
+   return (player == white ? n : n | 1);
+} /* KPKIndex */
+
+
+static void KPKPosition (LONG n, SQUARE *psq, SQUARE *wk, SQUARE *bk)
+{
+   *psq = ((((n >> 15) & 0x07) + 1) << 4) | ((n >> 13) & 0x03);
+   *wk  = (((n >> 10) & 0x07) << 4) | ((n >> 7) & 0x07);
+   *bk  = (((n >> 4) & 0x07) << 4) | ((n >> 1) & 0x07);
+} /* KPKPosition */
+
+
+static BOOL Adjacent (SQUARE sq1, SQUARE sq2)
+{
+   return (sq1 != sq2 && Abs(rank(sq1) - rank(sq2)) <= 1 && Abs(file(sq1) - file(sq2)) <= 1);
+} /* Adjacent */
+
+
+static BOOL PawnAttacks (SQUARE psq, SQUARE sq)
+{
+   return (sq == psq + 0x0F && file(psq) > 0) || (sq == psq + 0x11 && file(psq) < 7);
+} /* PawnAttacks */
+
+
+// Does a white queen (or rook) on "qsq" attack "sq" (the white king on "wk" may block)?
+
+static BOOL SliderAttacks (SQUARE qsq, SQUARE wk, SQUARE sq, BOOL queen)
+{
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE dir = KingDirs[i];
+      if (! queen && dir != 0x01 && dir != -0x01 && dir != 0x10 && dir != -0x10) continue;
+
+      for (SQUARE to = qsq + dir; onBoard(to) && to != wk; to += dir)
+         if (to == sq) return true;
+   }
+   return false;
+} /* SliderAttacks */
+
+
+// Black to move after a promotion on "qsq": Is it a win for White (i.e. the new piece can't be
+// captured and Black isn't stalemated)?
+
+static BOOL PromotionWins (SQUARE qsq, SQUARE wk, SQUARE bk, BOOL queen)
+{
+   if (Adjacent(bk, qsq) && ! Adjacent(wk, qsq)) return false;
+
+   if (SliderAttacks(qsq, wk, bk, queen)) return true;        // Check (or mate)
+
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE to = bk + KingDirs[i];
+      if (onBoard(to) && ! Adjacent(to, wk) && to != qsq && ! SliderAttacks(qsq, wk, to, queen))
+         return true;
+   }
+   return false;                                               // Stalemate
+} /* PromotionWins */
+
+
+// White to move: Won if a pawn move (incl. promotion) or a king move leads to a won position.
+
+static BOOL WhiteWins (SQUARE psq, SQUARE wk, SQUARE bk)
+{
+   SQUARE to = psq + 0x10;
+
+   if (to != wk && to != bk)
+   {
+      if (rank(to) == 7)
+      {  if (PromotionWins(to, wk, bk, true) || PromotionWins(to, wk, bk, false)) return true;
+      }
+      else
+      {  if (Work[KPKIndex(to, wk, bk, black)] == kpkWin) return true;
+         if (rank(psq) == 1 && to + 0x10 != wk && to + 0x10 != bk &&
+             Work[KPKIndex(to + 0x10, wk, bk, black)] == kpkWin) return true;
+      }
+   }
+
+   for (INT i = 0; i < 8; i++)
+   {
+      to = wk + KingDirs[i];
+      if (onBoard(to) && to != psq && ! Adjacent(to, bk) && Work[KPKIndex(psq, to, bk, black)] == kpkWin)
+         return true;
+   }
+   return false;
+} /* WhiteWins */
+
+
+// Black to move: Won (for White) if mated, or if Black can't take the pawn and all king moves lead
+// to won positions.
+
+static BOOL BlackLoses (SQUARE psq, SQUARE wk, SQUARE bk)
+{
+   INT moves = 0;
+
+   for (INT i = 0; i < 8; i++)
+   {
+      SQUARE to = bk + KingDirs[i];
+      if (! onBoard(to) || Adjacent(to, wk) || PawnAttacks(psq, to)) continue;
+      if (to == psq) return false;                             // Takes the (undefended) pawn
+      if (Work[KPKIndex(psq, wk, to, white)] != kpkWin) return false;
+      moves++;
+   }
+   return (moves > 0 || PawnAttacks(psq, bk));                 // Stalemate is a draw
+} /* BlackLoses */
+
+
+static void SolveKPK (void)
+{
+   LONG changes;
+
+   for (LONG n = 0; n < kpkEntries; n++)
+   {
+      SQUARE psq, wk, bk;
+      KPKPosition(n, &psq, &wk, &bk);
+
+      BOOL illegal = (wk == bk || wk == psq || bk == psq || Adjacent(wk, bk) ||
+                      (! (n & 1) && PawnAttacks(psq, bk)));
+      Work[n] = (illegal ? kpkIllegal : kpkUnknown);
+   }
+
+   do
+   {
+      changes = 0;
+      for (LONG n = 0; n < kpkEntries; n++)
+      {
+         if (Work[n] != kpkUnknown) continue;
+
+         SQUARE psq, wk, bk;
+         KPKPosition(n, &psq, &wk, &bk);
+         if (n & 1 ? BlackLoses(psq, wk, bk) : WhiteWins(psq, wk, bk))
+         {  Work[n] = kpkWin;
+            changes++;
+         }
+      }
+   } while (changes > 0);
+
+   for (LONG n = 0; n < kpkEntries; n++)
+      if (Work[n] == kpkWin)
+         kpkData[n >> 3] |= bit(n & 0x07);
+} /* SolveKPK */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          WRITE TABLES                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static BOOL WriteTables (CHAR *fileName)
+{
+   static ENGINE_TABLES T;
+
+   FILE *file = fopen(fileName, "w");
+   if (! file) return false;
+
+   Engine_GetTables(&Global, &T);
+
+   fprintf(file, "// Generated by sigma-gentables (see \"Headless/GenTables.c\") - do not edit.\n\n");
+   fprintf(file, "#include \"Engine.h\"\n\n");
+   fprintf(file, "static const union { BYTE Data[%lu]; ENGINE_TABLES T; } Tables = {{", (unsigned long)sizeof(T));
+
+   BYTE *Data = (BYTE*)&T;
+   for (ULONG i = 0; i < sizeof(T); i++)
+      fprintf(file, "%s%u,", (i % 32 == 0 ? "\n   " : ""), Data[i]);
+
+   fprintf(file, "\n}};\n\nconst ENGINE_TABLES *EngineTables = &Tables.T;\n");
+   return (fclose(file) == 0);
+} /* WriteTables */
@@ -0,0 +1,898 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : MATCH.C                                                                              */
+/* Purpose : Headless engine match runner. Plays concurrent games between two Sigma engine        */
+/*           configurations from an opening suite, and reports the running Elo difference (or    */
+/*           runs a sequential probability ratio test).                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "EngineHost.h"
+#include "GameUtil.h"
+#include "PGN.h"
+#include "Level.h"
+#include "Rating.h"
+
+#include "Engine.f"
+#include "Time.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The games are played as an engine match in the application (see "AutoDemoPlay.c"), i.e. the
+// engines alternate colours, the time controls are given by a LEVEL (as in the "Engine Match"
+// dialog), and games are adjudicated with the same rules. Each opening of the suite is played
+// twice (once with each colour), and the openings are repeated if the match has more games.
+//
+// Each worker thread plays one game at a time with its own pair of engine instances (one per
+// configuration), and repeatedly takes the next game from the shared queue. Finished games are
+// appended to the PGN file as they complete (with the game number in the "Round" tag).
+//
+// In SPRT mode the match is stopped as soon as the test accepts H0 or H1 (see "Rating.c"), and
+// the games are then counted as pentanomial pairs. No new games are started after the decision,
+// but the games in progress are completed (and included in the final stats). The two engines are
+// configurations of this build, e.g. "-e2 selmargin=6" tests a wider selection margin.
+
+#define sprtMaxGames   20000                       // Default max games in SPRT mode.
+
+typedef struct
+{
+   CHAR    name[nameStrLen + 1];                   // Player name in the PGN file.
+   INT     threads;                                // Search threads.
+   ULONG64 hashBytes;                              // Transposition table size.
+   INT     playingStyle;                           // Search/eval parameters (see PARAM).
+   BOOL    selection;
+   BOOL    deepSelection;
+   INT     selMargin;
+   BOOL    extensions;
+   BOOL    nondeterm;
+} MATCH_ENGINE;
+
+typedef struct
+{
+   CHAR    *text;                                  // EPD line or PGN game.
+   LONG    size;
+   BOOL    epd;
+} OPENING;
+
+typedef struct
+{
+   MATCH_ENGINE Engine[2];                         // Engine 1 has white in the first game.
+   LEVEL   level;                                  // Time controls.
+   INT     games;                                  // Number of games in match.
+   INT     concurrency;                            // Number of concurrent games.
+   BOOL    adjWin;                                 // Adjudicate wins?
+   INT     adjWinLimit;                            // Win adjudication limit (in pawns).
+   BOOL    adjDraw;                                // Adjudicate draws?
+
+   CHAR    *openingFile;                           // EPD or PGN file (start position if nil).
+   INT     plies;                                  // Opening plies used from PGN games.
+   CHAR    *pgn;                                   // The opening PGN file.
+   INT     openingCount;
+   OPENING *Opening;
+
+   CHAR    *pgnFile;                               // Output PGN file (optional).
+   FILE    *pgnOut;
+
+   INT     next;                                   // Work queue (index of next game).
+   INT     played;                                 // Number of games completed.
+   INT     wins, draws, losses;                    // Match score (seen from engine 1).
+   INT     *Score;                                 // Score of each game for engine 1 in half
+                                                   // points (-1 if not played yet).
+   BOOL    sprt;                                   // Run SPRT?
+   REAL    elo0, elo1;                             // ELO difference of engine 1 under H0 and H1.
+   REAL    alpha, beta;                            // False positive/negative rates.
+   REAL    llr, llrLower, llrUpper;                // Log likelihood ratio and stop bounds.
+   LONG    Penta[pentaCount];                      // Pentanomial stats of the completed pairs.
+   INT     sprtResult;                             // 0 = Undecided, 1 = H1 accepted, -1 = H0.
+   LONG64  startMicroSecs;
+   pthread_mutex_t lock;                           // Protects the queue, stats, output and CGame
+                                                   // resets.
+   INT     result;                                 // Exit status.
+} MATCH;
+
+typedef struct
+{
+   MATCH     *M;
+   ENGINE    *E[2];                                // Engine instances of the 2 configurations.
+   CGame     *game;
+   pthread_t thread;
+} WORKER;
+
+typedef struct                                     // State of the chess clocks of a game.
+{
+   LONG64  timeLeftMS[2];                          // Indexed by colour (white = 0, black = 1).
+   LONG64  elapsedMS[2];
+} CLOCKS;
+
+static BOOL   ParseEngine     (MATCH_ENGINE *C, CHAR *s);
+static BOOL   ParseTimeControl(LEVEL *L, CHAR *s);
+static BOOL   LoadOpenings    (MATCH *M);
+static BOOL   SetupOpening    (MATCH *M, CGame *game, OPENING *o);
+static void   RunMatch        (MATCH *M);
+static void   *WorkerThread   (void *data);
+static void   PlayGame        (WORKER *W, INT gameNo);
+static void   SetSearchParam  (MATCH *M, ENGINE *E, CGame *game, CLOCKS *C);
+static BOOL   Adjudicate      (MATCH *M, CGame *game, INT score, INT *prevScore, INT *adjWinCount, INT *adjDrawCount);
+static void   SetGameResult   (CGame *game, INT result, INT infoResult, CHAR *text);
+static void   CalcElo         (INT wins, INT draws, INT losses, INT *elo, INT *margin);
+static void   PrintGame       (MATCH *M, INT gameNo, CGame *game);
+static void   PrintSummary    (MATCH *M);
+static void   Usage           (void);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          MAIN PROGRAM                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (int argc, char *argv[])
+{
+   MATCH M;
+   BOOL  ok      = true;
+   BOOL  games   = false;                          // Explicit number of games?
+   INT   threads = 1;
+   LONG  hashMB  = 16;
+
+   memset(&M, 0, sizeof(MATCH));
+   Level_Reset(&M.level);                          // EngineMatch_ResetParam() defaults.
+   M.games       = 10;
+   M.concurrency = 1;
+   M.adjWin      = true;
+   M.adjWinLimit = 5;
+   M.adjDraw     = true;
+   M.plies       = 8;
+   M.alpha       = 0.05;
+   M.beta        = 0.05;
+
+   for (INT i = 1; i < argc; i++)                  // Common engine options first.
+      if (EqualStr(argv[i], "-threads") && i + 1 < argc)
+         threads = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-hash") && i + 1 < argc)
+         hashMB = atol(argv[++i]);
+
+   for (INT k = 0; k < 2; k++)
+   {  MATCH_ENGINE *C = &M.Engine[k];
+      Format(C->name, "Sigma %d", k + 1);
+      C->threads       = threads;
+      C->hashBytes     = (ULONG64)hashMB*1024L*1024L;
+      C->playingStyle  = style_Normal;
+      C->selection     = true;
+      C->deepSelection = true;                     // (As GameWindow::SetSearchParam).
+      C->selMargin     = 4;
+      C->extensions    = true;
+      C->nondeterm     = false;
+   }
+
+   for (INT i = 1; i < argc; i++)
+      if ((EqualStr(argv[i], "-threads") || EqualStr(argv[i], "-hash")) && i + 1 < argc)
+         i++;
+      else if (EqualStr(argv[i], "-games") && i + 1 < argc)
+         M.games = atoi(argv[++i]), games = true;
+      else if (EqualStr(argv[i], "-concurrency") && i + 1 < argc)
+         M.concurrency = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-tc") && i + 1 < argc)
+         ok = ParseTimeControl(&M.level, argv[++i]) && ok;
+      else if (EqualStr(argv[i], "-avg") && i + 1 < argc)
+         M.level.mode = pmode_Average, M.level.Average.secs = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-depth") && i + 1 < argc)
+         M.level.mode = pmode_FixedDepth, M.level.FixedDepth.depth = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-openings") && i + 1 < argc)
+         M.openingFile = argv[++i];
+      else if (EqualStr(argv[i], "-plies") && i + 1 < argc)
+         M.plies = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-pgn") && i + 1 < argc)
+         M.pgnFile = argv[++i];
+      else if (EqualStr(argv[i], "-adjwin") && i + 1 < argc)
+         M.adjWinLimit = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-noadj"))
+         M.adjWin = M.adjDraw = false;
+      else if (EqualStr(argv[i], "-sprt") && i + 2 < argc)
+      {  M.sprt = true;
+         M.elo0 = atof(argv[++i]);
+         M.elo1 = atof(argv[++i]);
+      }
+      else if (EqualStr(argv[i], "-alpha") && i + 1 < argc)
+         M.alpha = atof(argv[++i]);
+      else if (EqualStr(argv[i], "-beta") && i + 1 < argc)
+         M.beta = atof(argv[++i]);
+      else if ((EqualStr(argv[i], "-e1") || EqualStr(argv[i], "-e2")) && i + 1 < argc)
+      {  ok = ParseEngine(&M.Engine[argv[i][2] - '1'], argv[i + 1]) && ok;
+         i++;
+      }
+      else
+      {  Usage();
+         return 2;
+      }
+
+   ok = ok && (M.games > 0 && M.concurrency >= 1 && 2*M.concurrency <= maxEngines && M.plies >= 0 &&
+              M.adjWinLimit >= 3 && M.adjWinLimit <= 9);
+   if (M.level.mode == pmode_Average)    ok = ok && M.level.Average.secs > 0;
+   if (M.level.mode == pmode_FixedDepth) ok = ok && M.level.FixedDepth.depth > 0 && M.level.FixedDepth.depth < maxSearchDepth;
+   for (INT k = 0; k < 2; k++)
+      ok = ok && M.Engine[k].threads >= 1 && M.Engine[k].threads <= maxSearchThreads;
+
+   if (M.sprt)                                     // The SPRT runs in whole game pairs (until
+   {                                               // a decision, or at most "games" games).
+      if (! games) M.games = sprtMaxGames;
+      M.games += odd(M.games);
+      ok = ok && M.elo0 < M.elo1 && M.alpha > 0.0 && M.alpha < 0.5 && M.beta > 0.0 && M.beta < 0.5;
+      SPRT_Bounds(M.alpha, M.beta, &M.llrLower, &M.llrUpper);
+   }
+
+   if (! ok)
+   {  Usage();
+      return 2;
+   }
+
+   Host_InitSystem();
+
+   if (! LoadOpenings(&M))
+      M.result = 1;
+   else if (M.pgnFile && ! (M.pgnOut = fopen(M.pgnFile, "ab")))
+   {  fprintf(stderr, "sigma-match: cannot open \"%s\"\n", M.pgnFile);
+      M.result = 1;
+   }
+   else
+   {  RunMatch(&M);
+      if (M.pgnOut && fclose(M.pgnOut) != 0)
+      {  fprintf(stderr, "sigma-match: cannot write \"%s\"\n", M.pgnFile);
+         M.result = 1;
+      }
+   }
+
+   Host_EndSystem();
+
+   free(M.Score);
+   free(M.Opening);
+   free(M.pgn);
+   return M.result;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-match [-games n] [-concurrency n] [-tc secs[/moves][+inc] | -avg secs | -depth n]\n");
+   fprintf(stderr, "                   [-openings file.epd|file.pgn] [-plies n] [-pgn file] [-adjwin pawns]\n");
+   fprintf(stderr, "                   [-noadj] [-sprt elo0 elo1 [-alpha a] [-beta b]] [-threads n] [-hash mb]\n");
+   fprintf(stderr, "                   [-e1 options] [-e2 options]\n");
+   fprintf(stderr, "engine options: name=s,threads=n,hash=mb,style=1..5,selection=0|1,deepselection=0|1,\n");
+   fprintf(stderr, "                selmargin=n,extensions=0|1,nondeterm=0|1\n");
+} /* Usage */
+
+/*---------------------------------------- Parse Options -----------------------------------------*/
+// Engine options are given as a comma separated list of "key=value" pairs.
+
+static BOOL ParseEngine (MATCH_ENGINE *C, CHAR *s)
+{
+   while (*s)
+   {
+      CHAR key[20], value[nameStrLen + 1];
+      INT  n = 0;
+
+      for (n = 0; *s && *s != '=' && *s != ','; s++) if (n < 19) key[n++] = *s;
+      key[n] = 0;
+      if (*s != '=') return false;
+      for (n = 0, s++; *s && *s != ','; s++) if (n < nameStrLen) value[n++] = *s;
+      value[n] = 0;
+      if (*s) s++;
+
+      INT v = atoi(value);
+
+      if (EqualStr(key, "name"))               CopyStr(value, C->name);
+      else if (EqualStr(key, "threads"))       C->threads = v;
+      else if (EqualStr(key, "hash"))          C->hashBytes = (ULONG64)v*1024L*1024L;
+      else if (EqualStr(key, "style"))         C->playingStyle = v;
+      else if (EqualStr(key, "selection"))     C->selection = (v != 0);
+      else if (EqualStr(key, "deepselection")) C->deepSelection = (v != 0);
+      else if (EqualStr(key, "selmargin"))     C->selMargin = v;
+      else if (EqualStr(key, "extensions"))    C->extensions = (v != 0);
+      else if (EqualStr(key, "nondeterm"))     C->nondeterm = (v != 0);
+      else return false;
+
+      if (EqualStr(key, "style") && (v < style_Chicken || v > style_Desperado)) return false;
+      if (EqualStr(key, "selmargin") && (v < 0 || v > 100)) return false;
+   }
+   return true;
+} /* ParseEngine */
+
+
+// Parses a "Time/Moves" level: "secs[/moves][+inc]", e.g. "60", "300/40" or "60+1" (Fischer).
+
+static BOOL ParseTimeControl (LEVEL *L, CHAR *s)
+{
+   LONG time, moves = allMoves, inc = 0;
+   INT  n;
+
+   if ((n = FrontStrNum(s, &time)) == 0 || time <= 0) return false;
+   s += n;
+   if (*s == '/')
+   {  if ((n = FrontStrNum(++s, &moves)) == 0 || moves <= 0) return false;
+      s += n;
+   }
+   if (*s == '+')
+   {  if ((n = FrontStrNum(++s, &inc)) == 0 || inc < 0) return false;
+      s += n;
+   }
+   if (*s || time > maxint) return false;
+
+   L->mode                = pmode_TimeMoves;
+   L->TimeMoves.time      = time;
+   L->TimeMoves.moves     = moves;
+   L->TimeMoves.clockType = (inc > 0 ? clock_Fischer : clock_Normal);
+   L->TimeMoves.delta     = inc;
+   return true;
+} /* ParseTimeControl */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                            OPENINGS                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Reads the opening suite: An EPD file (one position per line) or a PGN file (of which the first
+// "plies" half moves of each game are used). Invalid openings (and openings in which the game is
+// already over) are skipped.
+
+static BOOL LoadOpenings (MATCH *M)
+{
+   LONG size;
+
+   if (! M->openingFile) return true;
+
+   if (! (M->pgn = Host_ReadFile(M->openingFile, &size)))
+   {  fprintf(stderr, "sigma-match: cannot read \"%s\"\n", M->openingFile);
+      return false;
+   }
+   M->pgn[size] = 0;
+
+   INT  len = StrLen(M->openingFile);
+   BOOL epd = (len > 4 && SameStr(M->openingFile + len - 4, ".epd"));
+   INT  count, invalid = 0;
+   LONG *Start = nil;
+
+   if (epd)                                        // Split into lines.
+   {  INT n = 0;
+      count = 0;
+      for (CHAR *s = M->pgn; *s; )
+      {  if (count == n)
+         {  n = (n > 0 ? 2*n : 256);
+            Start = (LONG*)realloc(Start, n*sizeof(LONG));
+         }
+         Start[count++] = s - M->pgn;
+         while (*s && ! IsNewLine(*s)) s++;
+         while (IsNewLine(*s)) *(s++) = 0;
+      }
+   }
+   else
+      count = Host_SplitPGN(M->pgn, size, &Start);
+
+   M->Opening = (OPENING*)calloc(Max(count, 1), sizeof(OPENING));
+
+   CGame *game = new CGame();
+
+   for (INT i = 0; i < count; i++)
+   {
+      OPENING *o = &M->Opening[M->openingCount];
+      o->text = M->pgn + Start[i];
+      o->size = (i + 1 < count ? Start[i + 1] : size) - Start[i];
+      o->epd  = epd;
+
+      if (epd && (! o->text[0] || o->text[0] == '#')) continue;
+      if (SetupOpening(M, game, o) && game->moveCount > 0)
+         M->openingCount++;
+      else
+         invalid++;
+   }
+
+   delete game;
+   free(Start);
+
+   if (invalid > 0)
+      fprintf(stderr, "sigma-match: %d invalid opening%s skipped\n", invalid, (invalid == 1 ? "" : "s"));
+   if (M->openingCount == 0)
+   {  fprintf(stderr, "sigma-match: no openings found in \"%s\"\n", M->openingFile);
+      return false;
+   }
+   return true;
+} /* LoadOpenings */
+
+
+// Sets up the opening (or the initial position if "o" is nil) in the game, and clears the game
+// information and annotations. Must be called with the lock held (CGame::ResetGame isn't thread
+// safe).
+
+static BOOL SetupOpening (MATCH *M, CGame *game, OPENING *o)
+{
+   if (! o)
+      game->NewGame();
+   else if (o->epd)
+   {  if (game->Read_EPD(o->text) != epdErr_NoError) return false;
+   }
+   else
+   {
+      CHAR *buf = (CHAR*)malloc(o->size + 1);
+      CPgn pgn(game);
+
+      memcpy(buf, o->text, o->size);
+      pgn.ReadBegin(buf);
+      BOOL ok = pgn.ReadGame(o->size);
+      free(buf);
+      if (! ok) return false;
+
+      game->UndoAllMoves();
+      while (game->currMove < M->plies && game->currMove < game->lastMove)
+         game->RedoMove(false);
+      if (game->currMove == 0) return false;
+
+      MOVE m = game->Record[game->currMove];       // Replay the last opening move to truncate the
+      game->UndoMove(false);                       // game and recalc the legal moves and result.
+      game->PlayMove(&m);
+   }
+
+   game->ClrAnnotation();
+   for (INT i = 1; i <= game->lastMove; i++)
+      game->SetAnnotationGlyph(i, 0);
+   game->ResetGameInfo();
+   return true;
+} /* SetupOpening */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                            RUN MATCH                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void RunMatch (MATCH *M)
+{
+   INT    n = Min(M->concurrency, M->games);
+   WORKER *W = (WORKER*)calloc(n, sizeof(WORKER));
+
+   M->Score = (INT*)malloc(M->games*sizeof(INT));
+   for (INT i = 0; i < M->games; i++)
+      M->Score[i] = -1;
+
+   printf("Sigma Chess match: %s vs %s, %d games, %d concurrent", M->Engine[0].name, M->Engine[1].name, M->games, n);
+   switch (M->level.mode)
+   {
+      case pmode_TimeMoves  :
+         printf(", %d s", M->level.TimeMoves.time);
+         if (M->level.TimeMoves.moves != allMoves) printf("/%d", M->level.TimeMoves.moves);
+         if (M->level.TimeMoves.clockType == clock_Fischer) printf("+%d", M->level.TimeMoves.delta);
+         break;
+      case pmode_Average    : printf(", %d s/move", M->level.Average.secs); break;
+      case pmode_FixedDepth : printf(", depth %d", M->level.FixedDepth.depth); break;
+   }
+   if (M->openingCount > 0) printf(", %d openings", M->openingCount);
+   printf("\n");
+   if (M->sprt)
+      printf("SPRT elo0 = %g, elo1 = %g, alpha = %.3f, beta = %.3f, LLR bounds (%.2f, %.2f)\n",
+             M->elo0, M->elo1, M->alpha, M->beta, M->llrLower, M->llrUpper);
+   printf("\n");
+   fflush(stdout);
+
+   for (INT k = 0; k < n && M->result == 0; k++)   // The engines are created up front (the
+   {                                               // engine table isn't thread safe).
+      WORKER *w = &W[k];
+      w->M    = M;
+      w->game = new CGame();
+
+      for (INT j = 0; j < 2; j++)
+      {
+         w->E[j] = (ENGINE*)calloc(1, sizeof(ENGINE));
+         Engine_Create(&Global, w->E[j], 2*k + j);
+
+         if (! Host_SetTransTables(w->E[j], M->Engine[j].hashBytes) || ! Host_SetThreads(w->E[j], M->Engine[j].threads))
+         {  fprintf(stderr, "sigma-match: cannot allocate engine %d\n", 2*k + j + 1);
+            M->result = 1;
+         }
+      }
+   }
+
+   M->startMicroSecs = MicroTimer();
+
+   if (M->result == 0)
+   {
+      pthread_mutex_init(&M->lock, nil);
+      INT started = n;
+      for (INT k = 0; k < n; k++)
+         if (pthread_create(&W[k].thread, nil, WorkerThread, (void*)&W[k]) != 0)
+         {  fprintf(stderr, "sigma-match: cannot create worker thread\n");
+            M->result = 1;
+            started = k;
+            break;
+         }
+      for (INT k = 0; k < started; k++)
+         pthread_join(W[k].thread, nil);
+      pthread_mutex_destroy(&M->lock);
+
+      PrintSummary(M);
+   }
+
+   for (INT k = 0; k < n; k++)
+   {
+      for (INT j = 0; j < 2; j++)
+         if (W[k].E[j])
+         {  Host_SetTransTables(W[k].E[j], 0);
+            Host_SetThreads(W[k].E[j], 1);
+            Engine_Destroy(W[k].E[j]);
+            free(W[k].E[j]);
+         }
+      delete W[k].game;
+   }
+   free(W);
+} /* RunMatch */
+
+
+static void *WorkerThread (void *data)
+{
+   WORKER *W = (WORKER*)data;
+   MATCH  *M = W->M;
+
+   for (;;)
+   {
+      pthread_mutex_lock(&M->lock);
+      INT i = (M->result == 0 && M->sprtResult == 0 ? M->next++ : M->games);
+      pthread_mutex_unlock(&M->lock);
+      if (i >= M->games) break;
+
+      PlayGame(W, i);
+   }
+   return nil;
+} /* WorkerThread */
+
+/*------------------------------------------ Play Game -------------------------------------------*/
+// Engine 1 has white in even numbered games (counting from 0), and each opening is used for 2
+// consecutive games.
+
+static void PlayGame (WORKER *W, INT gameNo)
+{
+   MATCH  *M    = W->M;
+   CGame  *game = W->game;
+   INT    e1    = (even(gameNo) ? 0 : 1);          // Configuration playing white.
+   CLOCKS C;
+
+   pthread_mutex_lock(&M->lock);
+   SetupOpening(M, game, (M->openingCount > 0 ? &M->Opening[(gameNo/2) % M->openingCount] : nil));
+   pthread_mutex_unlock(&M->lock);
+
+   CopyStr(M->Engine[e1].name, game->Info.whiteName);
+   CopyStr(M->Engine[1 - e1].name, game->Info.blackName);
+   CopyStr("Engine Match", game->Info.event);
+   CopyStr("Sigma Chess", game->Info.site);
+   GetDateStr(game->Info.date);
+   NumToStr(gameNo + 1, game->Info.round);
+
+   for (INT c = 0; c < 2; c++)
+   {  C.timeLeftMS[c] = 1000*(LONG64)Level_CalcTotalTime(&M->level, (c == 0 ? white : black));
+      C.elapsedMS[c]  = 0;
+   }
+
+   INT prevScore = 1, adjWinCount = 0, adjDrawCount = 0;
+
+   for (;;)
+   {
+      COLOUR mover = game->player;
+      INT    c     = (mover == white ? 0 : 1);
+      ENGINE *E    = W->E[(mover == white ? e1 : 1 - e1)];
+
+      Host_SetGame(E, game);
+      SetSearchParam(M, E, game, &C);
+
+      LONG64 t0 = MicroTimer();
+      Host_Search(E);
+      LONG64 ms = (MicroTimer() - t0)/1000;
+
+      CHAR s[10];
+      Host_MoveStr(&Engine_BestMove(E), s);
+      MOVE *m = Host_ParseMove(game, s);
+      if (! m)                                     // (Should never happen).
+      {  SetGameResult(game, result_Resigned, (mover == white ? infoResult_BlackWin : infoResult_WhiteWin), "No move");
+         break;
+      }
+      game->PlayMove(m);
+      game->UpdateInfoResult();
+
+      C.elapsedMS[c]  += ms;
+      C.timeLeftMS[c] -= ms;
+      if ((M->level.mode == pmode_TimeMoves || M->level.mode == pmode_Tournament) && C.timeLeftMS[c] < 0)
+      {  CHAR text[100];
+         Format(text, "Time forfeit: %s wins", (game->player == white ? "White" : "Black"));
+         SetGameResult(game, result_TimeForfeit, (game->player == white ? infoResult_WhiteWin : infoResult_BlackWin), text);
+         break;
+      }
+      C.timeLeftMS[c] += 1000*(LONG64)Level_CheckTimeControl(&M->level, mover, game->MovesPlayed());
+
+      if (Adjudicate(M, game, Engine_BestScore(E), &prevScore, &adjWinCount, &adjDrawCount) || game->GameOver())
+         break;
+
+      if (game->lastMove >= gameRecSize - 2)       // Game record full.
+      {  SetGameResult(game, result_DrawAgreed, infoResult_Draw, "Maximum game length");
+         break;
+      }
+   }
+
+   INT score = 1;                                  // Half points for engine 1.
+   if (game->Info.result == infoResult_WhiteWin) score = (e1 == 0 ? 2 : 0);
+   else if (game->Info.result == infoResult_BlackWin) score = (e1 == 0 ? 0 : 2);
+
+   CHAR *buf = nil;
+   LONG size = 0;
+   if (M->pgnOut)
+   {  buf  = (CHAR*)malloc(pgn_BufferSize);
+      size = CPgn(game).WriteGame(buf);
+   }
+
+   pthread_mutex_lock(&M->lock);
+   M->Score[gameNo] = score;
+   M->played++;
+   if (score == 2) M->wins++;
+   else if (score == 1) M->draws++;
+   else M->losses++;
+
+   if (M->sprt && M->Score[gameNo ^ 1] >= 0)       // Pair completed (games 2k and 2k + 1).
+   {
+      M->Penta[M->Score[gameNo] + M->Score[gameNo ^ 1]]++;
+      M->llr = Penta_LLR(M->Penta, M->elo0, M->elo1);
+      if (M->sprtResult == 0)
+         M->sprtResult = (M->llr >= M->llrUpper ? 1 : (M->llr <= M->llrLower ? -1 : 0));
+   }
+
+   if (buf && (fwrite(buf, 1, size, M->pgnOut) != (size_t)size || fflush(M->pgnOut) != 0))
+   {  fprintf(stderr, "sigma-match: cannot write \"%s\"\n", M->pgnFile);
+      M->result = 1;
+   }
+   PrintGame(M, gameNo, game);
+   pthread_mutex_unlock(&M->lock);
+
+   free(buf);
+} /* PlayGame */
+
+
+// As GameWindow::SetSearchParam(), but with millisecond clocks.
+
+static void SetSearchParam (MATCH *M, ENGINE *E, CGame *game, CLOCKS *C)
+{
+   PARAM        *P = &E->P;
+   LEVEL        *L = &M->level;
+   MATCH_ENGINE *S = &M->Engine[E->refID % 2];    // (Engines are created in pairs).
+   INT          c  = (game->player == white ? 0 : 1);
+   INT          i;
+
+   P->pvSearch      = true;
+   P->alphaBetaWin  = true;
+   P->selection     = S->selection;
+   P->deepSelection = S->deepSelection;
+   P->selMargin     = S->selMargin;
+   P->extensions    = S->extensions;
+   P->nondeterm     = S->nondeterm;
+   P->useEndgameDB  = false;
+   P->multiPV       = 1;
+   P->playingStyle  = S->playingStyle;
+
+   INT moveCount = (game->currMove + 1)/2;
+   INT moveLim   = allMoves;
+
+   P->playingMode = mode_FixDepth;
+   P->movesPlayed = moveCount;
+   P->movesLeft   = 10;
+   P->timeLeftMS  = 10000;
+   P->timeIncMS   = 0;
+   P->timeInc     = 0;
+   P->moveTime    = 1;
+   P->depth       = 1;
+
+   switch (L->mode)
+   {
+      case pmode_TimeMoves :
+         P->playingMode = mode_Time;
+         moveLim = L->TimeMoves.moves;
+         P->movesPlayed = (moveLim == allMoves ? moveCount : moveCount % moveLim);
+         P->movesLeft   = (moveLim == allMoves ? moveLim : moveLim - P->movesPlayed + 1);
+         P->timeLeftMS  = (LONG)MaxL(1, (LONG)C->timeLeftMS[c]);
+         P->moveTime    = L->TimeMoves.time/(moveLim == allMoves ? 60 : moveLim);
+         if (L->TimeMoves.clockType == clock_Fischer)
+         {  P->timeInc   = L->TimeMoves.delta;
+            P->timeIncMS = 1000*(LONG)L->TimeMoves.delta;
+         }
+         break;
+
+      case pmode_Tournament :
+         P->playingMode = mode_Time;
+         P->movesPlayed = moveCount;
+         for (i = 1; i < 3 && L->Tournament.moves[i-1] <= P->movesPlayed; i++)
+            P->movesPlayed -= L->Tournament.moves[i-1];
+         P->movesLeft   = (i == 3 ? allMoves : L->Tournament.moves[i-1] - P->movesPlayed + 1);
+         P->timeLeftMS  = (LONG)MaxL(1, (LONG)C->timeLeftMS[c]);
+         P->moveTime    = (P->player == white ? L->Tournament.wtime[0] : L->Tournament.btime[0])/L->Tournament.moves[0];
+         break;
+
+      case pmode_Average :
+         P->playingMode = mode_Time;
+         P->movesPlayed = moveCount;
+         P->movesLeft   = Max(60 - moveCount, 20);
+         P->timeLeftMS  = (LONG)((P->movesPlayed + P->movesLeft)*1000L*L->Average.secs - C->elapsedMS[c]);
+         P->timeLeftMS  = MaxL(1000L*P->movesLeft, P->timeLeftMS);
+         P->moveTime    = L->Average.secs;
+         break;
+
+      case pmode_FixedDepth :
+         P->playingMode = mode_FixDepth;
+         P->depth       = L->FixedDepth.depth;
+         break;
+   }
+} /* SetSearchParam */
+
+/*----------------------------------------- Adjudication -----------------------------------------*/
+// Exactly as GameWindow::AutoSearchCompleted(). The "score" is the score of the engine that just
+// moved. Returns true if the game was adjudicated.
+
+static BOOL Adjudicate (MATCH *M, CGame *game, INT score, INT *prevScore, INT *adjWinCount, INT *adjDrawCount)
+{
+   CHAR adjText[100];
+   BOOL done = false;
+
+   if (game->GameOver())
+      return false;
+
+   if (M->adjDraw && score == 0)
+   {
+      *adjWinCount = 0;
+      if (game->lastMove <= 30)                    // Don't check for draw in the opening (first 15 moves
+         *adjDrawCount = 0;
+      else if (++(*adjDrawCount) >= 4)
+      {  SetGameResult(game, result_DrawAgreed, infoResult_Draw, "Draw agreed");
+         done = true;
+      }
+   }
+   else if (M->adjWin && score >= 100*M->adjWinLimit)
+   {
+      *adjDrawCount = 0;
+      (*adjWinCount)++;
+   }
+   else if (M->adjWin && score <= -100*M->adjWinLimit && *prevScore >= 100*M->adjWinLimit)
+   {
+      *adjDrawCount = 0;
+      if (++(*adjWinCount) >= 4)
+      {  CHAR scoreStr[20];
+         CalcScoreStr(scoreStr, score, scoreType_True);
+         Format(adjText, "Adjudicated: %s wins (score %s)", (game->player == white ? "White" : "Black"), scoreStr);
+         SetGameResult(game, result_Resigned, (game->player == white ? infoResult_WhiteWin : infoResult_BlackWin), adjText);
+         done = true;
+      }
+   }
+   else
+   {
+      *adjWinCount  = 0;
+      *adjDrawCount = 0;
+   }
+
+   *prevScore = score;
+   return done;
+} /* Adjudicate */
+
+
+static void SetGameResult (CGame *game, INT result, INT infoResult, CHAR *text)
+{
+   game->result      = result;
+   game->Info.result = infoResult;
+   game->SetAnnotation(game->currMove, text, StrLen(text));
+} /* SetGameResult */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          STATISTICS                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Elo difference (of engine 1) and the 95% confidence margin, computed from the score and the
+// standard error of the mean game score.
+
+static void CalcElo (INT wins, INT draws, INT losses, INT *elo, INT *margin)
+{
+   INT  n = wins + draws + losses;
+   REAL s = (wins + 0.5*draws)/Max(1, n);
+
+   REAL var = (wins*(1.0 - s)*(1.0 - s) + draws*(0.5 - s)*(0.5 - s) + losses*s*s)/Max(1, n);
+   REAL se  = sqrt(var/Max(1, n));
+
+   *elo    = Score_to_ELO(s);
+   *margin = (Score_to_ELO(s + 1.96*se) - Score_to_ELO(s - 1.96*se))/2;
+} /* CalcElo */
+
+
+static CHAR *TerminationStr (CGame *game)
+{
+   switch (game->result)
+   {
+      case result_Mate         : return "checkmate";
+      case result_StaleMate    : return "stalemate";
+      case result_Draw3rd      : return "repetition";
+      case result_Draw50       : return "50 move rule";
+      case result_DrawInsMtrl  : return "insufficient material";
+      case result_DrawAgreed   : return "adjudicated";
+      case result_Resigned     : return "adjudicated";
+      case result_TimeForfeit  : return "time forfeit";
+      default                  : return "";
+   }
+} /* TerminationStr */
+
+
+static void PrintGame (MATCH *M, INT gameNo, CGame *game)
+{
+   CHAR result[10];
+   INT  elo, margin;
+
+   CalcInfoResultStr(game->Info.result, result);
+   CalcElo(M->wins, M->draws, M->losses, &elo, &margin);
+
+   printf("Game %4d: %-12.12s - %-12.12s %-7s %-21s  %4d/%d  +%d =%d -%d  Elo %+d +/- %d",
+          gameNo + 1, game->Info.whiteName, game->Info.blackName, result, TerminationStr(game),
+          M->played, M->games, M->wins, M->draws, M->losses, elo, margin);
+   if (M->sprt)
+      printf("  LLR %.2f (%.2f, %.2f)", M->llr, M->llrLower, M->llrUpper);
+   printf("\n");
+   fflush(stdout);
+} /* PrintGame */
+
+
+static void PrintSummary (MATCH *M)
+{
+   INT elo, margin;
+   INT n = M->wins + M->draws + M->losses;
+
+   if (n == 0) return;
+
+   CalcElo(M->wins, M->draws, M->losses, &elo, &margin);
+   printf("\n%s vs %s: +%d =%d -%d (%.1f %%)\n", M->Engine[0].name, M->Engine[1].name,
+          M->wins, M->draws, M->losses, (M->wins + 0.5*M->draws)*100.0/n);
+   printf("Elo    : %+d +/- %d (95 %%)\n", elo, margin);
+
+   if (M->sprt)
+   {
+      elo = Penta_ELO(M->Penta, &margin);
+      printf("Penta  : %ld %ld %ld %ld %ld (pairs scoring 0..2 points)\n", (long)M->Penta[0],
+             (long)M->Penta[1], (long)M->Penta[2], (long)M->Penta[3], (long)M->Penta[4]);
+      printf("Elo    : %+d +/- %d (95 %%, pentanomial)\n", elo, margin);
+      printf("SPRT   : LLR %.2f (%.2f, %.2f) - %s\n", M->llr, M->llrLower, M->llrUpper,
+             (M->sprtResult > 0 ? "H1 accepted" : (M->sprtResult < 0 ? "H0 accepted" : "no decision")));
+   }
+   printf("Time   : %.1f s\n", (MicroTimer() - M->startMicroSecs)/1.0E6);
+} /* PrintSummary */
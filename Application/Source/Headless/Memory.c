@@ -0,0 +1,247 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : MEMORY.C                                                                             */
+/* Purpose : Headless implementation of the Sigma Class Library memory API ("CMemory.h") on top   */
+/*           of the C heap.                                                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "CMemory.h"
+
+// Handles are emulated by a heap allocated master pointer to the (relocatable) data block.
+// Locking is a no-op, since blocks are never moved behind the caller's back.
+
+
+/*--------------------------------------- Direct Pointers ----------------------------------------*/
+
+PTR Mem_AllocPtr (ULONG size)
+{
+   return (PTR)malloc(size);
+} /* Mem_AllocPtr */
+
+
+void Mem_FreePtr (void *ptr)
+{
+   if (ptr) free(ptr);
+} /* Mem_FreePtr */
+
+
+BOOL Mem_SetPtrSize (PTR ptr, ULONG newSize)  // Pointers can't be resized in place (just as
+{                                             // on the Mac, where this fails if block is locked).
+   return false;
+} /* Mem_SetPtrSize */
+
+/*----------------------------------------- Large Blocks -----------------------------------------*/
+// Large blocks (e.g. the transposition tables) are allocated in two steps: First an address range
+// is reserved (inaccessible and without any memory behind it), then a prefix of it is committed.
+// The committed part can later be resized in place, so pointers into the block remain valid. The
+// committed part is a multiple of the huge page size (2 MB), and is backed by explicit huge pages
+// if the system has a huge page pool, otherwise by transparent huge pages (if enabled). Committed
+// memory is zeroed and touched in parallel, so that the first search doesn't take the page faults.
+
+#define hugePageSize   (2L*1024L*1024L)
+#define hugeRound(n)   (((n) + hugePageSize - 1) & ~(ULONG64)(hugePageSize - 1))
+#define touchChunk     (64L*1024L*1024L)        // Minimum number of bytes touched per thread.
+#define maxTouchThreads 16
+
+typedef struct
+{
+   PTR     ptr;
+   ULONG64 bytes;
+} TOUCH_RANGE;
+
+static void TouchPages (PTR ptr, ULONG64 bytes);
+static void *TouchThread (void *data);
+
+PTR Mem_ReserveLargePtr (ULONG64 maxSize)
+{
+   ULONG64 bytes = hugeRound(maxSize);
+   PTR     ptr   = (PTR)mmap(nil, bytes + hugePageSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+   if (ptr == (PTR)MAP_FAILED) return nil;
+
+   PTR base = (PTR)hugeRound((uintptr_t)ptr);   // Align on huge page boundary and unmap the rest.
+   if (base > ptr) munmap(ptr, base - ptr);
+   munmap(base + bytes, (ptr + hugePageSize) - base);
+   return base;
+} /* Mem_ReserveLargePtr */
+
+
+BOOL Mem_CommitLargePtr (PTR ptr, ULONG64 size, ULONG64 newSize)
+{
+   size    = hugeRound(size);
+   newSize = hugeRound(newSize);
+
+   if (newSize < size)                          // Shrink: Release the memory beyond "newSize".
+      return (mmap(ptr + newSize, size - newSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0) != MAP_FAILED);
+
+   if (newSize > size)                          // Grow: Commit the memory from "size".
+   {
+      PTR     p = ptr + size;
+      ULONG64 n = newSize - size;
+
+#ifdef MAP_HUGETLB
+      if (mmap(p, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0) == MAP_FAILED)
+#endif
+      {
+         if (mmap(p, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+            return false;
+#ifdef MADV_HUGEPAGE
+         madvise(p, n, MADV_HUGEPAGE);
+#endif
+      }
+      TouchPages(p, n);
+   }
+
+   return true;
+} /* Mem_CommitLargePtr */
+
+
+void Mem_FreeLargePtr (PTR ptr, ULONG64 maxSize)
+{
+   if (ptr) munmap(ptr, hugeRound(maxSize));
+} /* Mem_FreeLargePtr */
+
+
+ULONG64 Mem_PhysicalBytes (void)               // Uncapped version of Mem_PhysicalRAM (used to
+{                                              // bound large block reservations).
+   return (ULONG64)sysconf(_SC_PHYS_PAGES)*(ULONG64)sysconf(_SC_PAGESIZE);
+} /* Mem_PhysicalBytes */
+
+
+static void TouchPages (PTR ptr, ULONG64 bytes)
+{
+   TOUCH_RANGE Range[maxTouchThreads];
+   pthread_t   Thread[maxTouchThreads];
+   INT         n = 1;
+
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   while (n < maxTouchThreads && n < cpus && (ULONG64)(n + 1)*touchChunk <= bytes) n++;
+
+   ULONG64 chunk = hugeRound(bytes/n);
+   INT     started = 0;
+
+   for (INT i = 0; i < n; i++)
+   {  ULONG64 offset = i*chunk;
+      Range[i].ptr   = ptr + offset;
+      Range[i].bytes = (offset >= bytes ? 0 : (bytes - offset < chunk ? bytes - offset : chunk));
+   }
+
+   for (INT i = 1; i < n; i++)                  // Range 0 (and the ranges of any threads that
+   {  if (pthread_create(&Thread[i], nil, TouchThread, &Range[i]) != 0) break;   // couldn't be
+      started = i;                              // created) are touched by the calling thread.
+   }
+
+   TouchThread(&Range[0]);
+   for (INT i = started + 1; i < n; i++)
+      TouchThread(&Range[i]);
+   for (INT i = 1; i <= started; i++)
+      pthread_join(Thread[i], nil);
+} /* TouchPages */
+
+
+static void *TouchThread (void *data)
+{
+   TOUCH_RANGE *R = (TOUCH_RANGE*)data;
+   long pageSize = sysconf(_SC_PAGESIZE);
+
+   for (ULONG64 i = 0; i < R->bytes; i += pageSize)
+      ((volatile BYTE*)R->ptr)[i] = 0;
+   return nil;
+} /* TouchThread */
+
+/*------------------------------------------- Handles --------------------------------------------*/
+
+HANDLE Mem_AllocHandle (ULONG size)
+{
+   HANDLE h = (HANDLE)malloc(sizeof(PTR));
+   if (! h) return nil;
+
+   *h = (PTR)malloc(size > 0 ? size : 1);
+   if (! *h)
+   {  free(h);
+      return nil;
+   }
+   return h;
+} /* Mem_AllocHandle */
+
+
+void Mem_FreeHandle (HANDLE h)
+{
+   if (! h) return;
+   free(*h);
+   free(h);
+} /* Mem_FreeHandle */
+
+
+void Mem_LockHandle (HANDLE h)
+{
+} /* Mem_LockHandle */
+
+
+void Mem_UnlockHandle (HANDLE h)
+{
+} /* Mem_UnlockHandle */
+
+
+BOOL Mem_SetHandleSize (HANDLE h, ULONG newSize)
+{
+   PTR p = (PTR)realloc(*h, newSize > 0 ? newSize : 1);
+   if (! p) return false;
+   *h = p;
+   return true;
+} /* Mem_SetHandleSize */
+
+/*-------------------------------------------- Misc ----------------------------------------------*/
+
+void Mem_Move (PTR from, PTR to, ULONG bytes)
+{
+   memmove(to, from, bytes);
+} /* Mem_Move */
+
+
+ULONG Mem_PhysicalRAM (void)        // Capped at 4 GB (ULONG).
+{
+   UInt64 bytes = (UInt64)sysconf(_SC_PHYS_PAGES)*(UInt64)sysconf(_SC_PAGESIZE);
+   return (ULONG)(bytes > 0xFFFFFFFF ? 0xFFFFFFFF : bytes);
+} /* Mem_PhysicalRAM */
+
+
+ULONG Mem_MaxBlockSize (void)
+{
+   return 10L*1024L*1024L;          // Just a dummy value (as under OS X)
+} /* Mem_MaxBlockSize */
+
+
+ULONG Mem_FreeBytes (void)
+{
+   return 10L*1024L*1024L;          // Just a dummy value (as under OS X)
+} /* Mem_FreeBytes */
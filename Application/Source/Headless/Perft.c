@@ -0,0 +1,278 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : PERFT.C                                                                              */
+/* Purpose : Headless move generator test. Counts the leaf nodes of the legal move tree (perft)   */
+/*           with both the game move generator (CGame) and the engine move generator, and checks  */
+/*           the counts against a suite of positions with known results.                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "EngineHost.h"
+
+#include "Engine.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                         PERFT POSITIONS                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The standard perft positions (start position, "Kiwipete" etc.) with their known leaf counts for
+// depth 1, 2, ... Between them they cover castling (through/out of check), en passant (incl.
+// discovered checks), promotions/under promotions and checks/pins.
+
+#define perftMaxDepth  6
+
+typedef struct
+{
+   CHAR   *fen;
+   LONG64 Count[perftMaxDepth + 1];  // Known leaf counts for depth 1.. (terminated by 0).
+} PERFT_POS;
+
+static PERFT_POS PerftPos[] =
+{
+   { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     { 20, 400, 8902, 197281, 4865609, 119060324, 0 } },
+   { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     { 48, 2039, 97862, 4085603, 193690690, 0 } },
+   { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     { 14, 191, 2812, 43238, 674624, 11030083, 0 } },
+   { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     { 6, 264, 9467, 422333, 15833292, 0 } },
+   { "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+     { 6, 264, 9467, 422333, 15833292, 0 } },
+   { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     { 44, 1486, 62379, 2103487, 89941194, 0 } },
+   { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+     { 46, 2079, 89890, 3894594, 164075551, 0 } },
+   { nil, { 0 } }
+};
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                         PERFT ROUTINES                                         */
+/*                                                                                                */
+/**************************************************************************************************/
+
+enum PERFT_GEN
+{
+   gen_Game   = 0x01,                // CGame::CalcMoves()/PlayMove()/UndoMove().
+   gen_Engine = 0x02                 // Engine move generators and PerformMove()/RetractMove().
+};
+
+static CHAR *GenName[3] = { "", "game", "engine" };
+
+/*-------------------------------------- Game Move Generator -------------------------------------*/
+
+static LONG64 GamePerft (CGame *game, INT depth, LONG64 Divide[] = nil)
+{
+   if (depth <= 0) return 1;
+   if (depth == 1 && ! Divide) return game->moveCount;
+
+   INT  n = game->moveCount;
+   MOVE Moves[maxLegalMoves];
+   for (INT i = 0; i < n; i++) Moves[i] = game->Moves[i];
+
+   LONG64 count = 0;
+
+   for (INT i = 0; i < n; i++)
+   {
+      game->PlayMove(&Moves[i]);
+      LONG64 sub = GamePerft(game, depth - 1);
+      game->UndoMove(false);
+
+      if (Divide) Divide[i] = sub;
+      count += sub;
+   }
+
+   game->CalcMoves();
+   return count;
+} /* GamePerft */
+
+/*----------------------------------------- Run Perft --------------------------------------------*/
+
+static LONG64 RunPerft (INT gen, CGame *game, ENGINE *E, INT depth, LONG64 *usecs, BOOL divide)
+{
+   LONG64 Divide[maxLegalMoves];
+   MOVE   *Moves;
+   INT    n;
+   UInt64 t0, t1;
+   LONG64 count;
+
+   MicroSecs(&t0);
+   if (gen == gen_Game)
+   {  count = GamePerft(game, depth, (divide ? Divide : nil));
+      Moves = game->Moves;
+      n     = game->moveCount;
+   }
+   else
+   {  Host_SetGame(E, game);
+      count = Engine_Perft(E, depth, (divide ? Divide : nil));
+      Moves = E->S.RootMoves;
+      n     = E->S.numRootMoves;
+   }
+   MicroSecs(&t1);
+   *usecs = (LONG64)(t1 - t0);
+
+   if (divide)
+   {  CHAR mstr[10];
+      for (INT i = 0; i < n; i++)
+      {  Host_MoveStr(&Moves[i], mstr);
+         printf("  %-6s %lld\n", mstr, (long long)Divide[i]);
+      }
+      printf("  moves %d\n", n);
+   }
+
+   return count;
+} /* RunPerft */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          MAIN PROGRAM                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Without a FEN argument the test suite is run for each generator, for all depths up to "-depth"
+// whose known leaf count is at most "-nodes". The exit status is 1 if any count is wrong. With a
+// FEN argument the leaf count(s) of that position are printed (per root move with "-divide").
+
+static void Usage (void);
+
+int main (int argc, char *argv[])
+{
+   INT    maxDepth = perftMaxDepth;
+   LONG64 maxNodes = 5000000;
+   INT    gens     = gen_Game | gen_Engine;
+   BOOL   divide   = false;
+   CHAR   *fen     = nil;
+   INT    result   = 0;
+
+   for (INT i = 1; i < argc; i++)
+      if (EqualStr(argv[i], "-depth") && i + 1 < argc)
+         maxDepth = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-nodes") && i + 1 < argc)
+         maxNodes = atoll(argv[++i]);
+      else if (EqualStr(argv[i], "-gen") && i + 1 < argc)
+      {  i++;
+         if (EqualStr(argv[i], "game"))        gens = gen_Game;
+         else if (EqualStr(argv[i], "engine")) gens = gen_Engine;
+         else if (EqualStr(argv[i], "both"))   gens = gen_Game | gen_Engine;
+         else { Usage(); return 2; }
+      }
+      else if (EqualStr(argv[i], "-divide"))
+         divide = true;
+      else if (argv[i][0] == '-' || fen)
+      {  Usage();
+         return 2;
+      }
+      else
+         fen = argv[i];
+
+   if (maxDepth < 1 || maxDepth >= maxSearchDepth)
+   {  Usage();
+      return 2;
+   }
+
+   ENGINE *E    = (ENGINE*)calloc(1, sizeof(ENGINE));
+   Host_InitSystem();
+   CGame  *game = new CGame();
+   Engine_Create(&Global, E, 0);
+
+   for (INT gen = gen_Game; gen <= gen_Engine; gen++)
+   {
+      if (! (gens & gen)) continue;
+
+      if (fen)
+      {
+         if (game->Read_EPD(fen) != epdErr_NoError)
+         {  fprintf(stderr, "sigma-perft: invalid FEN \"%s\"\n", fen);
+            result = 1;
+            break;
+         }
+
+         printf("%s: %s\n", GenName[gen], fen);
+         for (INT d = (divide ? maxDepth : 1); d <= maxDepth; d++)
+         {  LONG64 usecs;
+            LONG64 count = RunPerft(gen, game, E, d, &usecs, divide);
+            printf("  depth %d  nodes %12lld  time %7.3f s  nps %.0f\n", d, (long long)count,
+                   usecs/1.0E6, (usecs > 0 ? count*1.0E6/usecs : 0.0));
+         }
+         continue;
+      }
+
+      LONG64 totalNodes = 0, totalMicroSecs = 0;
+      INT    failed = 0;
+
+      printf("Perft test suite (%s move generator)\n\n", GenName[gen]);
+
+      for (INT i = 0; PerftPos[i].fen; i++)
+      {
+         PERFT_POS *T = &PerftPos[i];
+
+         game->Read_EPD(T->fen);
+         printf("%d  %s\n", i + 1, T->fen);
+
+         for (INT d = 1; d <= maxDepth && T->Count[d - 1] > 0 && T->Count[d - 1] <= maxNodes; d++)
+         {  LONG64 usecs;
+            LONG64 count = RunPerft(gen, game, E, d, &usecs, false);
+            BOOL   ok    = (count == T->Count[d - 1]);
+
+            printf("   depth %d  nodes %10lld  time %7.3f s  %s", d, (long long)count, usecs/1.0E6, (ok ? "OK" : "FAILED"));
+            if (! ok) printf(" (expected %lld)", (long long)T->Count[d - 1]), failed++;
+            printf("\n");
+
+            totalNodes     += count;
+            totalMicroSecs += usecs;
+         }
+      }
+
+      printf("\nNodes  : %lld\n", (long long)totalNodes);
+      printf("Time   : %.3f s\n", totalMicroSecs/1.0E6);
+      printf("NPS    : %.0f\n", (totalMicroSecs > 0 ? totalNodes*1.0E6/totalMicroSecs : 0.0));
+      printf("Result : %s\n\n", (failed ? "FAILED" : "PASSED"));
+
+      if (failed) result = 1;
+   }
+
+   Engine_Destroy(E);
+   Host_EndSystem();
+   delete game;
+   free(E);
+   return result;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-perft [-gen game|engine|both] [-depth n] [-nodes n] [-divide] [fen]\n");
+} /* Usage */
@@ -0,0 +1,991 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "EngineHost.h"
+
+#include "Engine.f"
+#include "Tablebase.f"
+#include "Time.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Builds the endgame tablebases probed by the engine (see "Tablebase.h"): For each material
+// signature (e.g. "KRKP") a DTM table ("KRKP.stm") and a WDL table ("KRKP.stw") are written. The
+// tables of the signatures reached by captures and promotions are built first (or loaded if they
+// already exist in the output folder).
+//
+// The positions are solved by iterative retrograde analysis with verification: Pass n first marks
+// the unknown predecessors of the positions lost in n-1 moves as won in n (and the positions with
+// a capture/promotion into a position lost in n-1), and then marks the unknown predecessors of the
+// positions won in n as lost, if all their moves lead to won positions. Each pass is split over
+// the worker threads (the threads only ever store the same value in a given entry during a
+// phase). The positions never reached are draws.
+
+#define tbgenMaxMoves  256
+#define tbgenPathSize  1000                        // Max path length of a table file (incl. 0).
+
+#define wrkUnknown     0xFFFE                      // Work entries (UINT). Positions won in n
+#define wrkIllegal     0xFFFF                      // moves are stored as n, positions lost in n
+#define wrkDraw        0x0000                      // moves as wrkLoss + n.
+#define wrkLoss        0x8000
+#define wrkIsWin(w)    ((w) > wrkDraw && (w) < wrkLoss)
+#define wrkIsLoss(w)   ((w) >= wrkLoss && (w) < wrkUnknown)
+
+typedef struct
+{
+   CHAR      name[tbMaxPieces + 3];                // Signature, e.g. "KRKP".
+   TABLEBASE T;                                    // Descriptor of the table being built.
+   UINT      *Work;                                // Result of each position (wrkXXX).
+   BYTE      *Pending;                             // Fastest win by a capture/promotion (0 = none).
+   INT       pass;
+} TBGEN;
+
+typedef struct
+{
+   TBGEN     *G;
+   ULONG     lo, hi;                               // Index range of this thread.
+   LONG      changes;                              // Entries changed by the thread.
+   LONG      horizon;                              // Longest win/loss found by the thread.
+   void      (*Phase)(void *W);
+   pthread_t thread;
+} WORKER;
+
+typedef struct                                     // A position of the table being built.
+{
+   PIECE     Piece[tbMaxPieces];
+   SQUARE    Sq[tbMaxPieces];                      // nullSq if captured.
+   BYTE      Slot[0x80];                           // Board (piece index + 1, 0 if empty).
+   COLOUR    player;
+} TBPOS;
+
+typedef struct                                     // A legal move of a position.
+{
+   BOOL      inTable;                              // Same signature (no capture/promotion)?
+   ULONG     index;                                // Index of the new position (if inTable).
+   INT       dtm;                                  // Its DTM entry (if not inTable).
+} TBMOVE;
+
+static CHAR  *sigLetters = "QRBNP";               // Signature letters (in index order).
+static CHAR  *outDir  = ".";
+static INT   threads  = 1;
+static INT   loaded   = 0;                         // Tables loaded (installed in "Global").
+static TABLEBASE Loaded[1000];
+static CHAR  Generated[1000][tbMaxPieces + 3];     // Signatures built/found in this run.
+static INT   generatedCount = 0;
+
+static BOOL Generate (CHAR *name);
+static void UnloadTables (void);
+static BOOL Canonical (CHAR *sig, CHAR *name);
+static void Usage (void);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                               MAIN                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (int argc, char *argv[])
+{
+   INT  all = 0, count = 0;
+   CHAR name[tbMaxPieces + 3];
+
+   threads = MaxL(1, MinL(64, sysconf(_SC_NPROCESSORS_ONLN)));
+
+   for (INT i = 1; i < argc; i++)
+      if (EqualStr(argv[i], "-threads") && i + 1 < argc)
+         threads = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-dir") && i + 1 < argc)
+         outDir = argv[++i];
+      else if (EqualStr(argv[i], "-all") && i + 1 < argc)
+         all = atoi(argv[++i]);
+      else if (argv[i][0] == '-')
+      {  Usage();
+         return 2;
+      }
+      else if (! Canonical(argv[i], name))
+      {  fprintf(stderr, "sigma-tbgen: invalid signature \"%s\"\n", argv[i]);
+         return 2;
+      }
+      else
+         count++;
+
+   if ((count == 0 && all == 0) || all < 0 || all > tbMaxPieces || threads < 1 || threads > 64)
+   {  Usage();
+      return 2;
+   }
+
+   if (StrLen(outDir) + tbMaxPieces + 6 > tbgenPathSize)     // "dir/KQRKR.stm"
+   {  fprintf(stderr, "sigma-tbgen: folder name too long \"%s\"\n", outDir);
+      return 2;
+   }
+
+   LONG64 t0 = MicroTimer();
+
+   // Build all signatures with up to "all" pieces (in order of piece count), and then the
+   // signatures given explicitly:
+
+   for (INT n = 3; n <= all; n++)
+   {
+      LONG codes = 1;
+      for (INT k = 2; k < n; k++) codes *= 10;
+
+      for (LONG code = 0; code < codes; code++)    // Each piece is a decimal digit (0..4 = white
+      {                                            // Q..P, 5..9 = black Q..P), and the digits
+         CHAR W[tbMaxPieces + 1], B[tbMaxPieces + 1], sig[tbMaxPieces + 3];   // must be non
+         INT  wn = 0, bn = 0, last = 0;            // decreasing (so each set is listed once).
+         BOOL ok = true;
+
+         for (LONG c = code, k = 2; k < n; k++, c /= 10)
+         {  INT d = c % 10;
+            if (d < last) ok = false;
+            last = d;
+            if (d < 5) W[wn++] = sigLetters[d];
+            else       B[bn++] = sigLetters[d - 5];
+         }
+         W[wn] = B[bn] = 0;
+         if (! ok) continue;
+         if (snprintf(sig, sizeof(sig), "K%sK%s", W, B) >= (INT)sizeof(sig)) return 1;
+         if (! Canonical(sig, name) || ! Generate(name)) return 1;
+         UnloadTables();
+      }
+   }
+
+   for (INT i = 1; i < argc; i++)
+      if (argv[i][0] == '-')
+         i++;
+      else
+      {  Canonical(argv[i], name);
+         if (! Generate(name)) return 1;
+         UnloadTables();
+      }
+
+   printf("Done : %d tables, %.1f s\n", generatedCount, (MicroTimer() - t0)/1.0E6);
+   return 0;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-tbgen [-threads n] [-dir folder] [-all n] [signature...]\n");
+   fprintf(stderr, "       (e.g. \"sigma-tbgen -all 4 KRPKR\", at most %d pieces)\n", tbMaxPieces);
+} /* Usage */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           SIGNATURES                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// A signature lists the pieces of each side (e.g. "KRPKR"). The canonical form has the pieces of
+// each side in index order (Q, R, B, N, P), and the stronger side (by material value, then the
+// number of pieces and finally the pieces themselves) first, i.e. as white.
+
+static INT LetterRank (CHAR c)
+{
+   for (INT i = 0; sigLetters[i]; i++)
+      if (sigLetters[i] == c) return i;
+   return -1;
+} /* LetterRank */
+
+
+static void SortSide (CHAR *s)
+{
+   for (INT i = 1; s[i]; i++)
+      for (INT j = i; j > 0 && LetterRank(s[j - 1]) > LetterRank(s[j]); j--)
+      {  CHAR c = s[j]; s[j] = s[j - 1]; s[j - 1] = c;
+      }
+} /* SortSide */
+
+
+static INT CompareSides (CHAR *a, CHAR *b)
+{
+   static INT Value[5] = { 9, 5, 3, 3, 1 };
+   INT va = 0, vb = 0;
+
+   for (INT i = 0; a[i]; i++) va += Value[LetterRank(a[i])];
+   for (INT i = 0; b[i]; i++) vb += Value[LetterRank(b[i])];
+   if (va != vb) return va - vb;
+   if (StrLen(a) != StrLen(b)) return StrLen(a) - StrLen(b);
+   for (INT i = 0; a[i]; i++)
+      if (a[i] != b[i]) return LetterRank(b[i]) - LetterRank(a[i]);
+   return 0;
+} /* CompareSides */
+
+
+static BOOL Canonical (CHAR *sig, CHAR *name)
+{
+   CHAR W[tbMaxPieces + 1], B[tbMaxPieces + 1];
+   INT  n = StrLen(sig), k;
+
+   if (n < 3 || n > tbMaxPieces || sig[0] != 'K') return false;
+   for (k = 1; k < n && sig[k] != 'K'; k++)
+      if (LetterRank(sig[k]) < 0) return false;
+   if (k == n) return false;
+
+   CopySubStr(sig + 1, k - 1, W);
+   CopyStr(sig + k + 1, B);
+   for (INT i = 0; B[i]; i++)
+      if (LetterRank(B[i]) < 0) return false;
+
+   SortSide(W);
+   SortSide(B);
+   if (CompareSides(W, B) < 0)
+      Format(name, "K%sK%s", B, W);
+   else
+      Format(name, "K%sK%s", W, B);
+   return true;
+} /* Canonical */
+
+
+// Sets up the table descriptor of a canonical signature.
+
+static void SetupTable (CHAR *name, TABLEBASE *T)
+{
+   static PIECE LetterPiece[5] = { queen, rook, bishop, knight, pawn };
+   COLOUR c = white;
+
+   T->pieceCount = 0;
+   T->pawns = false;
+   for (INT i = 0; name[i]; i++)
+   {
+      if (name[i] == 'K')
+      {  c = (i == 0 ? white : black);
+         T->Piece[T->pieceCount++] = king + c;
+      }
+      else
+      {  T->Piece[T->pieceCount++] = LetterPiece[LetterRank(name[i])] + c;
+         if (name[i] == 'P') T->pawns = true;
+      }
+   }
+
+   T->kind       = tbKind_DTM;
+   T->key        = TB_MaterialKey(T->Piece, T->pieceCount);
+   T->entries    = TB_Entries(T->pieceCount, T->pawns);
+   T->blockCount = 0;
+   T->data       = nil;
+   T->size       = 0;
+} /* SetupTable */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          LOAD & SAVE                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Builds the path of a table file in "outDir" (false if it doesn't fit in "path").
+
+static BOOL TablePath (CHAR *name, CHAR *ext, CHAR *path, INT size)
+{
+   INT n = snprintf(path, size, "%s/%s.%s", outDir, name, ext);
+   if (n >= 0 && n < size) return true;
+
+   fprintf(stderr, "sigma-tbgen: path too long in \"%s\"\n", outDir);
+   return false;
+} /* TablePath */
+
+
+static BOOL Exists (CHAR *name, CHAR *ext)
+{
+   CHAR path[tbgenPathSize];
+   return (TablePath(name, ext, path, sizeof(path)) && access(path, R_OK) == 0);
+} /* Exists */
+
+
+// Loads a DTM table (decompressed) and installs it in "Global" (so it can be probed with
+// TB_Lookup while building the tables that depend on it).
+
+static BOOL LoadTable (CHAR *name)
+{
+   CHAR path[tbgenPathSize];
+   if (! TablePath(name, "stm", path, sizeof(path))) return false;
+
+   FILE *file = fopen(path, "rb");
+   if (! file) return false;
+
+   fseek(file, 0, SEEK_END);
+   ULONG     size = ftell(file);
+   PTR       data = (PTR)malloc(size + 1);
+   TABLEBASE *T = &Loaded[loaded];
+   fseek(file, 0, SEEK_SET);
+
+   BOOL ok = (data && fread(data, 1, size, file) == size && Engine_OpenTablebase(T, data, size) &&
+              T->kind == tbKind_DTM);
+   fclose(file);
+
+   PTR raw = (ok ? (PTR)malloc(T->entries) : nil);
+   TABLEBASE_CACHE *C = (TABLEBASE_CACHE*)malloc(sizeof(TABLEBASE_CACHE));
+
+   if (raw && C)
+   {  C->T = nil;
+      for (ULONG i = 0; i < T->entries; i++)
+         raw[i] = TB_Read(T, C, i);
+      T->data = raw;
+      T->size = T->entries;
+      T->blockCount = 0;
+      loaded++;
+      Engine_SetTablebases(&Global, Loaded, loaded);
+   }
+   else
+      fprintf(stderr, "sigma-tbgen: cannot load \"%s\"\n", path), free(raw), raw = nil;
+
+   free(C);
+   free(data);
+   return (raw != nil);
+} /* LoadTable */
+
+
+static void UnloadTables (void)
+{
+   Engine_SetTablebases(&Global, nil, 0);
+   for (INT i = 0; i < loaded; i++)
+      free(Loaded[i].data);
+   loaded = 0;
+} /* UnloadTables */
+
+
+static void PutLong (PTR p, ULONG n)               // Big endian.
+{
+   p[0] = n >> 24; p[1] = n >> 16; p[2] = n >> 8; p[3] = n;
+} /* PutLong */
+
+
+// Compresses "n" bytes with PackBits (see "Tablebase.c"). Returns the compressed size.
+
+static ULONG Pack (PTR s, ULONG n, PTR d)
+{
+   PTR d0 = d;
+
+   for (ULONG i = 0; i < n; )
+   {
+      ULONG run = 1;
+      while (i + run < n && run < 130 && s[i + run] == s[i]) run++;
+
+      if (run >= 3)
+      {  *(d++) = run + 125;
+         *(d++) = s[i];
+         i += run;
+      }
+      else
+      {  ULONG j = i;
+         while (j < n && j - i < 128 && ! (j + 2 < n && s[j] == s[j + 1] && s[j] == s[j + 2])) j++;
+         *(d++) = j - i - 1;
+         while (i < j) *(d++) = s[i++];
+      }
+   }
+
+   return d - d0;
+} /* Pack */
+
+
+// Writes a table file. The entries of illegal positions ("Illegal" set) are never probed, and
+// are given the value of the preceding entry to improve the compression.
+
+static BOOL SaveTable (TBGEN *G, INT kind, PTR Entries, PTR Illegal)
+{
+   TABLEBASE *T = &G->T;
+   ULONG     blockCount = (T->entries + tbBlockSize - 1)/tbBlockSize;
+   ULONG     headerSize = tbHeaderSize + 4*(blockCount + 1);
+   PTR       Header = (PTR)calloc(headerSize, 1);
+   PTR       Block = (PTR)malloc(tbBlockSize + tbBlockSize/128 + 16);
+   CHAR      path[tbgenPathSize], *ext = (kind == tbKind_WDL ? (CHAR*)"stw" : (CHAR*)"stm");
+
+   BOOL pathOk = TablePath(G->name, ext, path, sizeof(path));
+   FILE *file = (pathOk ? fopen(path, "wb") : nil);
+   if (! file || ! Header || ! Block)
+   {  if (pathOk) fprintf(stderr, "sigma-tbgen: cannot create \"%s\"\n", path);
+      if (file) fclose(file);
+      free(Header); free(Block);
+      return false;
+   }
+
+   PutLong(Header, tbFileMagic);
+   Header[4] = kind;
+   Header[5] = T->pieceCount;
+   for (INT i = 0; i < T->pieceCount; i++)
+      Header[8 + i] = T->Piece[i];
+   PutLong(Header + 16, T->entries);
+   PutLong(Header + 20, tbBlockSize);
+   PutLong(Header + 24, blockCount);
+
+   for (ULONG i = 1; i < T->entries; i++)
+      if (Illegal[i]) Entries[i] = Entries[i - 1];
+
+   BOOL  ok = (fwrite(Header, 1, headerSize, file) == headerSize);
+   ULONG offset = headerSize;
+
+   for (ULONG b = 0; b < blockCount && ok; b++)
+   {
+      PutLong(Header + tbHeaderSize + 4*b, offset);
+      ULONG n = Pack(Entries + b*tbBlockSize, MinL(tbBlockSize, T->entries - b*tbBlockSize), Block);
+      ok = (fwrite(Block, 1, n, file) == n);
+      offset += n;
+   }
+   PutLong(Header + tbHeaderSize + 4*blockCount, offset);
+
+   ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(Header, 1, headerSize, file) == headerSize;
+   ok = (fclose(file) == 0) && ok;
+   if (! ok) fprintf(stderr, "sigma-tbgen: cannot write \"%s\"\n", path);
+
+   printf("   %-12s %10lu bytes\n", path + StrLen(outDir) + 1, (unsigned long)offset);
+   free(Header);
+   free(Block);
+   return ok;
+} /* SaveTable */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                         MOVE GENERATION                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The positions are generated directly on the 0x88 board (with the direction tables of the game
+// module), since the engine move generator needs a full search setup.
+
+static SQUARE *PieceDirs (PIECE p, BOOL *slide)    // Null terminated.
+{
+   *slide = (pieceType(p) >= bishop && pieceType(p) <= queen);
+   switch (pieceType(p))
+   {
+      case knight : return KnightDir;
+      case bishop : return BishopDir;
+      case rook   : return RookDir;
+      case queen  : return QueenDir;
+      default     : return KingDir;
+   }
+} /* PieceDirs */
+
+
+static void DecodePos (TABLEBASE *T, ULONG index, TBPOS *P)
+{
+   TB_Position(T, index, P->Sq, &P->player);
+   memset(P->Slot, 0, sizeof(P->Slot));
+   for (INT i = 0; i < T->pieceCount; i++)
+   {  P->Piece[i] = T->Piece[i];
+      if (! P->Slot[P->Sq[i]]) P->Slot[P->Sq[i]] = i + 1;
+   }
+} /* DecodePos */
+
+
+static BOOL Attacked (TABLEBASE *T, TBPOS *P, SQUARE sq, COLOUR c)     // By colour "c"?
+{
+   for (INT i = 0; i < T->pieceCount; i++)
+   {
+      SQUARE from = P->Sq[i];
+      PIECE  p = P->Piece[i];
+      if (from == nullSq || pieceColour(p) != c) continue;
+
+      if (pieceType(p) == pawn)
+      {  INT fwd = (c == white ? 16 : -16);
+         if (sq == from + fwd - 1 || sq == from + fwd + 1) return true;
+         continue;
+      }
+
+      BOOL   slide;
+      SQUARE *Dir = PieceDirs(p, &slide);
+      for (INT d = 0; Dir[d]; d++)
+         for (SQUARE to = from + Dir[d]; onBoard(to); to += Dir[d])
+         {  if (to == sq) return true;
+            if (! slide || P->Slot[to]) break;
+         }
+   }
+   return false;
+} /* Attacked */
+
+
+// Is the position with index "index" legal and in canonical form (i.e. no other index maps to it)?
+
+static BOOL ValidPos (TABLEBASE *T, ULONG index, TBPOS *P)
+{
+   DecodePos(T, index, P);
+
+   for (INT i = 0; i < T->pieceCount; i++)
+   {  if (P->Slot[P->Sq[i]] != i + 1) return false;                     // Square taken.
+      if (pieceType(P->Piece[i]) == pawn && (rank(P->Sq[i]) == 0 || rank(P->Sq[i]) == 7)) return false;
+   }
+
+   INT k = (P->player == white ? T->pieceCount - 1 : 0);                // The opponent king.
+   while (P->Piece[k] != king + (P->player ^ black)) k--;
+
+   return (TB_Index(T, P->Sq, P->player) == index && ! Attacked(T, P, P->Sq[k], P->player));
+} /* ValidPos */
+
+
+// Adds the move of piece "i" to "to" (promoting to "promo" if not empty), if legal.
+
+static void AddMove (TBGEN *G, TBPOS *P, INT i, SQUARE to, PIECE promo, TBMOVE Move[], INT *count)
+{
+   TABLEBASE *T = &G->T;
+   TBPOS     Q = *P;
+   INT       victim = Q.Slot[to] - 1;
+   INT       kingIndex = (P->player == white ? 0 : T->pieceCount - 1);
+
+   while (P->Piece[kingIndex] != king + P->player) kingIndex--;
+
+   if (victim >= 0) Q.Sq[victim] = nullSq;
+   Q.Slot[Q.Sq[i]] = 0;
+   Q.Slot[to] = i + 1;
+   Q.Sq[i] = to;
+   if (promo) Q.Piece[i] = promo + P->player;
+
+   if (Attacked(T, &Q, Q.Sq[kingIndex], P->player ^ black)) return;
+
+   TBMOVE *M = &Move[(*count)++];
+   M->inTable = (victim < 0 && ! promo);
+   if (M->inTable)
+      M->index = TB_Index(T, Q.Sq, P->player ^ black);
+   else
+   {
+      PIECE  Piece[tbMaxPieces];
+      SQUARE Sq[tbMaxPieces];
+      INT    n = 0;
+
+      for (INT j = 0; j < T->pieceCount; j++)
+         if (Q.Sq[j] != nullSq)
+            Piece[n] = Q.Piece[j], Sq[n++] = Q.Sq[j];
+
+      if (n == 2)
+         M->dtm = tbDtmDraw;
+      else if (! TB_Lookup(&Global, nil, tbKind_DTM, n, Piece, Sq, P->player ^ black, &M->dtm))
+      {  fprintf(stderr, "sigma-tbgen: missing table for capture/promotion in %s\n", G->name);
+         exit(1);
+      }
+   }
+} /* AddMove */
+
+
+static INT GenMoves (TBGEN *G, TBPOS *P, TBMOVE Move[])
+{
+   TABLEBASE *T = &G->T;
+   INT       count = 0;
+
+   for (INT i = 0; i < T->pieceCount; i++)
+   {
+      SQUARE from = P->Sq[i];
+      PIECE  p = P->Piece[i];
+      if (from == nullSq || pieceColour(p) != P->player) continue;
+
+      if (pieceType(p) == pawn)
+      {
+         INT    fwd = (P->player == white ? 16 : -16);
+         SQUARE to  = from + fwd;
+         BOOL   last = (rank(to) == 0 || rank(to) == 7);
+
+         for (INT d = -1; d <= 1; d++)
+         {
+            SQUARE sq = to + d;
+            if (! onBoard(sq) || (d == 0) != ! P->Slot[sq]) continue;
+            if (d != 0 && pieceColour(P->Piece[P->Slot[sq] - 1]) == P->player) continue;
+
+            if (! last)
+               AddMove(G, P, i, sq, empty, Move, &count);
+            else
+               for (PIECE promo = queen; promo >= knight; promo--)
+                  AddMove(G, P, i, sq, promo, Move, &count);
+         }
+
+         if (rank(from) == (P->player == white ? 1 : 6) && ! P->Slot[to] && ! P->Slot[to + fwd])
+            AddMove(G, P, i, to + fwd, empty, Move, &count);
+         continue;
+      }
+
+      BOOL   slide;
+      SQUARE *Dir = PieceDirs(p, &slide);
+      for (INT d = 0; Dir[d]; d++)
+         for (SQUARE to = from + Dir[d]; onBoard(to); to += Dir[d])
+         {
+            if (P->Slot[to])
+            {  if (pieceColour(P->Piece[P->Slot[to] - 1]) != P->player)
+                  AddMove(G, P, i, to, empty, Move, &count);
+               break;
+            }
+            AddMove(G, P, i, to, empty, Move, &count);
+            if (! slide) break;
+         }
+   }
+
+   return count;
+} /* GenMoves */
+
+
+// Returns the indices of the positions (with the opponent to move) from which a non capturing,
+// non promoting move leads to the position.
+
+static INT GenUnmoves (TBGEN *G, TBPOS *P, ULONG Index[])
+{
+   TABLEBASE *T = &G->T;
+   COLOUR    c = P->player ^ black;                // The side that has just moved.
+   INT       count = 0;
+
+   for (INT i = 0; i < T->pieceCount; i++)
+   {
+      SQUARE to = P->Sq[i];
+      PIECE  p = P->Piece[i];
+      if (to == nullSq || pieceColour(p) != c) continue;
+
+      TBPOS Q = *P;
+
+      if (pieceType(p) == pawn)
+      {
+         INT    back = (c == white ? -16 : 16);
+         SQUARE from = to + back;
+         INT    r = rank(from);
+
+         if (r == 0 || r == 7 || P->Slot[from]) continue;
+         Q.Sq[i] = from;
+         Index[count++] = TB_Index(T, Q.Sq, c);
+
+         if (r == (c == white ? 2 : 5) && ! P->Slot[from + back])
+         {  Q.Sq[i] = from + back;
+            Index[count++] = TB_Index(T, Q.Sq, c);
+         }
+         continue;
+      }
+
+      BOOL   slide;
+      SQUARE *Dir = PieceDirs(p, &slide);
+      for (INT d = 0; Dir[d]; d++)
+         for (SQUARE from = to - Dir[d]; onBoard(from) && ! P->Slot[from]; from -= Dir[d])
+         {  Q.Sq[i] = from;
+            Index[count++] = TB_Index(T, Q.Sq, c);
+            if (! slide) break;
+         }
+   }
+
+   return count;
+} /* GenUnmoves */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                      RETROGRADE ANALYSIS                                       */
+/*                                                                                                */
+/**************************************************************************************************/
+
+#define maxDependencies  64
+
+static INT  Dependencies (CHAR *name, CHAR Dep[][tbMaxPieces + 3]);
+static void RunPhase (TBGEN *G, void (*Phase)(void *W), LONG *changes, LONG *horizon);
+static void InitPhase (void *W);
+static void WinPhase (void *W);
+static void LossPhase (void *W);
+
+static BOOL Generate (CHAR *name)
+{
+   for (INT i = 0; i < generatedCount; i++)
+      if (EqualStr(Generated[i], name)) return true;
+
+   TBGEN G;
+   CopyStr(name, G.name);
+   SetupTable(name, &G.T);
+
+   if (! Exists(name, "stm") || ! Exists(name, "stw"))
+   {
+      // First make sure the tables reached by captures and promotions exist:
+
+      CHAR Dep[maxDependencies][tbMaxPieces + 3];
+      INT  count = Dependencies(name, Dep);
+
+      for (INT i = 0; i < count; i++)
+         if (! Generate(Dep[i])) return false;
+
+      for (INT i = 0; i < count; i++)
+      {  BOOL isLoaded = false;
+         SetupTable(Dep[i], &G.T);
+         for (INT j = 0; j < loaded; j++)
+            if (Loaded[j].key == G.T.key) isLoaded = true;
+         if (! isLoaded && ! LoadTable(Dep[i])) return false;
+      }
+      SetupTable(name, &G.T);
+
+      // Then solve the positions:
+
+      LONG64 t0 = MicroTimer();
+      printf("%s : %lu positions, %d threads\n", name, (unsigned long)G.T.entries, threads);
+      fflush(stdout);
+
+      G.Work    = (UINT*)malloc(G.T.entries*sizeof(UINT));
+      G.Pending = (BYTE*)malloc(G.T.entries);
+      if (! G.Work || ! G.Pending)
+      {  fprintf(stderr, "sigma-tbgen: out of memory (%s)\n", name);
+         return false;
+      }
+
+      LONG changes, horizon = 0;
+      G.pass = 0;
+      RunPhase(&G, InitPhase, &changes, &horizon);
+      for (G.pass = 1; G.pass <= horizon + 1 || changes > 0; G.pass++)
+      {  LONG n1, n2;
+         RunPhase(&G, WinPhase, &n1, &horizon);
+         RunPhase(&G, LossPhase, &n2, &horizon);
+         changes = n1 + n2;
+      }
+
+      // Finally write the DTM and WDL tables:
+
+      PTR  Dtm = (PTR)malloc(G.T.entries), Wdl = (PTR)malloc(G.T.entries), Illegal = G.Pending;
+      LONG Count[4] = { 0, 0, 0, 0 };              // Wins, draws, losses, illegal.
+      UINT longest = 0;
+
+      for (ULONG i = 0; i < G.T.entries; i++)
+      {
+         UINT w = G.Work[i];
+         Illegal[i] = (w == wrkIllegal);
+         if (wrkIsWin(w))
+            Dtm[i] = tbDtmWin(MinL(w, tbMaxDtm)), Wdl[i] = tbWdl_Win, Count[0]++, longest = MaxL(longest, w);
+         else if (wrkIsLoss(w))
+            Dtm[i] = tbDtmLoss(MinL(w - wrkLoss, tbMaxDtm)), Wdl[i] = tbWdl_Loss, Count[2]++;
+         else if (w == wrkIllegal)
+            Dtm[i] = tbDtmIllegal, Wdl[i] = tbWdl_Illegal, Count[3]++;
+         else
+            Dtm[i] = tbDtmDraw, Wdl[i] = tbWdl_Draw, Count[1]++;
+      }
+
+      printf("   %ld wins, %ld draws, %ld losses, %ld illegal, longest mate %d, %.1f s\n",
+             (long)Count[0], (long)Count[1], (long)Count[2], (long)Count[3], longest, (MicroTimer() - t0)/1.0E6);
+
+      BOOL ok = (Dtm && Wdl && SaveTable(&G, tbKind_DTM, Dtm, Illegal) && SaveTable(&G, tbKind_WDL, Wdl, Illegal));
+      free(G.Work);
+      free(G.Pending);
+      free(Dtm);
+      free(Wdl);
+      if (! ok) return false;
+   }
+
+   CopyStr(name, Generated[generatedCount++]);
+   return true;
+} /* Generate */
+
+
+// Returns the signatures reached by a capture, a promotion or a capture with promotion (except
+// "KK").
+
+static INT Dependencies (CHAR *name, CHAR Dep[][tbMaxPieces + 3])
+{
+   CHAR Sig[1 + 4][tbMaxPieces + 3];               // The signature and its promotions.
+   INT  n = StrLen(name), sigCount = 1, count = 0;
+
+   CopyStr(name, Sig[0]);
+   for (INT i = 1; i < n; i++)
+      for (INT k = 0; name[i] == 'P' && k < 4; k++)
+      {  CopyStr(name, Sig[sigCount]);
+         Sig[sigCount++][i] = sigLetters[k];
+      }
+
+   for (INT s = 0; s < sigCount; s++)
+      for (INT i = 0; i <= n; i++)                 // i = n: The promotion itself.
+      {
+         CHAR sig[tbMaxPieces + 3], dep[tbMaxPieces + 3];
+         BOOL found = false;
+
+         if (i < n)                                // Capture of piece i.
+         {  if (Sig[s][i] == 'K' || n == 3) continue;
+            CopySubStr(Sig[s], i, sig);
+            CopyStr(Sig[s] + i + 1, sig + i);
+         }
+         else if (s == 0)
+            continue;
+         else
+            CopyStr(Sig[s], sig);
+
+         if (! Canonical(sig, dep)) continue;
+         for (INT j = 0; j < count; j++)
+            if (EqualStr(Dep[j], dep)) found = true;
+         if (! found) CopyStr(dep, Dep[count++]);
+      }
+
+   return count;
+} /* Dependencies */
+
+
+static void *RunWorker (void *data)
+{
+   WORKER *W = (WORKER*)data;
+   W->Phase(W);
+   return nil;
+} /* RunWorker */
+
+
+static void RunPhase (TBGEN *G, void (*Phase)(void *W), LONG *changes, LONG *horizon)
+{
+   WORKER Worker[64];
+   ULONG  part = (G->T.entries + threads - 1)/threads;
+
+   for (INT t = 0; t < threads; t++)
+   {  WORKER *W = &Worker[t];
+      W->G       = G;
+      W->lo      = MinL(G->T.entries, t*part);
+      W->hi      = MinL(G->T.entries, W->lo + part);
+      W->changes = 0;
+      W->horizon = 0;
+      W->Phase   = Phase;
+      if (t > 0) pthread_create(&W->thread, nil, RunWorker, W);
+   }
+   RunWorker(&Worker[0]);
+
+   *changes = 0;
+   for (INT t = 0; t < threads; t++)
+   {  if (t > 0) pthread_join(Worker[t].thread, nil);
+      *changes += Worker[t].changes;
+      *horizon  = MaxL(*horizon, Worker[t].horizon);
+   }
+} /* RunPhase */
+
+/*------------------------------------------ Init Phase ------------------------------------------*/
+// Marks the illegal positions, mates and stalemates, and the positions where the best move is a
+// capture or promotion (if it wins, the win is pending until the pass of its length, since a non
+// capturing move may win faster; if no non capturing move exists, the position is solved).
+
+static void InitPhase (void *data)
+{
+   WORKER *W = (WORKER*)data;
+   TBGEN  *G = W->G;
+   TBPOS  P;
+   TBMOVE Move[tbgenMaxMoves];
+
+   for (ULONG i = W->lo; i < W->hi; i++)
+   {
+      G->Pending[i] = 0;
+      G->Work[i] = wrkUnknown;
+
+      if (! ValidPos(&G->T, i, &P))
+      {  G->Work[i] = wrkIllegal;
+         continue;
+      }
+
+      INT  n = GenMoves(G, &P, Move), inTable = 0, winIn = 0, lossIn = 0;
+      BOOL draw = false;
+
+      for (INT j = 0; j < n; j++)
+         if (Move[j].inTable) inTable++;
+         else if (tbDtmIsLoss(Move[j].dtm))
+         {  INT k = tbDtmMoves(Move[j].dtm) + 1;
+            if (winIn == 0 || k < winIn) winIn = k;
+         }
+         else if (tbDtmIsWin(Move[j].dtm))
+            lossIn = MaxL(lossIn, tbDtmMoves(Move[j].dtm));
+         else
+            draw = true;
+
+      if (n == 0)
+      {
+         INT k = (P.player == white ? 0 : G->T.pieceCount - 1);
+         while (P.Piece[k] != king + P.player) k--;
+         G->Work[i] = (Attacked(&G->T, &P, P.Sq[k], P.player ^ black) ? wrkLoss : wrkDraw);
+      }
+      else if (winIn > 0)
+      {  G->Pending[i] = winIn;
+         W->horizon = MaxL(W->horizon, winIn);
+      }
+      else if (inTable == 0)
+      {  G->Work[i] = (draw ? wrkDraw : wrkLoss + lossIn);
+         W->horizon = MaxL(W->horizon, lossIn);
+      }
+   }
+} /* InitPhase */
+
+/*------------------------------------------ Win Phase -------------------------------------------*/
+// Pass n: The positions with a move to a position lost in n-1 moves are won in n moves.
+
+static void WinPhase (void *data)
+{
+   WORKER *W = (WORKER*)data;
+   TBGEN  *G = W->G;
+   UINT   win = G->pass, loss = wrkLoss + G->pass - 1;
+   TBPOS  P;
+   ULONG  Index[tbgenMaxMoves];
+
+   for (ULONG i = W->lo; i < W->hi; i++)
+   {
+      UINT w = G->Work[i];
+
+      if (w == wrkUnknown && G->Pending[i] == win)
+      {  G->Work[i] = win;
+         W->changes++;
+      }
+      else if (w == loss)
+      {
+         DecodePos(&G->T, i, &P);
+         for (INT j = GenUnmoves(G, &P, Index) - 1; j >= 0; j--)
+            if (G->Work[Index[j]] == wrkUnknown)
+            {  G->Work[Index[j]] = win;
+               W->changes++;
+            }
+      }
+   }
+} /* WinPhase */
+
+/*------------------------------------------ Loss Phase ------------------------------------------*/
+// Pass n: The unknown predecessors of the positions won in n moves are lost if all their moves
+// lead to won positions (in as many moves as the longest win).
+
+static void LossPhase (void *data)
+{
+   WORKER *W = (WORKER*)data;
+   TBGEN  *G = W->G;
+   TBPOS  P, Q;
+   ULONG  Index[tbgenMaxMoves];
+   TBMOVE Move[tbgenMaxMoves];
+
+   for (ULONG i = W->lo; i < W->hi; i++)
+   {
+      if (G->Work[i] != G->pass) continue;
+
+      DecodePos(&G->T, i, &P);
+      for (INT j = GenUnmoves(G, &P, Index) - 1; j >= 0; j--)
+      {
+         if (G->Work[Index[j]] != wrkUnknown) continue;
+
+         DecodePos(&G->T, Index[j], &Q);
+         INT  n = GenMoves(G, &Q, Move), longest = 0;
+         BOOL lost = true;
+
+         for (INT k = 0; k < n && lost; k++)
+         {  INT v = (Move[k].inTable ? G->Work[Move[k].index] : Move[k].dtm);
+            if (Move[k].inTable ? ! wrkIsWin(v) : ! tbDtmIsWin(v)) lost = false;
+            else longest = MaxL(longest, (Move[k].inTable ? v : tbDtmMoves(v)));
+         }
+
+         if (lost)
+         {  G->Work[Index[j]] = wrkLoss + longest;
+            W->horizon = MaxL(W->horizon, longest);
+            W->changes++;
+         }
+      }
+   }
+} /* LossPhase */
@@ -0,0 +1,63 @@
+# Tablebase regression test (run by ctest, see "CMakeLists.txt"). Generates the KQK, KRK and KPK
+# tables with sigma-tbgen, checks their longest mates, and probes a few positions with sigma-uci
+# (the root of a position in the DTM tables gets the exact mate score, see "EndgameDB.c").
+#
+#    cmake -DTBGEN=<sigma-tbgen> -DUCI=<sigma-uci> -DDIR=<scratch folder> -P TablebaseTest.cmake
+
+file(REMOVE_RECURSE "${DIR}")
+file(MAKE_DIRECTORY "${DIR}")
+
+#--- Generate ---
+
+execute_process(COMMAND "${TBGEN}" -dir "${DIR}" KQK KRK KPK
+                OUTPUT_VARIABLE out RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+   message(FATAL_ERROR "sigma-tbgen failed (${result}):\n${out}")
+endif()
+
+foreach(table "KQK;10" "KRK;16" "KPK;28")
+   list(GET table 0 sig)
+   list(GET table 1 mate)
+   if(NOT out MATCHES "${sig} :[^\n]*\n[^\n]* longest mate ${mate},")
+      message(FATAL_ERROR "${sig}: longest mate should be ${mate}:\n${out}")
+   endif()
+endforeach()
+
+#--- Probe ---
+
+# FEN and the expected score of the side to move (without the tables the engine reports
+# ordinary centipawn scores for these at depth 2).
+set(probes
+   "8/8/8/5k2/8/8/1Q6/K7 w - - 0 1|mate 10"    # KQK, longest mate
+   "8/8/8/8/8/2k5/1R6/K7 w - - 0 1|mate 16"    # KRK, longest mate
+   "k7/1r6/2K5/8/8/8/8/8 b - - 0 1|mate 16"    # KRK, colours reversed
+   "8/8/8/8/8/8/8/KRk5 b - - 0 1|mate -15"     # KRK, losing side to move
+   "8/8/8/1k6/8/8/K5P1/8 w - - 0 1|mate 28"    # KPK, longest mate
+   "8/8/8/8/8/k7/P7/K7 w - - 0 1|cp 0")        # KPK, rook pawn draw
+
+foreach(probe ${probes})
+   string(REPLACE "|" ";" probe "${probe}")
+   list(GET probe 0 fen)
+   list(GET probe 1 score)
+
+   # (sigma-uci stops the search at the end of the input, but "ucinewgame" waits for it first).
+   file(WRITE "${DIR}/uci.txt"
+        "uci\nsetoption name EndgameDBPath value ${DIR}\nposition fen ${fen}\ngo depth 2\n"
+        "ucinewgame\n")
+   execute_process(COMMAND "${UCI}" INPUT_FILE "${DIR}/uci.txt"
+                   OUTPUT_VARIABLE out RESULT_VARIABLE result)
+
+   # Score of the last iteration (all tables must be found, i.e. 5 DTM and 5 WDL tables).
+   string(REGEX MATCHALL "score [a-z]+ -?[0-9]+" scores "${out}")
+   list(LENGTH scores n)
+   if(n GREATER 0)
+      math(EXPR n "${n} - 1")
+      list(GET scores ${n} last)
+   else()
+      set(last "none")
+   endif()
+   if(NOT result EQUAL 0 OR NOT out MATCHES "info string 10 endgame databases found" OR
+      NOT last STREQUAL "score ${score}")
+      message(FATAL_ERROR "${fen}: expected \"score ${score}\", got \"${last}\":\n${out}")
+   endif()
+endforeach()
@@ -0,0 +1,116 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : TOOLBOX.C                                                                            */
+/* Purpose : Portable implementation of the few Mac Toolbox routines used by the engine and the   */
+/*           Sigma Class Library core (see "PortablePrefix.h").                                   */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <time.h>
+
+#include "General.h"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                              TIMERS                                            */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static UInt64 startTime = 0;                      // Set once by Toolbox_Init() (before any
+                                                  // engine threads are started).
+
+static UInt64 MonotonicMicroSecs (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (UInt64)ts.tv_sec*1000000 + ts.tv_nsec/1000 - startTime;
+} /* MonotonicMicroSecs */
+
+
+void Toolbox_Init (void)
+{
+   startTime = 0;
+   startTime = MonotonicMicroSecs() - 1;
+} /* Toolbox_Init */
+
+
+unsigned long TickCount (void)
+{
+   return (unsigned long)((MonotonicMicroSecs()*60)/1000000);
+} /* TickCount */
+
+
+void Microseconds (UnsignedWide *m)
+{
+   UInt64 t = MonotonicMicroSecs();
+   m->hi = (uint32_t)(t >> 32);
+   m->lo = (uint32_t)t;
+} /* Microseconds */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                               MISC                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Same generator as the Toolbox (Park & Miller, seed 1). The seed is shared by all engine threads
+// and updated atomically.
+
+short Random (void)
+{
+   static LONG seed = 1;
+   LONG s = __atomic_load_n(&seed, __ATOMIC_RELAXED), next;
+
+   do
+      next = (LONG)(((LONG64)s*16807) % 0x7FFFFFFF);
+   while (! __atomic_compare_exchange_n(&seed, &s, next, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+   return (short)(next & 0xFFFF);
+} /* Random */
+
+
+void GetTime (DateTimeRec *d)
+{
+   time_t    t  = time(nil);
+   struct tm tmr, *tm = localtime_r(&t, &tmr);    // (Thread safe, games may be reset by workers).
+
+   d->year      = tm->tm_year + 1900;
+   d->month     = tm->tm_mon + 1;
+   d->day       = tm->tm_mday;
+   d->hour      = tm->tm_hour;
+   d->minute    = tm->tm_min;
+   d->second    = tm->tm_sec;
+   d->dayOfWeek = tm->tm_wday + 1;
+} /* GetTime */
+
+
+void NumToString (long n, Str255 s)
+{
+   s[0] = (unsigned char)snprintf((char*)&s[1], 255, "%ld", n);
+} /* NumToString */
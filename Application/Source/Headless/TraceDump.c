@@ -0,0 +1,400 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EngineHost.h"
+
+#include "Engine.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Reads a search trace file written by the engine host (see Host_SetTraceFile and "Trace.h") and
+// either prints a summary of each search, converts the trace to the Chrome trace event format
+// (for "chrome://tracing" or Perfetto), or prints the search tree as indented text. Each search
+// record is read separately, so large traces don't have to fit in memory.
+//
+// If the ring buffer overflowed, the start of the trace is missing: Exit events without a
+// matching Enter event are then skipped, and nodes still open at the end are closed.
+
+typedef struct
+{
+   CHAR   *traceFile;
+   CHAR   *chromeFile;                   // Chrome trace output (nil if none).
+   BOOL   tree;                          // Print the search tree?
+   INT    maxDepth;                      // Max tree depth printed (0 = all).
+   INT    search;                        // Only convert this search (0 = all).
+   FILE   *out;
+   LONG64 chromeCount;                   // Chrome events written so far.
+   LONG64 baseMicroTime;                 // Time origin of the Chrome trace (start of 1st search).
+} TRACEDUMP;
+
+typedef struct
+{
+   TRACE_FILE_HEADER H;
+   TRACE_EVENT       *Events;
+   LONG              *Match;             // Index of the exit event matching each enter event.
+   LONG64            *MicroTime;         // Time of each event (micro seconds).
+} SEARCH_TRACE;
+
+static CHAR *KindName[] = { "", "iteration", "enter", "exit", "cutoff", "transcut", "draw", "leaf", "standpat", "tablebase" };
+static CHAR *GenName[]  = { "Rfm", "A", "B", "C", "D", "E", "F1", "F2", "G", "H", "I", "J", "K", "L", "Rfm", "Null" };
+
+static void DumpSearch (TRACEDUMP *D, INT n, SEARCH_TRACE *S);
+static void Usage (void);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                               MAIN                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (int argc, char *argv[])
+{
+   TRACEDUMP D;
+
+   memset(&D, 0, sizeof(TRACEDUMP));
+
+   for (INT i = 1; i < argc; i++)
+      if (EqualStr(argv[i], "-chrome") && i + 1 < argc)
+         D.chromeFile = argv[++i];
+      else if (EqualStr(argv[i], "-tree"))
+         D.tree = true;
+      else if (EqualStr(argv[i], "-depth") && i + 1 < argc)
+         D.maxDepth = atoi(argv[++i]);
+      else if (EqualStr(argv[i], "-search") && i + 1 < argc)
+         D.search = atoi(argv[++i]);
+      else if (argv[i][0] == '-' || D.traceFile)
+      {  Usage();
+         return 2;
+      }
+      else
+         D.traceFile = argv[i];
+
+   if (! D.traceFile || (D.chromeFile && D.tree) || D.maxDepth < 0 || D.search < 0)
+   {  Usage();
+      return 2;
+   }
+
+   FILE *file = fopen(D.traceFile, "rb");
+   if (! file)
+   {  fprintf(stderr, "sigma-trace: cannot open \"%s\"\n", D.traceFile);
+      return 1;
+   }
+
+   D.out = stdout;
+   if (D.chromeFile && ! (D.out = fopen(D.chromeFile, "w")))
+   {  fprintf(stderr, "sigma-trace: cannot create \"%s\"\n", D.chromeFile);
+      fclose(file);
+      return 1;
+   }
+   if (D.chromeFile) fprintf(D.out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+   INT result = 0, n;
+   SEARCH_TRACE S;
+
+   for (n = 1; fread(&S.H, sizeof(TRACE_FILE_HEADER), 1, file) == 1; n++)
+   {
+      if (S.H.magic != traceFileMagic || S.H.version != traceFileVersion || S.H.eventSize != sizeof(TRACE_EVENT))
+      {  fprintf(stderr, "sigma-trace: \"%s\" is not a valid trace file (search %d)\n", D.traceFile, n);
+         result = 1;
+         break;
+      }
+
+      if (D.search > 0 && n != D.search)
+      {  fseek(file, S.H.count*sizeof(TRACE_EVENT), SEEK_CUR);
+         continue;
+      }
+
+      S.Events    = (TRACE_EVENT*)malloc(S.H.count*sizeof(TRACE_EVENT) + 1);
+      S.Match     = (LONG*)malloc(S.H.count*sizeof(LONG) + 1);
+      S.MicroTime = (LONG64*)malloc(S.H.count*sizeof(LONG64) + 1);
+      if (! S.Events || ! S.Match || ! S.MicroTime ||
+          fread(S.Events, sizeof(TRACE_EVENT), S.H.count, file) != S.H.count)
+      {  fprintf(stderr, "sigma-trace: cannot read search %d\n", n);
+         result = 1;
+         free(S.Events); free(S.Match); free(S.MicroTime);
+         break;
+      }
+
+      if (D.baseMicroTime == 0) D.baseMicroTime = S.H.startMicroTime;
+
+      DumpSearch(&D, n, &S);
+      free(S.Events);
+      free(S.Match);
+      free(S.MicroTime);
+   }
+
+   if (D.chromeFile)
+   {  fprintf(D.out, "\n]}\n");
+      fclose(D.out);
+   }
+   fclose(file);
+
+   if (D.search > 0 && n <= D.search && result == 0)
+   {  fprintf(stderr, "sigma-trace: no search %d in \"%s\"\n", D.search, D.traceFile);
+      result = 1;
+   }
+   return result;
+} /* main */
+
+
+static void Usage (void)
+{
+   fprintf(stderr, "usage: sigma-trace [-search n] tracefile                      (summary)\n");
+   fprintf(stderr, "       sigma-trace [-search n] -chrome out.json tracefile     (Chrome trace events)\n");
+   fprintf(stderr, "       sigma-trace [-search n] -tree [-depth n] tracefile     (search tree)\n");
+} /* Usage */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          DUMP SEARCH                                           */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void MatchEvents (SEARCH_TRACE *S);
+static void EventTimes (SEARCH_TRACE *S);
+static void PrintSummary (INT n, SEARCH_TRACE *S);
+static void WriteChrome (TRACEDUMP *D, INT n, SEARCH_TRACE *S);
+static void PrintTree (TRACEDUMP *D, INT n, SEARCH_TRACE *S);
+
+static void DumpSearch (TRACEDUMP *D, INT n, SEARCH_TRACE *S)
+{
+   MatchEvents(S);
+   EventTimes(S);
+
+   if (D->chromeFile)
+      WriteChrome(D, n, S);
+   else if (D->tree)
+      PrintTree(D, n, S);
+   else
+      PrintSummary(n, S);
+} /* DumpSearch */
+
+
+// Pairs each Enter event with its Exit event (-1 if the node is still open at the end of the
+// trace). Exit events without an Enter event (lost in the ring buffer) are matched with -1.
+
+static void MatchEvents (SEARCH_TRACE *S)
+{
+   LONG *Stack = (LONG*)malloc((S->H.count + 1)*sizeof(LONG)), sp = 0;
+
+   for (LONG i = 0; i < (LONG)S->H.count; i++)
+   {
+      S->Match[i] = -1;
+      if (S->Events[i].kind == trace_Enter)
+         Stack[sp++] = i;
+      else if (traceIsExit(S->Events[i].kind) && sp > 0)
+      {  S->Match[i] = Stack[--sp];
+         S->Match[S->Match[i]] = i;
+      }
+   }
+
+   free(Stack);
+} /* MatchEvents */
+
+
+// Computes the time of each event in micro seconds. Only every "stampInterval"'th event of the
+// search holds a (32 bit) time stamp, which is extended to 64 bits backwards from the end of the
+// search (the start may have been overwritten in the ring buffer). The times of the events in
+// between are interpolated linearly, and the events before the first time stamp get its time.
+
+static void EventTimes (SEARCH_TRACE *S)
+{
+   LONG64 ticks = S->H.endTime - S->H.startTime;
+   REAL   scale = (ticks > 0 ? (REAL)(S->H.endMicroTime - S->H.startMicroTime)/ticks : 1.0);
+   LONG64 t1    = ticks >> S->H.clockShift;   // Time of the next time stamp (initially the end
+   LONG   i1    = (LONG)S->H.count;           // of the search) and its event index.
+
+   for (LONG i = i1 - 1; i >= -1; i--)
+   {
+      if (i >= 0 && (S->H.dropped + i) % S->H.stampInterval != 0) continue;
+
+      LONG64 t0 = (i >= 0 ? t1 - (ULONG)((ULONG)t1 - S->Events[i].time) : t1);
+      for (LONG j = Max(i, 0); j < i1; j++)
+      {  LONG64 t = t0 + (i >= 0 ? (t1 - t0)*(j - i)/(i1 - i) : 0);
+         S->MicroTime[j] = S->H.startMicroTime + (LONG64)((t << S->H.clockShift)*scale);
+      }
+      t1 = t0;
+      i1 = i;
+   }
+} /* EventTimes */
+
+
+static void EventMoveStr (TRACE_EVENT *e, CHAR *s)
+{
+   MOVE m;
+
+   clrMove(m);
+   if ((e->gen & 0x0F) == gen_Null)
+      CopyStr("null", s);
+   else if (e->piece == empty)
+      CopyStr("-", s);
+   else
+   {  m.piece = e->piece;
+      m.from  = e->from;
+      m.to    = e->to;
+      m.type  = traceEventPromotion(e);
+      Host_MoveStr(&m, s);
+   }
+} /* EventMoveStr */
+
+/*------------------------------------------- Summary --------------------------------------------*/
+
+static void PrintSummary (INT n, SEARCH_TRACE *S)
+{
+   LONG64 Count[trace_Tablebase + 1];
+   LONG   orphans = 0, open = 0;
+
+   for (INT k = 0; k <= trace_Tablebase; k++) Count[k] = 0;
+
+   for (LONG i = 0; i < (LONG)S->H.count; i++)
+   {
+      TRACE_EVENT *e = &S->Events[i];
+      if (e->kind <= trace_Tablebase) Count[e->kind]++;
+      if (S->Match[i] >= 0) continue;
+      if (e->kind == trace_Enter) open++;
+      else if (traceIsExit(e->kind)) orphans++;
+   }
+
+   printf("Search %d: depth %d, %.3f s, %llu events (%llu dropped), %ld unmatched exits, %ld open nodes\n",
+          n, (int)S->H.mainDepth, (S->H.endMicroTime - S->H.startMicroTime)/1.0E6,
+          (unsigned long long)S->H.count, (unsigned long long)S->H.dropped, (long)orphans, (long)open);
+
+   for (INT k = trace_Iteration; k <= trace_Tablebase; k++)
+      printf("   %-10s %12lld\n", KindName[k], (long long)Count[k]);
+} /* PrintSummary */
+
+/*----------------------------------------- Chrome Trace -----------------------------------------*/
+// Each node becomes a duration event ("B"/"E") named after the move leading to it. The searches
+// are shown as separate threads on the time line of the first search.
+
+static void ChromeEvent (TRACEDUMP *D, INT n, SEARCH_TRACE *S, LONG i, CHAR ph, CHAR *name, CHAR *args)
+{
+   fprintf(D->out, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":%d%s%s%s}",
+           (D->chromeCount++ > 0 ? ",\n" : ""), name, ph, (long long)(S->MicroTime[i] - D->baseMicroTime),
+           n, (ph == 'i' ? ",\"s\":\"t\"" : ""), (args ? ",\"args\":" : ""), (args ? args : ""));
+} /* ChromeEvent */
+
+
+static void WriteChrome (TRACEDUMP *D, INT n, SEARCH_TRACE *S)
+{
+   CHAR name[20], best[20], args[200];
+   LONG open = 0;
+
+   Format(args, "{\"name\":\"Search %d (depth %d)\"}", n, (int)S->H.mainDepth);
+   fprintf(D->out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":%s}",
+           (D->chromeCount++ > 0 ? ",\n" : ""), n, args);
+
+   for (LONG i = 0; i < (LONG)S->H.count; i++)
+   {
+      TRACE_EVENT *e = &S->Events[i];
+
+      switch (e->kind)
+      {
+         case trace_Iteration :
+            Format(name, "Depth %d", e->depth);
+            Format(args, "{\"alpha\":%d,\"beta\":%d,\"score\":%d}", e->alpha, e->beta, e->value);
+            ChromeEvent(D, n, S, i, 'i', name, args);
+            break;
+         case trace_Enter :
+            EventMoveStr(e, name);
+            Format(args, "{\"gen\":\"%s\",\"depth\":%d,\"ply\":%d,\"alpha\":%d,\"beta\":%d}",
+                   GenName[e->gen & 0x0F], e->depth, e->value, e->alpha, e->beta);
+            ChromeEvent(D, n, S, i, 'B', name, args);
+            open++;
+            break;
+         default :
+            if (! traceIsExit(e->kind) || S->Match[i] < 0) break;
+            Format(args, "{\"exit\":\"%s\",\"score\":%d}", KindName[e->kind], e->value);
+            if (e->piece != empty)
+            {  EventMoveStr(e, best);
+               Format(args + StrLen(args) - 1, ",\"best\":\"%s\",\"bestGen\":\"%s\"}", best, GenName[e->gen & 0x0F]);
+            }
+            ChromeEvent(D, n, S, i, 'E', "", args);
+            open--;
+      }
+   }
+
+   if (S->H.count > 0)                           // Close the nodes still open.
+      for (; open > 0; open--)
+         ChromeEvent(D, n, S, S->H.count - 1, 'E', "", nil);
+} /* WriteChrome */
+
+/*------------------------------------------ Search Tree -----------------------------------------*/
+// Prints each node on a line (indented by its level below the first node in the trace) with the
+// move leading to it, its generator, depth/ply, window, and how it was exited:
+//
+//    e2e4 [A] depth 2 ply 5 (-20,15) : cutoff 12 by g8f6 [C]
+
+static void PrintTree (TRACEDUMP *D, INT n, SEARCH_TRACE *S)
+{
+   CHAR move[20], best[20];
+   INT  level = 0;
+
+   printf("Search %d: depth %d, %llu events (%llu dropped)\n", n, (int)S->H.mainDepth,
+          (unsigned long long)S->H.count, (unsigned long long)S->H.dropped);
+
+   for (LONG i = 0; i < (LONG)S->H.count; i++)
+   {
+      TRACE_EVENT *e = &S->Events[i];
+
+      if (e->kind == trace_Iteration)
+         printf("Iteration %d (%d,%d)\n", e->depth, e->alpha, e->beta);
+      else if (traceIsExit(e->kind))
+      {  if (S->Match[i] >= 0) level--;
+      }
+      else if (e->kind == trace_Enter)
+      {
+         if (D->maxDepth == 0 || level < D->maxDepth)
+         {
+            EventMoveStr(e, move);
+            printf("%*s%s [%s] depth %d ply %d (%d,%d) : ", 3*level, "", move, GenName[e->gen & 0x0F],
+                   e->depth, e->value, e->alpha, e->beta);
+
+            if (S->Match[i] < 0)
+               printf("open\n");
+            else
+            {  TRACE_EVENT *x = &S->Events[S->Match[i]];
+               printf("%s %d", KindName[x->kind], x->value);
+               if (x->piece != empty)
+               {  EventMoveStr(x, best);
+                  printf(" %s %s [%s]", (x->kind == trace_Cutoff ? "by" : "best"), best, GenName[x->gen & 0x0F]);
+               }
+               printf("\n");
+            }
+         }
+         level++;
+      }
+   }
+} /* PrintTree */
@@ -0,0 +1,509 @@
+/**************************************************************************************************/
+/*                                                                                                */
+/* Module  : UCIENGINE.C                                                                          */
+/* Purpose : Headless UCI front end ("sigma-uci"), which exposes the Sigma engine as a UCI engine */
+/*           (reading commands from stdin and writing the replies to stdout).                     */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+  and the following disclaimer in the documentation and/or other materials provided with the
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "EngineHost.h"
+
+#include "Engine.f"
+#include "Time.f"
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                       CONSTANTS & TYPES                                        */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// The main thread reads and executes the commands. A "go" command starts a host thread, which
+// runs the message loop of the search (Host_Search) and prints the "info" lines and finally the
+// "bestmove". Hence "stop", "ponderhit" and "isready" can be handled while the engine searches.
+// All other commands first wait for the search to complete.
+
+#define uciLineSize      20000                     // Max input line length (long move lists).
+#define uciDefaultHash   16                        // Default/max transposition table size (MB).
+#define uciMaxHash       65536
+#define uciInfoInterval  1000000                   // Micro secs between periodic "info" lines.
+
+typedef struct
+{
+   ENGINE    *E;
+   CGame     *game;                                // Current position ("position" command).
+   CGame     *pvGame;                              // Copy of the search position (PV checks).
+   pthread_t thread;                               // Host thread of the current search.
+   BOOL      searching;                            // Has a search been started (and not joined)?
+   LONG64    infoTime;                             // MicroTimer() of next periodic "info" line.
+} UCI_ENGINE;
+
+static void   UCI_Main       (UCI_ENGINE *U);
+static void   UCI_Position   (UCI_ENGINE *U, CHAR *s);
+static void   UCI_SetOption  (UCI_ENGINE *U, CHAR *s);
+static void   UCI_Go         (UCI_ENGINE *U, CHAR *s);
+static void   UCI_Stop       (UCI_ENGINE *U);
+static void   UCI_Wait       (UCI_ENGINE *U);
+static void   *SearchThread  (void *data);
+static void   SearchMsg      (ENGINE *E, ULONG msg, PTR data);
+static void   SendMainLine   (UCI_ENGINE *U);
+static void   SendNodeCount  (UCI_ENGINE *U);
+static CHAR   *NextToken     (CHAR **s);
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                          MAIN PROGRAM                                          */
+/*                                                                                                */
+/**************************************************************************************************/
+
+int main (void)
+{
+   UCI_ENGINE U;
+
+   setvbuf(stdout, nil, _IOLBF, 0);               // Line buffered, even if stdout is a pipe.
+
+   Host_InitSystem();
+   U.E         = (ENGINE*)calloc(1, sizeof(ENGINE));
+   U.game      = new CGame();
+   U.pvGame    = new CGame();
+   U.searching = false;
+   U.infoTime  = 0;
+   Engine_Create(&Global, U.E, 0);
+   U.E->P.useEndgameDB = false;                   // Until installed (option "EndgameDBPath").
+
+   Host_SetTransReserve((ULONG64)uciMaxHash << 20);  // "Hash" can be resized in place up to this.
+   if (! Host_SetTransTables(U.E, (ULONG64)uciDefaultHash << 20))
+   {  fprintf(stderr, "sigma-uci: cannot allocate transposition tables\n");
+      return 1;
+   }
+
+   UCI_Main(&U);
+
+   UCI_Stop(&U);
+   Host_SetTransTables(U.E, 0);
+   Host_SetThreads(U.E, 1);
+   Engine_Destroy(U.E);
+   Host_EndSystem();
+   delete U.game;
+   delete U.pvGame;
+   free(U.E);
+   return 0;
+} /* main */
+
+
+static void UCI_Main (UCI_ENGINE *U)
+{
+   static CHAR line[uciLineSize];
+
+   while (fgets(line, uciLineSize, stdin))
+   {
+      CHAR *s = line, *cmd = NextToken(&s);
+
+      if (! cmd)
+         continue;
+      else if (EqualStr(cmd, "uci"))
+      {
+         printf("id name Sigma Chess 6.2\n");
+         printf("id author Ole K. Christensen\n");
+         printf("option name Hash type spin default %d min 0 max %d\n", uciDefaultHash, uciMaxHash);
+         printf("option name Threads type spin default 1 min 1 max %d\n", maxSearchThreads);
+         printf("option name MultiPV type spin default 1 min 1 max %d\n", maxMultiPV);
+         printf("option name Ponder type check default false\n");
+         printf("option name Style type combo default Normal var Chicken var Defensive var Normal var Aggressive var Desperado\n");
+         printf("option name SelectionMargin type spin default 4 min 0 max 100\n");
+         printf("option name EndgameDBPath type string default <empty>\n");
+         printf("uciok\n");
+      }
+      else if (EqualStr(cmd, "isready"))
+         printf("readyok\n");
+      else if (EqualStr(cmd, "ucinewgame"))
+         UCI_Wait(U);
+      else if (EqualStr(cmd, "setoption"))
+         UCI_Wait(U), UCI_SetOption(U, s);
+      else if (EqualStr(cmd, "position"))
+         UCI_Wait(U), UCI_Position(U, s);
+      else if (EqualStr(cmd, "go"))
+         UCI_Wait(U), UCI_Go(U, s);
+      else if (EqualStr(cmd, "stop"))
+         UCI_Stop(U);
+      else if (EqualStr(cmd, "ponderhit"))
+         Engine_ClearBackgrounding(U->E);         // Time control now applies (from search start).
+      else if (EqualStr(cmd, "quit"))
+         return;
+   }
+} /* UCI_Main */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                           COMMANDS                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+/*------------------------------------------- Position -------------------------------------------*/
+// position [startpos | fen <fen>] [moves <move1> ... <moveN>]
+
+static void UCI_Position (UCI_ENGINE *U, CHAR *s)
+{
+   CGame *game = U->game;
+   CHAR  *tok  = NextToken(&s);
+   CHAR  fen[200];
+
+   if (tok && EqualStr(tok, "fen"))
+   {
+      fen[0] = 0;
+      while ((tok = NextToken(&s)) && ! EqualStr(tok, "moves") && StrLen(fen) + StrLen(tok) < 190)
+      {  if (fen[0]) strcat(fen, " ");
+         strcat(fen, tok);
+      }
+      if (game->Read_EPD(fen) != epdErr_NoError)
+      {  printf("info string invalid fen %s\n", fen);
+         game->NewGame();
+         return;
+      }
+   }
+   else
+   {
+      game->NewGame();
+      tok = NextToken(&s);
+   }
+
+   if (! tok || ! EqualStr(tok, "moves")) return;
+
+   while ((tok = NextToken(&s)))
+   {
+      MOVE *m = Host_ParseMove(game, tok);
+
+      if (! m || game->currMove >= gameRecSize - 2)
+      {  printf("info string illegal move %s\n", tok);
+         return;
+      }
+      MOVE mv = *m;
+      game->PlayMove(&mv);
+   }
+} /* UCI_Position */
+
+/*------------------------------------------ Set Option ------------------------------------------*/
+// setoption name <id> [value <x>]
+
+static void UCI_SetOption (UCI_ENGINE *U, CHAR *s)
+{
+   ENGINE *E = U->E;
+   CHAR   *tok, name[100], *value = nil;
+
+   if (! (tok = NextToken(&s)) || ! EqualStr(tok, "name")) return;
+
+   name[0] = 0;
+   while ((tok = NextToken(&s)) && ! EqualStr(tok, "value") && StrLen(name) + StrLen(tok) < 90)
+   {  if (name[0]) strcat(name, " ");
+      strcat(name, tok);
+   }
+   if (tok && EqualStr(tok, "value")) value = NextToken(&s);
+   if (! value) return;
+
+   if (SameStr(name, "Hash"))
+   {
+      LONG mb = atol(value);
+      if (mb < 0 || mb > uciMaxHash || ! Host_SetTransTables(E, (ULONG64)mb << 20))
+         printf("info string cannot allocate %s MB hash\n", value);
+   }
+   else if (SameStr(name, "Threads"))
+   {
+      INT n = atoi(value);
+      if (n < 1 || n > maxSearchThreads || ! Host_SetThreads(E, n))
+         printf("info string cannot create %s threads\n", value);
+   }
+   else if (SameStr(name, "MultiPV"))
+      E->P.multiPV = Max(1, Min(maxMultiPV, atoi(value)));
+   else if (SameStr(name, "Style"))
+   {
+      static CHAR *Style[] = { "Chicken", "Defensive", "Normal", "Aggressive", "Desperado", nil };
+      for (INT i = 0; Style[i]; i++)
+         if (SameStr(value, Style[i])) E->P.playingStyle = style_Chicken + i;
+   }
+   else if (SameStr(name, "SelectionMargin"))
+      E->P.selMargin = Max(0, Min(100, atoi(value)));
+   else if (SameStr(name, "EndgameDBPath"))
+   {
+      INT n = Host_SetEndgameDB(EqualStr(value, "<empty>") ? nil : value);
+      E->P.useEndgameDB = (n > 0);
+      printf("info string %d endgame databases found\n", n);
+   }
+} /* UCI_SetOption */
+
+/*---------------------------------------------- Go ----------------------------------------------*/
+// go [ponder] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [movetime <ms>]
+//    [depth <n>] [nodes <n>] [mate <n>] [infinite]
+//
+// Searches without a limit ("go infinite" or plain "go") and ponder searches are run as
+// background searches, which only report their best move after "stop" (or "ponderhit").
+
+static void UCI_Go (UCI_ENGINE *U, CHAR *s)
+{
+   ENGINE *E = U->E;
+   PARAM  *P = &E->P;
+   CHAR   *tok;
+   LONG   wtime = 0, btime = 0, winc = 0, binc = 0, moveTime = 0;
+   INT    movesToGo = 0, depth = 0, mate = 0;
+   BOOL   ponder = false;
+
+   P->nodeLimit = 0;
+
+   while ((tok = NextToken(&s)))
+   {
+      CHAR *arg = nil;                             // Numeric argument of the token.
+
+      if (EqualStr(tok, "ponder"))
+         ponder = true;
+      else if (EqualStr(tok, "infinite") || ! (arg = NextToken(&s)))
+         continue;
+      else if (EqualStr(tok, "wtime"))     wtime = atol(arg);
+      else if (EqualStr(tok, "btime"))     btime = atol(arg);
+      else if (EqualStr(tok, "winc"))      winc = atol(arg);
+      else if (EqualStr(tok, "binc"))      binc = atol(arg);
+      else if (EqualStr(tok, "movestogo")) movesToGo = atoi(arg);
+      else if (EqualStr(tok, "movetime"))  moveTime = atol(arg);
+      else if (EqualStr(tok, "depth"))     depth = atoi(arg);
+      else if (EqualStr(tok, "mate"))      mate = atoi(arg);
+      else if (EqualStr(tok, "nodes"))     P->nodeLimit = atoll(arg);
+   }
+
+   Host_SetGame(E, U->game);
+   U->pvGame->CopyFrom(U->game, false, false, false);
+
+   LONG timeLeft = (P->player == white ? wtime : btime);
+
+   P->backgrounding = false;
+   P->timeLeftMS    = 0;
+   P->timeIncMS     = 0;
+   P->moveTimeMS    = 0;
+
+   if (mate > 0)
+   {  P->playingMode = mode_Mate;
+      P->depth       = Min(mate, maxSearchDepth/2 - 1);
+   }
+   else if (depth > 0)
+   {  P->playingMode = mode_FixDepth;
+      P->depth       = Min(depth, maxSearchDepth - 1);
+   }
+   else if (moveTime > 0)
+   {  P->playingMode = mode_Time;
+      P->moveTimeMS  = moveTime;
+   }
+   else if (timeLeft > 0)
+   {  P->playingMode = mode_Time;
+      P->timeLeftMS  = timeLeft;
+      P->timeIncMS   = (P->player == white ? winc : binc);
+      P->movesLeft   = (movesToGo > 0 ? movesToGo : allMoves);
+      P->movesPlayed = (movesToGo > 0 ? Max(0, 40 - movesToGo) : (U->game->currMove + 1)/2);
+   }
+   else if (P->nodeLimit > 0)
+      P->playingMode = mode_Infinite;
+   else
+   {  P->playingMode   = mode_Infinite;
+      P->backgrounding = true;
+   }
+
+   if (ponder) P->backgrounding = true;
+
+   U->infoTime  = MicroTimer() + uciInfoInterval;
+   U->searching = (pthread_create(&U->thread, nil, SearchThread, (void*)U) == 0);
+   if (! U->searching)
+      printf("bestmove 0000\n");
+} /* UCI_Go */
+
+/*----------------------------------------- Stop/Wait --------------------------------------------*/
+
+static void UCI_Stop (UCI_ENGINE *U)
+{
+   if (! U->searching) return;
+
+   Engine_ClearBackgrounding(U->E);               // Background searches must report now.
+   Engine_Stop(U->E);
+   UCI_Wait(U);
+} /* UCI_Stop */
+
+
+static void UCI_Wait (UCI_ENGINE *U)              // Waits for the current search (if any) to
+{                                                 // complete.
+   if (! U->searching) return;
+
+   pthread_join(U->thread, nil);
+   U->searching = false;
+} /* UCI_Wait */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                        SEARCH HOST THREAD                                      */
+/*                                                                                                */
+/**************************************************************************************************/
+
+static void *SearchThread (void *data)
+{
+   UCI_ENGINE *U = (UCI_ENGINE*)data;
+   ENGINE     *E = U->E;
+   CHAR       mstr[10], pstr[10];
+
+   Host_Search(E, SearchMsg, (PTR)U);
+
+   Host_MoveStr(&Engine_BestMove(E), mstr);
+   if (! isNull(Engine_BestMove(E)) && Engine_IsPonderMove(E) && ! isNull(Engine_BestReply(E)))
+   {  Host_MoveStr(&Engine_BestReply(E), pstr);
+      printf("bestmove %s ponder %s\n", mstr, pstr);
+   }
+   else
+      printf("bestmove %s\n", mstr);
+
+   return nil;
+} /* SearchThread */
+
+
+static void SearchMsg (ENGINE *E, ULONG msg, PTR data)
+{
+   UCI_ENGINE *U = (UCI_ENGINE*)data;
+
+   if (Engine_MainDepth(E) < 1) return;            // Nothing to report before the 1st iteration
+                                                   // (and the initial counts aren't reset yet).
+   switch (msg)
+   {
+      case msg_NewIteration :
+         printf("info depth %d\n", Engine_MainDepth(E));
+         break;
+
+      case msg_NewMainLine :
+         SendMainLine(U);
+         break;
+
+      case msg_NewNodeCount :
+         SendNodeCount(U);
+         break;
+
+      case msg_Periodic :
+         if (MicroTimer() >= U->infoTime)
+         {  SendNodeCount(U);
+            U->infoTime = MicroTimer() + uciInfoInterval;
+         }
+         break;
+   }
+} /* SearchMsg */
+
+/*---------------------------------------- Info Lines --------------------------------------------*/
+
+// The main line is printed as far as it's legal, because the single PV line is posted async (and
+// may thus change while it's being printed). Empty lines (e.g. before the first iteration) are
+// skipped.
+
+static void SendMainLine (UCI_ENGINE *U)
+{
+   ENGINE *E     = U->E;
+   CGame  *game  = U->pvGame;
+   INT    score  = Engine_BestScore(E);
+   LONG64 usecs  = MicroTimer() - E->S.startMicroTime + 1;
+   CHAR   line[10*maxSearchDepth + 200], *s = line;
+   INT    n      = 0;
+
+   s += Format(s, "info depth %d ", Engine_MainDepth(E));
+   if (E->P.multiPV > 1)                           // Only in multi PV mode (as most engines).
+      s += Format(s, "multipv %d ", Engine_MultiPV(E));
+   s += Format(s, "score ");
+
+   if (score >= mateWinVal)
+      s += Format(s, "mate %d", (1 + maxVal - score)/2);
+   else if (score <= mateLoseVal)
+      s += Format(s, "mate %d", -(1 + maxVal + score)/2);
+   else
+      s += Format(s, "cp %d", score);
+
+   switch (Engine_ScoreType(E))                    // NB: A "lower bound" score type is returned
+   {                                               // on fail low (i.e. it's an upper bound).
+      case scoreType_LowerBound : s += Format(s, " upperbound"); break;
+      case scoreType_UpperBound : s += Format(s, " lowerbound"); break;
+   }
+
+   s += Format(s, " nodes %lld nps %lld time %lld hashfull %d pv",
+               (long long)Engine_MoveCount(E), (long long)(Engine_MoveCount(E)*1000000/usecs),
+               (long long)(usecs/1000), Engine_HashFull(E));
+
+   for (MOVE *Line = Engine_MainLine(E); n < maxSearchDepth && ! isNull(Line[n]); n++)
+   {
+      Host_MoveStr(&Line[n], s + 1);
+      MOVE *m = Host_ParseMove(game, s + 1);
+      if (! m || game->currMove >= gameRecSize - 2) break;
+
+      MOVE mv = *m;
+      game->PlayMove(&mv);
+      *s = ' ';
+      s += StrLen(s);
+   }
+   *s = 0;
+
+   if (n > 0) printf("%s\n", line);
+
+   while (n-- > 0) game->UndoMove(true);
+   game->lastMove = game->currMove;
+} /* SendMainLine */
+
+
+static void SendNodeCount (UCI_ENGINE *U)
+{
+   ENGINE *E     = U->E;
+   LONG64 nodes  = Engine_MoveCount(E);
+   LONG64 usecs  = MicroTimer() - E->S.startMicroTime + 1;
+
+   printf("info nodes %lld nps %lld time %lld hashfull %d\n", (long long)nodes,
+          (long long)(nodes*1000000/usecs), (long long)(usecs/1000), Engine_HashFull(E));
+} /* SendNodeCount */
+
+
+/**************************************************************************************************/
+/*                                                                                                */
+/*                                               MISC                                             */
+/*                                                                                                */
+/**************************************************************************************************/
+
+// Returns the next blank separated token of "*s" (nil if none), and advances "*s" past it.
+
+static CHAR *NextToken (CHAR **s)
+{
+   CHAR *p = *s;
+
+   while (*p == ' ' || *p == '\t' || IsNewLine(*p)) p++;
+   if (! *p) return nil;
+
+   CHAR *tok = p;
+   while (*p && *p != ' ' && *p != '\t' && ! IsNewLine(*p)) p++;
+   if (*p) *(p++) = 0;
+
+   *s = p;
+   return tok;
+} /* NextToken */
@@ -201,10 +201,10 @@ void SigmaApplication::ProcessEngineMessages (void)
    if (! Global.msgBitTab) return;  // If no engines have posted messages -> return
 
    for (INT i = 0; Global.msgBitTab; i++)
-      if (Global.msgBitTab & bit(i))
+      if (Global.msgBitTab & engineBit(i))
       {
          ((GameWindow*)(Global.Engine[i]->refID))->ProcessEngineMessage();
-         Global.msgBitTab ^= bit(i);  // Clear message table bit
+         Global.msgBitTab ^= engineBit(i);  // Clear message table bit
       }
 } /* SigmaApplication::ProcessEngineMessages */
 
@@ -0,0 +1,60 @@
+/*
+Copyright (c) 2011, Ole K. Christensen
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted 
+provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this list of conditions 
+  and the following disclaimer.
+
+ Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+  and the following disclaimer in the documentation and/or other materials provided with the 
+  distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Prefix header for the portable (non Carbon) builds, i.e. the headless engine tools. Declares the
+// small subset of the Mac Toolbox used by the engine and the Sigma Class Library core. The routines
+// are implemented in "Headless/Toolbox.c".
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define __engine_portable 1                       // Portable C engine back end (see "AsmDef.h")
+#define __sigma_headless  1                       // No GUI, i.e. no Carbon/Sigma Class Library UI
+#define __engine_smp      1                       // Lazy SMP helper threads (pthreads, see "SMP.c")
+#define __engine_threads  1                       // Engines run in OS threads (see "Engine.c")
+
+typedef int64_t        SInt64;
+typedef uint64_t       UInt64;
+typedef unsigned char  Str255[256];
+typedef unsigned char  Str63[64];
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__          // Word order such that MicroSecs() can be
+typedef struct { uint32_t lo, hi; } UnsignedWide;      // applied to a 64 bit integer (as in the GUI).
+#else
+typedef struct { uint32_t hi, lo; } UnsignedWide;
+#endif
+typedef struct { unsigned short red, green, blue; } RGBColor;
+enum { normal = 0 };                              // QuickDraw text style (also used as a zero constant)
+
+typedef struct { short year, month, day, hour, minute, second, dayOfWeek; } DateTimeRec;
+
+void Toolbox_Init (void);                         // Sets the startup time (before any threads)
+unsigned long TickCount (void);                   // Ticks (1/60th sec) since startup
+void Microseconds (UnsignedWide *m);              // Microseconds since startup
+short Random (void);
+void GetTime (DateTimeRec *d);
+void NumToString (long n, Str255 s);               // Pascal string
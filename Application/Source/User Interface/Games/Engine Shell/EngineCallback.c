@@ -134,25 +134,27 @@ void GameWindow::ProcessEngineMessage (void)
 } /* GameWindow::ProcessEngineMessage */
 
 
+// The first probe of a database loads the whole file and installs it in the engine, which then
+// probes it directly (i.e. without calling back). If it can't be loaded, the engine gets -1.
+
 static void ProbeEndgameDB (ENGINE *E)
 {
    CFile efile(nil);
    CHAR  fileName[50];
-   ULONG bytes = 4, res;
+   ULONG bytes;
+   PTR   data;
+   INT   db;
 
    E->S.edbResult = -1;
 
+   for (db = 0; db < edbCount && ! EqualStr(Engine_EndgameDBName(db), E->S.edbName); db++);
+   if (db == edbCount) return;
+
    Format(fileName, ":Endgame Databases:%s", E->S.edbName);
    if (efile.Set(fileName,'EDB') != fileError_NoError) return;
-   if (efile.Open(filePerm_Rd) != fileError_NoError) return;
-
-   if (efile.SetPos((E->S.edbPos/4)*3) != fileError_NoError) goto close;
-   if (efile.Read(&bytes, (PTR)&res) != fileError_NoError) goto close;
-
-   E->S.edbResult = (res >> (26 - 6*(E->S.edbPos % 4))) & 0x003F;
+   if (efile.Load(&bytes, &data) != fileError_NoError || ! data) return;
 
-close:
-   efile.Close();
+   Engine_SetEndgameDB(&Global, db, data, bytes);           // Kept until the application quits.
 } /* ProbeEndgameDB */
 
 
@@ -206,6 +206,7 @@ void GameWindow::SetSearchParam (BOOL nextBest)
    P->useEndgameDB   = Prefs.useEndgameDB;
    P->proVersion     = ProVersion();
    P->nextBest       = nextBest;
+   P->multiPV        = (! UsingUCIEngine() && MultiPVAllowed() ? GetMultiPVcount() : 1);
 
    //--- Mode/Level/Style parameters ---
 
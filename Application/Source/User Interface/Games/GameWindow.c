@@ -241,6 +241,7 @@ GameWindow::GameWindow (CHAR *title, CRect frame, BOOL isExaChess)
 
    varDisplayVer = Prefs.GameDisplay.varDisplayVer;
    multiPVoptionId = UCI_GetMultiPVOptionId(uciEngineId);
+   sigmaMultiPVcount = 1;
 
    toolbarTop = Prefs.GameDisplay.toolbarTop;
 
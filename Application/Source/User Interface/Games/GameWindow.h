@@ -273,6 +273,7 @@ public:
    BOOL showInfoArea;
    BOOL varDisplayVer;       // Verical PV display?.
    INT  multiPVoptionId;     // Index in UCI_INFO->Options[] of multiPV option. Set to -1 if multiPV not supported.
+   INT  sigmaMultiPVcount;   // Multi PV count of the built-in Sigma engine.
    BOOL toolbarTop;
 
    CRect mainRect, boardRect, infoRect, tabRect, toolbarRect, miniToolbarRect;  // Subview frames
@@ -490,13 +490,14 @@ BOOL GameWindow::EngineSupportsRating (CHAR *title)
 
 BOOL GameWindow::SupportsMultiPV (void)
 {
-   return multiPVoptionId != uci_NullOptionId;
+   return (! UsingUCIEngine() || multiPVoptionId != uci_NullOptionId);
 } // GameWindow::SupportsMultiPV
 
 
 INT GameWindow::GetMaxMultiPVcount (void)
 {
-   if (multiPVoptionId == uci_NullOptionId || EngineMatch.gameWin == this) return 1;
+   if (! SupportsMultiPV() || EngineMatch.gameWin == this) return 1;
+   if (! UsingUCIEngine()) return Min(maxMultiPV, uci_MaxMultiPVcount);
 
    UCI_INFO *UCIInfo = &Prefs.UCI.Engine[uciEngineId];
    return UCIInfo->Options[multiPVoptionId].u.Spin.max;
@@ -505,7 +506,8 @@ INT GameWindow::GetMaxMultiPVcount (void)
 
 INT GameWindow::GetMultiPVcount (void)
 {
-   if (multiPVoptionId == uci_NullOptionId || EngineMatch.gameWin == this) return 1;
+   if (! SupportsMultiPV() || EngineMatch.gameWin == this) return 1;
+   if (! UsingUCIEngine()) return sigmaMultiPVcount;
 
    UCI_INFO *UCIInfo = &Prefs.UCI.Engine[uciEngineId];
    return UCIInfo->Options[multiPVoptionId].u.Spin.val;
@@ -514,7 +516,16 @@ INT GameWindow::GetMultiPVcount (void)
 
 void GameWindow::SetMultiPVcount (INT count)
 {
-   if (multiPVoptionId == uci_NullOptionId || EngineMatch.gameWin == this) return;
+   if (! SupportsMultiPV() || EngineMatch.gameWin == this) return;
+
+   if (! UsingUCIEngine())
+   {  if (count >= 1 && count <= GetMaxMultiPVcount() && count != sigmaMultiPVcount)
+      {  sigmaMultiPVcount = count;
+         if (count > 2) varDisplayVer = false;
+         infoAreaView->RefreshAnalysis();
+      }
+      return;
+   }
 
    UCI_INFO   *UCIInfo = &Prefs.UCI.Engine[uciEngineId];
    UCI_OPTION *Option  = &UCIInfo->Options[multiPVoptionId];
@@ -530,13 +541,23 @@ void GameWindow::SetMultiPVcount (INT count)
 
 void GameWindow::IncMultiPVcount (void)
 {
-   if (multiPVoptionId == uci_NullOptionId || EngineMatch.gameWin == this) return;
+   if (! SupportsMultiPV() || EngineMatch.gameWin == this) return;
 
    if (! MultiPVAllowed())
    {  NoteDialog(this, "Multi PV not Available", "Multi PV is not available in the current playing mode. Choose 'Monitor', 'Infinite' or 'Manual' playing mode instead...");
       return;
    }
 
+   if (! UsingUCIEngine())
+   {  if (sigmaMultiPVcount < GetMaxMultiPVcount())
+      {  if (thinking && level.mode == pmode_Monitor)
+            Analyze_Stop();
+         SetMultiPVcount(sigmaMultiPVcount + 1);
+         CheckMonitorMode();
+      }
+      return;
+   }
+
    UCI_INFO   *UCIInfo = &Prefs.UCI.Engine[uciEngineId];
    UCI_OPTION *Option  = &UCIInfo->Options[multiPVoptionId];
 
@@ -557,7 +578,17 @@ void GameWindow::IncMultiPVcount (void)
 
 void GameWindow::DecMultiPVcount (void)
 {
-   if (multiPVoptionId == uci_NullOptionId || EngineMatch.gameWin == this) return;
+   if (! SupportsMultiPV() || EngineMatch.gameWin == this) return;
+
+   if (! UsingUCIEngine())
+   {  if (sigmaMultiPVcount > 1)
+      {  if (thinking && level.mode == pmode_Monitor)
+            Analyze_Stop();
+         SetMultiPVcount(sigmaMultiPVcount - 1);
+         CheckMonitorMode();
+      }
+      return;
+   }
 
    UCI_INFO   *UCIInfo = &Prefs.UCI.Engine[uciEngineId];
    UCI_OPTION *Option  = &UCIInfo->Options[multiPVoptionId];
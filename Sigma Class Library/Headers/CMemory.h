@@ -38,6 +38,13 @@ void Mem_FreePtr (void *ptr);
 BOOL Mem_SetPtrSize (PTR ptr, ULONG newSize);
 void Mem_Move (PTR from, PTR to, ULONG bytes); 
 
+// Large blocks resizable in place (reserved address space of which a prefix is committed). Only
+// available in the headless build (see "Headless/Memory.c").
+PTR  Mem_ReserveLargePtr (ULONG64 maxSize);
+BOOL Mem_CommitLargePtr (PTR ptr, ULONG64 size, ULONG64 newSize);
+void Mem_FreeLargePtr (PTR ptr, ULONG64 maxSize);
+ULONG64 Mem_PhysicalBytes (void);
+
 HANDLE Mem_AllocHandle (ULONG size);
 void Mem_FreeHandle (HANDLE h);
 void Mem_LockHandle (HANDLE h);
@@ -48,7 +48,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define maxint         0x7FFF
 #define maxlong        0x7FFFFFFF
 
-#define bit(i)         (1 << i)
+#define bit(i)         (1 << (i))
 #define bitL(i)        (1L << i)
 #define clrBit(i,a)    (a &= ~bit(i))
 #define even(x)        (((x) & 1) == 0)
@@ -68,14 +68,22 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /**************************************************************************************************/
 
 typedef short          INT;
+#ifdef __LP64__                      // LONG/ULONG must remain 32 bit (e.g. ATTACK words and file formats).
+typedef int            LONG;
+#else
 typedef long           LONG;
+#endif
 typedef short          BOOL;
 typedef char           CHAR;
 typedef unsigned char  BYTE;
 typedef unsigned char  *PTR;
 typedef double         REAL;
 typedef unsigned short UINT;
+#ifdef __LP64__
+typedef unsigned int   ULONG;
+#else
 typedef unsigned long  ULONG;
+#endif
 //typedef double         LONG64;
 //typedef double         ULONG64;
 typedef SInt64         LONG64;